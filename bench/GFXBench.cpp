@@ -0,0 +1,421 @@
+//=====================================================================
+//
+// GFXBench.cpp - Core math micro benchmarks
+//
+// Last Modified: 2026/10/18 17:48:05
+//
+// build one executable per GFX_PLATFORM and compare their json:
+//
+//   cl /O2 /EHsc /DGFX_PLATFORM=1 /I..\gfx GFXBench.cpp
+//      ..\gfx\GFXMatrix.cpp ..\gfx\GFXVector.cpp ..\gfx\GFXTransform.cpp
+//
+//   g++ -O2 -msse2 -DGFX_PLATFORM=1 -I../gfx GFXBench.cpp
+//      ../gfx/GFXMatrix.cpp ../gfx/GFXVector.cpp ../gfx/GFXTransform.cpp
+//
+// (platform 0 none, 1 sse2, 2 /arch:AVX, 3 /arch:AVX2, 4 neon)
+//
+// usage: GFXBench [-o result.json] [-q] [-f filter]
+//
+//=====================================================================
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <vector>
+#include <algorithm>
+
+#include "GFXMatrix.h"
+#include "GFXVector.h"
+#include "GFXTransform.h"
+
+using namespace GFX::Core;
+
+
+//---------------------------------------------------------------------
+// platform
+//---------------------------------------------------------------------
+static const char *PlatformName()
+{
+	switch (GFX_PLATFORM) {
+	case GFX_PLATFORM_NONE: return "none";
+	case GFX_PLATFORM_SSE2: return "sse2";
+	case GFX_PLATFORM_AVX: return "avx";
+	case GFX_PLATFORM_AVX2: return GFX_SIMD_FMA? "avx2+fma" : "avx2";
+	case GFX_PLATFORM_NEON: return "neon";
+	}
+	return "unknown";
+}
+
+static const char *CompilerName()
+{
+#if defined(_MSC_VER)
+	static char text[32];
+	sprintf(text, "msvc %d", (int)_MSC_VER);
+	return text;
+#elif defined(__clang__)
+	return "clang " __clang_version__;
+#elif defined(__GNUC__)
+	return "gcc " __VERSION__;
+#else
+	return "unknown";
+#endif
+}
+
+
+//---------------------------------------------------------------------
+// input data, filled from a fixed seed so every build sees the same
+// numbers. results are folded into g_sink so nothing is optimized out
+//---------------------------------------------------------------------
+struct BenchInstance
+{
+	Matrix4 mvp;
+	Matrix4 mv;
+	Matrix4 normal;
+};
+
+struct BenchData
+{
+	std::vector<Matrix4> m0, m1, mo;
+	std::vector<Vector3> a3, b3, o3;
+	std::vector<Vector4> a4, o4;
+	std::vector<float> f;
+	std::vector<BenchInstance> inst;
+	Matrix4 vp;
+	Transform transform;
+};
+
+static volatile float g_sink = 0.0f;
+static uint32_t g_seed = 0x12345678;
+
+static float Random(float low, float high)
+{
+	g_seed = g_seed * 1664525u + 1013904223u;
+	return low + (high - low) * (float)(g_seed >> 8) * (1.0f / 16777216.0f);
+}
+
+static void BenchData_Init(BenchData& d, size_t n)
+{
+	d.m0.resize(n), d.m1.resize(n), d.mo.resize(n);
+	d.a3.resize(n), d.b3.resize(n), d.o3.resize(n);
+	d.a4.resize(n), d.o4.resize(n);
+	d.f.resize(n);
+	d.inst.resize(n);
+	for (size_t i = 0; i < n; i++) {
+		Matrix4_SetRotate(d.m0[i], Random(-1, 1), Random(-1, 1), Random(-1, 1), Random(0, 6));
+		d.m0[i].m30 = Random(-100, 100);
+		d.m0[i].m31 = Random(-100, 100);
+		d.m0[i].m32 = Random(-100, 100);
+		Matrix4_SetRotate(d.m1[i], Random(-1, 1), Random(-1, 1), Random(-1, 1), Random(0, 6));
+		d.a3[i] = Vector3(Random(-10, 10), Random(-10, 10), Random(-10, 10));
+		d.b3[i] = Vector3(Random(-10, 10), Random(-10, 10), Random(-10, 10));
+		d.a4[i] = Vector4(Random(-10, 10), Random(-10, 10), Random(-10, 10), 1.0f);
+		d.f[i] = Random(0.1f, 3.0f);
+	}
+	Matrix4 view, proj;
+	Matrix4_LookAt(view, Vector4(0, 5, -10, 1), Vector4(0, 0, 0, 1), Vector4(0, 1, 0, 0));
+	Matrix4_SetPerspective(proj, PI_DIV_4, 16.0f / 9.0f, 0.1f, 1000.0f);
+	Matrix4::Multiply(d.vp, view, proj);
+	d.transform.SetTransform(TS_VIEW, &view);
+	d.transform.SetTransform(TS_PROJECTION, &proj);
+}
+
+
+//---------------------------------------------------------------------
+// cases: one call processes n items
+//---------------------------------------------------------------------
+static void Bench_MatrixMultiply(BenchData& d, size_t n)
+{
+	for (size_t i = 0; i < n; i++) {
+		Matrix4::Multiply(d.mo[i], d.m0[i], d.m1[i]);
+	}
+	g_sink = g_sink + d.mo[n - 1].m00;
+}
+
+static void Bench_MatrixMultiplyVp(BenchData& d, size_t n)
+{
+	for (size_t i = 0; i < n; i++) {
+		Matrix4::Multiply(d.mo[i], d.m0[i], d.vp);
+	}
+	g_sink = g_sink + d.mo[n - 1].m33;
+}
+
+static void Bench_MatrixTransform4(BenchData& d, size_t n)
+{
+	const Matrix4& m = d.m0[0];
+	for (size_t i = 0; i < n; i++) {
+		Matrix4::Transform(d.o4[i], m, d.a4[i]);
+	}
+	g_sink = g_sink + d.o4[n - 1].w;
+}
+
+static void Bench_MatrixTransform3(BenchData& d, size_t n)
+{
+	const Matrix4& m = d.m0[0];
+	for (size_t i = 0; i < n; i++) {
+		Matrix4::Transform(d.o3[i], m, d.a3[i]);
+	}
+	g_sink = g_sink + d.o3[n - 1].z;
+}
+
+static void Bench_TransformArray4(BenchData& d, size_t n)
+{
+	d.m0[0].TransformArray(&d.o4[0], &d.a4[0], n);
+	g_sink = g_sink + d.o4[n - 1].w;
+}
+
+static void Bench_TransformArray3(BenchData& d, size_t n)
+{
+	d.m0[0].TransformArray(&d.o3[0], &d.a3[0], n);
+	g_sink = g_sink + d.o3[n - 1].z;
+}
+
+static void Bench_VectorNormalize(BenchData& d, size_t n)
+{
+	for (size_t i = 0; i < n; i++) {
+		d.o3[i] = d.a3[i];
+		d.o3[i].Normalize();
+	}
+	g_sink = g_sink + d.o3[n - 1].x;
+}
+
+static void Bench_NormalizeArray(BenchData& d, size_t n)
+{
+	NormalizeArray(&d.o3[0], &d.a3[0], n);
+	g_sink = g_sink + d.o3[n - 1].x;
+}
+
+static void Bench_VectorCross(BenchData& d, size_t n)
+{
+	for (size_t i = 0; i < n; i++) {
+		d.o3[i] = d.a3[i].Cross(d.b3[i]);
+	}
+	g_sink = g_sink + d.o3[n - 1].y;
+}
+
+static void Bench_VectorDot(BenchData& d, size_t n)
+{
+	float sum = 0.0f;
+	for (size_t i = 0; i < n; i++) {
+		sum += d.a3[i].Dot(d.b3[i]);
+	}
+	g_sink = g_sink + sum;
+}
+
+static void Bench_SetRotate(BenchData& d, size_t n)
+{
+	for (size_t i = 0; i < n; i++) {
+		const Vector3& axis = d.a3[i];
+		Matrix4_SetRotate(d.mo[i], axis.x, axis.y, axis.z, d.f[i]);
+	}
+	g_sink = g_sink + d.mo[n - 1].m11;
+}
+
+static void Bench_LookAt(BenchData& d, size_t n)
+{
+	const Vector4 at(0.0f, 0.0f, 0.0f, 1.0f);
+	const Vector4 up(0.0f, 1.0f, 0.0f, 0.0f);
+	for (size_t i = 0; i < n; i++) {
+		Matrix4_LookAt(d.mo[i], d.a4[i], at, up);
+	}
+	g_sink = g_sink + d.mo[n - 1].m32;
+}
+
+static void Bench_SetPerspective(BenchData& d, size_t n)
+{
+	for (size_t i = 0; i < n; i++) {
+		Matrix4_SetPerspective(d.mo[i], d.f[i] * 0.5f, 16.0f / 9.0f, 0.1f, 1000.0f);
+	}
+	g_sink = g_sink + d.mo[n - 1].m00;
+}
+
+static void Bench_UpdateMvp(BenchData& d, size_t n)
+{
+	Transform& t = d.transform;
+	for (size_t i = 0; i < n; i++) {
+		t.SetTransform(TS_WORLD, &d.m0[i]);
+		t.UpdateMvp();
+		d.mo[i] = *t.GetMvp();
+	}
+	g_sink = g_sink + d.mo[n - 1].m30;
+}
+
+static void Bench_InstancesMvp(BenchData& d, size_t n)
+{
+	d.transform.ComputeInstances(&d.m0[0], n, &d.mo[0]);
+	g_sink = g_sink + d.mo[n - 1].m30;
+}
+
+static void Bench_InstancesAll(BenchData& d, size_t n)
+{
+	BenchInstance *inst = &d.inst[0];
+	d.transform.ComputeInstances(&d.m0[0], n, &inst->mvp, &inst->mv,
+			&inst->normal, sizeof(BenchInstance));
+	g_sink = g_sink + inst[n - 1].normal.m00;
+}
+
+
+//---------------------------------------------------------------------
+// runner: the pass count is calibrated so one sample takes about
+// target_ms, the median of the samples is reported
+//---------------------------------------------------------------------
+typedef void (*BenchFunc)(BenchData& d, size_t n);
+
+struct BenchCase
+{
+	const char *name;
+	BenchFunc func;
+};
+
+struct BenchResult
+{
+	const char *name;
+	size_t batch;
+	double ns_per_op;
+	double ns_min;
+	double mops;
+};
+
+static const BenchCase g_cases[] = {
+	{ "matrix4_multiply", Bench_MatrixMultiply },
+	{ "matrix4_multiply_vp", Bench_MatrixMultiplyVp },
+	{ "matrix4_transform_vec4", Bench_MatrixTransform4 },
+	{ "matrix4_transform_vec3", Bench_MatrixTransform3 },
+	{ "matrix4_transform_array_vec4", Bench_TransformArray4 },
+	{ "matrix4_transform_array_vec3", Bench_TransformArray3 },
+	{ "vector3_normalize", Bench_VectorNormalize },
+	{ "vector3_normalize_array", Bench_NormalizeArray },
+	{ "vector3_cross", Bench_VectorCross },
+	{ "vector3_dot", Bench_VectorDot },
+	{ "matrix4_set_rotate", Bench_SetRotate },
+	{ "matrix4_look_at", Bench_LookAt },
+	{ "matrix4_set_perspective", Bench_SetPerspective },
+	{ "transform_update_mvp", Bench_UpdateMvp },
+	{ "transform_instances_mvp", Bench_InstancesMvp },
+	{ "transform_instances_mvp_mv_normal", Bench_InstancesAll },
+};
+
+typedef std::chrono::steady_clock BenchClock;
+
+static double Seconds(BenchClock::time_point a, BenchClock::time_point b)
+{
+	return std::chrono::duration<double>(b - a).count();
+}
+
+static BenchResult BenchRun(const BenchCase& c, BenchData& d, size_t n,
+		double target_ms, int samples)
+{
+	size_t passes = 1;
+	c.func(d, n);
+	for (;;) {
+		BenchClock::time_point t0 = BenchClock::now();
+		for (size_t p = 0; p < passes; p++) c.func(d, n);
+		double ms = Seconds(t0, BenchClock::now()) * 1000.0;
+		if (ms >= target_ms * 0.5 || passes >= ((size_t)1 << 30)) {
+			if (ms > 0.0 && ms < target_ms) {
+				passes = (size_t)(passes * (target_ms / ms)) + 1;
+			}
+			break;
+		}
+		passes *= 2;
+	}
+	std::vector<double> ns(samples);
+	for (int s = 0; s < samples; s++) {
+		BenchClock::time_point t0 = BenchClock::now();
+		for (size_t p = 0; p < passes; p++) c.func(d, n);
+		ns[s] = Seconds(t0, BenchClock::now()) * 1e9 / ((double)passes * n);
+	}
+	std::sort(ns.begin(), ns.end());
+	BenchResult r;
+	r.name = c.name;
+	r.batch = n;
+	r.ns_per_op = ns[samples / 2];
+	r.ns_min = ns[0];
+	r.mops = (r.ns_per_op > 0.0)? 1000.0 / r.ns_per_op : 0.0;
+	return r;
+}
+
+
+//---------------------------------------------------------------------
+// json
+//---------------------------------------------------------------------
+static bool WriteJson(const char *filename, const std::vector<BenchResult>& results)
+{
+	FILE *fp = fopen(filename, "w");
+	if (fp == NULL) return false;
+	fprintf(fp, "{\n");
+	fprintf(fp, "  \"platform\": \"%s\",\n", PlatformName());
+	fprintf(fp, "  \"platform_id\": %d,\n", (int)GFX_PLATFORM);
+	fprintf(fp, "  \"compiler\": \"%s\",\n", CompilerName());
+	fprintf(fp, "  \"results\": [\n");
+	for (size_t i = 0; i < results.size(); i++) {
+		const BenchResult& r = results[i];
+		fprintf(fp, "    { \"name\": \"%s\", \"batch\": %d, \"ns_per_op\": %.4f, "
+				"\"ns_min\": %.4f, \"mops_per_sec\": %.3f }%s\n",
+				r.name, (int)r.batch, r.ns_per_op, r.ns_min, r.mops,
+				(i + 1 < results.size())? "," : "");
+	}
+	fprintf(fp, "  ]\n");
+	fprintf(fp, "}\n");
+	fclose(fp);
+	return true;
+}
+
+
+//---------------------------------------------------------------------
+// main
+//---------------------------------------------------------------------
+int main(int argc, char *argv[])
+{
+	const char *output = "gfxbench.json";
+	const char *filter = NULL;
+	bool quick = false;
+
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+			output = argv[++i];
+		}
+		else if (strcmp(argv[i], "-f") == 0 && i + 1 < argc) {
+			filter = argv[++i];
+		}
+		else if (strcmp(argv[i], "-q") == 0) {
+			quick = true;
+		}
+		else {
+			printf("usage: %s [-o result.json] [-q] [-f filter]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	// from a few draw calls up to a large scene, the largest batch
+	// no longer fits in L2 (64K matrices are 4MB)
+	const size_t batches[] = { 16, 256, 4096, 65536 };
+	const int batch_count = (int)(sizeof(batches) / sizeof(batches[0]));
+	const double target_ms = quick? 5.0 : 40.0;
+	const int samples = quick? 3 : 7;
+
+	BenchData data;
+	BenchData_Init(data, batches[batch_count - 1]);
+
+	printf("platform: %s, compiler: %s\n", PlatformName(), CompilerName());
+	printf("%-32s %8s %12s %12s %12s\n", "case", "batch", "ns/op", "ns/op min", "Mop/s");
+
+	std::vector<BenchResult> results;
+	for (size_t c = 0; c < sizeof(g_cases) / sizeof(g_cases[0]); c++) {
+		if (filter && strstr(g_cases[c].name, filter) == NULL) continue;
+		for (int b = 0; b < batch_count; b++) {
+			BenchResult r = BenchRun(g_cases[c], data, batches[b], target_ms, samples);
+			printf("%-32s %8d %12.3f %12.3f %12.2f\n", r.name, (int)r.batch,
+					r.ns_per_op, r.ns_min, r.mops);
+			results.push_back(r);
+		}
+	}
+
+	if (!WriteJson(output, results)) {
+		printf("can not write %s\n", output);
+		return 2;
+	}
+	printf("results written to %s\n", output);
+	return 0;
+}
+
+
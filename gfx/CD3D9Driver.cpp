@@ -465,6 +465,7 @@ bool CD3D9Driver::Clear(bool target, bool zBuffer, bool stencil)
 bool CD3D9Driver::BeginScene()
 {
 	if (m_device) {
+		FlushTextures();
 		HRESULT hr = m_device->BeginScene();
 		if (SUCCEEDED(hr)) {
 			return true;
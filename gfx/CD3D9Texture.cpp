@@ -7,6 +7,8 @@
 //=====================================================================
 #include "CD3D9Texture.h"
 #include "GFXWin32.h"
+#include "GFXResample.h"
+#include "GFXMipmap.h"
 
 
 //---------------------------------------------------------------------
@@ -108,20 +110,56 @@ int CD3D9Texture::Create(CD3D9Driver *drv, int w, int h, PixelFormat fmt, int fl
 
 
 //---------------------------------------------------------------------
-// create with parameters
+// create from image: sizes the device can't take (pow2 / square only)
+// get the image resampled to what TextureFit says, lower levels are
+// built from it on the cpu
 //---------------------------------------------------------------------
 int CD3D9Texture::Create(CD3D9Driver *drv, const Image *image, int flag, int mipmap)
 {
 	Release();
-	int hr = CreateTexture(drv->GetDevice(), image->GetWidth(), image->GetHeight(),
-			image->GetFormat(), flag, mipmap);
+	int w = image->GetWidth();
+	int h = image->GetHeight();
+	int tw = w, th = h;
+	Image *fitted = NULL;
+	drv->TextureFit(w, h, image->GetFormat(), &tw, &th);
+	if (tw != w || th != h) {
+		fitted = ResizeImage(image, tw, th, RESAMPLE_BICUBIC);
+		if (fitted == NULL) {
+			return -1;
+		}
+		image = fitted;
+	}
+	int hr = CreateTexture(drv->GetDevice(), tw, th, image->GetFormat(), flag, mipmap);
 	if (hr == 0) {
 		this->RestoreFromImage(0, image);
+		if (m_levels > 1) {
+			GenerateMipmaps(this, image, MIPMAP_BOX);
+		}
+	}
+	if (fitted) {
+		delete fitted;
 	}
 	return hr;
 }
 
 
+//---------------------------------------------------------------------
+// pool factory
+//---------------------------------------------------------------------
+TextureFactory CD3D9Texture::Factory(CD3D9Driver *drv)
+{
+	return [drv](const TextureDesc& desc) -> Texture* {
+		CD3D9Texture *texture = new CD3D9Texture();
+		if (texture->Create(drv, desc.width, desc.height, desc.format,
+					desc.flag, desc.levels) != 0) {
+			delete texture;
+			return NULL;
+		}
+		return texture;
+	};
+}
+
+
 //---------------------------------------------------------------------
 // create from file
 //---------------------------------------------------------------------
@@ -11,6 +11,7 @@
 
 #include "CD3D9Driver.h"
 #include "GFXTexture.h"
+#include "GFXTexturePool.h"
 
 
 //---------------------------------------------------------------------
@@ -47,6 +48,9 @@ public:
 
 	static D3DFORMAT GetD3DFormat(PixelFormat fmt);
 
+	// factory for TexturePool, desc.flag and desc.levels go to Create
+	static TextureFactory Factory(CD3D9Driver *drv);
+
 protected:
 	int CreateTexture(IDirect3DDevice9 *device, int w, int h, PixelFormat fmt, int flag, int mipmap);
 
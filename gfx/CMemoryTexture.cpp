@@ -0,0 +1,332 @@
+//=====================================================================
+//
+// CMemoryTexture.cpp - texture in system memory
+//
+// Last Modified: 2026/10/18 21:48:20
+//
+//=====================================================================
+#include <stdlib.h>
+#include <string.h>
+
+#include "CMemoryTexture.h"
+#include "GFXMipmap.h"
+#include "GFXPixel.h"
+
+
+//---------------------------------------------------------------------
+// Namespace Begin
+//---------------------------------------------------------------------
+NAMESPACE_BEGIN(GFX);
+
+#define MEMTEX_ALIGN		64
+#define MEMTEX_PITCH_ALIGN	16
+
+
+//---------------------------------------------------------------------
+// ctor
+//---------------------------------------------------------------------
+CMemoryTexture::CMemoryTexture()
+{
+	m_raw = NULL;
+	m_bits = NULL;
+	m_size = 0;
+	m_readers = 0;
+	m_writer = false;
+}
+
+
+//---------------------------------------------------------------------
+// dtor
+//---------------------------------------------------------------------
+CMemoryTexture::~CMemoryTexture()
+{
+	Release();
+}
+
+
+//---------------------------------------------------------------------
+// release
+//---------------------------------------------------------------------
+int CMemoryTexture::Release()
+{
+	if (m_raw) {
+		free(m_raw);
+		m_raw = NULL;
+	}
+	m_bits = NULL;
+	m_size = 0;
+	m_offsets.clear();
+	m_pitches.clear();
+	m_readers = 0;
+	m_writer = false;
+	InitSize(0, 0, FMT_A8R8G8B8, true);
+	return 0;
+}
+
+
+//---------------------------------------------------------------------
+// create with parameters
+//---------------------------------------------------------------------
+int CMemoryTexture::Create(int w, int h, PixelFormat fmt, int mipmap)
+{
+	Release();
+	if (w <= 0 || h <= 0 || fmt >= FMT_UNKNOWN) {
+		return -1;
+	}
+	int levels = GetMipmapLevels(w, h);
+	if (mipmap > 0 && mipmap < levels) {
+		levels = mipmap;
+	}
+	InitSize(w, h, fmt, true);
+	m_levels = levels;
+	m_offsets.resize(levels);
+	m_pitches.resize(levels);
+	size_t size = 0;
+	for (int i = 0; i < levels; i++) {
+		int32_t pitch = (int32_t)(GetLevelWidth(i) * (m_bpp / 8));
+		pitch = (pitch + MEMTEX_PITCH_ALIGN - 1) & ~(MEMTEX_PITCH_ALIGN - 1);
+		m_offsets[i] = size;
+		m_pitches[i] = pitch;
+		size += (size_t)pitch * GetLevelHeight(i);
+		size = (size + MEMTEX_ALIGN - 1) & ~((size_t)MEMTEX_ALIGN - 1);
+	}
+	m_raw = malloc(size + MEMTEX_ALIGN);
+	if (m_raw == NULL) {
+		Release();
+		return -1;
+	}
+	m_bits = (uint8_t*)(((size_t)m_raw + MEMTEX_ALIGN - 1) & ~((size_t)MEMTEX_ALIGN - 1));
+	m_size = size;
+	memset(m_bits, 0, size);
+	return 0;
+}
+
+
+//---------------------------------------------------------------------
+// create from image
+//---------------------------------------------------------------------
+int CMemoryTexture::Create(const Image *image, int mipmap)
+{
+	int hr = Create(image->GetWidth(), image->GetHeight(), image->GetFormat(), mipmap);
+	if (hr == 0) {
+		RestoreFromImage(0, image);
+		if (m_levels > 1) {
+			GenerateMipmaps(this, image, MIPMAP_BOX);
+		}
+	}
+	return hr;
+}
+
+
+//---------------------------------------------------------------------
+// pool factory
+//---------------------------------------------------------------------
+TextureFactory CMemoryTexture::Factory()
+{
+	return [](const TextureDesc& desc) -> Texture* {
+		CMemoryTexture *texture = new CMemoryTexture();
+		if (texture->Create(desc.width, desc.height, desc.format, desc.levels) != 0) {
+			delete texture;
+			return NULL;
+		}
+		return texture;
+	};
+}
+
+
+//---------------------------------------------------------------------
+// level memory
+//---------------------------------------------------------------------
+uint8_t* CMemoryTexture::GetLevelBits(int mip)
+{
+	if (m_bits == NULL || mip < 0 || mip >= m_levels) return NULL;
+	return m_bits + m_offsets[mip];
+}
+
+const uint8_t* CMemoryTexture::GetLevelBits(int mip) const
+{
+	if (m_bits == NULL || mip < 0 || mip >= m_levels) return NULL;
+	return m_bits + m_offsets[mip];
+}
+
+int32_t CMemoryTexture::GetLevelPitch(int mip) const
+{
+	if (m_bits == NULL || mip < 0 || mip >= m_levels) return 0;
+	return m_pitches[mip];
+}
+
+
+//---------------------------------------------------------------------
+// take a read or write lock of rect (NULL: whole level), NULL when
+// the rect is outside the level or the lock conflicts
+//---------------------------------------------------------------------
+uint8_t* CMemoryTexture::AcquireLock(int mip, const Rect *rect, bool readOnly)
+{
+	uint8_t *bits = GetLevelBits(mip);
+	if (bits == NULL) {
+		return NULL;
+	}
+	int w = GetLevelWidth(mip);
+	int h = GetLevelHeight(mip);
+	int left = 0, top = 0, right = w, bottom = h;
+	if (rect) {
+		left = rect->left;
+		top = rect->top;
+		right = rect->right;
+		bottom = rect->bottom;
+		if (left < 0 || top < 0 || right > w || bottom > h) return NULL;
+		if (left >= right || top >= bottom) return NULL;
+	}
+	bits += (size_t)m_pitches[mip] * top + (size_t)left * (m_bpp / 8);
+	std::lock_guard<std::mutex> guard(m_lock);
+	if (m_writer || (readOnly == false && m_readers > 0)) {
+		return NULL;
+	}
+	if (readOnly) {
+		if (m_readers++ > 0) {
+			return bits;
+		}
+	}
+	else {
+		m_writer = true;
+	}
+	m_locked_bits = bits;
+	m_locked_pitch = m_pitches[mip];
+	m_locked_w = right - left;
+	m_locked_h = bottom - top;
+	return bits;
+}
+
+
+//---------------------------------------------------------------------
+// drop the write lock or one read lock
+//---------------------------------------------------------------------
+void CMemoryTexture::ReleaseLock()
+{
+	std::lock_guard<std::mutex> guard(m_lock);
+	if (m_writer) {
+		m_writer = false;
+	}
+	else if (m_readers > 0) {
+		if (--m_readers > 0) {
+			return;
+		}
+	}
+	m_locked_bits = NULL;
+	m_locked_pitch = 0;
+}
+
+
+//---------------------------------------------------------------------
+// lock
+//---------------------------------------------------------------------
+void* CMemoryTexture::Lock(int mip, const Rect *rect, bool readOnly)
+{
+	return AcquireLock(mip, rect, readOnly);
+}
+
+
+//---------------------------------------------------------------------
+// unlock
+//---------------------------------------------------------------------
+void CMemoryTexture::Unlock(int mip)
+{
+	(void)mip;
+	ReleaseLock();
+}
+
+
+//---------------------------------------------------------------------
+// update rect
+//---------------------------------------------------------------------
+bool CMemoryTexture::UpdateTexture(int mip, const Rect *rect, const void *bits, int pitch)
+{
+	if (m_driver) {
+		return StageUpdate(mip, rect, bits, pitch, m_format);
+	}
+	uint8_t *dst = AcquireLock(mip, rect, false);
+	if (dst == NULL) {
+		return false;
+	}
+	const uint8_t *src = (const uint8_t*)bits;
+	int32_t stride = m_pitches[mip];
+	int w = (rect)? (rect->right - rect->left) : GetLevelWidth(mip);
+	int h = (rect)? (rect->bottom - rect->top) : GetLevelHeight(mip);
+	int size = (m_bpp / 8) * w;
+	for (int j = 0; j < h; j++) {
+		memcpy(dst, src, size);
+		dst += stride;
+		src += pitch;
+	}
+	ReleaseLock();
+	return true;
+}
+
+
+//---------------------------------------------------------------------
+// read texture
+//---------------------------------------------------------------------
+bool CMemoryTexture::ReadTexture(int mip, const Rect *rect, void *bits, int pitch)
+{
+	if (m_pending > 0) {
+		Flush();
+	}
+	const uint8_t *src = AcquireLock(mip, rect, true);
+	if (src == NULL) {
+		return false;
+	}
+	uint8_t *dst = (uint8_t*)bits;
+	int32_t stride = m_pitches[mip];
+	int w = (rect)? (rect->right - rect->left) : GetLevelWidth(mip);
+	int h = (rect)? (rect->bottom - rect->top) : GetLevelHeight(mip);
+	int size = (m_bpp / 8) * w;
+	for (int j = 0; j < h; j++) {
+		memcpy(dst, src, size);
+		dst += pitch;
+		src += stride;
+	}
+	ReleaseLock();
+	return true;
+}
+
+
+//---------------------------------------------------------------------
+// read rect converted to fmt, a reader like ReadTexture
+//---------------------------------------------------------------------
+bool CMemoryTexture::ReadConverted(int mip, const Rect *rect, void *bits, int pitch,
+		PixelFormat fmt)
+{
+	const uint8_t *src = AcquireLock(mip, rect, true);
+	if (src == NULL) {
+		return false;
+	}
+	ConvertPixels(bits, pitch, fmt, src, m_pitches[mip], m_format,
+			rect->right - rect->left, rect->bottom - rect->top);
+	ReleaseLock();
+	return true;
+}
+
+
+//---------------------------------------------------------------------
+// write rect converted from fmt
+//---------------------------------------------------------------------
+bool CMemoryTexture::UpdateConverted(int mip, const Rect *rect, const void *bits, int pitch,
+		PixelFormat fmt)
+{
+	uint8_t *dst = AcquireLock(mip, rect, false);
+	if (dst == NULL) {
+		return false;
+	}
+	ConvertPixels(dst, m_pitches[mip], m_format, bits, pitch, fmt,
+			rect->right - rect->left, rect->bottom - rect->top);
+	ReleaseLock();
+	return true;
+}
+
+
+//---------------------------------------------------------------------
+// Namespace End
+//---------------------------------------------------------------------
+NAMESPACE_END(GFX);
+
+
@@ -0,0 +1,104 @@
+//=====================================================================
+//
+// CMemoryTexture.h - texture in system memory
+//
+// Last Modified: 2026/10/18 21:48:20
+//
+//=====================================================================
+#ifndef _CMEMORY_TEXTURE_H_
+#define _CMEMORY_TEXTURE_H_
+
+#include <mutex>
+
+#include "GFXTexture.h"
+#include "GFXTexturePool.h"
+
+
+//---------------------------------------------------------------------
+// Namespace Begin
+//---------------------------------------------------------------------
+NAMESPACE_BEGIN(GFX);
+
+
+//---------------------------------------------------------------------
+// Memory Texture: every level in one 64 byte aligned block, levels
+// start on 64 byte boundaries and rows on 16. needs no device, so the
+// whole Texture interface works headless.
+//
+// Lock takes a sub rect of any level. any number of read locks may be
+// held at once (from any thread), a write lock excludes everything
+// else, and a Lock that conflicts returns NULL instead of waiting.
+// LockedPitch / LockedBits describe the lock that made the texture
+// locked, readers sharing it use GetLevelPitch. ReadTexture and
+// UpdateTexture copy with their own lock, ReadTexture runs
+// concurrently with other readers (unless it has deferred updates to
+// flush first), so do the format converting CopyTo / SaveToImage
+//---------------------------------------------------------------------
+class CMemoryTexture : public Texture
+{
+public:
+	virtual ~CMemoryTexture();
+	CMemoryTexture();
+
+public:
+
+	// mipmap is the level count as in CD3D9Texture: 0 for a full chain,
+	// otherwise clamped to it. levels start cleared to zero, returns 0
+	// or -1 for FMT_UNKNOWN / an empty size
+	virtual int Create(int w, int h, PixelFormat fmt, int mipmap = 1);
+
+	// level 0 from image, lower levels built with a box filter
+	virtual int Create(const Image *image, int mipmap = 1);
+
+	virtual int Release();
+
+	virtual void *Lock(int mip, const Rect *rect, bool readOnly = false);
+	virtual void Unlock(int mip);
+
+	virtual bool UpdateTexture(int mip, const Rect *rect, const void *bits, int pitch);
+	virtual bool ReadTexture(int mip, const Rect *rect, void *bits, int pitch);
+
+	inline bool Available() const { return m_bits? true : false; }
+
+	// level memory, NULL / 0 for a level that doesn't exist. reading
+	// or writing it directly bypasses the locks
+	uint8_t *GetLevelBits(int mip);
+	const uint8_t *GetLevelBits(int mip) const;
+	int32_t GetLevelPitch(int mip) const;
+
+	// bytes allocated for all levels
+	inline size_t GetMemorySize() const { return m_size; }
+
+	// factory for TexturePool
+	static TextureFactory Factory();
+
+protected:
+	virtual bool ReadConverted(int mip, const Rect *rect, void *bits, int pitch,
+			PixelFormat fmt);
+	virtual bool UpdateConverted(int mip, const Rect *rect, const void *bits, int pitch,
+			PixelFormat fmt);
+
+	uint8_t *AcquireLock(int mip, const Rect *rect, bool readOnly);
+	void ReleaseLock();
+
+protected:
+	void *m_raw;
+	uint8_t *m_bits;
+	size_t m_size;
+	std::vector<size_t> m_offsets;
+	std::vector<int32_t> m_pitches;
+	std::mutex m_lock;
+	int m_readers;
+	bool m_writer;
+};
+
+
+//---------------------------------------------------------------------
+// Namespace End
+//---------------------------------------------------------------------
+NAMESPACE_END(GFX);
+
+
+#endif
+
+
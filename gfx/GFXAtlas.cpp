@@ -0,0 +1,413 @@
+//=====================================================================
+//
+// GFXAtlas.cpp - images packed into one texture
+//
+// Last Modified: 2026/10/18 22:40:07
+//
+//=====================================================================
+#include <algorithm>
+
+#include "GFXAtlas.h"
+
+
+//---------------------------------------------------------------------
+// Namespace Begin
+//---------------------------------------------------------------------
+NAMESPACE_BEGIN(GFX);
+
+// candidates looked at per move allowed in Compact
+#define ATLAS_COMPACT_SCAN		8
+
+
+//---------------------------------------------------------------------
+// rect helpers
+//---------------------------------------------------------------------
+static inline int64_t AtlasArea(const Rect& r)
+{
+	return (int64_t)(r.right - r.left) * (r.bottom - r.top);
+}
+
+static inline bool AtlasIntersect(const Rect& a, const Rect& b)
+{
+	return a.left < b.right && b.left < a.right && a.top < b.bottom && b.top < a.bottom;
+}
+
+static inline bool AtlasContains(const Rect& a, const Rect& b)
+{
+	return a.left <= b.left && a.top <= b.top && a.right >= b.right && a.bottom >= b.bottom;
+}
+
+static inline Rect AtlasRect(int left, int top, int right, int bottom)
+{
+	Rect r;
+	r.left = left;
+	r.top = top;
+	r.right = right;
+	r.bottom = bottom;
+	return r;
+}
+
+
+//---------------------------------------------------------------------
+// ctor
+//---------------------------------------------------------------------
+TextureAtlas::TextureAtlas()
+{
+	m_texture = NULL;
+	m_gutter = 0;
+	m_count = 0;
+	m_used_area = 0;
+}
+
+
+//---------------------------------------------------------------------
+// dtor
+//---------------------------------------------------------------------
+TextureAtlas::~TextureAtlas()
+{
+}
+
+
+//---------------------------------------------------------------------
+// create
+//---------------------------------------------------------------------
+void TextureAtlas::Create(Texture *texture, int gutter)
+{
+	m_texture = texture;
+	m_gutter = (gutter < 0)? 0 : gutter;
+	Clear();
+}
+
+
+//---------------------------------------------------------------------
+// clear
+//---------------------------------------------------------------------
+void TextureAtlas::Clear()
+{
+	m_entries.clear();
+	m_unused.clear();
+	m_free.clear();
+	m_count = 0;
+	m_used_area = 0;
+	if (m_texture && m_texture->GetWidth() > 0 && m_texture->GetHeight() > 0) {
+		m_free.push_back(AtlasRect(0, 0, m_texture->GetWidth(), m_texture->GetHeight()));
+	}
+}
+
+
+//---------------------------------------------------------------------
+// best free rect for w x h: shortest leftover side first, or lowest
+// bottom edge then leftmost
+//---------------------------------------------------------------------
+bool TextureAtlas::FindPosition(int w, int h, int fit, Rect *rect) const
+{
+	int best1 = -1, best2 = -1;
+	bool found = false;
+	for (size_t i = 0; i < m_free.size(); i++) {
+		const Rect& f = m_free[i];
+		int fw = f.right - f.left;
+		int fh = f.bottom - f.top;
+		if (fw < w || fh < h) continue;
+		int s1, s2;
+		if (fit == FIT_SHORT_SIDE) {
+			s1 = std::min(fw - w, fh - h);
+			s2 = std::max(fw - w, fh - h);
+		}
+		else {
+			s1 = f.top + h;
+			s2 = f.left;
+		}
+		if (!found || s1 < best1 || (s1 == best1 && s2 < best2)) {
+			best1 = s1;
+			best2 = s2;
+			*rect = AtlasRect(f.left, f.top, f.left + w, f.top + h);
+			found = true;
+		}
+	}
+	return found;
+}
+
+
+//---------------------------------------------------------------------
+// take rect out of the free space: every free rect it cuts is split
+// into the up to four maximal pieces around it, then pieces inside
+// another free rect are dropped
+//---------------------------------------------------------------------
+void TextureAtlas::Occupy(const Rect& r)
+{
+	std::vector<Rect> pieces;
+	size_t count = 0;
+	for (size_t i = 0; i < m_free.size(); i++) {
+		const Rect f = m_free[i];
+		if (!AtlasIntersect(f, r)) {
+			m_free[count++] = f;
+			continue;
+		}
+		if (r.top > f.top) pieces.push_back(AtlasRect(f.left, f.top, f.right, r.top));
+		if (r.bottom < f.bottom) pieces.push_back(AtlasRect(f.left, r.bottom, f.right, f.bottom));
+		if (r.left > f.left) pieces.push_back(AtlasRect(f.left, f.top, r.left, f.bottom));
+		if (r.right < f.right) pieces.push_back(AtlasRect(r.right, f.top, f.right, f.bottom));
+	}
+	m_free.resize(count);
+
+	// only the new pieces can be redundant or make others redundant,
+	// pieces kept are in m_free when the next one is checked
+	for (size_t i = 0; i < pieces.size(); i++) {
+		bool keep = true;
+		for (size_t j = 0; j < m_free.size() && keep; j++) {
+			if (AtlasContains(m_free[j], pieces[i])) keep = false;
+		}
+		if (!keep) continue;
+		count = 0;
+		for (size_t j = 0; j < m_free.size(); j++) {
+			if (!AtlasContains(pieces[i], m_free[j])) {
+				m_free[count++] = m_free[j];
+			}
+		}
+		m_free.resize(count);
+		m_free.push_back(pieces[i]);
+	}
+}
+
+
+//---------------------------------------------------------------------
+// give rect back: it is joined with free rects sharing a whole edge,
+// the result is free but not necessarily maximal until Rebuild
+//---------------------------------------------------------------------
+void TextureAtlas::Release(const Rect& rect)
+{
+	Rect r = rect;
+	for (size_t i = 0; i < m_free.size(); ) {
+		const Rect& f = m_free[i];
+		bool join = false;
+		if (f.left == r.left && f.right == r.right) {
+			join = (f.bottom == r.top || f.top == r.bottom);
+		}
+		else if (f.top == r.top && f.bottom == r.bottom) {
+			join = (f.right == r.left || f.left == r.right);
+		}
+		if (join || AtlasContains(r, f)) {
+			r = AtlasRect(std::min(r.left, f.left), std::min(r.top, f.top),
+					std::max(r.right, f.right), std::max(r.bottom, f.bottom));
+			m_free[i] = m_free.back();
+			m_free.pop_back();
+			i = 0;
+			continue;
+		}
+		i++;
+	}
+	for (size_t i = 0; i < m_free.size(); i++) {
+		if (AtlasContains(m_free[i], r)) return;
+	}
+	m_free.push_back(r);
+}
+
+
+//---------------------------------------------------------------------
+// exact maximal free rects from the cells in use
+//---------------------------------------------------------------------
+void TextureAtlas::Rebuild()
+{
+	m_free.clear();
+	if (m_texture == NULL) return;
+	m_free.push_back(AtlasRect(0, 0, m_texture->GetWidth(), m_texture->GetHeight()));
+	for (size_t i = 0; i < m_entries.size(); i++) {
+		if (m_entries[i].used) {
+			Occupy(m_entries[i].cell);
+		}
+	}
+}
+
+
+//---------------------------------------------------------------------
+// copy the sw x sh rect of image to x, y of the texture with its edge
+// pixels repeated into the gutters
+//---------------------------------------------------------------------
+void TextureAtlas::Upload(int x, int y, const Image *image, int sx, int sy, int sw, int sh)
+{
+	int g = m_gutter;
+	if (g == 0) {
+		m_texture->CopyFrom(0, x, y, image, sx, sy, sw, sh);
+		return;
+	}
+	int w = sw + g * 2;
+	int h = sh + g * 2;
+	Image padded(w, h, image->GetFormat());
+	padded.Blit(g, g, image, sx, sy, sw, sh);
+	for (int i = 0; i < g; i++) {
+		padded.Blit(g, i, &padded, g, g, sw, 1);
+		padded.Blit(g, h - 1 - i, &padded, g, h - 1 - g, sw, 1);
+	}
+	for (int i = 0; i < g; i++) {
+		padded.Blit(i, 0, &padded, g, 0, 1, h);
+		padded.Blit(w - 1 - i, 0, &padded, w - 1 - g, 0, 1, h);
+	}
+	m_texture->CopyFrom(0, x, y, &padded, 0, 0, w, h);
+}
+
+
+//---------------------------------------------------------------------
+// insert
+//---------------------------------------------------------------------
+int TextureAtlas::Insert(const Image *image)
+{
+	return Insert(image, 0, 0, image->GetWidth(), image->GetHeight());
+}
+
+int TextureAtlas::Insert(const Image *image, int sx, int sy, int sw, int sh)
+{
+	if (m_texture == NULL || sw <= 0 || sh <= 0) return -1;
+	if (sx < 0 || sy < 0 || sx + sw > image->GetWidth() || sy + sh > image->GetHeight()) {
+		return -1;
+	}
+	int w = sw + m_gutter * 2;
+	int h = sh + m_gutter * 2;
+	Rect cell;
+	if (!FindPosition(w, h, FIT_SHORT_SIDE, &cell)) {
+		// removals leave the free list approximate, try the exact one
+		Rebuild();
+		if (!FindPosition(w, h, FIT_SHORT_SIDE, &cell)) {
+			return -1;
+		}
+	}
+	Occupy(cell);
+	Upload(cell.left, cell.top, image, sx, sy, sw, sh);
+	int id;
+	if (m_unused.empty()) {
+		id = (int)m_entries.size();
+		m_entries.resize(id + 1);
+	}
+	else {
+		id = m_unused.back();
+		m_unused.pop_back();
+	}
+	m_entries[id].cell = cell;
+	m_entries[id].used = true;
+	m_count++;
+	m_used_area += AtlasArea(cell);
+	return id;
+}
+
+
+//---------------------------------------------------------------------
+// remove
+//---------------------------------------------------------------------
+bool TextureAtlas::Remove(int id)
+{
+	if (id < 0 || id >= (int)m_entries.size() || !m_entries[id].used) {
+		return false;
+	}
+	Entry& entry = m_entries[id];
+	entry.used = false;
+	Release(entry.cell);
+	m_unused.push_back(id);
+	m_count--;
+	m_used_area -= AtlasArea(entry.cell);
+	return true;
+}
+
+
+//---------------------------------------------------------------------
+// rects
+//---------------------------------------------------------------------
+bool TextureAtlas::GetRect(int id, Rect *rect) const
+{
+	if (id < 0 || id >= (int)m_entries.size() || !m_entries[id].used) {
+		return false;
+	}
+	const Rect& cell = m_entries[id].cell;
+	rect->left = cell.left + m_gutter;
+	rect->top = cell.top + m_gutter;
+	rect->right = cell.right - m_gutter;
+	rect->bottom = cell.bottom - m_gutter;
+	return true;
+}
+
+bool TextureAtlas::GetUV(int id, RectFloat *uv) const
+{
+	Rect rc;
+	if (!GetRect(id, &rc)) {
+		return false;
+	}
+	float iw = m_texture->GetInvWidth();
+	float ih = m_texture->GetInvHeight();
+	uv->left = rc.left * iw;
+	uv->top = rc.top * ih;
+	uv->right = rc.right * iw;
+	uv->bottom = rc.bottom * ih;
+	return true;
+}
+
+
+//---------------------------------------------------------------------
+// fragmentation
+//---------------------------------------------------------------------
+float TextureAtlas::GetFragmentation() const
+{
+	if (m_texture == NULL) return 0.0f;
+	int64_t total = (int64_t)m_texture->GetWidth() * m_texture->GetHeight();
+	int64_t free_area = total - m_used_area;
+	if (free_area <= 0) return 0.0f;
+	int64_t largest = 0;
+	for (size_t i = 0; i < m_free.size(); i++) {
+		largest = std::max(largest, AtlasArea(m_free[i]));
+	}
+	return 1.0f - (float)((double)largest / (double)free_area);
+}
+
+
+//---------------------------------------------------------------------
+// compact: the cells with the highest bottom edge are taken out one
+// at a time and put back at the lowest place the free space has,
+// moving the pixels when that place is lower
+//---------------------------------------------------------------------
+int TextureAtlas::Compact(int max_moves, std::vector<int> *moved)
+{
+	if (m_texture == NULL || max_moves <= 0 || m_count == 0) return 0;
+	Rebuild();
+	std::vector<int> order;
+	for (size_t i = 0; i < m_entries.size(); i++) {
+		if (m_entries[i].used) order.push_back((int)i);
+	}
+	const std::vector<Entry>& entries = m_entries;
+	std::sort(order.begin(), order.end(), [&entries](int a, int b) {
+		const Rect& ra = entries[a].cell;
+		const Rect& rb = entries[b].cell;
+		if (ra.bottom != rb.bottom) return ra.bottom > rb.bottom;
+		return ra.left > rb.left;
+	});
+	int moves = 0;
+	int scan = max_moves * ATLAS_COMPACT_SCAN;
+	for (size_t i = 0; i < order.size() && moves < max_moves && scan > 0; i++, scan--) {
+		Entry& entry = m_entries[order[i]];
+		Rect old = entry.cell;
+		int w = old.right - old.left;
+		int h = old.bottom - old.top;
+		Release(old);
+		Rect cell;
+		if (!FindPosition(w, h, FIT_BOTTOM_LEFT, &cell) ||
+			cell.bottom > old.bottom ||
+			(cell.bottom == old.bottom && cell.left >= old.left)) {
+			Occupy(old);
+			continue;
+		}
+		Image pixels(w, h, m_texture->GetFormat());
+		m_texture->CopyTo(0, old.left, old.top, &pixels, 0, 0, w, h);
+		Occupy(cell);
+		m_texture->CopyFrom(0, cell.left, cell.top, &pixels, 0, 0, w, h);
+		entry.cell = cell;
+		moves++;
+		if (moved) {
+			moved->push_back(order[i]);
+		}
+	}
+	return moves;
+}
+
+
+//---------------------------------------------------------------------
+// Namespace End
+//---------------------------------------------------------------------
+NAMESPACE_END(GFX);
+
+
@@ -0,0 +1,111 @@
+//=====================================================================
+//
+// GFXAtlas.h - images packed into one texture
+//
+// Last Modified: 2026/10/18 22:40:07
+//
+//=====================================================================
+#ifndef _GFX_ATLAS_H_
+#define _GFX_ATLAS_H_
+
+#include "GFXTypes.h"
+#include "GFXImage.h"
+#include "GFXTexture.h"
+
+
+//---------------------------------------------------------------------
+// Namespace Begin
+//---------------------------------------------------------------------
+NAMESPACE_BEGIN(GFX);
+
+
+//---------------------------------------------------------------------
+// TextureAtlas - MaxRects packing of images into level 0 of a texture
+// it doesn't own. every image is surrounded by gutter pixels copied
+// from its edges, so bilinear filtering never reads a neighbour.
+//
+// the free space is kept as maximal free rectangles, an insert takes
+// the one leaving the shortest side (best short side fit) and a
+// remove gives its cell back right away. the free list is rebuilt
+// exactly when an insert doesn't fit and before compacting. Compact
+// moves a few images per call (highest first) to the lowest free
+// place, so free space gathers at the bottom. ids stay valid across
+// moves, their rects and uvs change
+//---------------------------------------------------------------------
+class TextureAtlas
+{
+public:
+	virtual ~TextureAtlas();
+	TextureAtlas();
+
+public:
+	// start packing into texture, forgets every image
+	void Create(Texture *texture, int gutter = 1);
+
+	// forget every image, the texture content is left alone
+	void Clear();
+
+	// copy an image (or its sw x sh rect at sx, sy) into the atlas,
+	// converting to the texture format. returns the id (>= 0) or -1
+	// when it doesn't fit
+	int Insert(const Image *image);
+	int Insert(const Image *image, int sx, int sy, int sw, int sh);
+
+	// free the place of id
+	bool Remove(int id);
+
+	// rect of id in texture pixels (gutters excluded), false if unused
+	bool GetRect(int id, Rect *rect) const;
+
+	// the same rect in texture coordinates (GetInvWidth / GetInvHeight)
+	bool GetUV(int id, RectFloat *uv) const;
+
+	// move up to max_moves images to lower places, ids moved are
+	// appended to moved (may be NULL). returns the number moved
+	int Compact(int max_moves, std::vector<int> *moved = NULL);
+
+	// 1 - largest free rect / free area: 0 when the free space is one
+	// rectangle, near 1 when it is scattered
+	float GetFragmentation() const;
+
+	inline Texture* GetTexture() { return m_texture; }
+	inline int GetCount() const { return m_count; }
+	inline int GetGutter() const { return m_gutter; }
+
+	// area of the cells in use, gutters included
+	inline int64_t GetUsedArea() const { return m_used_area; }
+
+protected:
+	enum { FIT_SHORT_SIDE = 0, FIT_BOTTOM_LEFT };
+
+	bool FindPosition(int w, int h, int fit, Rect *rect) const;
+	void Occupy(const Rect& rect);
+	void Release(const Rect& rect);
+	void Rebuild();
+	void Upload(int x, int y, const Image *image, int sx, int sy, int sw, int sh);
+
+protected:
+	struct Entry {
+		Rect cell;		// gutters included
+		bool used;
+	};
+
+	Texture *m_texture;
+	int m_gutter;
+	int m_count;
+	int64_t m_used_area;
+	std::vector<Entry> m_entries;
+	std::vector<int> m_unused;
+	std::vector<Rect> m_free;
+};
+
+
+//---------------------------------------------------------------------
+// Namespace End
+//---------------------------------------------------------------------
+NAMESPACE_END(GFX);
+
+
+#endif
+
+
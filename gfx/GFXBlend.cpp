@@ -0,0 +1,357 @@
+//=====================================================================
+//
+// GFXBlend.cpp - alpha blended and color keyed pixel rows
+//
+// Last Modified: 2026/10/18 19:48:10
+//
+//=====================================================================
+#include <stddef.h>
+#include <string.h>
+
+#include "GFXPixel.h"
+
+
+//---------------------------------------------------------------------
+// Namespace Begin
+//---------------------------------------------------------------------
+NAMESPACE_BEGIN(GFX);
+
+
+//---------------------------------------------------------------------
+// row kernel: count A8R8G8B8 src pixels onto A8R8G8B8 dst in place,
+// fill is or-ed into every result (0xff000000 for X8R8G8B8)
+//---------------------------------------------------------------------
+typedef void (*BlendRowProc)(uint8_t *dst, const uint8_t *src, int count,
+		uint32_t color, uint32_t fill);
+
+#define BLEND_OPS		(BLEND_MODULATE + 1)
+#define BLEND_CHUNK		256
+
+
+//---------------------------------------------------------------------
+// generic kernels: x / 255 rounded to nearest for x <= 255 * 255 is
+// (t + (t >> 8)) >> 8 with t = x + 128, the simd versions use the
+// same expression in 16 bit lanes
+//---------------------------------------------------------------------
+static inline uint32_t Div255(uint32_t x) {
+	x += 128;
+	return (x + (x >> 8)) >> 8;
+}
+
+static inline uint32_t Sat255(uint32_t x) {
+	return (x > 255)? 255 : x;
+}
+
+template <int OP>
+static inline uint32_t BlendPixel(uint32_t d, uint32_t s, uint32_t color)
+{
+	if (OP == BLEND_MODULATE) {
+		uint32_t m = 0;
+		for (int i = 0; i < 32; i += 8) {
+			m |= Div255(((s >> i) & 0xff) * ((color >> i) & 0xff)) << i;
+		}
+		s = m;
+	}
+	uint32_t sa = s >> 24;
+	uint32_t ia = 255 - sa;
+	uint32_t da = d >> 24;
+	uint32_t a = sa + Div255(da * ia);
+	uint32_t c = 0;
+	for (int i = 0; i < 24; i += 8) {
+		uint32_t sc = (s >> i) & 0xff;
+		uint32_t dc = (d >> i) & 0xff;
+		uint32_t x;
+		switch (OP) {
+		case BLEND_PREMULTIPLIED: x = Sat255(sc + Div255(dc * ia)); break;
+		case BLEND_ADD: x = Sat255(dc + Div255(sc * sa)); break;
+		case BLEND_MULTIPLY: x = Div255(dc * Div255(sc * sa + 255 * ia)); break;
+		default: x = Div255(sc * sa + dc * ia); break;
+		}
+		c |= x << i;
+	}
+	if (OP == BLEND_PREMULTIPLIED) {
+		a = Sat255(a);
+	}
+	return c | (a << 24);
+}
+
+template <int OP>
+static void Blend_C(uint8_t *dst, const uint8_t *src, int count, uint32_t color, uint32_t fill)
+{
+	for (int i = 0; i < count; i++) {
+		uint32_t d, s;
+		memcpy(&d, dst + i * 4, 4);
+		memcpy(&s, src + i * 4, 4);
+		d = BlendPixel<OP>(d, s, color) | fill;
+		memcpy(dst + i * 4, &d, 4);
+	}
+}
+
+static void ColorKey_C(uint8_t *dst, const uint8_t *src, int count, uint32_t color, uint32_t fill)
+{
+	for (int i = 0; i < count; i++) {
+		uint32_t s;
+		memcpy(&s, src + i * 4, 4);
+		if ((s ^ color) & 0xffffff) {
+			s |= fill;
+			memcpy(dst + i * 4, &s, 4);
+		}
+	}
+}
+
+static const BlendRowProc BlendKernel_Generic[BLEND_OPS] = {
+	Blend_C<BLEND_SRCOVER>, Blend_C<BLEND_PREMULTIPLIED>, Blend_C<BLEND_ADD>,
+	Blend_C<BLEND_MULTIPLY>, ColorKey_C, Blend_C<BLEND_MODULATE>,
+};
+
+
+#if GFX_PIXEL_X86
+
+//---------------------------------------------------------------------
+// SSE2: channels widened to 16 bit lanes, two pixels per register.
+// alpha lanes (3 and 7) get sa + da * (1 - sa) by setting the source
+// lane to 1 where s * sa is formed
+//---------------------------------------------------------------------
+static GFX_PIXEL_SSE2 inline __m128i Div255_SSE2(__m128i x)
+{
+	x = _mm_add_epi16(x, _mm_set1_epi16(128));
+	return _mm_srli_epi16(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), 8);
+}
+
+static GFX_PIXEL_SSE2 inline __m128i Select_SSE2(__m128i mask, __m128i a, __m128i b)
+{
+	return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+// two pixels in 16 bit lanes, c is the modulate color in the same form
+template <int OP>
+static GFX_PIXEL_SSE2 inline __m128i BlendWords_SSE2(__m128i d, __m128i s, __m128i c)
+{
+	const __m128i lane = _mm_set_epi16(-1, 0, 0, 0, -1, 0, 0, 0);
+	const __m128i full = _mm_set1_epi16(255);
+	if (OP == BLEND_MODULATE) {
+		s = Div255_SSE2(_mm_mullo_epi16(s, c));
+	}
+	__m128i sa = _mm_shufflehi_epi16(_mm_shufflelo_epi16(s, 0xff), 0xff);
+	__m128i ia = _mm_sub_epi16(full, sa);
+	__m128i s1 = _mm_or_si128(s, _mm_and_si128(lane, full));
+	switch (OP) {
+	case BLEND_PREMULTIPLIED:
+		return _mm_add_epi16(s, Div255_SSE2(_mm_mullo_epi16(d, ia)));
+	case BLEND_ADD: {
+		__m128i k = Div255_SSE2(_mm_mullo_epi16(d, ia));
+		__m128i x = Div255_SSE2(_mm_mullo_epi16(s1, sa));
+		return _mm_add_epi16(x, Select_SSE2(lane, k, d));
+	}
+	case BLEND_MULTIPLY: {
+		__m128i k = Div255_SSE2(_mm_mullo_epi16(d, ia));
+		__m128i f = Div255_SSE2(_mm_add_epi16(_mm_mullo_epi16(s1, sa),
+					_mm_mullo_epi16(full, ia)));
+		__m128i x = Div255_SSE2(_mm_mullo_epi16(d, f));
+		return Select_SSE2(lane, _mm_add_epi16(sa, k), x);
+	}
+	default:
+		return Div255_SSE2(_mm_add_epi16(_mm_mullo_epi16(s1, sa), _mm_mullo_epi16(d, ia)));
+	}
+}
+
+template <int OP>
+static GFX_PIXEL_SSE2 void Blend_SSE2(uint8_t *dst, const uint8_t *src, int count,
+		uint32_t color, uint32_t fill)
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i c = _mm_unpacklo_epi8(_mm_set1_epi32((int)color), zero);
+	const __m128i f = _mm_set1_epi32((int)fill);
+	int i = 0;
+	for (; i + 4 <= count; i += 4) {
+		__m128i d = _mm_loadu_si128((const __m128i*)(dst + i * 4));
+		__m128i s = _mm_loadu_si128((const __m128i*)(src + i * 4));
+		__m128i lo = BlendWords_SSE2<OP>(_mm_unpacklo_epi8(d, zero),
+				_mm_unpacklo_epi8(s, zero), c);
+		__m128i hi = BlendWords_SSE2<OP>(_mm_unpackhi_epi8(d, zero),
+				_mm_unpackhi_epi8(s, zero), c);
+		d = _mm_or_si128(_mm_packus_epi16(lo, hi), f);
+		_mm_storeu_si128((__m128i*)(dst + i * 4), d);
+	}
+	Blend_C<OP>(dst + i * 4, src + i * 4, count - i, color, fill);
+}
+
+static GFX_PIXEL_SSE2 void ColorKey_SSE2(uint8_t *dst, const uint8_t *src, int count,
+		uint32_t color, uint32_t fill)
+{
+	const __m128i rgb = _mm_set1_epi32(0xffffff);
+	const __m128i key = _mm_set1_epi32((int)(color & 0xffffff));
+	const __m128i f = _mm_set1_epi32((int)fill);
+	int i = 0;
+	for (; i + 4 <= count; i += 4) {
+		__m128i d = _mm_loadu_si128((const __m128i*)(dst + i * 4));
+		__m128i s = _mm_loadu_si128((const __m128i*)(src + i * 4));
+		__m128i m = _mm_cmpeq_epi32(_mm_and_si128(s, rgb), key);
+		d = Select_SSE2(m, d, _mm_or_si128(s, f));
+		_mm_storeu_si128((__m128i*)(dst + i * 4), d);
+	}
+	ColorKey_C(dst + i * 4, src + i * 4, count - i, color, fill);
+}
+
+static const BlendRowProc BlendKernel_SSE2[BLEND_OPS] = {
+	Blend_SSE2<BLEND_SRCOVER>, Blend_SSE2<BLEND_PREMULTIPLIED>, Blend_SSE2<BLEND_ADD>,
+	Blend_SSE2<BLEND_MULTIPLY>, ColorKey_SSE2, Blend_SSE2<BLEND_MODULATE>,
+};
+
+
+//---------------------------------------------------------------------
+// AVX2: the same per 128 bit lane, eight pixels per step. unpack and
+// pack stay inside lanes so pixel order is kept
+//---------------------------------------------------------------------
+static GFX_PIXEL_AVX2 inline __m256i Div255_AVX2(__m256i x)
+{
+	x = _mm256_add_epi16(x, _mm256_set1_epi16(128));
+	return _mm256_srli_epi16(_mm256_add_epi16(x, _mm256_srli_epi16(x, 8)), 8);
+}
+
+template <int OP>
+static GFX_PIXEL_AVX2 inline __m256i BlendWords_AVX2(__m256i d, __m256i s, __m256i c)
+{
+	const __m256i lane = _mm256_setr_epi16(0, 0, 0, -1, 0, 0, 0, -1,
+			0, 0, 0, -1, 0, 0, 0, -1);
+	const __m256i full = _mm256_set1_epi16(255);
+	if (OP == BLEND_MODULATE) {
+		s = Div255_AVX2(_mm256_mullo_epi16(s, c));
+	}
+	__m256i sa = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(s, 0xff), 0xff);
+	__m256i ia = _mm256_sub_epi16(full, sa);
+	__m256i s1 = _mm256_or_si256(s, _mm256_and_si256(lane, full));
+	switch (OP) {
+	case BLEND_PREMULTIPLIED:
+		return _mm256_add_epi16(s, Div255_AVX2(_mm256_mullo_epi16(d, ia)));
+	case BLEND_ADD: {
+		__m256i k = Div255_AVX2(_mm256_mullo_epi16(d, ia));
+		__m256i x = Div255_AVX2(_mm256_mullo_epi16(s1, sa));
+		return _mm256_add_epi16(x, _mm256_blendv_epi8(d, k, lane));
+	}
+	case BLEND_MULTIPLY: {
+		__m256i k = Div255_AVX2(_mm256_mullo_epi16(d, ia));
+		__m256i f = Div255_AVX2(_mm256_add_epi16(_mm256_mullo_epi16(s1, sa),
+					_mm256_mullo_epi16(full, ia)));
+		__m256i x = Div255_AVX2(_mm256_mullo_epi16(d, f));
+		return _mm256_blendv_epi8(x, _mm256_add_epi16(sa, k), lane);
+	}
+	default:
+		return Div255_AVX2(_mm256_add_epi16(_mm256_mullo_epi16(s1, sa),
+					_mm256_mullo_epi16(d, ia)));
+	}
+}
+
+template <int OP>
+static GFX_PIXEL_AVX2 void Blend_AVX2(uint8_t *dst, const uint8_t *src, int count,
+		uint32_t color, uint32_t fill)
+{
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i c = _mm256_unpacklo_epi8(_mm256_set1_epi32((int)color), zero);
+	const __m256i f = _mm256_set1_epi32((int)fill);
+	int i = 0;
+	for (; i + 8 <= count; i += 8) {
+		__m256i d = _mm256_loadu_si256((const __m256i*)(dst + i * 4));
+		__m256i s = _mm256_loadu_si256((const __m256i*)(src + i * 4));
+		__m256i lo = BlendWords_AVX2<OP>(_mm256_unpacklo_epi8(d, zero),
+				_mm256_unpacklo_epi8(s, zero), c);
+		__m256i hi = BlendWords_AVX2<OP>(_mm256_unpackhi_epi8(d, zero),
+				_mm256_unpackhi_epi8(s, zero), c);
+		d = _mm256_or_si256(_mm256_packus_epi16(lo, hi), f);
+		_mm256_storeu_si256((__m256i*)(dst + i * 4), d);
+	}
+	_mm256_zeroupper();
+	Blend_SSE2<OP>(dst + i * 4, src + i * 4, count - i, color, fill);
+}
+
+static GFX_PIXEL_AVX2 void ColorKey_AVX2(uint8_t *dst, const uint8_t *src, int count,
+		uint32_t color, uint32_t fill)
+{
+	const __m256i rgb = _mm256_set1_epi32(0xffffff);
+	const __m256i key = _mm256_set1_epi32((int)(color & 0xffffff));
+	const __m256i f = _mm256_set1_epi32((int)fill);
+	int i = 0;
+	for (; i + 8 <= count; i += 8) {
+		__m256i d = _mm256_loadu_si256((const __m256i*)(dst + i * 4));
+		__m256i s = _mm256_loadu_si256((const __m256i*)(src + i * 4));
+		__m256i m = _mm256_cmpeq_epi32(_mm256_and_si256(s, rgb), key);
+		d = _mm256_blendv_epi8(_mm256_or_si256(s, f), d, m);
+		_mm256_storeu_si256((__m256i*)(dst + i * 4), d);
+	}
+	_mm256_zeroupper();
+	ColorKey_SSE2(dst + i * 4, src + i * 4, count - i, color, fill);
+}
+
+static const BlendRowProc BlendKernel_AVX2[BLEND_OPS] = {
+	Blend_AVX2<BLEND_SRCOVER>, Blend_AVX2<BLEND_PREMULTIPLIED>, Blend_AVX2<BLEND_ADD>,
+	Blend_AVX2<BLEND_MULTIPLY>, ColorKey_AVX2, Blend_AVX2<BLEND_MODULATE>,
+};
+
+#endif
+
+
+//---------------------------------------------------------------------
+// blend a block: src rows other than A8R8G8B8 and R5G6B5 dst rows go
+// through A8R8G8B8 chunks that stay in L1
+//---------------------------------------------------------------------
+bool BlendPixels(void *dst, int32_t dst_pitch, PixelFormat dst_fmt,
+		const void *src, int32_t src_pitch, PixelFormat src_fmt, int w, int h,
+		BlendOp op, uint32_t color)
+{
+	if (dst_fmt != FMT_A8R8G8B8 && dst_fmt != FMT_X8R8G8B8 && dst_fmt != FMT_R5G6B5) {
+		return false;
+	}
+	if (src_fmt < FMT_A8R8G8B8 || src_fmt >= FMT_UNKNOWN) {
+		return false;
+	}
+	if (op < BLEND_SRCOVER || op >= BLEND_OPS) {
+		return false;
+	}
+	const BlendRowProc *kernels = BlendKernel_Generic;
+#if GFX_PIXEL_X86
+	switch (GetPixelKernel()) {
+	case PIXEL_KERNEL_AVX2: kernels = BlendKernel_AVX2; break;
+	case PIXEL_KERNEL_SSE2: kernels = BlendKernel_SSE2; break;
+	default: break;
+	}
+#endif
+	BlendRowProc proc = kernels[op];
+	uint32_t fill = (dst_fmt == FMT_X8R8G8B8)? 0xff000000 : 0;
+	bool convert_src = (src_fmt != FMT_A8R8G8B8);
+	bool convert_dst = (dst_fmt == FMT_R5G6B5);
+	int chunk = (convert_src || convert_dst)? BLEND_CHUNK : w;
+	int src_size = Image::FormatToBpp(src_fmt) / 8;
+	int dst_size = Image::FormatToBpp(dst_fmt) / 8;
+	uint32_t sbuf[BLEND_CHUNK];
+	uint32_t dbuf[BLEND_CHUNK];
+	for (int j = 0; j < h; j++) {
+		const uint8_t *ss = (const uint8_t*)src + (ptrdiff_t)src_pitch * j;
+		uint8_t *dd = (uint8_t*)dst + (ptrdiff_t)dst_pitch * j;
+		for (int i = 0; i < w; i += chunk) {
+			int n = (w - i < chunk)? (w - i) : chunk;
+			const uint8_t *s = ss + i * src_size;
+			uint8_t *d = dd + i * dst_size;
+			if (convert_src) {
+				UnpackPixelRow(sbuf, s, src_fmt, n);
+				s = (const uint8_t*)sbuf;
+			}
+			if (convert_dst) {
+				UnpackPixelRow(dbuf, d, dst_fmt, n);
+				proc((uint8_t*)dbuf, s, n, color, fill);
+				PackPixelRow(d, dst_fmt, dbuf, n);
+			}
+			else {
+				proc(d, s, n, color, fill);
+			}
+		}
+	}
+	return true;
+}
+
+
+//---------------------------------------------------------------------
+// Namespace End
+//---------------------------------------------------------------------
+NAMESPACE_END(GFX);
+
+
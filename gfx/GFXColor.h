@@ -26,8 +26,8 @@ struct Color
 	uint32_t color;
 
 	inline Color() {}
-	inline Color(uint32_t c): color(c) {}
-	inline Color(uint32_t a, uint32_t r, uint32_t g, uint32_t b):
+	inline GFX_CONSTEXPR Color(uint32_t c): color(c) {}
+	inline GFX_CONSTEXPR Color(uint32_t a, uint32_t r, uint32_t g, uint32_t b):
 		color((a << 24) | (r << 16) | (g << 8) | b) {}
 
 	inline uint32_t GetRed() const { return (color >> 16) & 0xff; }
@@ -0,0 +1,567 @@
+//=====================================================================
+//
+// GFXConvert.cpp - half, normalized integer and packed vector formats
+//
+// Last Modified: 2026/10/18 17:12:30
+//
+//=====================================================================
+#include "GFXConvert.h"
+#include "GFXSimd.h"
+
+
+//---------------------------------------------------------------------
+// Namespace Begin
+//---------------------------------------------------------------------
+NAMESPACE_BEGIN(GFX);
+NAMESPACE_BEGIN(Core);
+
+
+//---------------------------------------------------------------------
+// integer lanes: rounding to nearest even (the default mode) and
+// back, 32 bit armv7 has no rounding convert and stays scalar
+//---------------------------------------------------------------------
+#if GFX_SIMD_SSE
+#define GFX_CONVERT_SIMD	1
+typedef __m128i Int4;
+
+static inline Int4 Int4_Round(const Float4& x) { return _mm_cvtps_epi32(x.v); }
+static inline Float4 Int4_ToFloat(Int4 x) { return _mm_cvtepi32_ps(x); }
+
+#elif GFX_SIMD_NEON && defined(__aarch64__)
+#define GFX_CONVERT_SIMD	1
+typedef int32x4_t Int4;
+
+static inline Int4 Int4_Round(const Float4& x) { return vcvtnq_s32_f32(x.v); }
+static inline Float4 Int4_ToFloat(Int4 x) { return vcvtq_f32_s32(x); }
+
+#else
+#define GFX_CONVERT_SIMD	0
+#endif
+
+
+#if GFX_CONVERT_SIMD
+// nan to zero, clamp to [low, high], scale and round 4 floats
+static inline Int4 RoundLanes(const Float4& v, const Float4& low,
+		const Float4& high, const Float4& scale)
+{
+	Float4 x = And(v, CmpEq(v, v));
+	return Int4_Round(Min(Max(x, low), high) * scale);
+}
+
+static inline void StoreLanes(float *dst, Int4 x, const Float4& scale,
+		const Float4& low)
+{
+	Max(Int4_ToFloat(x) / scale, low).Store(dst);
+}
+#endif
+
+
+#if GFX_SIMD_SSE
+//---------------------------------------------------------------------
+// half conversion with SSE2 integer ops (F. Giesen), same rounding,
+// overflow and nan payload as FloatToHalf, lanes are sign extended
+// so that _mm_packs_epi32 narrows them without saturating
+//---------------------------------------------------------------------
+static inline __m128i FloatToHalf4(__m128 f)
+{
+	const __m128i f16max = _mm_set1_epi32((127 + 16) << 23);
+	const __m128i f32inf = _mm_set1_epi32(255 << 23);
+	const __m128i denorm_limit = _mm_set1_epi32(113 << 23);
+	const __m128i denorm_magic = _mm_set1_epi32(((127 - 15) + (23 - 10) + 1) << 23);
+	const __m128i one = _mm_set1_epi32(1);
+	__m128i x = _mm_castps_si128(f);
+	__m128i sign = _mm_and_si128(x, _mm_set1_epi32((int)0x80000000));
+	x = _mm_xor_si128(x, sign);
+	// subnormal: the fpu add aligns and rounds the mantissa
+	__m128 d = _mm_add_ps(_mm_castsi128_ps(x), _mm_castsi128_ps(denorm_magic));
+	__m128i sub = _mm_sub_epi32(_mm_castps_si128(d), denorm_magic);
+	// normal: rebias and round half to even, a carry bumps the exponent
+	__m128i odd = _mm_and_si128(_mm_srli_epi32(x, 13), one);
+	__m128i nrm = _mm_add_epi32(x, _mm_set1_epi32(-(112 << 23) + 0xfff));
+	nrm = _mm_srli_epi32(_mm_add_epi32(nrm, odd), 13);
+	// inf and nan, the payload keeps its top bits and turns quiet
+	__m128i payload = _mm_or_si128(_mm_set1_epi32(0x200),
+			_mm_and_si128(_mm_srli_epi32(x, 13), _mm_set1_epi32(0x3ff)));
+	__m128i is_nan = _mm_cmpgt_epi32(x, f32inf);
+	__m128i big = _mm_or_si128(_mm_set1_epi32(0x7c00), _mm_and_si128(is_nan, payload));
+	__m128i is_sub = _mm_cmplt_epi32(x, denorm_limit);
+	__m128i is_big = _mm_cmpgt_epi32(x, _mm_sub_epi32(f16max, one));
+	__m128i h = _mm_or_si128(_mm_and_si128(is_sub, sub), _mm_andnot_si128(is_sub, nrm));
+	h = _mm_or_si128(_mm_and_si128(is_big, big), _mm_andnot_si128(is_big, h));
+	h = _mm_or_si128(h, _mm_srli_epi32(sign, 16));
+	return _mm_srai_epi32(_mm_slli_epi32(h, 16), 16);
+}
+
+// h holds zero extended halves, subnormals are scaled by 2^112 and
+// nans are made quiet
+static inline __m128 HalfToFloat4(__m128i h)
+{
+	const __m128i nosign = _mm_set1_epi32(0x7fff);
+	const __m128 magic = _mm_castsi128_ps(_mm_set1_epi32((254 - 15) << 23));
+	const __m128i was_infnan = _mm_set1_epi32(0x7bff);
+	const __m128 exp_infnan = _mm_castsi128_ps(_mm_set1_epi32(255 << 23));
+	__m128i expmant = _mm_and_si128(nosign, h);
+	__m128i sign = _mm_slli_epi32(_mm_xor_si128(h, expmant), 16);
+	__m128 scaled = _mm_mul_ps(_mm_castsi128_ps(_mm_slli_epi32(expmant, 13)), magic);
+	__m128i infnan = _mm_cmpgt_epi32(expmant, was_infnan);
+	__m128i nan = _mm_cmpgt_epi32(expmant, _mm_set1_epi32(0x7c00));
+	__m128i quiet = _mm_and_si128(nan, _mm_set1_epi32(0x400000));
+	__m128 bits = _mm_or_ps(_mm_castsi128_ps(_mm_or_si128(sign, quiet)),
+			_mm_and_ps(_mm_castsi128_ps(infnan), exp_infnan));
+	return _mm_or_ps(scaled, bits);
+}
+#endif
+
+
+//---------------------------------------------------------------------
+// float <-> half
+//---------------------------------------------------------------------
+void FloatToHalfArray(uint16_t *dst, const float *src, size_t count)
+{
+	size_t i = 0;
+#if GFX_SIMD_F16C
+	for (; i + 8 <= count; i += 8) {
+		__m128i h = _mm256_cvtps_ph(_mm256_loadu_ps(src + i), 0);
+		_mm_storeu_si128((__m128i*)(dst + i), h);
+	}
+#elif GFX_SIMD_SSE
+	for (; i + 8 <= count; i += 8) {
+		__m128i a = FloatToHalf4(_mm_loadu_ps(src + i));
+		__m128i b = FloatToHalf4(_mm_loadu_ps(src + i + 4));
+		_mm_storeu_si128((__m128i*)(dst + i), _mm_packs_epi32(a, b));
+	}
+#elif GFX_CONVERT_SIMD
+	for (; i + 4 <= count; i += 4) {
+		float16x4_t h = vcvt_f16_f32(vld1q_f32(src + i));
+		vst1_u16(dst + i, vreinterpret_u16_f16(h));
+	}
+#endif
+	for (; i < count; i++) {
+		dst[i] = FloatToHalf(src[i]);
+	}
+}
+
+void HalfToFloatArray(float *dst, const uint16_t *src, size_t count)
+{
+	size_t i = 0;
+#if GFX_SIMD_F16C
+	for (; i + 8 <= count; i += 8) {
+		__m128i h = _mm_loadu_si128((const __m128i*)(src + i));
+		_mm256_storeu_ps(dst + i, _mm256_cvtph_ps(h));
+	}
+#elif GFX_SIMD_SSE
+	const __m128i zero = _mm_setzero_si128();
+	for (; i + 8 <= count; i += 8) {
+		__m128i h = _mm_loadu_si128((const __m128i*)(src + i));
+		_mm_storeu_ps(dst + i, HalfToFloat4(_mm_unpacklo_epi16(h, zero)));
+		_mm_storeu_ps(dst + i + 4, HalfToFloat4(_mm_unpackhi_epi16(h, zero)));
+	}
+#elif GFX_CONVERT_SIMD
+	for (; i + 4 <= count; i += 4) {
+		float16x4_t h = vreinterpret_f16_u16(vld1_u16(src + i));
+		vst1q_f32(dst + i, vcvt_f32_f16(h));
+	}
+#endif
+	for (; i < count; i++) {
+		dst[i] = HalfToFloat(src[i]);
+	}
+}
+
+
+//---------------------------------------------------------------------
+// float -> snorm / unorm, 16 (8 bit) or 8 (16 bit) values per pass
+//---------------------------------------------------------------------
+void FloatToSnorm8Array(int8_t *dst, const float *src, size_t count)
+{
+	size_t i = 0;
+#if GFX_CONVERT_SIMD
+	const Float4 low(-1.0f), high(1.0f), scale(127.0f);
+	for (; i + 16 <= count; i += 16) {
+		Int4 a = RoundLanes(Float4::Load(src + i), low, high, scale);
+		Int4 b = RoundLanes(Float4::Load(src + i + 4), low, high, scale);
+		Int4 c = RoundLanes(Float4::Load(src + i + 8), low, high, scale);
+		Int4 d = RoundLanes(Float4::Load(src + i + 12), low, high, scale);
+	#if GFX_SIMD_SSE
+		__m128i ab = _mm_packs_epi32(a, b);
+		__m128i cd = _mm_packs_epi32(c, d);
+		_mm_storeu_si128((__m128i*)(dst + i), _mm_packs_epi16(ab, cd));
+	#else
+		int16x8_t ab = vcombine_s16(vmovn_s32(a), vmovn_s32(b));
+		int16x8_t cd = vcombine_s16(vmovn_s32(c), vmovn_s32(d));
+		vst1q_s8(dst + i, vcombine_s8(vmovn_s16(ab), vmovn_s16(cd)));
+	#endif
+	}
+#endif
+	for (; i < count; i++) {
+		dst[i] = FloatToSnorm8(src[i]);
+	}
+}
+
+void FloatToSnorm16Array(int16_t *dst, const float *src, size_t count)
+{
+	size_t i = 0;
+#if GFX_CONVERT_SIMD
+	const Float4 low(-1.0f), high(1.0f), scale(32767.0f);
+	for (; i + 8 <= count; i += 8) {
+		Int4 a = RoundLanes(Float4::Load(src + i), low, high, scale);
+		Int4 b = RoundLanes(Float4::Load(src + i + 4), low, high, scale);
+	#if GFX_SIMD_SSE
+		_mm_storeu_si128((__m128i*)(dst + i), _mm_packs_epi32(a, b));
+	#else
+		vst1q_s16(dst + i, vcombine_s16(vmovn_s32(a), vmovn_s32(b)));
+	#endif
+	}
+#endif
+	for (; i < count; i++) {
+		dst[i] = FloatToSnorm16(src[i]);
+	}
+}
+
+void FloatToUnorm8Array(uint8_t *dst, const float *src, size_t count)
+{
+	size_t i = 0;
+#if GFX_CONVERT_SIMD
+	const Float4 low(0.0f), high(1.0f), scale(255.0f);
+	for (; i + 16 <= count; i += 16) {
+		Int4 a = RoundLanes(Float4::Load(src + i), low, high, scale);
+		Int4 b = RoundLanes(Float4::Load(src + i + 4), low, high, scale);
+		Int4 c = RoundLanes(Float4::Load(src + i + 8), low, high, scale);
+		Int4 d = RoundLanes(Float4::Load(src + i + 12), low, high, scale);
+	#if GFX_SIMD_SSE
+		__m128i ab = _mm_packs_epi32(a, b);
+		__m128i cd = _mm_packs_epi32(c, d);
+		_mm_storeu_si128((__m128i*)(dst + i), _mm_packus_epi16(ab, cd));
+	#else
+		int16x8_t ab = vcombine_s16(vmovn_s32(a), vmovn_s32(b));
+		int16x8_t cd = vcombine_s16(vmovn_s32(c), vmovn_s32(d));
+		vst1q_u8(dst + i, vcombine_u8(vqmovun_s16(ab), vqmovun_s16(cd)));
+	#endif
+	}
+#endif
+	for (; i < count; i++) {
+		dst[i] = FloatToUnorm8(src[i]);
+	}
+}
+
+void FloatToUnorm16Array(uint16_t *dst, const float *src, size_t count)
+{
+	size_t i = 0;
+#if GFX_CONVERT_SIMD
+	const Float4 low(0.0f), high(1.0f), scale(65535.0f);
+	for (; i + 8 <= count; i += 8) {
+		Int4 a = RoundLanes(Float4::Load(src + i), low, high, scale);
+		Int4 b = RoundLanes(Float4::Load(src + i + 4), low, high, scale);
+	#if GFX_SIMD_SSE
+		// no packus_epi32 before sse4.1: bias into the signed range
+		const __m128i bias = _mm_set1_epi32(32768);
+		__m128i ab = _mm_packs_epi32(_mm_sub_epi32(a, bias), _mm_sub_epi32(b, bias));
+		ab = _mm_xor_si128(ab, _mm_set1_epi16((short)0x8000));
+		_mm_storeu_si128((__m128i*)(dst + i), ab);
+	#else
+		vst1q_u16(dst + i, vcombine_u16(vqmovun_s32(a), vqmovun_s32(b)));
+	#endif
+	}
+#endif
+	for (; i < count; i++) {
+		dst[i] = FloatToUnorm16(src[i]);
+	}
+}
+
+
+//---------------------------------------------------------------------
+// snorm / unorm -> float
+//---------------------------------------------------------------------
+void Snorm8ToFloatArray(float *dst, const int8_t *src, size_t count)
+{
+	size_t i = 0;
+#if GFX_CONVERT_SIMD
+	const Float4 scale(127.0f), low(-1.0f);
+	for (; i + 16 <= count; i += 16) {
+	#if GFX_SIMD_SSE
+		__m128i v = _mm_loadu_si128((const __m128i*)(src + i));
+		__m128i lo = _mm_srai_epi16(_mm_unpacklo_epi8(v, v), 8);
+		__m128i hi = _mm_srai_epi16(_mm_unpackhi_epi8(v, v), 8);
+		StoreLanes(dst + i, _mm_srai_epi32(_mm_unpacklo_epi16(lo, lo), 16), scale, low);
+		StoreLanes(dst + i + 4, _mm_srai_epi32(_mm_unpackhi_epi16(lo, lo), 16), scale, low);
+		StoreLanes(dst + i + 8, _mm_srai_epi32(_mm_unpacklo_epi16(hi, hi), 16), scale, low);
+		StoreLanes(dst + i + 12, _mm_srai_epi32(_mm_unpackhi_epi16(hi, hi), 16), scale, low);
+	#else
+		int8x16_t v = vld1q_s8(src + i);
+		int16x8_t lo = vmovl_s8(vget_low_s8(v));
+		int16x8_t hi = vmovl_s8(vget_high_s8(v));
+		StoreLanes(dst + i, vmovl_s16(vget_low_s16(lo)), scale, low);
+		StoreLanes(dst + i + 4, vmovl_s16(vget_high_s16(lo)), scale, low);
+		StoreLanes(dst + i + 8, vmovl_s16(vget_low_s16(hi)), scale, low);
+		StoreLanes(dst + i + 12, vmovl_s16(vget_high_s16(hi)), scale, low);
+	#endif
+	}
+#endif
+	for (; i < count; i++) {
+		dst[i] = Snorm8ToFloat(src[i]);
+	}
+}
+
+void Snorm16ToFloatArray(float *dst, const int16_t *src, size_t count)
+{
+	size_t i = 0;
+#if GFX_CONVERT_SIMD
+	const Float4 scale(32767.0f), low(-1.0f);
+	for (; i + 8 <= count; i += 8) {
+	#if GFX_SIMD_SSE
+		__m128i v = _mm_loadu_si128((const __m128i*)(src + i));
+		StoreLanes(dst + i, _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16), scale, low);
+		StoreLanes(dst + i + 4, _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16), scale, low);
+	#else
+		int16x8_t v = vld1q_s16(src + i);
+		StoreLanes(dst + i, vmovl_s16(vget_low_s16(v)), scale, low);
+		StoreLanes(dst + i + 4, vmovl_s16(vget_high_s16(v)), scale, low);
+	#endif
+	}
+#endif
+	for (; i < count; i++) {
+		dst[i] = Snorm16ToFloat(src[i]);
+	}
+}
+
+void Unorm8ToFloatArray(float *dst, const uint8_t *src, size_t count)
+{
+	size_t i = 0;
+#if GFX_CONVERT_SIMD
+	const Float4 scale(255.0f), low(0.0f);
+	for (; i + 16 <= count; i += 16) {
+	#if GFX_SIMD_SSE
+		const __m128i zero = _mm_setzero_si128();
+		__m128i v = _mm_loadu_si128((const __m128i*)(src + i));
+		__m128i lo = _mm_unpacklo_epi8(v, zero);
+		__m128i hi = _mm_unpackhi_epi8(v, zero);
+		StoreLanes(dst + i, _mm_unpacklo_epi16(lo, zero), scale, low);
+		StoreLanes(dst + i + 4, _mm_unpackhi_epi16(lo, zero), scale, low);
+		StoreLanes(dst + i + 8, _mm_unpacklo_epi16(hi, zero), scale, low);
+		StoreLanes(dst + i + 12, _mm_unpackhi_epi16(hi, zero), scale, low);
+	#else
+		uint8x16_t v = vld1q_u8(src + i);
+		uint16x8_t lo = vmovl_u8(vget_low_u8(v));
+		uint16x8_t hi = vmovl_u8(vget_high_u8(v));
+		StoreLanes(dst + i, vreinterpretq_s32_u32(vmovl_u16(vget_low_u16(lo))), scale, low);
+		StoreLanes(dst + i + 4, vreinterpretq_s32_u32(vmovl_u16(vget_high_u16(lo))), scale, low);
+		StoreLanes(dst + i + 8, vreinterpretq_s32_u32(vmovl_u16(vget_low_u16(hi))), scale, low);
+		StoreLanes(dst + i + 12, vreinterpretq_s32_u32(vmovl_u16(vget_high_u16(hi))), scale, low);
+	#endif
+	}
+#endif
+	for (; i < count; i++) {
+		dst[i] = Unorm8ToFloat(src[i]);
+	}
+}
+
+void Unorm16ToFloatArray(float *dst, const uint16_t *src, size_t count)
+{
+	size_t i = 0;
+#if GFX_CONVERT_SIMD
+	const Float4 scale(65535.0f), low(0.0f);
+	for (; i + 8 <= count; i += 8) {
+	#if GFX_SIMD_SSE
+		const __m128i zero = _mm_setzero_si128();
+		__m128i v = _mm_loadu_si128((const __m128i*)(src + i));
+		StoreLanes(dst + i, _mm_unpacklo_epi16(v, zero), scale, low);
+		StoreLanes(dst + i + 4, _mm_unpackhi_epi16(v, zero), scale, low);
+	#else
+		uint16x8_t v = vld1q_u16(src + i);
+		StoreLanes(dst + i, vreinterpretq_s32_u32(vmovl_u16(vget_low_u16(v))), scale, low);
+		StoreLanes(dst + i + 4, vreinterpretq_s32_u32(vmovl_u16(vget_high_u16(v))), scale, low);
+	#endif
+	}
+#endif
+	for (; i < count; i++) {
+		dst[i] = Unorm16ToFloat(src[i]);
+	}
+}
+
+
+//---------------------------------------------------------------------
+// octahedral normals, 4 per pass, same operation order as the scalar
+// OctahedralEncode / OctahedralDecode
+//---------------------------------------------------------------------
+void OctahedralEncodeArray(uint32_t *dst, const Vector3 *src, size_t count,
+		size_t src_stride)
+{
+	const uint8_t *s = (const uint8_t*)src;
+	size_t i = 0;
+#if GFX_CONVERT_SIMD
+	const Float4 zero(0.0f), one(1.0f), low(-1.0f), scale(32767.0f);
+	for (; i + 4 <= count; i += 4, s += src_stride * 4) {
+		Float4 x, y, z, w;
+		Float4_Gather<3>(s, src_stride, x, y, z, w);
+		Float4 sum = (Abs(x) + Abs(y)) + Abs(z);
+		Float4 inv = And(CmpGt(sum, zero), one / sum);
+		x = x * inv;
+		y = y * inv;
+		Float4 fx = (one - Abs(y)) * Select(CmpGe(x, zero), one, low);
+		Float4 fy = (one - Abs(x)) * Select(CmpGe(y, zero), one, low);
+		Float4 fold = CmpLt(z, zero);
+		Int4 ex = RoundLanes(Select(fold, fx, x), low, one, scale);
+		Int4 ey = RoundLanes(Select(fold, fy, y), low, one, scale);
+	#if GFX_SIMD_SSE
+		ex = _mm_and_si128(ex, _mm_set1_epi32(0xffff));
+		_mm_storeu_si128((__m128i*)(dst + i), _mm_or_si128(ex, _mm_slli_epi32(ey, 16)));
+	#else
+		uint32x4_t ux = vandq_u32(vreinterpretq_u32_s32(ex), vdupq_n_u32(0xffff));
+		uint32x4_t uy = vshlq_n_u32(vreinterpretq_u32_s32(ey), 16);
+		vst1q_u32(dst + i, vorrq_u32(ux, uy));
+	#endif
+	}
+#endif
+	for (; i < count; i++, s += src_stride) {
+		dst[i] = OctahedralEncode(*(const Vector3*)s);
+	}
+}
+
+#if GFX_CONVERT_SIMD
+// 4 encoded normals to unit x, y, z lanes, used by the scalar decode
+// too so both round the same way
+static inline void OctahedralDecodeLanes(Int4 e, Float4& x, Float4& y, Float4& z)
+{
+	const Float4 zero(0.0f), one(1.0f), low(-1.0f), scale(32767.0f);
+#if GFX_SIMD_SSE
+	Int4 ex = _mm_srai_epi32(_mm_slli_epi32(e, 16), 16);
+	Int4 ey = _mm_srai_epi32(e, 16);
+#else
+	Int4 ex = vshrq_n_s32(vshlq_n_s32(e, 16), 16);
+	Int4 ey = vshrq_n_s32(e, 16);
+#endif
+	x = Max(Int4_ToFloat(ex) / scale, low);
+	y = Max(Int4_ToFloat(ey) / scale, low);
+	z = (one - Abs(x)) - Abs(y);
+	Float4 t = Max(-z, zero);
+	x = Select(CmpGe(x, zero), x - t, x + t);
+	y = Select(CmpGe(y, zero), y - t, y + t);
+	Float4 inv = one / Sqrt((x * x + y * y) + z * z);
+	x = x * inv;
+	y = y * inv;
+	z = z * inv;
+}
+#endif
+
+Vector3 OctahedralDecode(uint32_t e)
+{
+#if GFX_CONVERT_SIMD
+	Float4 x, y, z;
+	#if GFX_SIMD_SSE
+	OctahedralDecodeLanes(_mm_cvtsi32_si128((int)e), x, y, z);
+	#else
+	OctahedralDecodeLanes(vdupq_n_s32((int32_t)e), x, y, z);
+	#endif
+	return Vector3(x.Get(0), y.Get(0), z.Get(0));
+#else
+	float x = Snorm16ToFloat((int16_t)(e & 0xffff));
+	float y = Snorm16ToFloat((int16_t)(e >> 16));
+	float z = (1.0f - Abs(x)) - Abs(y);
+	float t = Max(-z, 0.0f);
+	x = (x >= 0.0f)? (x - t) : (x + t);
+	y = (y >= 0.0f)? (y - t) : (y + t);
+	float inv = 1.0f / sqrtf((x * x + y * y) + z * z);
+	return Vector3(x * inv, y * inv, z * inv);
+#endif
+}
+
+void OctahedralDecodeArray(Vector3 *dst, const uint32_t *src, size_t count,
+		size_t dst_stride)
+{
+	uint8_t *d = (uint8_t*)dst;
+	size_t i = 0;
+#if GFX_CONVERT_SIMD
+	const Float4 one(1.0f);
+	for (; i + 4 <= count; i += 4, d += dst_stride * 4) {
+		Float4 x, y, z;
+	#if GFX_SIMD_SSE
+		OctahedralDecodeLanes(_mm_loadu_si128((const __m128i*)(src + i)), x, y, z);
+	#else
+		OctahedralDecodeLanes(vreinterpretq_s32_u32(vld1q_u32(src + i)), x, y, z);
+	#endif
+		Float4_Scatter<3>(d, dst_stride, x, y, z, one);
+	}
+#endif
+	for (; i < count; i++, d += dst_stride) {
+		*(Vector3*)d = OctahedralDecode(src[i]);
+	}
+}
+
+
+//---------------------------------------------------------------------
+// 10:10:10:2, 4 colors per pass
+//---------------------------------------------------------------------
+void PackA2B10G10R10Array(uint32_t *dst, const Vector4 *src, size_t count,
+		size_t src_stride)
+{
+	const uint8_t *s = (const uint8_t*)src;
+	size_t i = 0;
+#if GFX_CONVERT_SIMD
+	const Float4 zero(0.0f), one(1.0f), k10(1023.0f), k2(3.0f);
+	for (; i + 4 <= count; i += 4, s += src_stride * 4) {
+		Float4 x, y, z, w;
+		Float4_Gather<4>(s, src_stride, x, y, z, w);
+		Int4 r = RoundLanes(x, zero, one, k10);
+		Int4 g = RoundLanes(y, zero, one, k10);
+		Int4 b = RoundLanes(z, zero, one, k10);
+		Int4 a = RoundLanes(w, zero, one, k2);
+	#if GFX_SIMD_SSE
+		__m128i c = _mm_or_si128(r, _mm_slli_epi32(g, 10));
+		c = _mm_or_si128(c, _mm_slli_epi32(b, 20));
+		c = _mm_or_si128(c, _mm_slli_epi32(a, 30));
+		_mm_storeu_si128((__m128i*)(dst + i), c);
+	#else
+		int32x4_t c = vorrq_s32(r, vshlq_n_s32(g, 10));
+		c = vorrq_s32(c, vshlq_n_s32(b, 20));
+		c = vorrq_s32(c, vshlq_n_s32(a, 30));
+		vst1q_u32(dst + i, vreinterpretq_u32_s32(c));
+	#endif
+	}
+#endif
+	for (; i < count; i++, s += src_stride) {
+		dst[i] = PackA2B10G10R10(*(const Vector4*)s);
+	}
+}
+
+void UnpackA2B10G10R10Array(Vector4 *dst, const uint32_t *src, size_t count,
+		size_t dst_stride)
+{
+	uint8_t *d = (uint8_t*)dst;
+	size_t i = 0;
+#if GFX_CONVERT_SIMD
+	const Float4 zero(0.0f), k10(1023.0f), k2(3.0f);
+	for (; i + 4 <= count; i += 4, d += dst_stride * 4) {
+	#if GFX_SIMD_SSE
+		const __m128i mask = _mm_set1_epi32(0x3ff);
+		__m128i c = _mm_loadu_si128((const __m128i*)(src + i));
+		Int4 r = _mm_and_si128(c, mask);
+		Int4 g = _mm_and_si128(_mm_srli_epi32(c, 10), mask);
+		Int4 b = _mm_and_si128(_mm_srli_epi32(c, 20), mask);
+		Int4 a = _mm_srli_epi32(c, 30);
+	#else
+		const uint32x4_t mask = vdupq_n_u32(0x3ff);
+		uint32x4_t c = vld1q_u32(src + i);
+		Int4 r = vreinterpretq_s32_u32(vandq_u32(c, mask));
+		Int4 g = vreinterpretq_s32_u32(vandq_u32(vshrq_n_u32(c, 10), mask));
+		Int4 b = vreinterpretq_s32_u32(vandq_u32(vshrq_n_u32(c, 20), mask));
+		Int4 a = vreinterpretq_s32_u32(vshrq_n_u32(c, 30));
+	#endif
+		Float4 x = Int4_ToFloat(r) / k10;
+		Float4 y = Int4_ToFloat(g) / k10;
+		Float4 z = Int4_ToFloat(b) / k10;
+		Float4 w = Int4_ToFloat(a) / k2;
+		Float4_Scatter<4>(d, dst_stride, x, y, z, w);
+	}
+#endif
+	for (; i < count; i++, d += dst_stride) {
+		*(Vector4*)d = UnpackA2B10G10R10(src[i]);
+	}
+}
+
+
+//---------------------------------------------------------------------
+// Namespace End
+//---------------------------------------------------------------------
+NAMESPACE_END(Core);
+NAMESPACE_END(GFX);
+
+
@@ -0,0 +1,140 @@
+//=====================================================================
+//
+// GFXConvert.h - half, normalized integer and packed vector formats
+//
+// Last Modified: 2026/10/18 17:12:30
+//
+//=====================================================================
+#ifndef _GFX_CONVERT_H_
+#define _GFX_CONVERT_H_
+
+#include <math.h>
+
+#include "GFXVector.h"
+
+
+//---------------------------------------------------------------------
+// Namespace Begin
+//---------------------------------------------------------------------
+NAMESPACE_BEGIN(GFX);
+NAMESPACE_BEGIN(Core);
+
+
+//---------------------------------------------------------------------
+// scalar conversions, Direct3D rules: nan becomes 0, values are
+// clamped to the representable range and rounded to nearest even,
+// snorm uses 2^(n-1)-1 steps so the most negative code is also -1.
+// the array kernels below give the same results lane for lane.
+//---------------------------------------------------------------------
+inline int32_t RoundToInt(float x) {
+#if GFX_SIMD_SSE
+	return _mm_cvtss_si32(_mm_set_ss(x));
+#else
+	return (int32_t)lrintf(x);
+#endif
+}
+
+inline float ClampUnit(float x, float low) {
+	if (!(x == x)) return 0.0f;
+	return (x < low)? low : ((x > 1.0f)? 1.0f : x);
+}
+
+inline int8_t FloatToSnorm8(float x) { return (int8_t)RoundToInt(ClampUnit(x, -1.0f) * 127.0f); }
+inline int16_t FloatToSnorm16(float x) { return (int16_t)RoundToInt(ClampUnit(x, -1.0f) * 32767.0f); }
+inline uint8_t FloatToUnorm8(float x) { return (uint8_t)RoundToInt(ClampUnit(x, 0.0f) * 255.0f); }
+inline uint16_t FloatToUnorm16(float x) { return (uint16_t)RoundToInt(ClampUnit(x, 0.0f) * 65535.0f); }
+
+inline float Snorm8ToFloat(int8_t x) { return Max((float)x / 127.0f, -1.0f); }
+inline float Snorm16ToFloat(int16_t x) { return Max((float)x / 32767.0f, -1.0f); }
+inline float Unorm8ToFloat(uint8_t x) { return (float)x / 255.0f; }
+inline float Unorm16ToFloat(uint16_t x) { return (float)x / 65535.0f; }
+
+
+//---------------------------------------------------------------------
+// octahedral unit vector: the direction is projected on the octahedron
+// |x| + |y| + |z| = 1 and the lower half folded over the upper, the
+// result is two snorm16 with x in the low word. decoded vectors are
+// renormalized, zero vectors encode as (0, 0) and decode to +z
+//---------------------------------------------------------------------
+inline uint32_t OctahedralEncode(const Vector3& n) {
+	float s = Abs(n.x) + Abs(n.y) + Abs(n.z);
+	float inv = (s > 0.0f)? (1.0f / s) : 0.0f;
+	float x = n.x * inv;
+	float y = n.y * inv;
+	if (n.z < 0.0f) {
+		float fx = (1.0f - Abs(y)) * ((x >= 0.0f)? 1.0f : -1.0f);
+		float fy = (1.0f - Abs(x)) * ((y >= 0.0f)? 1.0f : -1.0f);
+		x = fx, y = fy;
+	}
+	uint32_t ex = (uint16_t)FloatToSnorm16(x);
+	uint32_t ey = (uint16_t)FloatToSnorm16(y);
+	return ex | (ey << 16);
+}
+
+// in GFXConvert.cpp: with SIMD it runs the lanes of the array kernel,
+// so FMA contraction of x * x + y * y + z * z can't make them differ
+Vector3 OctahedralDecode(uint32_t e);
+
+
+//---------------------------------------------------------------------
+// 10:10:10:2 unorm in the D3DFMT_A2B10G10R10 layout: r in bits 0-9,
+// g in 10-19, b in 20-29 and a in 30-31. store normals or other
+// signed data biased with v * 0.5 + 0.5
+//---------------------------------------------------------------------
+inline uint32_t PackA2B10G10R10(const Vector4& c) {
+	uint32_t r = (uint32_t)RoundToInt(ClampUnit(c.x, 0.0f) * 1023.0f);
+	uint32_t g = (uint32_t)RoundToInt(ClampUnit(c.y, 0.0f) * 1023.0f);
+	uint32_t b = (uint32_t)RoundToInt(ClampUnit(c.z, 0.0f) * 1023.0f);
+	uint32_t a = (uint32_t)RoundToInt(ClampUnit(c.w, 0.0f) * 3.0f);
+	return r | (g << 10) | (b << 20) | (a << 30);
+}
+
+inline Vector4 UnpackA2B10G10R10(uint32_t c) {
+	return Vector4((float)(c & 0x3ff) / 1023.0f,
+			(float)((c >> 10) & 0x3ff) / 1023.0f,
+			(float)((c >> 20) & 0x3ff) / 1023.0f,
+			(float)(c >> 30) / 3.0f);
+}
+
+
+//---------------------------------------------------------------------
+// array kernels: SSE2 (F16C for half with AVX2) and NEON on aarch64,
+// the other targets loop over the scalar versions. src and dst must
+// not overlap, count is in elements
+//---------------------------------------------------------------------
+void FloatToHalfArray(uint16_t *dst, const float *src, size_t count);
+void HalfToFloatArray(float *dst, const uint16_t *src, size_t count);
+
+void FloatToSnorm8Array(int8_t *dst, const float *src, size_t count);
+void FloatToSnorm16Array(int16_t *dst, const float *src, size_t count);
+void FloatToUnorm8Array(uint8_t *dst, const float *src, size_t count);
+void FloatToUnorm16Array(uint16_t *dst, const float *src, size_t count);
+
+void Snorm8ToFloatArray(float *dst, const int8_t *src, size_t count);
+void Snorm16ToFloatArray(float *dst, const int16_t *src, size_t count);
+void Unorm8ToFloatArray(float *dst, const uint8_t *src, size_t count);
+void Unorm16ToFloatArray(float *dst, const uint16_t *src, size_t count);
+
+// strides are in bytes so normals can be read from or written to
+// an interleaved vertex stream (eg. &vertex[0].normal, sizeof(VertexSt))
+void OctahedralEncodeArray(uint32_t *dst, const Vector3 *src, size_t count,
+		size_t src_stride = sizeof(Vector3));
+void OctahedralDecodeArray(Vector3 *dst, const uint32_t *src, size_t count,
+		size_t dst_stride = sizeof(Vector3));
+
+void PackA2B10G10R10Array(uint32_t *dst, const Vector4 *src, size_t count,
+		size_t src_stride = sizeof(Vector4));
+void UnpackA2B10G10R10Array(Vector4 *dst, const uint32_t *src, size_t count,
+		size_t dst_stride = sizeof(Vector4));
+
+
+//---------------------------------------------------------------------
+// Namespace End
+//---------------------------------------------------------------------
+NAMESPACE_END(Core);
+NAMESPACE_END(GFX);
+
+
+#endif
+
+
@@ -27,6 +27,7 @@ VideoDriver::VideoDriver()
 	m_video_capacity.texture_has_mipmap = false;
 	m_video_capacity.texture_max_width = 0;
 	m_video_capacity.texture_max_height = 0;
+	ResetUploadStats();
 }
 
 
@@ -35,6 +36,11 @@ VideoDriver::VideoDriver()
 //---------------------------------------------------------------------
 VideoDriver::~VideoDriver()
 {
+	std::vector<Texture*> textures;
+	textures.swap(m_deferred_textures);
+	for (size_t i = 0; i < textures.size(); i++) {
+		textures[i]->SetDeferred(NULL);
+	}
 }
 
 
@@ -188,6 +194,40 @@ bool VideoDriver::CheckDeviceFormat(PixelFormat fmt, ResourceType rt)
 }
 
 
+//---------------------------------------------------------------------
+// deferred textures
+//---------------------------------------------------------------------
+void VideoDriver::AttachTexture(Texture *texture)
+{
+	m_deferred_textures.push_back(texture);
+}
+
+void VideoDriver::DetachTexture(Texture *texture)
+{
+	for (size_t i = 0; i < m_deferred_textures.size(); i++) {
+		if (m_deferred_textures[i] == texture) {
+			m_deferred_textures[i] = m_deferred_textures.back();
+			m_deferred_textures.pop_back();
+			break;
+		}
+	}
+}
+
+int VideoDriver::FlushTextures()
+{
+	int count = 0;
+	for (size_t i = 0; i < m_deferred_textures.size(); i++) {
+		count += m_deferred_textures[i]->Flush(&m_upload_stats);
+	}
+	return count;
+}
+
+void VideoDriver::ResetUploadStats()
+{
+	memset(&m_upload_stats, 0, sizeof(m_upload_stats));
+}
+
+
 //---------------------------------------------------------------------
 // calculate texture size
 //---------------------------------------------------------------------
@@ -12,6 +12,7 @@
 #include "GFXTypes.h"
 #include "GFXColor.h"
 #include "GFXImage.h"
+#include "GFXTexture.h"
 
 #include <functional>
 
@@ -111,6 +112,18 @@ public:
 
 	virtual bool CheckDeviceFormat(PixelFormat fmt, ResourceType rt);
 
+	// flush every texture deferred to this driver (Texture::SetDeferred),
+	// backends call it at BeginScene. returns the rects uploaded
+	int FlushTextures();
+
+	// totals of the deferred textures, updated by FlushTextures
+	inline const TextureUploadStats& GetUploadStats() const { return m_upload_stats; }
+	void ResetUploadStats();
+
+	// called by Texture::SetDeferred and the Texture destructor
+	void AttachTexture(Texture *texture);
+	void DetachTexture(Texture *texture);
+
 public:
 	inline bool IsTextureSquareOnly() const { return m_video_capacity.texture_square_only; }
 	inline bool IsTextureHasAlpha() const { return m_video_capacity.texture_has_alpha; }
@@ -138,6 +151,8 @@ protected:
 	VideoCapacity m_video_capacity;
 	Core::Color m_background_color;
 	std::vector<SupportFormat> m_support_formats;
+	std::vector<Texture*> m_deferred_textures;
+	TextureUploadStats m_upload_stats;
 	int m_device_id;
 	int m_video_width;
 	int m_video_height;
@@ -0,0 +1,244 @@
+//=====================================================================
+//
+// GFXFrustum.cpp - frustum planes and batched culling
+//
+// Last Modified: 2026/10/18 15:31:06
+//
+//=====================================================================
+#include "GFXFrustum.h"
+#include "GFXTransform.h"
+#include "GFXSimd.h"
+
+
+//---------------------------------------------------------------------
+// Namespace Begin
+//---------------------------------------------------------------------
+NAMESPACE_BEGIN(GFX);
+NAMESPACE_BEGIN(Core);
+
+
+//---------------------------------------------------------------------
+// Gribb/Hartmann: with row vectors clip = v * m, so every plane is a
+// sum of the columns of m
+//---------------------------------------------------------------------
+void Frustum::SetMatrix(const Matrix4& m, bool opengl)
+{
+	Vector4 c0(m.m00, m.m10, m.m20, m.m30);
+	Vector4 c1(m.m01, m.m11, m.m21, m.m31);
+	Vector4 c2(m.m02, m.m12, m.m22, m.m32);
+	Vector4 c3(m.m03, m.m13, m.m23, m.m33);
+	plane[PLANE_LEFT] = c3 + c0;
+	plane[PLANE_RIGHT] = c3 - c0;
+	plane[PLANE_BOTTOM] = c3 + c1;
+	plane[PLANE_TOP] = c3 - c1;
+	plane[PLANE_NEAR] = opengl? (c3 + c2) : c2;
+	plane[PLANE_FAR] = c3 - c2;
+	for (int i = 0; i < PLANE_COUNT; i++) {
+		Vector4& p = plane[i];
+		float k = p.x * p.x + p.y * p.y + p.z * p.z;
+		if (k > 0.0f) {
+			p *= InverseSquareRoot(k);
+		}
+	}
+}
+
+
+//---------------------------------------------------------------------
+// from Transform
+//---------------------------------------------------------------------
+void Frustum::SetViewProjection(Transform& transform)
+{
+	SetMatrix(*transform.GetVp(), transform.IsOpenGL());
+}
+
+
+//---------------------------------------------------------------------
+// single object tests
+//---------------------------------------------------------------------
+bool Frustum::TestPoint(const Vector3& p) const
+{
+	for (int i = 0; i < PLANE_COUNT; i++) {
+		const Vector4& n = plane[i];
+		if (n.x * p.x + n.y * p.y + n.z * p.z + n.w < 0.0f)
+			return false;
+	}
+	return true;
+}
+
+bool Frustum::TestSphere(const Vector3& center, float radius) const
+{
+	for (int i = 0; i < PLANE_COUNT; i++) {
+		const Vector4& n = plane[i];
+		float d = n.x * center.x + n.y * center.y + n.z * center.z + n.w;
+		if (d < -radius)
+			return false;
+	}
+	return true;
+}
+
+bool Frustum::TestAabb(const Vector3& vmin, const Vector3& vmax) const
+{
+	Vector3 c = (vmin + vmax) * 0.5f;
+	Vector3 e = (vmax - vmin) * 0.5f;
+	for (int i = 0; i < PLANE_COUNT; i++) {
+		const Vector4& n = plane[i];
+		float d = n.x * c.x + n.y * c.y + n.z * c.z + n.w;
+		float r = Abs(n.x) * e.x + Abs(n.y) * e.y + Abs(n.z) * e.z;
+		if (d + r < 0.0f)
+			return false;
+	}
+	return true;
+}
+
+
+//---------------------------------------------------------------------
+// batched kernels, F is Float4 or Float8: each lane is one object,
+// the planes are broadcast, and the mask of lanes inside all six
+// planes is expanded into indices
+//---------------------------------------------------------------------
+static inline int CullEmit(int mask, int base, int *visible) {
+	int n = 0;
+	while (mask) {
+		int k = 0;
+		while ((mask & (1 << k)) == 0) k++;
+		visible[n++] = base + k;
+		mask &= mask - 1;
+	}
+	return n;
+}
+
+template <class F>
+static inline F CullSphereLanes(const Vector4 *plane, const F& x,
+		const F& y, const F& z, const F& r)
+{
+	F nr = -r;
+	F inside = CmpEq(nr, nr);
+	for (int i = 0; i < Frustum::PLANE_COUNT; i++) {
+		const Vector4& p = plane[i];
+		F d = MulAdd(F(p.x), x, MulAdd(F(p.y), y, MulAdd(F(p.z), z, F(p.w))));
+		inside = And(inside, CmpGe(d, nr));
+	}
+	return inside;
+}
+
+template <class F>
+static int CullSpheresN(const Vector4 *plane, const float *x, const float *y,
+		const float *z, const float *r, int count, int *visible)
+{
+	const int N = F::LANES;
+	int n = 0, i = 0;
+	for (; i + N <= count; i += N) {
+		F inside = CullSphereLanes(plane, F::Load(x + i), F::Load(y + i),
+				F::Load(z + i), F::Load(r + i));
+		n += CullEmit(inside.MoveMask(), i, visible + n);
+	}
+	if (i < count) {
+		float t[4][N];
+		for (int k = 0; k < N; k++) {
+			bool valid = (i + k < count);
+			t[0][k] = valid? x[i + k] : 0.0f;
+			t[1][k] = valid? y[i + k] : 0.0f;
+			t[2][k] = valid? z[i + k] : 0.0f;
+			t[3][k] = valid? r[i + k] : 0.0f;
+		}
+		F inside = CullSphereLanes(plane, F::Load(t[0]), F::Load(t[1]),
+				F::Load(t[2]), F::Load(t[3]));
+		int mask = inside.MoveMask() & ((1 << (count - i)) - 1);
+		n += CullEmit(mask, i, visible + n);
+	}
+	return n;
+}
+
+template <class F>
+static inline F CullAabbLanes(const Vector4 *plane, const F& cx, const F& cy,
+		const F& cz, const F& ex, const F& ey, const F& ez)
+{
+	F zero = F::Zero();
+	F inside = CmpEq(zero, zero);
+	for (int i = 0; i < Frustum::PLANE_COUNT; i++) {
+		const Vector4& p = plane[i];
+		F d = MulAdd(F(p.x), cx, MulAdd(F(p.y), cy, MulAdd(F(p.z), cz, F(p.w))));
+		F r = MulAdd(F(Abs(p.x)), ex, MulAdd(F(Abs(p.y)), ey, F(Abs(p.z)) * ez));
+		inside = And(inside, CmpGe(d + r, zero));
+	}
+	return inside;
+}
+
+template <class F>
+static int CullAabbsN(const Vector4 *plane, const float *cx, const float *cy,
+		const float *cz, const float *ex, const float *ey, const float *ez,
+		int count, int *visible)
+{
+	const int N = F::LANES;
+	int n = 0, i = 0;
+	for (; i + N <= count; i += N) {
+		F inside = CullAabbLanes(plane, F::Load(cx + i), F::Load(cy + i),
+				F::Load(cz + i), F::Load(ex + i), F::Load(ey + i),
+				F::Load(ez + i));
+		n += CullEmit(inside.MoveMask(), i, visible + n);
+	}
+	if (i < count) {
+		const float *src[6] = { cx, cy, cz, ex, ey, ez };
+		float t[6][N];
+		for (int j = 0; j < 6; j++) {
+			for (int k = 0; k < N; k++) {
+				t[j][k] = (i + k < count)? src[j][i + k] : 0.0f;
+			}
+		}
+		F inside = CullAabbLanes(plane, F::Load(t[0]), F::Load(t[1]),
+				F::Load(t[2]), F::Load(t[3]), F::Load(t[4]), F::Load(t[5]));
+		int mask = inside.MoveMask() & ((1 << (count - i)) - 1);
+		n += CullEmit(mask, i, visible + n);
+	}
+	return n;
+}
+
+
+//---------------------------------------------------------------------
+// 8 objects per iteration with AVX, 4 otherwise
+//---------------------------------------------------------------------
+#if GFX_SIMD_AVX
+typedef Float8 FloatCull;
+#else
+typedef Float4 FloatCull;
+#endif
+
+int Frustum::CullSpheres(const float *x, const float *y, const float *z,
+		const float *r, int count, int *visible) const
+{
+	if (count <= 0) return 0;
+	return CullSpheresN<FloatCull>(plane, x, y, z, r, count, visible);
+}
+
+int Frustum::CullAabbs(const float *cx, const float *cy, const float *cz,
+		const float *ex, const float *ey, const float *ez,
+		int count, int *visible) const
+{
+	if (count <= 0) return 0;
+	return CullAabbsN<FloatCull>(plane, cx, cy, cz, ex, ey, ez, count, visible);
+}
+
+int Frustum::CullSpheres(const SphereArray& spheres, int *visible) const
+{
+	int count = spheres.Size();
+	if (count == 0) return 0;
+	return CullSpheres(&spheres.x[0], &spheres.y[0], &spheres.z[0],
+			&spheres.r[0], count, visible);
+}
+
+int Frustum::CullAabbs(const AabbArray& boxes, int *visible) const
+{
+	int count = boxes.Size();
+	if (count == 0) return 0;
+	return CullAabbs(&boxes.cx[0], &boxes.cy[0], &boxes.cz[0],
+			&boxes.ex[0], &boxes.ey[0], &boxes.ez[0], count, visible);
+}
+
+
+//---------------------------------------------------------------------
+// Namespace End
+//---------------------------------------------------------------------
+NAMESPACE_END(Core);
+NAMESPACE_END(GFX);
+
+
@@ -0,0 +1,149 @@
+//=====================================================================
+//
+// GFXFrustum.h - frustum planes and batched culling
+//
+// Last Modified: 2026/10/18 15:31:06
+//
+//=====================================================================
+#ifndef _GFX_FRUSTUM_H_
+#define _GFX_FRUSTUM_H_
+
+#include <vector>
+
+#include "GFXMatrix.h"
+
+
+//---------------------------------------------------------------------
+// Namespace Begin
+//---------------------------------------------------------------------
+NAMESPACE_BEGIN(GFX);
+NAMESPACE_BEGIN(Core);
+
+class Transform;
+
+
+//---------------------------------------------------------------------
+// SphereArray - bounding spheres as structure of arrays
+//---------------------------------------------------------------------
+struct SphereArray
+{
+	std::vector<float> x, y, z, r;
+
+	inline int Size() const { return (int)r.size(); }
+
+	inline void Clear() {
+		x.clear(), y.clear(), z.clear(), r.clear();
+	}
+
+	inline void Reserve(int n) {
+		x.reserve(n), y.reserve(n), z.reserve(n), r.reserve(n);
+	}
+
+	inline int Add(const Vector3& center, float radius) {
+		x.push_back(center.x), y.push_back(center.y), z.push_back(center.z);
+		r.push_back(radius);
+		return Size() - 1;
+	}
+
+	inline void Set(int i, const Vector3& center, float radius) {
+		x[i] = center.x, y[i] = center.y, z[i] = center.z, r[i] = radius;
+	}
+};
+
+
+//---------------------------------------------------------------------
+// AabbArray - axis aligned boxes as center and half extent arrays
+//---------------------------------------------------------------------
+struct AabbArray
+{
+	std::vector<float> cx, cy, cz;
+	std::vector<float> ex, ey, ez;
+
+	inline int Size() const { return (int)cx.size(); }
+
+	inline void Clear() {
+		cx.clear(), cy.clear(), cz.clear();
+		ex.clear(), ey.clear(), ez.clear();
+	}
+
+	inline void Reserve(int n) {
+		cx.reserve(n), cy.reserve(n), cz.reserve(n);
+		ex.reserve(n), ey.reserve(n), ez.reserve(n);
+	}
+
+	inline int Add(const Vector3& vmin, const Vector3& vmax) {
+		cx.push_back((vmin.x + vmax.x) * 0.5f);
+		cy.push_back((vmin.y + vmax.y) * 0.5f);
+		cz.push_back((vmin.z + vmax.z) * 0.5f);
+		ex.push_back((vmax.x - vmin.x) * 0.5f);
+		ey.push_back((vmax.y - vmin.y) * 0.5f);
+		ez.push_back((vmax.z - vmin.z) * 0.5f);
+		return Size() - 1;
+	}
+
+	inline void Set(int i, const Vector3& vmin, const Vector3& vmax) {
+		cx[i] = (vmin.x + vmax.x) * 0.5f;
+		cy[i] = (vmin.y + vmax.y) * 0.5f;
+		cz[i] = (vmin.z + vmax.z) * 0.5f;
+		ex[i] = (vmax.x - vmin.x) * 0.5f;
+		ey[i] = (vmax.y - vmin.y) * 0.5f;
+		ez[i] = (vmax.z - vmin.z) * 0.5f;
+	}
+};
+
+
+//---------------------------------------------------------------------
+// Frustum - six normalized planes (a, b, c, d), a point p is inside
+// when a * p.x + b * p.y + c * p.z + d >= 0 for every plane
+//---------------------------------------------------------------------
+struct Frustum
+{
+	enum {
+		PLANE_LEFT = 0,
+		PLANE_RIGHT,
+		PLANE_BOTTOM,
+		PLANE_TOP,
+		PLANE_NEAR,
+		PLANE_FAR,
+		PLANE_COUNT,
+	};
+
+	Vector4 plane[PLANE_COUNT];
+
+	// planes of clip space v * m, opengl for a [-w, w] clip z range,
+	// otherwise the Direct3D [0, w] range. planes are in the space of
+	// the vectors m is applied to: world space for GetVp(), object
+	// space for GetMvp() (always [0, w], it includes Matrix4GL2DX)
+	void SetMatrix(const Matrix4& m, bool opengl = false);
+
+	// world space frustum of the current view and projection
+	void SetViewProjection(Transform& transform);
+
+	bool TestPoint(const Vector3& p) const;
+	bool TestSphere(const Vector3& center, float radius) const;
+	bool TestAabb(const Vector3& vmin, const Vector3& vmax) const;
+
+	// write indices of the objects intersecting the frustum into
+	// visible (capacity of Size() entries), returns visible count
+	int CullSpheres(const SphereArray& spheres, int *visible) const;
+	int CullAabbs(const AabbArray& boxes, int *visible) const;
+
+	// same on raw arrays, for callers with their own storage
+	int CullSpheres(const float *x, const float *y, const float *z,
+			const float *r, int count, int *visible) const;
+	int CullAabbs(const float *cx, const float *cy, const float *cz,
+			const float *ex, const float *ey, const float *ez,
+			int count, int *visible) const;
+};
+
+
+//---------------------------------------------------------------------
+// Namespace End
+//---------------------------------------------------------------------
+NAMESPACE_END(Core);
+NAMESPACE_END(GFX);
+
+
+#endif
+
+
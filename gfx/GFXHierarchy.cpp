@@ -0,0 +1,169 @@
+//=====================================================================
+//
+// GFXHierarchy.cpp - flat transform hierarchy
+//
+// Last Modified: 2026/10/18 15:02:44
+//
+//=====================================================================
+#include <string.h>
+
+#include "GFXHierarchy.h"
+#include "GFXTransform.h"
+
+
+//---------------------------------------------------------------------
+// Namespace Begin
+//---------------------------------------------------------------------
+NAMESPACE_BEGIN(GFX);
+NAMESPACE_BEGIN(Core);
+
+
+//---------------------------------------------------------------------
+// ctor
+//---------------------------------------------------------------------
+TransformHierarchy::TransformHierarchy()
+{
+	m_vp = Matrix4Unit;
+	m_dirty_any = false;
+	m_dirty_vp = false;
+}
+
+
+//---------------------------------------------------------------------
+// dtor
+//---------------------------------------------------------------------
+TransformHierarchy::~TransformHierarchy()
+{
+}
+
+
+//---------------------------------------------------------------------
+// remove all nodes
+//---------------------------------------------------------------------
+void TransformHierarchy::Clear()
+{
+	m_parent.clear();
+	m_dirty.clear();
+	m_local.clear();
+	m_world.clear();
+	m_mvp.clear();
+	m_dirty_any = false;
+}
+
+
+//---------------------------------------------------------------------
+// reserve
+//---------------------------------------------------------------------
+void TransformHierarchy::Reserve(int capacity)
+{
+	m_parent.reserve(capacity);
+	m_dirty.reserve(capacity);
+	m_local.reserve(capacity);
+	m_world.reserve(capacity);
+	m_mvp.reserve(capacity);
+}
+
+
+//---------------------------------------------------------------------
+// append a node after its parent
+//---------------------------------------------------------------------
+int TransformHierarchy::AddNode(int parent, const Matrix4& local)
+{
+	int index = (int)m_parent.size();
+	assert(parent >= -1 && parent < index);
+	m_parent.push_back(parent);
+	m_dirty.push_back(1);
+	m_local.push_back(local);
+	m_world.push_back(local);
+	m_mvp.push_back(local);
+	m_dirty_any = true;
+	return index;
+}
+
+
+//---------------------------------------------------------------------
+// local transform
+//---------------------------------------------------------------------
+void TransformHierarchy::SetLocal(int node, const Matrix4& local)
+{
+	m_local[node] = local;
+	m_dirty[node] = 1;
+	m_dirty_any = true;
+}
+
+
+//---------------------------------------------------------------------
+// camera
+//---------------------------------------------------------------------
+void TransformHierarchy::SetViewProjection(const Matrix4& view, const Matrix4& projection)
+{
+	Matrix4::Multiply(m_vp, view, projection);
+	m_dirty_vp = true;
+}
+
+void TransformHierarchy::SetViewProjection(const Matrix4& vp)
+{
+	m_vp = vp;
+	m_dirty_vp = true;
+}
+
+
+//---------------------------------------------------------------------
+// one linear pass: a node is dirty if it was set or its parent was
+// rebuilt in this pass, parents come first so their flag is final.
+//---------------------------------------------------------------------
+int TransformHierarchy::Update()
+{
+	int count = (int)m_parent.size();
+	int updated = 0;
+
+	if (count == 0) {
+		m_dirty_any = false;
+		m_dirty_vp = false;
+		return 0;
+	}
+
+	const int *parent = &m_parent[0];
+	unsigned char *dirty = &m_dirty[0];
+	const Matrix4 *local = &m_local[0];
+	Matrix4 *world = &m_world[0];
+	Matrix4 *mvp = &m_mvp[0];
+
+	if (m_dirty_any) {
+		for (int i = 0; i < count; i++) {
+			int p = parent[i];
+			if (p >= 0) dirty[i] |= dirty[p];
+			if (dirty[i] == 0) continue;
+			if (p < 0) {
+				world[i] = local[i];
+			}
+			else {
+				Matrix4::Multiply(world[i], local[i], world[p]);
+			}
+			if (!m_dirty_vp) {
+				Matrix4::Multiply(mvp[i], world[i], m_vp);
+			}
+			updated++;
+		}
+		memset(dirty, 0, count);
+		m_dirty_any = false;
+	}
+
+	if (m_dirty_vp) {
+		for (int i = 0; i < count; i++) {
+			Matrix4::Multiply(mvp[i], world[i], m_vp);
+		}
+		m_dirty_vp = false;
+	}
+
+	return updated;
+}
+
+
+//---------------------------------------------------------------------
+// Namespace End
+//---------------------------------------------------------------------
+NAMESPACE_END(Core);
+NAMESPACE_END(GFX);
+
+
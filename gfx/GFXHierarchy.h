@@ -0,0 +1,87 @@
+//=====================================================================
+//
+// GFXHierarchy.h - flat transform hierarchy
+//
+// Last Modified: 2026/10/18 15:02:44
+//
+//=====================================================================
+#ifndef _GFX_HIERARCHY_H_
+#define _GFX_HIERARCHY_H_
+
+#include <vector>
+
+#include "GFXMatrix.h"
+
+
+//---------------------------------------------------------------------
+// Namespace Begin
+//---------------------------------------------------------------------
+NAMESPACE_BEGIN(GFX);
+NAMESPACE_BEGIN(Core);
+
+
+//---------------------------------------------------------------------
+// TransformHierarchy - nodes are stored as parallel arrays in parent
+// first order (a parent index is always lower than its children), so
+// one forward pass propagates dirty flags and rebuilds world matrices
+// of the changed subtrees, world = local * parent world (row vector).
+//---------------------------------------------------------------------
+class TransformHierarchy
+{
+public:
+	virtual ~TransformHierarchy();
+	TransformHierarchy();
+
+public:
+	void Clear();
+	void Reserve(int capacity);
+
+	// parent is -1 for a root or an existing node, returns node index
+	int AddNode(int parent, const Matrix4& local);
+
+	inline int GetNodeCount() const { return (int)m_parent.size(); }
+	inline int GetParent(int node) const { return m_parent[node]; }
+
+	void SetLocal(int node, const Matrix4& local);
+	inline const Matrix4& GetLocal(int node) const { return m_local[node]; }
+
+	// results of the last Update()
+	inline const Matrix4& GetWorld(int node) const { return m_world[node]; }
+	inline const Matrix4& GetMvp(int node) const { return m_mvp[node]; }
+
+	// contiguous arrays for bulk upload, GetNodeCount() entries
+	inline const Matrix4* GetWorldArray() const { return m_world.empty()? NULL : &m_world[0]; }
+	inline const Matrix4* GetMvpArray() const { return m_mvp.empty()? NULL : &m_mvp[0]; }
+
+	// mvp = world * view * projection, all nodes are refreshed on the
+	// next Update() when the camera changes
+	void SetViewProjection(const Matrix4& view, const Matrix4& projection);
+	void SetViewProjection(const Matrix4& vp);
+	inline const Matrix4& GetViewProjection() const { return m_vp; }
+
+	// recompute world and mvp of dirty subtrees, returns the number
+	// of nodes whose world matrix was rebuilt
+	int Update();
+
+protected:
+	std::vector<int> m_parent;
+	std::vector<unsigned char> m_dirty;
+	std::vector<Matrix4> m_local;
+	std::vector<Matrix4> m_world;
+	std::vector<Matrix4> m_mvp;
+	Matrix4 m_vp;
+	bool m_dirty_any;
+	bool m_dirty_vp;
+};
+
+
+//---------------------------------------------------------------------
+// Namespace End
+//---------------------------------------------------------------------
+NAMESPACE_END(Core);
+NAMESPACE_END(GFX);
+
+
+#endif
+
+
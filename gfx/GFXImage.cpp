@@ -9,6 +9,8 @@
 #include <string.h>
 
 #include "GFXImage.h"
+#include "GFXPixel.h"
+#include "GFXColor.h"
 
 
 //---------------------------------------------------------------------
@@ -77,24 +79,58 @@ Image::~Image()
 //---------------------------------------------------------------------
 void Image::CopyRect(int x, int y, const Image *src, int sx, int sy, int sw, int sh)
 {
-	if (src->GetBpp() == GetBpp()) {
-		int clipdst[4] = { 0, 0, GetWidth(), GetHeight() };
-		int clipsrc[4] = { 0, 0, src->GetWidth(), src->GetHeight() };
-		int rectsrc[4] = { sx, sy, sx + sw, sy + sh };
-		int mode = 0;
-		if (ClipRect(clipdst, clipsrc, &x, &y, rectsrc, mode) == 0) {
-			sx = rectsrc[0];
-			sy = rectsrc[1];
-			sw = rectsrc[2] - rectsrc[0];
-			sh = rectsrc[3] - rectsrc[1];
-			int need = sw * (GetBpp() / 8);
-			for (int j = 0; j < sh; j++) {
-				const unsigned char *ss = src->GetLine(sy + j);
-				unsigned char *dd = GetLine(y + j);
-				memcpy(dd, ss, need);
-			}
-		}
+	Blit(x, y, src, sx, sy, sw, sh, 0);
+}
+
+
+//---------------------------------------------------------------------
+// blit: the clipped source rect is read bottom up for VFLIP and each
+// row from the right for HFLIP
+//---------------------------------------------------------------------
+bool Image::Blit(int x, int y, const Image *src, int sx, int sy, int sw, int sh, int mode)
+{
+	int clipdst[4] = { 0, 0, GetWidth(), GetHeight() };
+	int clipsrc[4] = { 0, 0, src->GetWidth(), src->GetHeight() };
+	int rectsrc[4] = { sx, sy, sx + sw, sy + sh };
+	if (ClipRect(clipdst, clipsrc, &x, &y, rectsrc, mode) != 0) {
+		return false;
+	}
+	sx = rectsrc[0];
+	sy = rectsrc[1];
+	sw = rectsrc[2] - rectsrc[0];
+	sh = rectsrc[3] - rectsrc[1];
+	const unsigned char *ss = src->GetLine(sy) + sx * (src->GetBpp() / 8);
+	unsigned char *dd = GetLine(y) + x * (GetBpp() / 8);
+	return ConvertPixels(dd, GetPitch(), GetFormat(), ss, src->GetPitch(),
+			src->GetFormat(), sw, sh, mode);
+}
+
+
+//---------------------------------------------------------------------
+// blend rectangle
+//---------------------------------------------------------------------
+bool Image::Blend(int x, int y, const Image *src, int sx, int sy, int sw, int sh, BlendOp op)
+{
+	return Blend(x, y, src, sx, sy, sw, sh, op, Core::Color(0xffffffff));
+}
+
+bool Image::Blend(int x, int y, const Image *src, int sx, int sy, int sw, int sh, BlendOp op,
+		const Core::Color& color)
+{
+	int clipdst[4] = { 0, 0, GetWidth(), GetHeight() };
+	int clipsrc[4] = { 0, 0, src->GetWidth(), src->GetHeight() };
+	int rectsrc[4] = { sx, sy, sx + sw, sy + sh };
+	if (ClipRect(clipdst, clipsrc, &x, &y, rectsrc, 0) != 0) {
+		return false;
 	}
+	sx = rectsrc[0];
+	sy = rectsrc[1];
+	sw = rectsrc[2] - rectsrc[0];
+	sh = rectsrc[3] - rectsrc[1];
+	const unsigned char *ss = src->GetLine(sy) + sx * (src->GetBpp() / 8);
+	unsigned char *dd = GetLine(y) + x * (GetBpp() / 8);
+	return BlendPixels(dd, GetPitch(), GetFormat(), ss, src->GetPitch(),
+			src->GetFormat(), sw, sh, op, color.color);
 }
 
 
@@ -48,6 +48,36 @@ enum PixelFormat
 };
 
 
+//---------------------------------------------------------------------
+// Blit mode, the same bits as ClipRect
+//---------------------------------------------------------------------
+enum BlitMode
+{
+	BLIT_HFLIP = 1,
+	BLIT_VFLIP = 2,
+};
+
+
+//---------------------------------------------------------------------
+// Blend operators, s / d are source / destination channels in 0-1 and
+// sa the source alpha. except for the color key the alpha written is
+// sa + da * (1 - sa). results are rounded to nearest
+//---------------------------------------------------------------------
+enum BlendOp
+{
+	BLEND_SRCOVER = 0,		// s * sa + d * (1 - sa), straight alpha
+	BLEND_PREMULTIPLIED,	// s + d * (1 - sa), saturated
+	BLEND_ADD,				// d + s * sa, saturated
+	BLEND_MULTIPLY,			// d * (s * sa + 1 - sa)
+	BLEND_COLORKEY,			// s where s.rgb != color.rgb, else d
+	BLEND_MODULATE,			// BLEND_SRCOVER of s * color (alpha too)
+};
+
+NAMESPACE_BEGIN(Core);
+struct Color;
+NAMESPACE_END(Core);
+
+
 //---------------------------------------------------------------------
 // Image
 //---------------------------------------------------------------------
@@ -74,8 +104,22 @@ public:
 	inline const unsigned char* operator[](int y) const { return GetLine(y); }
 
 public:
+	// formats may differ, pixels are converted (GFXPixel.h)
 	void CopyRect(int x, int y, const Image *src, int sx, int sy, int sw, int sh);
 
+	// CopyRect with BLIT_HFLIP / BLIT_VFLIP: clip, mirror and convert
+	// in one pass. src may be this image if the rects do not overlap,
+	// returns false when nothing was drawn
+	bool Blit(int x, int y, const Image *src, int sx, int sy, int sw, int sh, int mode = 0);
+
+	// blend src onto this image with clipping. this image must be
+	// A8R8G8B8, X8R8G8B8 or R5G6B5, src may be any format (no alpha
+	// reads as opaque). color is the key of BLEND_COLORKEY and the
+	// factor of BLEND_MODULATE, returns false when nothing was drawn
+	bool Blend(int x, int y, const Image *src, int sx, int sy, int sw, int sh, BlendOp op);
+	bool Blend(int x, int y, const Image *src, int sx, int sy, int sw, int sh, BlendOp op,
+			const Core::Color& color);
+
 public:
 
 	static int FormatToBpp(PixelFormat fmt);
@@ -39,7 +39,76 @@
 
 
 #if GFX_PLATFORM == GFX_PLATFORM_SSE2
-#include <xmmintrin.h>
+#include <emmintrin.h>
+#elif GFX_PLATFORM == GFX_PLATFORM_AVX || GFX_PLATFORM == GFX_PLATFORM_AVX2
+#include <immintrin.h>
+#elif GFX_PLATFORM == GFX_PLATFORM_NEON
+#include <arm_neon.h>
+#endif
+
+
+//---------------------------------------------------------------------
+// SIMD features: AVX/AVX2 are supersets of SSE2, AVX2 may use FMA
+//---------------------------------------------------------------------
+#if GFX_PLATFORM == GFX_PLATFORM_SSE2 || GFX_PLATFORM == GFX_PLATFORM_AVX || \
+	GFX_PLATFORM == GFX_PLATFORM_AVX2
+#define GFX_SIMD_SSE		1
+#else
+#define GFX_SIMD_SSE		0
+#endif
+
+#if GFX_PLATFORM == GFX_PLATFORM_AVX || GFX_PLATFORM == GFX_PLATFORM_AVX2
+#define GFX_SIMD_AVX		1
+#else
+#define GFX_SIMD_AVX		0
+#endif
+
+#if GFX_PLATFORM == GFX_PLATFORM_AVX2
+#define GFX_SIMD_AVX2		1
+#else
+#define GFX_SIMD_AVX2		0
+#endif
+
+#if GFX_PLATFORM == GFX_PLATFORM_AVX2 && defined(__FMA__)
+#define GFX_SIMD_FMA		1
+#else
+#define GFX_SIMD_FMA		0
+#endif
+
+// every AVX2 cpu has F16C, gcc/clang still need -mf16c
+#if GFX_PLATFORM == GFX_PLATFORM_AVX2 && (defined(__F16C__) || defined(_MSC_VER))
+#define GFX_SIMD_F16C		1
+#else
+#define GFX_SIMD_F16C		0
+#endif
+
+#if GFX_PLATFORM == GFX_PLATFORM_NEON
+#define GFX_SIMD_NEON		1
+#else
+#define GFX_SIMD_NEON		0
+#endif
+
+
+//---------------------------------------------------------------------
+// Language: math types are constexpr-constructible on C++11 and the
+// Matrix4_SetXxx helpers are constexpr on C++14 (VS2017 and later)
+//---------------------------------------------------------------------
+#if defined(_MSVC_LANG)
+#define GFX_CPLUSPLUS		_MSVC_LANG
+#else
+#define GFX_CPLUSPLUS		__cplusplus
+#endif
+
+#if GFX_CPLUSPLUS >= 201103L
+#define GFX_CONSTEXPR		constexpr
+#else
+#define GFX_CONSTEXPR
+#endif
+
+#if GFX_CPLUSPLUS >= 201402L && (!defined(_MSC_VER) || _MSC_VER >= 1910)
+#define GFX_CONSTEXPR14		constexpr
+#else
+#define GFX_CONSTEXPR14
 #endif
 
 
@@ -151,6 +220,10 @@ inline bool NearZero(float x, float error = EPSILON_E6) {
 	return (x >= -error) && (x <= error);
 }
 
+inline bool NearZero(double x, double error = EPSILON_E6) {
+	return (x >= -error) && (x <= error);
+}
+
 inline float RadToDeg(float radius) {
 	return RAD_TO_DEG * radius;
 }
@@ -164,18 +237,35 @@ inline float DegToRad(float degree) {
 // Platform
 //---------------------------------------------------------------------
 inline float SquareRoot(float x) {
-#if GFX_PLATFORM == GFX_PLATFORM_NONE
-	return sqrtf(x);
-#elif GFX_PLATFORM == GFX_PLATFORM_SSE2
+#if GFX_SIMD_SSE
 	float y;
 	__m128 in = _mm_load_ss(&x);
 	_mm_store_ss(&y, _mm_sqrt_ss(in));
 	return y;
+#else
+	return sqrtf(x);
 #endif
 }
 
+inline double SquareRoot(double x) {
+	return sqrt(x);
+}
+
 inline float InverseSquareRoot(float x) {
-#if GFX_PLATFORM == GFX_PLATFORM_NONE
+#if GFX_SIMD_SSE
+	#if GFX_ENABLE_FAST_MATH == 0
+	float y, x2;
+	x2 = x * 0.5F;
+	__m128 in = _mm_load_ss(&x);
+	_mm_store_ss( &y, _mm_rsqrt_ss(in));
+	return y * (1.5f - (x2 * y * y));
+	#else
+	float y;
+	__m128 in = _mm_load_ss( &x );
+	_mm_store_ss( &y, _mm_rsqrt_ss( in ) );
+	return y;
+	#endif
+#else
 	#if GFX_ENABLE_FAST_MATH == 0
 	return 1.0f / SquareRoot(x);
 	#else
@@ -188,23 +278,282 @@ inline float InverseSquareRoot(float x) {
 	y = y * (1.5f - xhalf * y * y);
 	return y;
 	#endif
-#elif GFX_PLATFORM == GFX_PLATFORM_SSE2
-	#if GFX_ENABLE_FAST_MATH == 0
-	float y, x2;
-	x2 = x * 0.5F;
-	__m128 in = _mm_load_ss(&x);
-	_mm_store_ss( &y, _mm_rsqrt_ss(in));
-	return y * (1.5f - (x2 * y * y));
-	#else
-	float y;
-	__m128 in = _mm_load_ss( &pIn );
-	_mm_store_ss( &y, _mm_rsqrt_ss( in ) );
-	return y;
-	#endif
 #endif
 }
 
 
+//---------------------------------------------------------------------
+// Fast math: Cephes style polynomial approximations without libm,
+// max error measured against double precision libm:
+//
+//   FastSinCos  |x| <= 8192       abs error 1.0e-7
+//   FastTan     |x| <= 8192       rel error 2.5e-7 where |cos x| > 0.01,
+//                                 next to the zeros of tan too
+//   FastAtan2   all finite        abs error 3.0e-7 rad, (0, 0) gives 0,
+//                                 -0 counts as +0
+//   FastExp     [-87.3, 88.7]     rel error 1.2e-7, the input is
+//                                 clamped to that range (inf above)
+//   FastLog     positive normal   rel error 8.0e-8, abs error 4.0e-8
+//                                 on [0.5, 2], 0 gives -inf, < 0 nan
+//
+// the 4/8 lane versions in GFXSimd.h use the same polynomials,
+// test/GFXTestMath.cpp checks both against this table.
+// SinCos/Tan/Atan2/Exp/Log pick them when GFX_ENABLE_FAST_MATH is set.
+//---------------------------------------------------------------------
+inline void FastSinCos(float x, float *s, float *c) {
+	float q = x * 0.636619772f;
+	int n = (int)(q + ((q >= 0.0f)? 0.5f : -0.5f));
+	float fn = (float)n;
+	// pi/2 in five parts, the first four have few enough bits that
+	// fn * part is exact for |n| < 2^13, so r keeps its relative
+	// precision next to the zeros of sin and cos
+	float r = x - fn * 1.5703125f;
+	r = r - fn * 4.837512969970703125e-4f;
+	r = r - fn * 7.549533620476723e-8f;
+	r = r - fn * 2.5632829192545614e-12f;
+	r = r - fn * 6.123234262925839e-17f;
+	float z = r * r;
+	float ps = r + r * z * (-1.6666654611e-1f + z * (8.3321608736e-3f +
+			z * -1.9515295891e-4f));
+	float pc = 1.0f - 0.5f * z + z * z * (4.166664568298827e-2f +
+			z * (-1.388731625493765e-3f + z * 2.443315711809948e-5f));
+	switch (n & 3) {
+	case 0: *s = ps; *c = pc; break;
+	case 1: *s = pc; *c = -ps; break;
+	case 2: *s = -ps; *c = -pc; break;
+	default: *s = -pc; *c = ps; break;
+	}
+}
+
+inline float FastSin(float x) {
+	float s, c;
+	FastSinCos(x, &s, &c);
+	return s;
+}
+
+inline float FastCos(float x) {
+	float s, c;
+	FastSinCos(x, &s, &c);
+	return c;
+}
+
+inline float FastTan(float x) {
+	float s, c;
+	FastSinCos(x, &s, &c);
+	return s / c;
+}
+
+// atan on [0, 1]: reduced around tan(pi/8) then an odd polynomial
+inline float FastAtanUnit(float t) {
+	float y = 0.0f;
+	if (t > 0.4142135623730950f) {
+		t = (t - 1.0f) / (t + 1.0f);
+		y = PI_DIV_4;
+	}
+	float z = t * t;
+	return y + t + t * z * (-3.33329491539e-1f + z * (1.99777106478e-1f +
+			z * (-1.38776856032e-1f + z * 8.05374449538e-2f)));
+}
+
+inline float FastAtan2(float y, float x) {
+	float ax = Abs(x), ay = Abs(y);
+	float hi = Max(ax, ay), lo = Min(ax, ay);
+	if (hi == 0.0f) return 0.0f;
+	float r = FastAtanUnit(lo / hi);
+	if (ay > ax) r = PI_DIV_2 - r;
+	if (x < 0.0f) r = PI - r;
+	return (y < 0.0f)? -r : r;
+}
+
+inline float FastExp(float x) {
+	x = Clamp(x, -87.3365447f, 88.7228391f);
+	float fn = x * 1.44269504088896341f;
+	fn = (float)(int)(fn + ((fn >= 0.0f)? 0.5f : -0.5f));
+	float r = x - fn * 0.693359375f;
+	r = r - fn * -2.12194440e-4f;
+	float z = r * r;
+	float p = 1.0f + r + z * (5.0000001201e-1f + r * (1.6666665459e-1f +
+			r * (4.1665795894e-2f + r * (8.3334519073e-3f +
+			r * (1.3981999507e-3f + r * 1.9875691500e-4f)))));
+	// 2^n as two factors so n = 128 and n = -126 both stay normal
+	int n = (int)fn;
+	int n1 = n >> 1;
+	union { int32_t intpart; float floatpart; } e1, e2;
+	e1.intpart = (n1 + 127) << 23;
+	e2.intpart = (n - n1 + 127) << 23;
+	return p * e1.floatpart * e2.floatpart;
+}
+
+inline float FastLog(float x) {
+	if (x <= 0.0f) {
+		return (x == 0.0f)? -HUGE_VALF : NAN;
+	}
+	union { int32_t intpart; float floatpart; } convert;
+	convert.floatpart = x;
+	float e = (float)(((convert.intpart >> 23) & 0xff) - 126);
+	convert.intpart = (convert.intpart & 0x807fffff) | 0x3f000000;
+	float m = convert.floatpart;
+	if (m < 0.707106781186547524f) {
+		e = e - 1.0f;
+		m = m + m;
+	}
+	m = m - 1.0f;
+	float z = m * m;
+	float y = m * z * (3.3333331174e-1f + m * (-2.4999993993e-1f +
+			m * (2.0000714765e-1f + m * (-1.6668057665e-1f +
+			m * (1.4249322787e-1f + m * (-1.2420140846e-1f +
+			m * (1.1676998740e-1f + m * (-1.1514610310e-1f +
+			m * 7.0376836292e-2f))))))));
+	y = y + e * -2.12194440e-4f;
+	y = y - 0.5f * z;
+	return m + y + e * 0.693359375f;
+}
+
+inline void SinCos(float x, float *s, float *c) {
+#if GFX_ENABLE_FAST_MATH
+	FastSinCos(x, s, c);
+#else
+	*s = sinf(x);
+	*c = cosf(x);
+#endif
+}
+
+inline float Tan(float x) {
+#if GFX_ENABLE_FAST_MATH
+	return FastTan(x);
+#else
+	return tanf(x);
+#endif
+}
+
+inline float Atan2(float y, float x) {
+#if GFX_ENABLE_FAST_MATH
+	return FastAtan2(y, x);
+#else
+	return atan2f(y, x);
+#endif
+}
+
+inline float Exp(float x) {
+#if GFX_ENABLE_FAST_MATH
+	return FastExp(x);
+#else
+	return expf(x);
+#endif
+}
+
+inline float Log(float x) {
+#if GFX_ENABLE_FAST_MATH
+	return FastLog(x);
+#else
+	return logf(x);
+#endif
+}
+
+
+
+//---------------------------------------------------------------------
+// Half: IEEE 754 binary16 storage. it is a POD so it can live in the
+// vector unions, arithmetic goes through float and assigning a float
+// rounds to nearest even (overflow gives inf, nan stays nan)
+//---------------------------------------------------------------------
+inline uint16_t FloatToHalf(float f) {
+	union { float floatpart; uint32_t intpart; } convert;
+	convert.floatpart = f;
+	uint32_t u = convert.intpart & 0x7fffffff;
+	uint32_t sign = (convert.intpart >> 16) & 0x8000;
+	if (u >= 0x7f800000) {
+		uint32_t nan = (u > 0x7f800000)? (0x200 | ((u >> 13) & 0x3ff)) : 0;
+		return (uint16_t)(sign | 0x7c00 | nan);
+	}
+	if (u >= 0x47800000) {
+		return (uint16_t)(sign | 0x7c00);
+	}
+	if (u < 0x38800000) {
+		// subnormal: mantissa with the implicit bit, shifted by 14..24
+		if (u < 0x33000000) return (uint16_t)sign;
+		uint32_t shift = 126 - (u >> 23);
+		uint32_t m = (u & 0x7fffff) | 0x800000;
+		uint32_t h = m >> shift;
+		uint32_t rem = m & ((1u << shift) - 1);
+		uint32_t half = 1u << (shift - 1);
+		if (rem > half || (rem == half && (h & 1))) h++;
+		return (uint16_t)(sign | h);
+	}
+	// rebias 127 -> 15, a carry out of the mantissa bumps the exponent
+	uint32_t h = (u >> 13) - (112 << 10);
+	uint32_t rem = u & 0x1fff;
+	if (rem > 0x1000 || (rem == 0x1000 && (h & 1))) h++;
+	return (uint16_t)(sign | h);
+}
+
+inline float HalfToFloat(uint16_t h) {
+	union { float floatpart; uint32_t intpart; } convert;
+	uint32_t sign = (uint32_t)(h & 0x8000) << 16;
+	uint32_t e = (h >> 10) & 0x1f;
+	uint32_t m = h & 0x3ff;
+	if (e == 0) {
+		float f = (float)m * (1.0f / 16777216.0f);
+		return sign? -f : f;
+	}
+	else if (e == 31) {
+		// nan turns quiet, as F16C and NEON do
+		uint32_t quiet = m? 0x400000 : 0;
+		convert.intpart = sign | 0x7f800000 | quiet | (m << 13);
+	}
+	else {
+		convert.intpart = sign | ((e + 112) << 23) | (m << 13);
+	}
+	return convert.floatpart;
+}
+
+struct Half
+{
+	uint16_t bits;
+
+	inline operator float() const { return HalfToFloat(bits); }
+	inline Half& operator = (float f) { bits = FloatToHalf(f); return *this; }
+};
+
+inline Half Half_FromFloat(float f) {
+	Half h;
+	h.bits = FloatToHalf(f);
+	return h;
+}
+
+
+//---------------------------------------------------------------------
+// ScalarTraits: Scalar is the type arithmetic and scale factors use,
+// Real is the type of lengths. integers measure lengths in float
+//---------------------------------------------------------------------
+template <class T>
+struct ScalarTraits {
+	typedef T Scalar;
+	typedef float Real;
+	enum { IS_FLOAT = 0 };
+};
+
+template <>
+struct ScalarTraits<float> {
+	typedef float Scalar;
+	typedef float Real;
+	enum { IS_FLOAT = 1 };
+};
+
+template <>
+struct ScalarTraits<double> {
+	typedef double Scalar;
+	typedef double Real;
+	enum { IS_FLOAT = 1 };
+};
+
+template <>
+struct ScalarTraits<Half> {
+	typedef float Scalar;
+	typedef float Real;
+	enum { IS_FLOAT = 1 };
+};
+
 
 //---------------------------------------------------------------------
 // namespace endup
@@ -0,0 +1,366 @@
+//=====================================================================
+//
+// GFXMatrix.cpp -
+//
+// Last Modified: 2026/10/18 10:12:40
+//
+//=====================================================================
+#include <stddef.h>
+#include <string.h>
+
+#include "GFXMatrix.h"
+#include "GFXSimd.h"
+
+
+//---------------------------------------------------------------------
+// Namespace Begin
+//---------------------------------------------------------------------
+NAMESPACE_BEGIN(GFX);
+NAMESPACE_BEGIN(Core);
+
+
+#if GFX_SIMD_SSE
+
+//---------------------------------------------------------------------
+// SSE helpers for the 2x2 block inverse: a 2x2 matrix lives in one
+// register as (m00, m01, m10, m11)
+//---------------------------------------------------------------------
+#define GFX_SHUFFLE(a, b, x, y, z, w) \
+	_mm_shuffle_ps(a, b, (x) | ((y) << 2) | ((z) << 4) | ((w) << 6))
+#define GFX_SWIZZLE(a, x, y, z, w) GFX_SHUFFLE(a, a, x, y, z, w)
+
+// A * B
+static inline __m128 Mat2Mul(__m128 a, __m128 b)
+{
+	return _mm_add_ps(_mm_mul_ps(a, GFX_SWIZZLE(b, 0, 3, 0, 3)),
+		_mm_mul_ps(GFX_SWIZZLE(a, 1, 0, 3, 2), GFX_SWIZZLE(b, 2, 1, 2, 1)));
+}
+
+// adj(A) * B
+static inline __m128 Mat2AdjMul(__m128 a, __m128 b)
+{
+	return _mm_sub_ps(_mm_mul_ps(GFX_SWIZZLE(a, 3, 3, 0, 0), b),
+		_mm_mul_ps(GFX_SWIZZLE(a, 1, 1, 2, 2), GFX_SWIZZLE(b, 2, 3, 0, 1)));
+}
+
+// A * adj(B)
+static inline __m128 Mat2MulAdj(__m128 a, __m128 b)
+{
+	return _mm_sub_ps(_mm_mul_ps(a, GFX_SWIZZLE(b, 3, 0, 3, 0)),
+		_mm_mul_ps(GFX_SWIZZLE(a, 1, 0, 3, 2), GFX_SWIZZLE(b, 2, 1, 2, 1)));
+}
+
+// horizontal sum broadcast to every lane
+static inline __m128 HorizontalSum(__m128 v)
+{
+	v = _mm_add_ps(v, GFX_SWIZZLE(v, 2, 3, 0, 1));
+	return _mm_add_ps(v, GFX_SWIZZLE(v, 1, 0, 3, 2));
+}
+
+// cross product of xyz, w becomes zero
+static inline __m128 Cross3(__m128 a, __m128 b)
+{
+	__m128 u = _mm_mul_ps(GFX_SWIZZLE(a, 1, 2, 0, 3), GFX_SWIZZLE(b, 2, 0, 1, 3));
+	__m128 v = _mm_mul_ps(GFX_SWIZZLE(a, 2, 0, 1, 3), GFX_SWIZZLE(b, 1, 2, 0, 3));
+	return _mm_sub_ps(u, v);
+}
+
+#endif
+
+
+//---------------------------------------------------------------------
+// determinant
+//---------------------------------------------------------------------
+float Matrix4Kernel<float>::Determinant(const Matrix4& a)
+{
+#if GFX_SIMD_SSE
+	__m128 r0 = _mm_loadu_ps(a.m[0]);
+	__m128 r1 = _mm_loadu_ps(a.m[1]);
+	__m128 r2 = _mm_loadu_ps(a.m[2]);
+	__m128 r3 = _mm_loadu_ps(a.m[3]);
+	__m128 A = _mm_movelh_ps(r0, r1);
+	__m128 B = _mm_movehl_ps(r1, r0);
+	__m128 C = _mm_movelh_ps(r2, r3);
+	__m128 D = _mm_movehl_ps(r3, r2);
+	// (|A|, |B|, |C|, |D|)
+	__m128 dets = _mm_sub_ps(
+		_mm_mul_ps(GFX_SHUFFLE(r0, r2, 0, 2, 0, 2), GFX_SHUFFLE(r1, r3, 1, 3, 1, 3)),
+		_mm_mul_ps(GFX_SHUFFLE(r0, r2, 1, 3, 1, 3), GFX_SHUFFLE(r1, r3, 0, 2, 0, 2)));
+	// |M| = |A||D| + |B||C| - tr(adj(A) B adj(D) C)
+	__m128 AB = Mat2AdjMul(A, B);
+	__m128 DC = Mat2AdjMul(D, C);
+	__m128 tr = HorizontalSum(_mm_mul_ps(AB, GFX_SWIZZLE(DC, 0, 2, 1, 3)));
+	// lane 0 holds |A||D|, lane 1 holds |B||C|
+	__m128 p = _mm_mul_ps(dets, GFX_SWIZZLE(dets, 3, 2, 1, 0));
+	__m128 det = _mm_sub_ss(_mm_add_ss(p, GFX_SWIZZLE(p, 1, 1, 1, 1)), tr);
+	return _mm_cvtss_f32(det);
+#else
+	return Matrix4::DeterminantScalar(a);
+#endif
+}
+
+
+//---------------------------------------------------------------------
+// general inverse
+//---------------------------------------------------------------------
+bool Matrix4Kernel<float>::Inverse(Matrix4& t, const Matrix4& a)
+{
+#if GFX_SIMD_SSE
+	__m128 r0 = _mm_loadu_ps(a.m[0]);
+	__m128 r1 = _mm_loadu_ps(a.m[1]);
+	__m128 r2 = _mm_loadu_ps(a.m[2]);
+	__m128 r3 = _mm_loadu_ps(a.m[3]);
+	__m128 A = _mm_movelh_ps(r0, r1);
+	__m128 B = _mm_movehl_ps(r1, r0);
+	__m128 C = _mm_movelh_ps(r2, r3);
+	__m128 D = _mm_movehl_ps(r3, r2);
+	__m128 dets = _mm_sub_ps(
+		_mm_mul_ps(GFX_SHUFFLE(r0, r2, 0, 2, 0, 2), GFX_SHUFFLE(r1, r3, 1, 3, 1, 3)),
+		_mm_mul_ps(GFX_SHUFFLE(r0, r2, 1, 3, 1, 3), GFX_SHUFFLE(r1, r3, 0, 2, 0, 2)));
+	__m128 detA = GFX_SWIZZLE(dets, 0, 0, 0, 0);
+	__m128 detB = GFX_SWIZZLE(dets, 1, 1, 1, 1);
+	__m128 detC = GFX_SWIZZLE(dets, 2, 2, 2, 2);
+	__m128 detD = GFX_SWIZZLE(dets, 3, 3, 3, 3);
+	__m128 DC = Mat2AdjMul(D, C);
+	__m128 AB = Mat2AdjMul(A, B);
+	// inverse = 1/|M| * [X Y; Z W], computed as adjugates first
+	__m128 X = _mm_sub_ps(_mm_mul_ps(detD, A), Mat2Mul(B, DC));
+	__m128 W = _mm_sub_ps(_mm_mul_ps(detA, D), Mat2Mul(C, AB));
+	__m128 Y = _mm_sub_ps(_mm_mul_ps(detB, C), Mat2MulAdj(D, AB));
+	__m128 Z = _mm_sub_ps(_mm_mul_ps(detC, B), Mat2MulAdj(A, DC));
+	__m128 tr = HorizontalSum(_mm_mul_ps(AB, GFX_SWIZZLE(DC, 0, 2, 1, 3)));
+	__m128 det = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(detA, detD),
+				_mm_mul_ps(detB, detC)), tr);
+	if (_mm_cvtss_f32(det) == 0.0f) {
+		return false;
+	}
+	__m128 k = _mm_div_ps(_mm_setr_ps(1.0f, -1.0f, -1.0f, 1.0f), det);
+	X = _mm_mul_ps(X, k);
+	Y = _mm_mul_ps(Y, k);
+	Z = _mm_mul_ps(Z, k);
+	W = _mm_mul_ps(W, k);
+	// apply the 2x2 adjugate swizzle while storing
+	_mm_storeu_ps(t.m[0], GFX_SHUFFLE(X, Y, 3, 1, 3, 1));
+	_mm_storeu_ps(t.m[1], GFX_SHUFFLE(X, Y, 2, 0, 2, 0));
+	_mm_storeu_ps(t.m[2], GFX_SHUFFLE(Z, W, 3, 1, 3, 1));
+	_mm_storeu_ps(t.m[3], GFX_SHUFFLE(Z, W, 2, 0, 2, 0));
+	return true;
+#else
+	return Matrix4::InverseScalar(t, a);
+#endif
+}
+
+
+//---------------------------------------------------------------------
+// affine inverse
+//---------------------------------------------------------------------
+bool Matrix4Kernel<float>::InverseAffine(Matrix4& t, const Matrix4& a)
+{
+#if GFX_SIMD_SSE
+	__m128 mask = _mm_castsi128_ps(_mm_setr_epi32(-1, -1, -1, 0));
+	__m128 r0 = _mm_and_ps(_mm_loadu_ps(a.m[0]), mask);
+	__m128 r1 = _mm_and_ps(_mm_loadu_ps(a.m[1]), mask);
+	__m128 r2 = _mm_and_ps(_mm_loadu_ps(a.m[2]), mask);
+	__m128 tr = _mm_loadu_ps(a.m[3]);
+	__m128 c0 = Cross3(r1, r2);
+	__m128 c1 = Cross3(r2, r0);
+	__m128 c2 = Cross3(r0, r1);
+	__m128 det = HorizontalSum(_mm_mul_ps(r0, c0));
+	if (_mm_cvtss_f32(det) == 0.0f) {
+		return false;
+	}
+	__m128 k = _mm_div_ps(_mm_set1_ps(1.0f), det);
+	c0 = _mm_mul_ps(c0, k);
+	c1 = _mm_mul_ps(c1, k);
+	c2 = _mm_mul_ps(c2, k);
+	__m128 c3 = _mm_setzero_ps();
+	_MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+	// c0..c2 are rows of inv(R) with w = 0 now
+	__m128 p = _mm_add_ps(
+		_mm_mul_ps(GFX_SWIZZLE(tr, 0, 0, 0, 0), c0),
+		_mm_mul_ps(GFX_SWIZZLE(tr, 1, 1, 1, 1), c1));
+	p = _mm_add_ps(p, _mm_mul_ps(GFX_SWIZZLE(tr, 2, 2, 2, 2), c2));
+	p = _mm_sub_ps(_mm_setr_ps(0.0f, 0.0f, 0.0f, 1.0f), p);
+	_mm_storeu_ps(t.m[0], c0);
+	_mm_storeu_ps(t.m[1], c1);
+	_mm_storeu_ps(t.m[2], c2);
+	_mm_storeu_ps(t.m[3], p);
+	return true;
+#else
+	return Matrix4::InverseAffineScalar(t, a);
+#endif
+}
+
+#if GFX_SIMD_SSE
+#undef GFX_SWIZZLE
+#undef GFX_SHUFFLE
+#endif
+
+
+//---------------------------------------------------------------------
+// scalar: transform one vertex, read everything before writing so
+// dst can be the same memory as src
+//---------------------------------------------------------------------
+template <int NIN, int NOUT>
+static inline void TransformOne(const Matrix4& m, float *d, const float *s)
+{
+	float x = s[0], y = s[1], z = s[2];
+	float w = (NIN == 4)? s[3] : 1.0f;
+	float ox = x * m.m00 + y * m.m10 + z * m.m20 + w * m.m30;
+	float oy = x * m.m01 + y * m.m11 + z * m.m21 + w * m.m31;
+	float oz = x * m.m02 + y * m.m12 + z * m.m22 + w * m.m32;
+	if (NOUT == 4) {
+		float ow = x * m.m03 + y * m.m13 + z * m.m23 + w * m.m33;
+		d[3] = ow;
+	}
+	d[0] = ox;
+	d[1] = oy;
+	d[2] = oz;
+}
+
+
+#if GFX_SIMD_SSE
+
+//---------------------------------------------------------------------
+// SSE: out = x * r0 + y * r1 + z * r2 + w * r3 for one column
+//---------------------------------------------------------------------
+static inline __m128 Dot4(__m128 x, __m128 y, __m128 z, __m128 w,
+		float c0, float c1, float c2, float c3)
+{
+	__m128 u = _mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(c0)),
+			_mm_mul_ps(y, _mm_set1_ps(c1)));
+	__m128 v = _mm_add_ps(_mm_mul_ps(z, _mm_set1_ps(c2)),
+			_mm_mul_ps(w, _mm_set1_ps(c3)));
+	return _mm_add_ps(u, v);
+}
+
+#endif
+
+
+#if GFX_SIMD_AVX
+
+//---------------------------------------------------------------------
+// AVX: 8-wide column dot product
+//---------------------------------------------------------------------
+static inline __m256 Dot8(__m256 x, __m256 y, __m256 z, __m256 w,
+		float c0, float c1, float c2, float c3)
+{
+#if GFX_SIMD_FMA
+	__m256 u = _mm256_fmadd_ps(x, _mm256_set1_ps(c0),
+			_mm256_mul_ps(y, _mm256_set1_ps(c1)));
+	__m256 v = _mm256_fmadd_ps(z, _mm256_set1_ps(c2),
+			_mm256_mul_ps(w, _mm256_set1_ps(c3)));
+#else
+	__m256 u = _mm256_add_ps(_mm256_mul_ps(x, _mm256_set1_ps(c0)),
+			_mm256_mul_ps(y, _mm256_set1_ps(c1)));
+	__m256 v = _mm256_add_ps(_mm256_mul_ps(z, _mm256_set1_ps(c2)),
+			_mm256_mul_ps(w, _mm256_set1_ps(c3)));
+#endif
+	return _mm256_add_ps(u, v);
+}
+
+#endif
+
+
+#if GFX_SIMD_NEON
+
+//---------------------------------------------------------------------
+// NEON: out = x * r0 + y * r1 + z * r2 + w * r3 for one column
+//---------------------------------------------------------------------
+static inline float32x4_t Dot4(float32x4_t x, float32x4_t y,
+		float32x4_t z, float32x4_t w,
+		float c0, float c1, float c2, float c3)
+{
+	float32x4_t u = vmulq_n_f32(x, c0);
+	u = vmlaq_n_f32(u, y, c1);
+	u = vmlaq_n_f32(u, z, c2);
+	return vmlaq_n_f32(u, w, c3);
+}
+
+#endif
+
+
+//---------------------------------------------------------------------
+// batch kernel: NIN/NOUT are 3 or 4 floats per vertex
+//---------------------------------------------------------------------
+template <int NIN, int NOUT>
+static void TransformKernel(const Matrix4& m, uint8_t *dst, size_t dst_stride,
+		const uint8_t *src, size_t src_stride, size_t count)
+{
+	size_t i = 0;
+#if GFX_SIMD_AVX
+	for (; i + 8 <= count; i += 8) {
+		Float8 x, y, z, w;
+		Float8_Gather<NIN>(src, src_stride, x, y, z, w);
+		Float8 ox = Dot8(x.v, y.v, z.v, w.v, m.m00, m.m10, m.m20, m.m30);
+		Float8 oy = Dot8(x.v, y.v, z.v, w.v, m.m01, m.m11, m.m21, m.m31);
+		Float8 oz = Dot8(x.v, y.v, z.v, w.v, m.m02, m.m12, m.m22, m.m32);
+		Float8 ow = (NOUT == 4)?
+			Float8(Dot8(x.v, y.v, z.v, w.v, m.m03, m.m13, m.m23, m.m33)) : w;
+		Float8_Scatter<NOUT>(dst, dst_stride, ox, oy, oz, ow);
+		src += src_stride * 8;
+		dst += dst_stride * 8;
+	}
+#endif
+#if GFX_SIMD_SSE || GFX_SIMD_NEON
+	for (; i + 4 <= count; i += 4) {
+		Float4 x, y, z, w, ox, oy, oz, ow;
+		Float4_Gather<NIN>(src, src_stride, x, y, z, w);
+		ox = Dot4(x.v, y.v, z.v, w.v, m.m00, m.m10, m.m20, m.m30);
+		oy = Dot4(x.v, y.v, z.v, w.v, m.m01, m.m11, m.m21, m.m31);
+		oz = Dot4(x.v, y.v, z.v, w.v, m.m02, m.m12, m.m22, m.m32);
+		ow = (NOUT == 4)? Float4(Dot4(x.v, y.v, z.v, w.v,
+			m.m03, m.m13, m.m23, m.m33)) : w;
+		Float4_Scatter<NOUT>(dst, dst_stride, ox, oy, oz, ow);
+		src += src_stride * 4;
+		dst += dst_stride * 4;
+	}
+#endif
+	for (; i < count; i++) {
+		TransformOne<NIN, NOUT>(m, (float*)dst, (const float*)src);
+		src += src_stride;
+		dst += dst_stride;
+	}
+}
+
+
+//---------------------------------------------------------------------
+// Vector3 -> Vector3, (x, y, z, 1) * m with w dropped
+//---------------------------------------------------------------------
+void Matrix4Kernel<float>::TransformArray(const Matrix4& m, Vector3 *dst,
+		const Vector3 *src, size_t count, size_t dst_stride, size_t src_stride)
+{
+	TransformKernel<3, 3>(m, (uint8_t*)dst, dst_stride,
+			(const uint8_t*)src, src_stride, count);
+}
+
+
+//---------------------------------------------------------------------
+// Vector3 -> Vector4, (x, y, z, 1) * m homogeneous
+//---------------------------------------------------------------------
+void Matrix4Kernel<float>::TransformArray(const Matrix4& m, Vector4 *dst,
+		const Vector3 *src, size_t count, size_t dst_stride, size_t src_stride)
+{
+	TransformKernel<3, 4>(m, (uint8_t*)dst, dst_stride,
+			(const uint8_t*)src, src_stride, count);
+}
+
+
+//---------------------------------------------------------------------
+// Vector4 -> Vector4
+//---------------------------------------------------------------------
+void Matrix4Kernel<float>::TransformArray(const Matrix4& m, Vector4 *dst,
+		const Vector4 *src, size_t count, size_t dst_stride, size_t src_stride)
+{
+	TransformKernel<4, 4>(m, (uint8_t*)dst, dst_stride,
+			(const uint8_t*)src, src_stride, count);
+}
+
+
+//---------------------------------------------------------------------
+// Namespace End
+//---------------------------------------------------------------------
+NAMESPACE_END(Core);
+NAMESPACE_END(GFX);
+
+
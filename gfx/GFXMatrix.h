@@ -2,7 +2,7 @@
 //
 // GFXMatrix.h - 
 //
-// Last Modified: 2020/04/26 05:48:03
+// Last Modified: 2026/10/18 16:48:20
 //
 //=====================================================================
 #ifndef _GFX_MATRIX_H_
@@ -20,436 +20,901 @@ NAMESPACE_BEGIN(Core);
 
 
 //---------------------------------------------------------------------
-// Matrix2
+// Matrix<T, R, C> - row vector convention, v * m. T is float, double
+// or Half. the square 2x2, 3x3 and 4x4 specializations add the named
+// elements (m00 ..) and constructors, shared members live in MatrixOps.
+// 4x4 statics go through Matrix4Kernel, float has a SIMD kernel.
 //---------------------------------------------------------------------
-struct Matrix2
-{
-	union {
-		struct {
-			float m00, m01;
-			float m10, m11;
-		};
-		float m[2][2];
-	};
-	
-	inline Matrix2() {}
+template <class T, int R, int C> struct Matrix;
+template <class T> struct Matrix4Kernel;
+template <> struct Matrix4Kernel<float>;
 
-	inline Matrix2(const Matrix2& s) {
-		m00 = s.m00, m01 = s.m01;
-		m10 = s.m10, m11 = s.m11;
-	}
 
-	inline Matrix2(const float *m) {
-		m00 = m[0], m01 = m[1];
-		m10 = m[2], m11 = m[3];
-	}
+//---------------------------------------------------------------------
+// MatrixOps - shared members, D is the derived Matrix<T, R, C>
+//---------------------------------------------------------------------
+template <class D, class T, int R, int C>
+struct MatrixOps
+{
+	typedef T Type;
+	typedef typename ScalarTraits<T>::Scalar Scalar;
 
-	inline Matrix2& operator = (const Matrix2& s) {
-		m00 = s.m00, m01 = s.m01;
-		m10 = s.m10, m11 = s.m11;
-		return *this;
-	}
+	enum { ROWS = R, COLS = C };
 
-	inline Matrix2& Load(const float *m) {
-		m00 = m[0], m01 = m[1];
-		m10 = m[2], m11 = m[3];
-		return *this;
+	inline D& Self() { return *static_cast<D*>(this); }
+	inline const D& Self() const { return *static_cast<const D*>(this); }
+
+	inline D& Load(const T *p) {
+		for (int j = 0; j < R; j++) {
+			for (int i = 0; i < C; i++) Self().m[j][i] = p[j * C + i];
+		}
+		return Self();
 	}
 
-	inline Matrix2& SetZero() {
-		m00 = m01 = 0.0f;
-		m10 = m11 = 0.0f;
-		return *this;
+	inline D& SetZero() {
+		for (int j = 0; j < R; j++) {
+			for (int i = 0; i < C; i++) Self().m[j][i] = Scalar(0);
+		}
+		return Self();
 	}
 
-	inline Matrix2& SetIdentity() {
-		m00 = 1.0f, m01 = 0.0f;
-		m10 = 0.0f, m11 = 1.0f;
-		return *this;
+	inline D& SetIdentity() {
+		for (int j = 0; j < R; j++) {
+			for (int i = 0; i < C; i++) Self().m[j][i] = Scalar((i == j)? 1 : 0);
+		}
+		return Self();
 	}
 
-	inline Matrix2& operator += (const Matrix2& s) {
-		m00 += s.m00; m01 += s.m01;
-		m10 += s.m10; m11 += s.m11;
-		return *this;
+	inline D& operator += (const D& s) {
+		for (int j = 0; j < R; j++) {
+			for (int i = 0; i < C; i++) Self().m[j][i] = Self().m[j][i] + s.m[j][i];
+		}
+		return Self();
 	}
 
-	inline Matrix2& operator -= (const Matrix2& s) {
-		m00 -= s.m00; m01 -= s.m01;
-		m10 -= s.m10; m11 -= s.m11;
-		return *this;
+	inline D& operator -= (const D& s) {
+		for (int j = 0; j < R; j++) {
+			for (int i = 0; i < C; i++) Self().m[j][i] = Self().m[j][i] - s.m[j][i];
+		}
+		return Self();
 	}
 
-	inline Matrix2& operator *= (float k) {
-		m00 *= k; m01 *= k;
-		m10 *= k; m11 *= k;
-		return *this;
+	inline D& operator *= (Scalar k) {
+		for (int j = 0; j < R; j++) {
+			for (int i = 0; i < C; i++) Self().m[j][i] = Self().m[j][i] * k;
+		}
+		return Self();
 	}
 
-	inline Matrix2& operator /= (float k) {
-		m00 /= k; m01 /= k;
-		m10 /= k; m11 /= k;
-		return *this;
+	inline D& operator /= (Scalar k) {
+		for (int j = 0; j < R; j++) {
+			for (int i = 0; i < C; i++) Self().m[j][i] = Self().m[j][i] / k;
+		}
+		return Self();
 	}
 
-	inline Matrix2 operator + (const Matrix2& s) {
-		Matrix2 t(*this);
+	inline D operator + (const D& s) const {
+		D t(Self());
 		t += s;
 		return t;
 	}
 
-	inline Matrix2 operator - (const Matrix2& s) {
-		Matrix2 t(*this);
+	inline D operator - (const D& s) const {
+		D t(Self());
 		t -= s;
 		return t;
 	}
 
-	inline Matrix2 operator * (float k) {
-		Matrix2 t(*this);
+	inline D operator * (Scalar k) const {
+		D t(Self());
 		t *= k;
 		return t;
 	}
 
-	inline Matrix2 operator / (float k) {
-		Matrix2 t(*this);
+	inline D operator / (Scalar k) const {
+		D t(Self());
 		t /= k;
 		return t;
 	}
 
-	inline Matrix2 operator * (const Matrix2& s) const {
-		Matrix2 t;
-		for (int i = 0; i < 2; i++) {
-			for (int j = 0; j < 2; j++) {
-				t.m[j][i] = (m[j][0] * s.m[0][i]) +
-							(m[j][1] * s.m[1][i]);
+	template <int K>
+	inline Matrix<T, R, K> operator * (const Matrix<T, C, K>& s) const {
+		Matrix<T, R, K> t;
+		for (int j = 0; j < R; j++) {
+			for (int i = 0; i < K; i++) {
+				Scalar x = Scalar(Self().m[j][0]) * Scalar(s.m[0][i]);
+				for (int k = 1; k < C; k++) {
+					x += Scalar(Self().m[j][k]) * Scalar(s.m[k][i]);
+				}
+				t.m[j][i] = x;
 			}
 		}
 		return t;
 	}
 
-	inline Matrix2& operator *= (const Matrix2& s) {
-		Matrix2 t(*this);
-		this->operator=(t.operator*(s));
-		return *this;
+	inline D& operator *= (const D& s) {
+		D t = (*this) * s;
+		Self() = t;
+		return Self();
 	}
 
-	inline Vector2 Transform(const Vector2& v) const {
-		Vector2 t;
-		t.m[0] = v.m[0] * m00 + v.m[1] * m10;
-		t.m[1] = v.m[0] * m01 + v.m[1] * m11;
+	inline Vector<T, C> Transform(const Vector<T, R>& v) const {
+		Vector<T, C> t;
+		for (int i = 0; i < C; i++) {
+			Scalar x = Scalar(v.m[0]) * Scalar(Self().m[0][i]);
+			for (int k = 1; k < R; k++) {
+				x += Scalar(v.m[k]) * Scalar(Self().m[k][i]);
+			}
+			t.m[i] = x;
+		}
+		return t;
+	}
+
+	inline Matrix<T, C, R> Transpose() const {
+		Matrix<T, C, R> t;
+		for (int j = 0; j < R; j++) {
+			for (int i = 0; i < C; i++) t.m[i][j] = Self().m[j][i];
+		}
 		return t;
 	}
 };
 
 
 //---------------------------------------------------------------------
-// Matrix3
+// Matrix<T, R, C> - general size, elements only through m[][]
 //---------------------------------------------------------------------
-struct Matrix3
+template <class T, int R, int C>
+struct Matrix: public MatrixOps<Matrix<T, R, C>, T, R, C>
+{
+	T m[R][C];
+
+	inline Matrix() {}
+
+	inline Matrix(const T *p) {
+		this->Load(p);
+	}
+};
+
+
+//---------------------------------------------------------------------
+// Matrix<T, 2, 2>
+//---------------------------------------------------------------------
+template <class T>
+struct Matrix<T, 2, 2>: public MatrixOps<Matrix<T, 2, 2>, T, 2, 2>
 {
 	union {
 		struct {
-			float m00, m01, m02;
-			float m10, m11, m12;
-			float m20, m21, m22;
+			T m00, m01;
+			T m10, m11;
 		};
-		float m[3][3];
+		T m[2][2];
 	};
 
-	inline Matrix3() {}
+	inline Matrix() {}
 
-	inline Matrix3(const Matrix3& s) {
-		m00 = s.m00, m01 = s.m01, m02 = s.m02;
-		m10 = s.m10, m11 = s.m11, m12 = s.m12;
-		m20 = s.m20, m21 = s.m21, m22 = s.m22;
-	}
+	inline GFX_CONSTEXPR Matrix(T i00, T i01, T i10, T i11):
+		m00(i00), m01(i01), m10(i10), m11(i11) {}
 
-	inline Matrix3(const float *m) {
-		m00 = m[0], m01 = m[1], m02 = m[2];
-		m10 = m[3], m11 = m[4], m12 = m[5];
-		m20 = m[6], m21 = m[7], m22 = m[8];
+	inline Matrix(const T *p) {
+		this->Load(p);
 	}
+};
 
-	inline Matrix3& operator = (const Matrix3& s) {
-		m00 = s.m00, m01 = s.m01, m02 = s.m02;
-		m10 = s.m10, m11 = s.m11, m12 = s.m12;
-		m20 = s.m20, m21 = s.m21, m22 = s.m22;
-		return *this;
-	}
 
-	inline Matrix3& Load(const float *m) {
-		m00 = m[0], m01 = m[1], m02 = m[2];
-		m10 = m[3], m11 = m[4], m12 = m[5];
-		m20 = m[6], m21 = m[7], m22 = m[8];
-		return *this;
+//---------------------------------------------------------------------
+// Matrix<T, 3, 3>
+//---------------------------------------------------------------------
+template <class T>
+struct Matrix<T, 3, 3>: public MatrixOps<Matrix<T, 3, 3>, T, 3, 3>
+{
+	typedef MatrixOps<Matrix<T, 3, 3>, T, 3, 3> Base;
+	typedef typename ScalarTraits<T>::Scalar Scalar;
+
+	union {
+		struct {
+			T m00, m01, m02;
+			T m10, m11, m12;
+			T m20, m21, m22;
+		};
+		T m[3][3];
+	};
+
+	inline Matrix() {}
+
+	inline GFX_CONSTEXPR Matrix(T i00, T i01, T i02,
+			T i10, T i11, T i12,
+			T i20, T i21, T i22):
+		m00(i00), m01(i01), m02(i02),
+		m10(i10), m11(i11), m12(i12),
+		m20(i20), m21(i21), m22(i22) {}
+
+	inline Matrix(const T *p) {
+		this->Load(p);
 	}
 
-	inline Matrix3& SetZero() {
-		m00 = m01 = m02 = 0.0f;
-		m10 = m11 = m12 = 0.0f;
-		m20 = m21 = m22 = 0.0f;
-		return *this;
+	using Base::Transform;
+
+	// 2d affine: (v, 1) * m, the third column is ignored
+	inline Vector<T, 2> Transform(const Vector<T, 2>& v) const {
+		Vector<T, 2> t;
+		t.m[0] = Scalar(v.m[0]) * m00 + Scalar(v.m[1]) * m10 + m20;
+		t.m[1] = Scalar(v.m[0]) * m01 + Scalar(v.m[1]) * m11 + m21;
+		return t;
 	}
+};
 
-	inline Matrix3& SetIdentity() {
-		m00 = 1.0f, m01 = 0.0f, m02 = 0.0f;
-		m10 = 0.0f, m11 = 1.0f, m12 = 0.0f;
-		m20 = 0.0f, m21 = 0.0f, m22 = 1.0f;
-		return *this;
+
+//---------------------------------------------------------------------
+// Matrix<T, 4, 4>
+//---------------------------------------------------------------------
+template <class T>
+struct Matrix<T, 4, 4>: public MatrixOps<Matrix<T, 4, 4>, T, 4, 4>
+{
+	typedef typename ScalarTraits<T>::Scalar Scalar;
+	typedef Matrix4Kernel<T> Kernel;
+
+	union {
+		struct {
+			T m00, m01, m02, m03;
+			T m10, m11, m12, m13;
+			T m20, m21, m22, m23;
+			T m30, m31, m32, m33;
+		};
+		T m[4][4];
+	};
+
+	inline Matrix() {}
+
+	inline GFX_CONSTEXPR Matrix(T i00, T i01, T i02, T i03,
+			T i10, T i11, T i12, T i13,
+			T i20, T i21, T i22, T i23,
+			T i30, T i31, T i32, T i33):
+		m00(i00), m01(i01), m02(i02), m03(i03),
+		m10(i10), m11(i11), m12(i12), m13(i13),
+		m20(i20), m21(i21), m22(i22), m23(i23),
+		m30(i30), m31(i31), m32(i32), m33(i33) {}
+
+	inline Matrix(const T *p) {
+		this->Load(p);
 	}
 
-	inline Matrix3& operator += (const Matrix3& s) {
-		m00 += s.m00; m01 += s.m01; m02 += s.m02;
-		m10 += s.m10; m11 += s.m11; m12 += s.m12;
-		m20 += s.m20; m21 += s.m21; m22 += s.m22;
+	inline Matrix& operator += (const Matrix& s) {
+		Add(*this, *this, s);
 		return *this;
 	}
 
-	inline Matrix3& operator -= (const Matrix3& s) {
-		m00 -= s.m00; m01 -= s.m01; m02 -= s.m02;
-		m10 -= s.m10; m11 -= s.m11; m12 -= s.m12;
-		m20 -= s.m20; m21 -= s.m21; m22 -= s.m22;
+	inline Matrix& operator -= (const Matrix& s) {
+		Sub(*this, *this, s);
 		return *this;
 	}
 
-	inline Matrix3& operator *= (float k) {
-		m00 *= k; m01 *= k; m02 *= k;
-		m10 *= k; m11 *= k; m12 *= k;
-		m20 *= k; m21 *= k; m22 *= k;
+	inline Matrix& operator *= (Scalar k) {
+		Scale(*this, *this, k);
 		return *this;
 	}
 
-	inline Matrix3& operator /= (float k) {
-		m00 /= k; m01 /= k; m02 /= k;
-		m10 /= k; m11 /= k; m12 /= k;
-		m20 /= k; m21 /= k; m22 /= k;
+	inline Matrix& operator /= (Scalar k) {
+		Scale(*this, *this, Scalar(1) / k);
 		return *this;
 	}
 
-	inline Matrix3 operator + (const Matrix3& s) {
-		Matrix3 t(*this);
+	inline Matrix operator + (const Matrix& s) const {
+		Matrix t(*this);
 		t += s;
 		return t;
 	}
 
-	inline Matrix3 operator - (const Matrix3& s) {
-		Matrix3 t(*this);
+	inline Matrix operator - (const Matrix& s) const {
+		Matrix t(*this);
 		t -= s;
 		return t;
 	}
 
-	inline Matrix3 operator * (float k) {
-		Matrix3 t(*this);
+	inline Matrix operator * (Scalar k) const {
+		Matrix t(*this);
 		t *= k;
 		return t;
 	}
 
-	inline Matrix3 operator / (float k) {
-		Matrix3 t(*this);
+	inline Matrix operator / (Scalar k) const {
+		Matrix t(*this);
 		t /= k;
 		return t;
 	}
 
-	inline Matrix3 operator * (const Matrix3& s) const {
-		Matrix3 t;
-		for (int i = 0; i < 3; i++) {
-			for (int j = 0; j < 3; j++) {
-				t.m[j][i] = (m[j][0] * s.m[0][i]) +
-							(m[j][1] * s.m[1][i]) +
-							(m[j][2] * s.m[2][i]);
-			}
-		}
+	inline Matrix operator * (const Matrix& s) const {
+		Matrix t;
+		Multiply(t, *this, s);
 		return t;
 	}
 
-	inline Matrix3& operator *= (const Matrix3& s) {
-		Matrix3 t(*this);
-		this->operator=(t.operator*(s));
+	inline Matrix& operator *= (const Matrix& s) {
+		Matrix t;
+		Multiply(t, *this, s);
+		this->operator=(t);
 		return *this;
 	}
 
-	inline Vector3 Transform(const Vector3& v) const {
-		Vector3 t;
-		t.m[0] = v.m[0] * m00 + v.m[1] * m10 + v.m[2] * m20;
-		t.m[1] = v.m[0] * m01 + v.m[1] * m11 + v.m[2] * m21;
-		t.m[2] = v.m[0] * m02 + v.m[1] * m12 + v.m[2] * m22;
+	inline Vector<T, 4> Transform(const Vector<T, 4>& v) const {
+		Vector<T, 4> t;
+		Transform(t, *this, v);
 		return t;
 	}
 
-	inline Vector2 Transform(const Vector2& v) const {
-		Vector2 t;
-		t.m[0] = v.m[0] * m00 + v.m[1] * m10 + m20;
-		t.m[1] = v.m[0] * m01 + v.m[1] * m11 + m21;
+	inline Vector<T, 3> Transform(const Vector<T, 3>& v) const {
+		Vector<T, 3> t;
+		Transform(t, *this, v);
 		return t;
 	}
-};
 
+	// batch transform over strided arrays, strides are in bytes so the
+	// arrays can point into vertex structs (eg. &vertices[0].pos with
+	// sizeof(VertexSt)), dst may be the same array as src.
+	inline void TransformArray(Vector<T, 3> *dst, const Vector<T, 3> *src,
+			size_t count,
+			size_t dst_stride = sizeof(Vector<T, 3>),
+			size_t src_stride = sizeof(Vector<T, 3>)) const {
+		Kernel::TransformArray(*this, dst, src, count, dst_stride, src_stride);
+	}
 
-//---------------------------------------------------------------------
-// Matrix4
-//---------------------------------------------------------------------
-struct Matrix4
-{
-	union {
-		struct {
-			float m00, m01, m02, m03;
-			float m10, m11, m12, m13;
-			float m20, m21, m22, m23;
-			float m30, m31, m32, m33;
-		};
-		float m[4][4];
-	};
+	inline Matrix Transpose() const {
+		Matrix t;
+		Transpose(t, *this);
+		return t;
+	}
 
-	inline Matrix4() {}
+	inline Scalar Determinant() const {
+		return Determinant(*this);
+	}
 
-	inline Matrix4(const Matrix4& s) {
-		m00 = s.m00, m01 = s.m01, m02 = s.m02, m03 = s.m03;
-		m10 = s.m10, m11 = s.m11, m12 = s.m12, m13 = s.m13;
-		m20 = s.m20, m21 = s.m21, m22 = s.m22, m23 = s.m23;
-		m30 = s.m30, m31 = s.m31, m32 = s.m32, m33 = s.m33;
+	// general inverse, returns identity when the matrix is singular
+	inline Matrix Inverse() const {
+		Matrix t;
+		if (!Inverse(t, *this)) t.SetIdentity();
+		return t;
 	}
 
-	inline Matrix4(const float *m) {
-		m00 = m[ 0], m01 = m[ 1], m02 = m[ 2], m03 = m[ 3];
-		m10 = m[ 4], m11 = m[ 5], m12 = m[ 6], m13 = m[ 7];
-		m20 = m[ 8], m21 = m[ 9], m22 = m[10], m23 = m[11];
-		m30 = m[12], m31 = m[13], m32 = m[14], m33 = m[15];
+	// inverse of rotation/scale (even shear) with translation in row 3,
+	// the last column must be (0, 0, 0, 1)
+	inline Matrix InverseAffine() const {
+		Matrix t;
+		if (!InverseAffine(t, *this)) t.SetIdentity();
+		return t;
 	}
 
-	inline Matrix4& operator = (const Matrix4& s) {
-		m00 = s.m00, m01 = s.m01, m02 = s.m02, m03 = s.m03;
-		m10 = s.m10, m11 = s.m11, m12 = s.m12, m13 = s.m13;
-		m20 = s.m20, m21 = s.m21, m22 = s.m22, m23 = s.m23;
-		m30 = s.m30, m31 = s.m31, m32 = s.m32, m33 = s.m33;
-		return *this;
+	// homogeneous: (x, y, z, 1) * m keeping w
+	inline void TransformArray(Vector<T, 4> *dst, const Vector<T, 3> *src,
+			size_t count,
+			size_t dst_stride = sizeof(Vector<T, 4>),
+			size_t src_stride = sizeof(Vector<T, 3>)) const {
+		Kernel::TransformArray(*this, dst, src, count, dst_stride, src_stride);
 	}
 
-	inline Matrix4& Load(const float *m) {
-		m00 = m[ 0], m01 = m[ 1], m02 = m[ 2], m03 = m[ 3];
-		m10 = m[ 4], m11 = m[ 5], m12 = m[ 6], m13 = m[ 7];
-		m20 = m[ 8], m21 = m[ 9], m22 = m[10], m23 = m[11];
-		m30 = m[12], m31 = m[13], m32 = m[14], m33 = m[15];
-		return *this;
+	inline void TransformArray(Vector<T, 4> *dst, const Vector<T, 4> *src,
+			size_t count,
+			size_t dst_stride = sizeof(Vector<T, 4>),
+			size_t src_stride = sizeof(Vector<T, 4>)) const {
+		Kernel::TransformArray(*this, dst, src, count, dst_stride, src_stride);
 	}
 
-	inline Matrix4& SetZero() {
-		m00 = m01 = m02 = m03 = 0.0f;
-		m10 = m11 = m12 = m13 = 0.0f;
-		m20 = m21 = m22 = m23 = 0.0f;
-		m30 = m31 = m32 = m33 = 0.0f;
-		return *this;
+public:
+
+	// scalar reference: t = a * b, t must not alias a or b
+	static inline void MultiplyScalar(Matrix& t, const Matrix& a, const Matrix& b) {
+		for (int i = 0; i < 4; i++) {
+			for (int j = 0; j < 4; j++) {
+				t.m[j][i] = (Scalar(a.m[j][0]) * Scalar(b.m[0][i])) +
+							(Scalar(a.m[j][1]) * Scalar(b.m[1][i])) +
+							(Scalar(a.m[j][2]) * Scalar(b.m[2][i])) +
+							(Scalar(a.m[j][3]) * Scalar(b.m[3][i]));
+			}
+		}
 	}
 
-	inline Matrix4& SetIdentity() {
-		m00 = 1.0f, m01 = 0.0f, m02 = 0.0f, m03 = 0.0f;
-		m10 = 0.0f, m11 = 1.0f, m12 = 0.0f, m13 = 0.0f;
-		m20 = 0.0f, m21 = 0.0f, m22 = 1.0f, m23 = 0.0f;
-		m30 = 0.0f, m31 = 0.0f, m32 = 0.0f, m33 = 1.0f;
-		return *this;
+	// scalar reference: t = v * m
+	static inline void TransformScalar(Vector<T, 4>& t, const Matrix& m, const Vector<T, 4>& v) {
+		Scalar x = v.m[0], y = v.m[1], z = v.m[2], w = v.m[3];
+		t.m[0] = x * m.m00 + y * m.m10 + z * m.m20 + w * m.m30;
+		t.m[1] = x * m.m01 + y * m.m11 + z * m.m21 + w * m.m31;
+		t.m[2] = x * m.m02 + y * m.m12 + z * m.m22 + w * m.m32;
+		t.m[3] = x * m.m03 + y * m.m13 + z * m.m23 + w * m.m33;
 	}
 
-	inline Matrix4& operator += (const Matrix4& s) {
-		m00 += s.m00; m01 += s.m01; m02 += s.m02; m03 += s.m03;
-		m10 += s.m10; m11 += s.m11; m12 += s.m12; m13 += s.m13;
-		m20 += s.m20; m21 += s.m21; m22 += s.m22; m23 += s.m23;
-		m30 += s.m00; m31 += s.m31; m32 += s.m32; m33 += s.m33;
-		return *this;
+	// scalar reference: t = (v, 1) * m, w is dropped
+	static inline void TransformScalar(Vector<T, 3>& t, const Matrix& m, const Vector<T, 3>& v) {
+		Scalar x = v.m[0], y = v.m[1], z = v.m[2];
+		t.m[0] = x * m.m00 + y * m.m10 + z * m.m20 + m.m30;
+		t.m[1] = x * m.m01 + y * m.m11 + z * m.m21 + m.m31;
+		t.m[2] = x * m.m02 + y * m.m12 + z * m.m22 + m.m32;
 	}
 
-	inline Matrix4& operator -= (const Matrix4& s) {
-		m00 -= s.m00; m01 -= s.m01; m02 -= s.m02; m03 -= s.m03;
-		m10 -= s.m10; m11 -= s.m11; m12 -= s.m12; m13 -= s.m13;
-		m20 -= s.m20; m21 -= s.m21; m22 -= s.m22; m23 -= s.m23;
-		m30 -= s.m00; m31 -= s.m31; m32 -= s.m32; m33 -= s.m33;
-		return *this;
+	static inline void AddScalar(Matrix& t, const Matrix& a, const Matrix& b) {
+		for (int j = 0; j < 4; j++) {
+			for (int i = 0; i < 4; i++) t.m[j][i] = a.m[j][i] + b.m[j][i];
+		}
 	}
 
-	inline Matrix4& operator *= (float k) {
-		m00 *= k; m01 *= k; m02 *= k; m03 *= k;
-		m10 *= k; m11 *= k; m12 *= k; m13 *= k;
-		m20 *= k; m21 *= k; m22 *= k; m23 *= k;
-		m30 *= k; m31 *= k; m32 *= k; m33 *= k;
-		return *this;
+	static inline void SubScalar(Matrix& t, const Matrix& a, const Matrix& b) {
+		for (int j = 0; j < 4; j++) {
+			for (int i = 0; i < 4; i++) t.m[j][i] = a.m[j][i] - b.m[j][i];
+		}
 	}
 
-	inline Matrix4& operator /= (float k) {
-		m00 /= k; m01 /= k; m02 /= k; m03 /= k;
-		m10 /= k; m11 /= k; m12 /= k; m13 /= k;
-		m20 /= k; m21 /= k; m22 /= k; m23 /= k;
-		m30 /= k; m31 /= k; m32 /= k; m33 /= k;
-		return *this;
+	static inline void TransposeScalar(Matrix& t, const Matrix& a) {
+		Matrix c(a);
+		for (int j = 0; j < 4; j++) {
+			for (int i = 0; i < 4; i++) t.m[j][i] = c.m[i][j];
+		}
 	}
 
-	inline Matrix4 operator + (const Matrix4& s) {
-		Matrix4 t(*this);
-		t += s;
-		return t;
+	static inline void ScaleScalar(Matrix& t, const Matrix& a, Scalar k) {
+		for (int j = 0; j < 4; j++) {
+			for (int i = 0; i < 4; i++) t.m[j][i] = a.m[j][i] * k;
+		}
 	}
 
-	inline Matrix4 operator - (const Matrix4& s) {
-		Matrix4 t(*this);
-		t -= s;
-		return t;
+	// determinant by 2x2 sub-factors
+	static inline Scalar DeterminantScalar(const Matrix& a) {
+		Scalar s0 = a.m00 * a.m11 - a.m10 * a.m01;
+		Scalar s1 = a.m00 * a.m12 - a.m10 * a.m02;
+		Scalar s2 = a.m00 * a.m13 - a.m10 * a.m03;
+		Scalar s3 = a.m01 * a.m12 - a.m11 * a.m02;
+		Scalar s4 = a.m01 * a.m13 - a.m11 * a.m03;
+		Scalar s5 = a.m02 * a.m13 - a.m12 * a.m03;
+		Scalar c5 = a.m22 * a.m33 - a.m32 * a.m23;
+		Scalar c4 = a.m21 * a.m33 - a.m31 * a.m23;
+		Scalar c3 = a.m21 * a.m32 - a.m31 * a.m22;
+		Scalar c2 = a.m20 * a.m33 - a.m30 * a.m23;
+		Scalar c1 = a.m20 * a.m32 - a.m30 * a.m22;
+		Scalar c0 = a.m20 * a.m31 - a.m30 * a.m21;
+		return s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+	}
+
+	// inverse = adjugate / determinant, t may alias a
+	static inline bool InverseScalar(Matrix& t, const Matrix& a) {
+		Scalar s0 = a.m00 * a.m11 - a.m10 * a.m01;
+		Scalar s1 = a.m00 * a.m12 - a.m10 * a.m02;
+		Scalar s2 = a.m00 * a.m13 - a.m10 * a.m03;
+		Scalar s3 = a.m01 * a.m12 - a.m11 * a.m02;
+		Scalar s4 = a.m01 * a.m13 - a.m11 * a.m03;
+		Scalar s5 = a.m02 * a.m13 - a.m12 * a.m03;
+		Scalar c5 = a.m22 * a.m33 - a.m32 * a.m23;
+		Scalar c4 = a.m21 * a.m33 - a.m31 * a.m23;
+		Scalar c3 = a.m21 * a.m32 - a.m31 * a.m22;
+		Scalar c2 = a.m20 * a.m33 - a.m30 * a.m23;
+		Scalar c1 = a.m20 * a.m32 - a.m30 * a.m22;
+		Scalar c0 = a.m20 * a.m31 - a.m30 * a.m21;
+		Scalar det = s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+		if (det == Scalar(0)) {
+			return false;
+		}
+		Scalar k = Scalar(1) / det;
+		Matrix r;
+		r.m00 = ( a.m11 * c5 - a.m12 * c4 + a.m13 * c3) * k;
+		r.m01 = (-a.m01 * c5 + a.m02 * c4 - a.m03 * c3) * k;
+		r.m02 = ( a.m31 * s5 - a.m32 * s4 + a.m33 * s3) * k;
+		r.m03 = (-a.m21 * s5 + a.m22 * s4 - a.m23 * s3) * k;
+		r.m10 = (-a.m10 * c5 + a.m12 * c2 - a.m13 * c1) * k;
+		r.m11 = ( a.m00 * c5 - a.m02 * c2 + a.m03 * c1) * k;
+		r.m12 = (-a.m30 * s5 + a.m32 * s2 - a.m33 * s1) * k;
+		r.m13 = ( a.m20 * s5 - a.m22 * s2 + a.m23 * s1) * k;
+		r.m20 = ( a.m10 * c4 - a.m11 * c2 + a.m13 * c0) * k;
+		r.m21 = (-a.m00 * c4 + a.m01 * c2 - a.m03 * c0) * k;
+		r.m22 = ( a.m30 * s4 - a.m31 * s2 + a.m33 * s0) * k;
+		r.m23 = (-a.m20 * s4 + a.m21 * s2 - a.m23 * s0) * k;
+		r.m30 = (-a.m10 * c3 + a.m11 * c1 - a.m12 * c0) * k;
+		r.m31 = ( a.m00 * c3 - a.m01 * c1 + a.m02 * c0) * k;
+		r.m32 = (-a.m30 * s3 + a.m31 * s1 - a.m32 * s0) * k;
+		r.m33 = ( a.m20 * s3 - a.m21 * s1 + a.m22 * s0) * k;
+		t = r;
+		return true;
+	}
+
+	// affine inverse, the 3x3 part is inverted with cross products of
+	// its rows, translation becomes -t * inv(R)
+	static inline bool InverseAffineScalar(Matrix& t, const Matrix& a) {
+		Vector<T, 3> r0(a.m00, a.m01, a.m02);
+		Vector<T, 3> r1(a.m10, a.m11, a.m12);
+		Vector<T, 3> r2(a.m20, a.m21, a.m22);
+		Vector<T, 3> c0 = r1.Cross(r2);
+		Vector<T, 3> c1 = r2.Cross(r0);
+		Vector<T, 3> c2 = r0.Cross(r1);
+		Scalar det = r0.Dot(c0);
+		if (det == Scalar(0)) {
+			return false;
+		}
+		Scalar k = Scalar(1) / det;
+		c0 *= k, c1 *= k, c2 *= k;
+		Scalar tx = a.m30, ty = a.m31, tz = a.m32;
+		t.m00 = c0.x, t.m01 = c1.x, t.m02 = c2.x, t.m03 = Scalar(0);
+		t.m10 = c0.y, t.m11 = c1.y, t.m12 = c2.y, t.m13 = Scalar(0);
+		t.m20 = c0.z, t.m21 = c1.z, t.m22 = c2.z, t.m23 = Scalar(0);
+		t.m30 = -(tx * c0.x + ty * c0.y + tz * c0.z);
+		t.m31 = -(tx * c1.x + ty * c1.y + tz * c1.z);
+		t.m32 = -(tx * c2.x + ty * c2.y + tz * c2.z);
+		t.m33 = Scalar(1);
+		return true;
 	}
 
-	inline Matrix4 operator * (float k) {
-		Matrix4 t(*this);
-		t *= k;
-		return t;
+public:
+
+	// t = a * b, t may alias a or b
+	static inline void Multiply(Matrix& t, const Matrix& a, const Matrix& b) {
+		Kernel::Multiply(t, a, b);
 	}
 
-	inline Matrix4 operator / (float k) {
-		Matrix4 t(*this);
-		t /= k;
-		return t;
+	// t = v * m
+	static inline void Transform(Vector<T, 4>& t, const Matrix& m, const Vector<T, 4>& v) {
+		Kernel::Transform(t, m, v);
 	}
 
-	inline Matrix4 operator * (const Matrix4& s) const {
-		Matrix4 t;
-		for (int i = 0; i < 4; i++) {
-			for (int j = 0; j < 4; j++) {
-				t.m[j][i] = (m[j][0] * s.m[0][i]) +
-							(m[j][1] * s.m[1][i]) +
-							(m[j][2] * s.m[2][i]) +
-							(m[j][3] * s.m[3][i]);
-			}
+	// t = (v, 1) * m
+	static inline void Transform(Vector<T, 3>& t, const Matrix& m, const Vector<T, 3>& v) {
+		Kernel::Transform(t, m, v);
+	}
+
+	// t may alias a
+	static inline void Transpose(Matrix& t, const Matrix& a) {
+		Kernel::Transpose(t, a);
+	}
+
+	static inline Scalar Determinant(const Matrix& a) {
+		return Kernel::Determinant(a);
+	}
+
+	// Inverse / InverseAffine return false (and leave t untouched)
+	// when a is singular, t may alias a
+	static inline bool Inverse(Matrix& t, const Matrix& a) {
+		return Kernel::Inverse(t, a);
+	}
+
+	static inline bool InverseAffine(Matrix& t, const Matrix& a) {
+		return Kernel::InverseAffine(t, a);
+	}
+
+	static inline void Add(Matrix& t, const Matrix& a, const Matrix& b) {
+		Kernel::Add(t, a, b);
+	}
+
+	static inline void Sub(Matrix& t, const Matrix& a, const Matrix& b) {
+		Kernel::Sub(t, a, b);
+	}
+
+	static inline void Scale(Matrix& t, const Matrix& a, Scalar k) {
+		Kernel::Scale(t, a, k);
+	}
+};
+
+
+//---------------------------------------------------------------------
+// Matrix4Kernel - scalar 4x4 statics for any element type
+//---------------------------------------------------------------------
+template <class T>
+struct Matrix4Kernel
+{
+	typedef Matrix<T, 4, 4> M;
+	typedef typename ScalarTraits<T>::Scalar Scalar;
+
+	static inline void Multiply(M& t, const M& a, const M& b) {
+		if (&t == &a || &t == &b) {
+			M c;
+			M::MultiplyScalar(c, a, b);
+			t = c;
+		}
+		else {
+			M::MultiplyScalar(t, a, b);
 		}
-		return t;
 	}
 
-	inline Matrix4& operator *= (const Matrix4& s) {
-		Matrix4 t(*this);
-		this->operator=(t.operator*(s));
-		return *this;
+	static inline void Transform(Vector<T, 4>& t, const M& m, const Vector<T, 4>& v) {
+		M::TransformScalar(t, m, v);
 	}
 
-	inline Vector4 Transform(const Vector4& v) const {
-		Vector4 t;
-		t.m[0] = v.m[0] * m00 + v.m[1] * m10 + v.m[2] * m20 + v.m[3] * m30;
-		t.m[1] = v.m[0] * m01 + v.m[1] * m11 + v.m[2] * m21 + v.m[3] * m31;
-		t.m[2] = v.m[0] * m02 + v.m[1] * m12 + v.m[2] * m22 + v.m[3] * m32;
-		t.m[3] = v.m[0] * m03 + v.m[1] * m13 + v.m[2] * m23 + v.m[3] * m33;
-		return t;
+	static inline void Transform(Vector<T, 3>& t, const M& m, const Vector<T, 3>& v) {
+		M::TransformScalar(t, m, v);
 	}
 
-	inline Vector3 Transform(const Vector3& v) const {
-		Vector3 t;
-		t.m[0] = v.m[0] * m00 + v.m[1] * m10 + v.m[2] * m20 + m30;
-		t.m[1] = v.m[0] * m01 + v.m[1] * m11 + v.m[2] * m21 + m31;
-		t.m[2] = v.m[0] * m02 + v.m[1] * m12 + v.m[2] * m22 + m32;
-		return t;
+	static inline void Transpose(M& t, const M& a) { M::TransposeScalar(t, a); }
+	static inline Scalar Determinant(const M& a) { return M::DeterminantScalar(a); }
+	static inline bool Inverse(M& t, const M& a) { return M::InverseScalar(t, a); }
+	static inline bool InverseAffine(M& t, const M& a) { return M::InverseAffineScalar(t, a); }
+	static inline void Add(M& t, const M& a, const M& b) { M::AddScalar(t, a, b); }
+	static inline void Sub(M& t, const M& a, const M& b) { M::SubScalar(t, a, b); }
+	static inline void Scale(M& t, const M& a, Scalar k) { M::ScaleScalar(t, a, k); }
+
+	// each source vector is copied before its result is stored
+	static void TransformArray(const M& m, Vector<T, 3> *dst,
+			const Vector<T, 3> *src, size_t count,
+			size_t dst_stride, size_t src_stride) {
+		const char *s = (const char*)src;
+		char *d = (char*)dst;
+		for (size_t i = 0; i < count; i++, s += src_stride, d += dst_stride) {
+			Vector<T, 3> v = *(const Vector<T, 3>*)s;
+			M::TransformScalar(*(Vector<T, 3>*)d, m, v);
+		}
+	}
+
+	static void TransformArray(const M& m, Vector<T, 4> *dst,
+			const Vector<T, 3> *src, size_t count,
+			size_t dst_stride, size_t src_stride) {
+		const char *s = (const char*)src;
+		char *d = (char*)dst;
+		for (size_t i = 0; i < count; i++, s += src_stride, d += dst_stride) {
+			const Vector<T, 3>& p = *(const Vector<T, 3>*)s;
+			Vector<T, 4> v;
+			v.x = p.x, v.y = p.y, v.z = p.z, v.w = Scalar(1);
+			M::TransformScalar(*(Vector<T, 4>*)d, m, v);
+		}
+	}
+
+	static void TransformArray(const M& m, Vector<T, 4> *dst,
+			const Vector<T, 4> *src, size_t count,
+			size_t dst_stride, size_t src_stride) {
+		const char *s = (const char*)src;
+		char *d = (char*)dst;
+		for (size_t i = 0; i < count; i++, s += src_stride, d += dst_stride) {
+			Vector<T, 4> v = *(const Vector<T, 4>*)s;
+			M::TransformScalar(*(Vector<T, 4>*)d, m, v);
+		}
+	}
+};
+
+
+//---------------------------------------------------------------------
+// Matrix4Kernel<float> - SSE/AVX/NEON, falls back to the scalar
+// references of Matrix<float, 4, 4> without SIMD
+//---------------------------------------------------------------------
+template <>
+struct Matrix4Kernel<float>
+{
+	typedef Matrix<float, 4, 4> M;
+
+	// t = a * b, t may alias a or b: every row of b and the current
+	// row of a are loaded before the row of t is written.
+	static inline void Multiply(M& t, const M& a, const M& b) {
+#if GFX_SIMD_AVX
+		__m256 b0 = _mm256_broadcast_ps((const __m128*)b.m[0]);
+		__m256 b1 = _mm256_broadcast_ps((const __m128*)b.m[1]);
+		__m256 b2 = _mm256_broadcast_ps((const __m128*)b.m[2]);
+		__m256 b3 = _mm256_broadcast_ps((const __m128*)b.m[3]);
+		for (int j = 0; j < 4; j += 2) {
+			__m256 r = _mm256_loadu_ps(a.m[j]);
+			__m256 x = _mm256_shuffle_ps(r, r, 0x00);
+			__m256 y = _mm256_shuffle_ps(r, r, 0x55);
+			__m256 z = _mm256_shuffle_ps(r, r, 0xaa);
+			__m256 w = _mm256_shuffle_ps(r, r, 0xff);
+	#if GFX_SIMD_FMA
+			__m256 u = _mm256_fmadd_ps(x, b0, _mm256_mul_ps(y, b1));
+			__m256 v = _mm256_fmadd_ps(z, b2, _mm256_mul_ps(w, b3));
+	#else
+			__m256 u = _mm256_add_ps(_mm256_mul_ps(x, b0), _mm256_mul_ps(y, b1));
+			__m256 v = _mm256_add_ps(_mm256_mul_ps(z, b2), _mm256_mul_ps(w, b3));
+	#endif
+			_mm256_storeu_ps(t.m[j], _mm256_add_ps(u, v));
+		}
+#elif GFX_SIMD_SSE
+		__m128 b0 = _mm_loadu_ps(b.m[0]);
+		__m128 b1 = _mm_loadu_ps(b.m[1]);
+		__m128 b2 = _mm_loadu_ps(b.m[2]);
+		__m128 b3 = _mm_loadu_ps(b.m[3]);
+		for (int j = 0; j < 4; j++) {
+			__m128 r = _mm_loadu_ps(a.m[j]);
+			__m128 u = _mm_add_ps(
+				_mm_mul_ps(_mm_shuffle_ps(r, r, 0x00), b0),
+				_mm_mul_ps(_mm_shuffle_ps(r, r, 0x55), b1));
+			__m128 v = _mm_add_ps(
+				_mm_mul_ps(_mm_shuffle_ps(r, r, 0xaa), b2),
+				_mm_mul_ps(_mm_shuffle_ps(r, r, 0xff), b3));
+			_mm_storeu_ps(t.m[j], _mm_add_ps(u, v));
+		}
+#elif GFX_SIMD_NEON
+		float32x4_t b0 = vld1q_f32(b.m[0]);
+		float32x4_t b1 = vld1q_f32(b.m[1]);
+		float32x4_t b2 = vld1q_f32(b.m[2]);
+		float32x4_t b3 = vld1q_f32(b.m[3]);
+		for (int j = 0; j < 4; j++) {
+			float32x4_t r = vld1q_f32(a.m[j]);
+			float32x4_t u = vmulq_n_f32(b0, vgetq_lane_f32(r, 0));
+			u = vmlaq_n_f32(u, b1, vgetq_lane_f32(r, 1));
+			u = vmlaq_n_f32(u, b2, vgetq_lane_f32(r, 2));
+			u = vmlaq_n_f32(u, b3, vgetq_lane_f32(r, 3));
+			vst1q_f32(t.m[j], u);
+		}
+#else
+		if (&t == &a || &t == &b) {
+			M c;
+			M::MultiplyScalar(c, a, b);
+			t = c;
+		}
+		else {
+			M::MultiplyScalar(t, a, b);
+		}
+#endif
+	}
+
+	// t = v * m
+	static inline void Transform(Vector4& t, const M& m, const Vector4& v) {
+#if GFX_SIMD_SSE
+		__m128 r = _mm_loadu_ps(v.m);
+		__m128 u = _mm_add_ps(
+			_mm_mul_ps(_mm_shuffle_ps(r, r, 0x00), _mm_loadu_ps(m.m[0])),
+			_mm_mul_ps(_mm_shuffle_ps(r, r, 0x55), _mm_loadu_ps(m.m[1])));
+		__m128 w = _mm_add_ps(
+			_mm_mul_ps(_mm_shuffle_ps(r, r, 0xaa), _mm_loadu_ps(m.m[2])),
+			_mm_mul_ps(_mm_shuffle_ps(r, r, 0xff), _mm_loadu_ps(m.m[3])));
+		_mm_storeu_ps(t.m, _mm_add_ps(u, w));
+#elif GFX_SIMD_NEON
+		float32x4_t r = vld1q_f32(v.m);
+		float32x4_t u = vmulq_n_f32(vld1q_f32(m.m[0]), vgetq_lane_f32(r, 0));
+		u = vmlaq_n_f32(u, vld1q_f32(m.m[1]), vgetq_lane_f32(r, 1));
+		u = vmlaq_n_f32(u, vld1q_f32(m.m[2]), vgetq_lane_f32(r, 2));
+		u = vmlaq_n_f32(u, vld1q_f32(m.m[3]), vgetq_lane_f32(r, 3));
+		vst1q_f32(t.m, u);
+#else
+		M::TransformScalar(t, m, v);
+#endif
+	}
+
+	// t = (v, 1) * m, Vector3 is only 12 bytes so never load 16 from it
+	static inline void Transform(Vector3& t, const M& m, const Vector3& v) {
+#if GFX_SIMD_SSE
+		__m128 u = _mm_add_ps(
+			_mm_mul_ps(_mm_set1_ps(v.m[0]), _mm_loadu_ps(m.m[0])),
+			_mm_mul_ps(_mm_set1_ps(v.m[1]), _mm_loadu_ps(m.m[1])));
+		__m128 w = _mm_add_ps(
+			_mm_mul_ps(_mm_set1_ps(v.m[2]), _mm_loadu_ps(m.m[2])),
+			_mm_loadu_ps(m.m[3]));
+		u = _mm_add_ps(u, w);
+		_mm_storel_pi((__m64*)t.m, u);
+		_mm_store_ss(t.m + 2, _mm_movehl_ps(u, u));
+#elif GFX_SIMD_NEON
+		float32x4_t u = vmlaq_n_f32(vld1q_f32(m.m[3]), vld1q_f32(m.m[0]), v.m[0]);
+		u = vmlaq_n_f32(u, vld1q_f32(m.m[1]), v.m[1]);
+		u = vmlaq_n_f32(u, vld1q_f32(m.m[2]), v.m[2]);
+		vst1_f32(t.m, vget_low_f32(u));
+		vst1q_lane_f32(t.m + 2, u, 2);
+#else
+		M::TransformScalar(t, m, v);
+#endif
+	}
+
+	// t may alias a
+	static inline void Transpose(M& t, const M& a) {
+#if GFX_SIMD_SSE
+		__m128 r0 = _mm_loadu_ps(a.m[0]);
+		__m128 r1 = _mm_loadu_ps(a.m[1]);
+		__m128 r2 = _mm_loadu_ps(a.m[2]);
+		__m128 r3 = _mm_loadu_ps(a.m[3]);
+		_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+		_mm_storeu_ps(t.m[0], r0);
+		_mm_storeu_ps(t.m[1], r1);
+		_mm_storeu_ps(t.m[2], r2);
+		_mm_storeu_ps(t.m[3], r3);
+#elif GFX_SIMD_NEON
+		float32x4x4_t r = vld4q_f32(a.m[0]);
+		vst1q_f32(t.m[0], r.val[0]);
+		vst1q_f32(t.m[1], r.val[1]);
+		vst1q_f32(t.m[2], r.val[2]);
+		vst1q_f32(t.m[3], r.val[3]);
+#else
+		M::TransposeScalar(t, a);
+#endif
+	}
+
+	// implemented in GFXMatrix.cpp, SSE uses the 2x2 block method
+	static float Determinant(const M& a);
+	static bool Inverse(M& t, const M& a);
+	static bool InverseAffine(M& t, const M& a);
+
+	static void TransformArray(const M& m, Vector3 *dst, const Vector3 *src,
+			size_t count, size_t dst_stride, size_t src_stride);
+	static void TransformArray(const M& m, Vector4 *dst, const Vector3 *src,
+			size_t count, size_t dst_stride, size_t src_stride);
+	static void TransformArray(const M& m, Vector4 *dst, const Vector4 *src,
+			size_t count, size_t dst_stride, size_t src_stride);
+
+	static inline void Add(M& t, const M& a, const M& b) {
+#if GFX_SIMD_AVX
+		for (int i = 0; i < 16; i += 8) {
+			__m256 x = _mm256_loadu_ps(a.m[0] + i);
+			__m256 y = _mm256_loadu_ps(b.m[0] + i);
+			_mm256_storeu_ps(t.m[0] + i, _mm256_add_ps(x, y));
+		}
+#elif GFX_SIMD_SSE
+		for (int i = 0; i < 16; i += 4) {
+			__m128 x = _mm_loadu_ps(a.m[0] + i);
+			__m128 y = _mm_loadu_ps(b.m[0] + i);
+			_mm_storeu_ps(t.m[0] + i, _mm_add_ps(x, y));
+		}
+#elif GFX_SIMD_NEON
+		for (int i = 0; i < 16; i += 4) {
+			float32x4_t x = vld1q_f32(a.m[0] + i);
+			float32x4_t y = vld1q_f32(b.m[0] + i);
+			vst1q_f32(t.m[0] + i, vaddq_f32(x, y));
+		}
+#else
+		M::AddScalar(t, a, b);
+#endif
+	}
+
+	static inline void Sub(M& t, const M& a, const M& b) {
+#if GFX_SIMD_AVX
+		for (int i = 0; i < 16; i += 8) {
+			__m256 x = _mm256_loadu_ps(a.m[0] + i);
+			__m256 y = _mm256_loadu_ps(b.m[0] + i);
+			_mm256_storeu_ps(t.m[0] + i, _mm256_sub_ps(x, y));
+		}
+#elif GFX_SIMD_SSE
+		for (int i = 0; i < 16; i += 4) {
+			__m128 x = _mm_loadu_ps(a.m[0] + i);
+			__m128 y = _mm_loadu_ps(b.m[0] + i);
+			_mm_storeu_ps(t.m[0] + i, _mm_sub_ps(x, y));
+		}
+#elif GFX_SIMD_NEON
+		for (int i = 0; i < 16; i += 4) {
+			float32x4_t x = vld1q_f32(a.m[0] + i);
+			float32x4_t y = vld1q_f32(b.m[0] + i);
+			vst1q_f32(t.m[0] + i, vsubq_f32(x, y));
+		}
+#else
+		M::SubScalar(t, a, b);
+#endif
+	}
+
+	static inline void Scale(M& t, const M& a, float k) {
+#if GFX_SIMD_AVX
+		__m256 s = _mm256_set1_ps(k);
+		for (int i = 0; i < 16; i += 8) {
+			__m256 x = _mm256_loadu_ps(a.m[0] + i);
+			_mm256_storeu_ps(t.m[0] + i, _mm256_mul_ps(x, s));
+		}
+#elif GFX_SIMD_SSE
+		__m128 s = _mm_set1_ps(k);
+		for (int i = 0; i < 16; i += 4) {
+			__m128 x = _mm_loadu_ps(a.m[0] + i);
+			_mm_storeu_ps(t.m[0] + i, _mm_mul_ps(x, s));
+		}
+#elif GFX_SIMD_NEON
+		for (int i = 0; i < 16; i += 4) {
+			float32x4_t x = vld1q_f32(a.m[0] + i);
+			vst1q_f32(t.m[0] + i, vmulq_n_f32(x, k));
+		}
+#else
+		M::ScaleScalar(t, a, k);
+#endif
 	}
 };
 
 
+//---------------------------------------------------------------------
+// names
+//---------------------------------------------------------------------
+typedef Matrix<float, 2, 2> Matrix2;
+typedef Matrix<float, 3, 3> Matrix3;
+typedef Matrix<float, 4, 4> Matrix4;
+
+typedef Matrix<double, 2, 2> Matrix2d;
+typedef Matrix<double, 3, 3> Matrix3d;
+typedef Matrix<double, 4, 4> Matrix4d;
+
+
 //---------------------------------------------------------------------
 // operators
 //---------------------------------------------------------------------
-inline Vector4 operator * (const Vector4& v, const Matrix4& m) { return m.Transform(v); }
-inline Vector3 operator * (const Vector3& v, const Matrix4& m) { return m.Transform(v); }
-inline Vector3 operator * (const Vector3& v, const Matrix3& m) { return m.Transform(v); }
-inline Vector2 operator * (const Vector2& v, const Matrix3& m) { return m.Transform(v); }
-inline Vector2 operator * (const Vector2& v, const Matrix2& m) { return m.Transform(v); }
+template <class T, int R, int C>
+inline Vector<T, C> operator * (const Vector<T, R>& v, const Matrix<T, R, C>& m) {
+	return m.Transform(v);
+}
+
+template <class T>
+inline Vector<T, 3> operator * (const Vector<T, 3>& v, const Matrix<T, 4, 4>& m) {
+	return m.Transform(v);
+}
+
+template <class T>
+inline Vector<T, 2> operator * (const Vector<T, 2>& v, const Matrix<T, 3, 3>& m) {
+	return m.Transform(v);
+}
 
 
 //---------------------------------------------------------------------
@@ -0,0 +1,612 @@
+//=====================================================================
+//
+// GFXMipmap.cpp - mipmap chain generation
+//
+// Last Modified: 2026/10/18 21:05:12
+//
+//=====================================================================
+#include <stddef.h>
+#include <string.h>
+#include <math.h>
+
+#include <vector>
+
+#include "GFXMipmap.h"
+#include "GFXPixel.h"
+#include "GFXUtil.h"
+
+
+//---------------------------------------------------------------------
+// Namespace Begin
+//---------------------------------------------------------------------
+NAMESPACE_BEGIN(GFX);
+
+
+// rows per band are chosen so a band is at least this many pixels
+#define MIPMAP_GRAIN		16384
+
+// bisection steps of the coverage search
+#define MIPMAP_COVERAGE_STEPS	16
+
+
+//---------------------------------------------------------------------
+// filter kernels, x in pixels of the destination level
+//---------------------------------------------------------------------
+static double MipmapSinc(double x)
+{
+	if (x == 0.0) return 1.0;
+	x *= 3.14159265358979323846;
+	return sin(x) / x;
+}
+
+static double MipmapBessel0(double x)
+{
+	double sum = 1.0, term = 1.0, half = x * 0.5;
+	for (int k = 1; k < 32; k++) {
+		term *= (half / k) * (half / k);
+		sum += term;
+		if (term < sum * 1e-12) break;
+	}
+	return sum;
+}
+
+static double MipmapRadius(MipmapFilter filter)
+{
+	return (filter == MIPMAP_BOX)? 0.5 : 3.0;
+}
+
+static double MipmapKernel(MipmapFilter filter, double x)
+{
+	if (x < 0.0) x = -x;
+	if (x >= 3.0) return 0.0;
+	if (filter == MIPMAP_KAISER) {
+		double t = x / 3.0;
+		return MipmapSinc(x) * MipmapBessel0(4.0 * sqrt(1.0 - t * t)) / MipmapBessel0(4.0);
+	}
+	return MipmapSinc(x) * MipmapSinc(x / 3.0);
+}
+
+
+//---------------------------------------------------------------------
+// MipmapTable - output i reads source [start[i], start[i] + taps) with
+// weights[i * taps + k]. taps is the same for every output and start
+// is moved back near the end, so every tap is inside the source and
+// unused taps just weigh 0
+//---------------------------------------------------------------------
+struct MipmapTable
+{
+	int taps;
+	std::vector<int> start;
+	std::vector<float> weights;
+};
+
+static void MipmapTable_Init(MipmapTable& table, int src_size, int dst_size,
+		MipmapFilter filter)
+{
+	double scale = (double)src_size / (double)dst_size;
+	double radius = MipmapRadius(filter) * scale;
+	int taps = (int)ceil(radius * 2.0) + 2;
+	if (taps > src_size) taps = src_size;
+	table.taps = taps;
+	table.start.resize(dst_size);
+	table.weights.assign((size_t)dst_size * taps, 0.0f);
+	std::vector<double> w(taps + 2);
+	for (int i = 0; i < dst_size; i++) {
+		double center = (i + 0.5) * scale;
+		int left = (int)floor(center - radius);
+		int right = (int)ceil(center + radius);
+		if (left < 0) left = 0;
+		if (right > src_size) right = src_size;
+		if (right - left > taps) right = left + taps;
+		double sum = 0.0;
+		for (int k = left; k < right; k++) {
+			double x;
+			if (filter == MIPMAP_BOX) {
+				// overlap of [k, k + 1) with [i, i + 1) * scale
+				double a = (k > i * scale)? k : (i * scale);
+				double b = (k + 1 < (i + 1) * scale)? (k + 1) : ((i + 1) * scale);
+				x = (b > a)? (b - a) : 0.0;
+			}
+			else {
+				x = MipmapKernel(filter, (k + 0.5 - center) / scale);
+			}
+			w[k - left] = x;
+			sum += x;
+		}
+		int start = (left + taps > src_size)? (src_size - taps) : left;
+		float *out = &table.weights[(size_t)i * taps];
+		table.start[i] = start;
+		for (int k = left; k < right; k++) {
+			out[k - start] = (float)(w[k - left] / sum);
+		}
+	}
+}
+
+
+//---------------------------------------------------------------------
+// sRGB tables: 8 bit to linear float, and linear quantized to 16 bits
+// back to 8 bit sRGB. built once on first use
+//---------------------------------------------------------------------
+struct MipmapGamma
+{
+	float linear[256];
+	float decode[256];
+	uint8_t encode[65536];
+
+	MipmapGamma() {
+		for (int i = 0; i < 256; i++) {
+			double c = i / 255.0;
+			linear[i] = (float)c;
+			c = (c <= 0.04045)? (c / 12.92) : pow((c + 0.055) / 1.055, 2.4);
+			decode[i] = (float)c;
+		}
+		for (int i = 0; i < 65536; i++) {
+			double v = i / 65535.0;
+			v = (v <= 0.0031308)? (v * 12.92) : (1.055 * pow(v, 1.0 / 2.4) - 0.055);
+			encode[i] = (uint8_t)(int)(v * 255.0 + 0.5);
+		}
+	}
+};
+
+static const MipmapGamma& MipmapGamma_Get()
+{
+	static const MipmapGamma gamma;
+	return gamma;
+}
+
+
+//---------------------------------------------------------------------
+// kernels on rows of float b, g, r, a: horizontal filters count
+// pixels, vertical combines taps rows of count floats, encode turns
+// count pixels into A8R8G8B8 (srgb table or NULL for linear, alpha
+// multiplied by alpha_scale). every set adds the products in the same
+// order so the results are identical
+//---------------------------------------------------------------------
+typedef void (*MipmapRowProc)(float *dst, const float *src, int count,
+		const MipmapTable& table);
+typedef void (*MipmapColumnProc)(float *dst, const float *const *rows,
+		const float *weights, int taps, int count);
+typedef void (*MipmapEncodeProc)(uint32_t *dst, const float *src, int count,
+		const uint8_t *srgb, float alpha_scale);
+
+struct MipmapKernels
+{
+	MipmapRowProc horizontal;
+	MipmapColumnProc vertical;
+	MipmapEncodeProc encode;
+};
+
+static void MipmapHorizontal_C(float *dst, const float *src, int count,
+		const MipmapTable& table)
+{
+	int taps = table.taps;
+	for (int i = 0; i < count; i++, dst += 4) {
+		const float *p = src + table.start[i] * 4;
+		const float *w = &table.weights[(size_t)i * taps];
+		float b = 0.0f, g = 0.0f, r = 0.0f, a = 0.0f;
+		for (int k = 0; k < taps; k++, p += 4) {
+			b += w[k] * p[0];
+			g += w[k] * p[1];
+			r += w[k] * p[2];
+			a += w[k] * p[3];
+		}
+		dst[0] = b;
+		dst[1] = g;
+		dst[2] = r;
+		dst[3] = a;
+	}
+}
+
+static void MipmapVertical_C(float *dst, const float *const *rows,
+		const float *weights, int taps, int count)
+{
+	for (int i = 0; i < count; i++) {
+		float x = 0.0f;
+		for (int k = 0; k < taps; k++) x += weights[k] * rows[k][i];
+		dst[i] = x;
+	}
+}
+
+static inline int MipmapQuantize(float x, float scale)
+{
+	x = (x < 1.0f)? ((x > 0.0f)? x : 0.0f) : 1.0f;
+	return (int)(x * scale + 0.5f);
+}
+
+static void MipmapEncode_C(uint32_t *dst, const float *src, int count,
+		const uint8_t *srgb, float alpha_scale)
+{
+	for (int i = 0; i < count; i++, src += 4) {
+		uint32_t c = (uint32_t)MipmapQuantize(src[3] * alpha_scale, 255.0f) << 24;
+		for (int k = 0; k < 3; k++) {
+			uint32_t x = (srgb)? srgb[MipmapQuantize(src[k], 65535.0f)] :
+				(uint32_t)MipmapQuantize(src[k], 255.0f);
+			c |= x << (k * 8);
+		}
+		dst[i] = c;
+	}
+}
+
+static const MipmapKernels MipmapKernel_Generic = {
+	MipmapHorizontal_C, MipmapVertical_C, MipmapEncode_C };
+
+
+#if GFX_PIXEL_X86
+
+//---------------------------------------------------------------------
+// SSE2: one pixel per register in the horizontal pass, four floats per
+// step in the vertical one
+//---------------------------------------------------------------------
+static GFX_PIXEL_SSE2 void MipmapHorizontal_SSE2(float *dst, const float *src,
+		int count, const MipmapTable& table)
+{
+	int taps = table.taps;
+	for (int i = 0; i < count; i++) {
+		const float *p = src + table.start[i] * 4;
+		const float *w = &table.weights[(size_t)i * taps];
+		__m128 acc = _mm_setzero_ps();
+		for (int k = 0; k < taps; k++) {
+			acc = _mm_add_ps(acc, _mm_mul_ps(_mm_set1_ps(w[k]), _mm_loadu_ps(p + k * 4)));
+		}
+		_mm_storeu_ps(dst + i * 4, acc);
+	}
+}
+
+static GFX_PIXEL_SSE2 void MipmapVertical_SSE2(float *dst, const float *const *rows,
+		const float *weights, int taps, int count)
+{
+	int i = 0;
+	for (; i + 4 <= count; i += 4) {
+		__m128 acc = _mm_setzero_ps();
+		for (int k = 0; k < taps; k++) {
+			acc = _mm_add_ps(acc, _mm_mul_ps(_mm_set1_ps(weights[k]),
+					_mm_loadu_ps(rows[k] + i)));
+		}
+		_mm_storeu_ps(dst + i, acc);
+	}
+	for (; i < count; i++) {
+		float x = 0.0f;
+		for (int k = 0; k < taps; k++) x += weights[k] * rows[k][i];
+		dst[i] = x;
+	}
+}
+
+static GFX_PIXEL_SSE2 void MipmapEncode_SSE2(uint32_t *dst, const float *src, int count,
+		const uint8_t *srgb, float alpha_scale)
+{
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 one = _mm_set1_ps(1.0f);
+	const __m128 half = _mm_set1_ps(0.5f);
+	const __m128 scale = _mm_setr_ps(1.0f, 1.0f, 1.0f, alpha_scale);
+	const __m128 s8 = _mm_set1_ps(255.0f);
+	const __m128 s16 = _mm_setr_ps(65535.0f, 65535.0f, 65535.0f, 255.0f);
+	if (srgb == NULL) {
+		int i = 0;
+		for (; i + 4 <= count; i += 4) {
+			__m128i c[4];
+			for (int k = 0; k < 4; k++) {
+				__m128 x = _mm_mul_ps(_mm_loadu_ps(src + (i + k) * 4), scale);
+				x = _mm_max_ps(_mm_min_ps(x, one), zero);
+				c[k] = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(x, s8), half));
+			}
+			__m128i lo = _mm_packs_epi32(c[0], c[1]);
+			__m128i hi = _mm_packs_epi32(c[2], c[3]);
+			_mm_storeu_si128((__m128i*)(dst + i), _mm_packus_epi16(lo, hi));
+		}
+		MipmapEncode_C(dst + i, src + i * 4, count - i, NULL, alpha_scale);
+		return;
+	}
+	for (int i = 0; i < count; i++) {
+		__m128 x = _mm_mul_ps(_mm_loadu_ps(src + i * 4), scale);
+		x = _mm_max_ps(_mm_min_ps(x, one), zero);
+		int32_t q[4];
+		_mm_storeu_si128((__m128i*)q, _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(x, s16), half)));
+		dst[i] = ((uint32_t)q[3] << 24) | ((uint32_t)srgb[q[2]] << 16) |
+			((uint32_t)srgb[q[1]] << 8) | srgb[q[0]];
+	}
+}
+
+static const MipmapKernels MipmapKernel_SSE2 = {
+	MipmapHorizontal_SSE2, MipmapVertical_SSE2, MipmapEncode_SSE2 };
+
+
+//---------------------------------------------------------------------
+// AVX2: two output pixels per register in the horizontal pass, eight
+// floats per step in the vertical one
+//---------------------------------------------------------------------
+static GFX_PIXEL_AVX2 void MipmapHorizontal_AVX2(float *dst, const float *src,
+		int count, const MipmapTable& table)
+{
+	int taps = table.taps;
+	int i = 0;
+	for (; i + 2 <= count; i += 2) {
+		const float *p0 = src + table.start[i] * 4;
+		const float *p1 = src + table.start[i + 1] * 4;
+		const float *w0 = &table.weights[(size_t)i * taps];
+		const float *w1 = w0 + taps;
+		__m256 acc = _mm256_setzero_ps();
+		for (int k = 0; k < taps; k++) {
+			__m256 x = _mm256_insertf128_ps(_mm256_castps128_ps256(
+					_mm_loadu_ps(p0 + k * 4)), _mm_loadu_ps(p1 + k * 4), 1);
+			__m256 w = _mm256_insertf128_ps(_mm256_castps128_ps256(
+					_mm_set1_ps(w0[k])), _mm_set1_ps(w1[k]), 1);
+			acc = _mm256_add_ps(acc, _mm256_mul_ps(w, x));
+		}
+		_mm256_storeu_ps(dst + i * 4, acc);
+	}
+	_mm256_zeroupper();
+	for (; i < count; i++) {
+		const float *p = src + table.start[i] * 4;
+		const float *w = &table.weights[(size_t)i * taps];
+		__m128 acc = _mm_setzero_ps();
+		for (int k = 0; k < taps; k++) {
+			acc = _mm_add_ps(acc, _mm_mul_ps(_mm_set1_ps(w[k]), _mm_loadu_ps(p + k * 4)));
+		}
+		_mm_storeu_ps(dst + i * 4, acc);
+	}
+}
+
+static GFX_PIXEL_AVX2 void MipmapVertical_AVX2(float *dst, const float *const *rows,
+		const float *weights, int taps, int count)
+{
+	int i = 0;
+	for (; i + 8 <= count; i += 8) {
+		__m256 acc = _mm256_setzero_ps();
+		for (int k = 0; k < taps; k++) {
+			acc = _mm256_add_ps(acc, _mm256_mul_ps(_mm256_set1_ps(weights[k]),
+					_mm256_loadu_ps(rows[k] + i)));
+		}
+		_mm256_storeu_ps(dst + i, acc);
+	}
+	_mm256_zeroupper();
+	for (; i < count; i++) {
+		float x = 0.0f;
+		for (int k = 0; k < taps; k++) x += weights[k] * rows[k][i];
+		dst[i] = x;
+	}
+}
+
+static const MipmapKernels MipmapKernel_AVX2 = {
+	MipmapHorizontal_AVX2, MipmapVertical_AVX2, MipmapEncode_SSE2 };
+
+#endif
+
+
+//---------------------------------------------------------------------
+// one level: filter the level above (8 bit rows of level 0, or the
+// float result of the previous level) into dst, then encode it
+//---------------------------------------------------------------------
+struct MipmapJob
+{
+	const MipmapKernels *kernels;
+	const MipmapGamma *gamma;
+	bool srgb;
+	const uint8_t *src_bits;		// level 0, NULL for the float levels
+	int32_t src_pitch;
+	PixelFormat src_fmt;
+	const float *src;
+	int sw, sh;
+	float *dst;
+	int dw, dh;
+	MipmapTable htable;
+	MipmapTable vtable;
+	Image *image;
+	float alpha_scale;
+};
+
+// output rows [begin, end). the horizontal results of the taps source
+// rows live in a ring indexed by row % taps, start only grows so a row
+// is filtered once per band
+static void MipmapFilterRows(void *ctx, int begin, int end)
+{
+	MipmapJob *job = (MipmapJob*)ctx;
+	int taps = job->vtable.taps;
+	std::vector<float> ring((size_t)taps * job->dw * 4);
+	std::vector<int> tags(taps, -1);
+	std::vector<const float*> rows(taps);
+	std::vector<uint32_t> argb(job->src_bits? job->sw : 0);
+	std::vector<float> line(job->src_bits? job->sw * 4 : 1);
+	const float *color = job->srgb? job->gamma->decode : job->gamma->linear;
+	for (int y = begin; y < end; y++) {
+		int start = job->vtable.start[y];
+		for (int k = 0; k < taps; k++) {
+			int sy = start + k;
+			float *slot = &ring[(size_t)(sy % taps) * job->dw * 4];
+			rows[k] = slot;
+			if (tags[sy % taps] == sy) continue;
+			tags[sy % taps] = sy;
+			const float *src = &line[0];
+			if (job->src_bits == NULL) {
+				src = job->src + (size_t)sy * job->sw * 4;
+			}
+			else {
+				UnpackPixelRow(&argb[0], job->src_bits + (ptrdiff_t)job->src_pitch * sy,
+						job->src_fmt, job->sw);
+				const uint8_t *p = (const uint8_t*)&argb[0];
+				for (int i = 0; i < job->sw * 4; i += 4) {
+					line[i + 0] = color[p[i + 0]];
+					line[i + 1] = color[p[i + 1]];
+					line[i + 2] = color[p[i + 2]];
+					line[i + 3] = job->gamma->linear[p[i + 3]];
+				}
+			}
+			job->kernels->horizontal(slot, src, job->dw, job->htable);
+		}
+		job->kernels->vertical(job->dst + (size_t)y * job->dw * 4, &rows[0],
+				&job->vtable.weights[(size_t)y * taps], taps, job->dw * 4);
+	}
+}
+
+static void MipmapEncodeRows(void *ctx, int begin, int end)
+{
+	MipmapJob *job = (MipmapJob*)ctx;
+	const uint8_t *srgb = job->srgb? job->gamma->encode : NULL;
+	std::vector<uint32_t> argb(job->dw);
+	for (int y = begin; y < end; y++) {
+		job->kernels->encode(&argb[0], job->dst + (size_t)y * job->dw * 4,
+				job->dw, srgb, job->alpha_scale);
+		PackPixelRow(job->image->GetLine(y), job->image->GetFormat(), &argb[0], job->dw);
+	}
+}
+
+// fraction of level pixels whose alpha, scaled and saturated, is above
+// ref. the scale for a target coverage is found by bisection on the
+// threshold ref / scale
+static double MipmapCoverage(const float *pixels, int count, float threshold)
+{
+	int n = 0;
+	for (int i = 0; i < count; i++) {
+		if (pixels[i * 4 + 3] > threshold) n++;
+	}
+	return (double)n / count;
+}
+
+static float MipmapCoverageScale(const float *pixels, int count, float ref, double target)
+{
+	float lo = 0.0f, hi = 1.0f;
+	for (int i = 0; i < MIPMAP_COVERAGE_STEPS; i++) {
+		float mid = (lo + hi) * 0.5f;
+		if (MipmapCoverage(pixels, count, mid) > target) lo = mid;
+		else hi = mid;
+	}
+	float threshold = (lo + hi) * 0.5f;
+	return ref / threshold;
+}
+
+static bool MipmapHasAlpha(PixelFormat fmt)
+{
+	return fmt == FMT_A8R8G8B8 || fmt == FMT_A8B8G8R8 ||
+		fmt == FMT_A1R5G5B5 || fmt == FMT_A4R4G4B4;
+}
+
+
+//---------------------------------------------------------------------
+// levels
+//---------------------------------------------------------------------
+int GetMipmapLevels(int w, int h)
+{
+	int n = 1;
+	while (w > 1 || h > 1) {
+		w >>= 1;
+		h >>= 1;
+		n++;
+	}
+	return n;
+}
+
+
+//---------------------------------------------------------------------
+// build chain
+//---------------------------------------------------------------------
+int BuildMipmaps(Image **chain, int count, const Image *src, MipmapFilter filter,
+		int flags, float alpha_ref, int threads)
+{
+	PixelFormat fmt = src->GetFormat();
+	if (fmt >= FMT_UNKNOWN) return 0;
+	int levels = GetMipmapLevels(src->GetWidth(), src->GetHeight()) - 1;
+	if (count > levels) count = levels;
+	if (count <= 0) return 0;
+
+	MipmapJob job;
+	job.kernels = &MipmapKernel_Generic;
+#if GFX_PIXEL_X86
+	switch (GetPixelKernel()) {
+	case PIXEL_KERNEL_AVX2: job.kernels = &MipmapKernel_AVX2; break;
+	case PIXEL_KERNEL_SSE2: job.kernels = &MipmapKernel_SSE2; break;
+	default: break;
+	}
+#endif
+	job.gamma = &MipmapGamma_Get();
+	job.srgb = (flags & MIPMAP_SRGB) != 0;
+	job.src_bits = src->GetBits();
+	job.src_pitch = src->GetPitch();
+	job.src_fmt = fmt;
+	job.src = NULL;
+	job.sw = src->GetWidth();
+	job.sh = src->GetHeight();
+
+	bool coverage = (flags & MIPMAP_COVERAGE) != 0 && MipmapHasAlpha(fmt) &&
+		alpha_ref > 0.0f && alpha_ref < 1.0f;
+	double target = 0.0;
+	if (coverage) {
+		std::vector<uint32_t> argb(job.sw);
+		int limit = (int)(alpha_ref * 255.0f);
+		int n = 0;
+		for (int y = 0; y < job.sh; y++) {
+			UnpackPixelRow(&argb[0], src->GetLine(y), fmt, job.sw);
+			for (int x = 0; x < job.sw; x++) {
+				if ((int)(argb[x] >> 24) > limit) n++;
+			}
+		}
+		target = (double)n / ((double)job.sw * job.sh);
+	}
+
+	std::vector<float> above, level;
+	for (int i = 0; i < count; i++) {
+		job.dw = (job.sw > 1)? (job.sw >> 1) : 1;
+		job.dh = (job.sh > 1)? (job.sh >> 1) : 1;
+		MipmapTable_Init(job.htable, job.sw, job.dw, filter);
+		MipmapTable_Init(job.vtable, job.sh, job.dh, filter);
+		level.resize((size_t)job.dw * job.dh * 4);
+		job.dst = &level[0];
+		int grain = MIPMAP_GRAIN / job.dw + 1;
+		ParallelFor(job.dh, grain, threads, MipmapFilterRows, &job);
+
+		job.alpha_scale = 1.0f;
+		if (coverage) {
+			job.alpha_scale = MipmapCoverageScale(job.dst, job.dw * job.dh,
+					alpha_ref, target);
+		}
+		job.image = new Image(job.dw, job.dh, fmt);
+		ParallelFor(job.dh, grain, threads, MipmapEncodeRows, &job);
+		chain[i] = job.image;
+
+		// the next level reads this one's floats
+		above.swap(level);
+		job.src_bits = NULL;
+		job.src = &above[0];
+		job.sw = job.dw;
+		job.sh = job.dh;
+	}
+	return count;
+}
+
+
+//---------------------------------------------------------------------
+// texture levels
+//---------------------------------------------------------------------
+bool GenerateMipmaps(Texture *tex, const Image *src, MipmapFilter filter,
+		int flags, float alpha_ref, int threads)
+{
+	int count = tex->GetLevels() - 1;
+	if (count <= 0) return true;
+	if (tex->IsLockable() == false) return false;
+	if (src && (src->GetWidth() != tex->GetWidth() || src->GetHeight() != tex->GetHeight())) {
+		return false;
+	}
+	Image *base = NULL;
+	if (src == NULL) {
+		base = new Image(tex->GetWidth(), tex->GetHeight(), tex->GetFormat());
+		tex->SaveToImage(0, base);
+		src = base;
+	}
+	std::vector<Image*> chain(count, (Image*)NULL);
+	int built = BuildMipmaps(&chain[0], count, src, filter, flags, alpha_ref, threads);
+	for (int i = 0; i < built; i++) {
+		Image *image = chain[i];
+		tex->CopyFrom(i + 1, 0, 0, image, 0, 0, image->GetWidth(), image->GetHeight());
+		delete image;
+	}
+	if (base) {
+		delete base;
+	}
+	return built == count;
+}
+
+
+//---------------------------------------------------------------------
+// Namespace End
+//---------------------------------------------------------------------
+NAMESPACE_END(GFX);
+
+
@@ -0,0 +1,72 @@
+//=====================================================================
+//
+// GFXMipmap.h - mipmap chain generation
+//
+// Last Modified: 2026/10/18 21:05:12
+//
+//=====================================================================
+#ifndef _GFX_MIPMAP_H_
+#define _GFX_MIPMAP_H_
+
+#include "GFXImage.h"
+#include "GFXTexture.h"
+
+
+//---------------------------------------------------------------------
+// Namespace Begin
+//---------------------------------------------------------------------
+NAMESPACE_BEGIN(GFX);
+
+
+//---------------------------------------------------------------------
+// Downsampling filters, sized in pixels of the smaller level
+//---------------------------------------------------------------------
+enum MipmapFilter
+{
+	MIPMAP_BOX = 0,			// area average, exact for odd sizes too
+	MIPMAP_KAISER,			// sinc with a Kaiser window, radius 3, alpha 4
+	MIPMAP_LANCZOS,			// Lanczos3
+};
+
+enum MipmapFlag
+{
+	MIPMAP_SRGB = 1,		// color is sRGB: filter in linear light
+	MIPMAP_COVERAGE = 2,	// keep the alpha test coverage of level 0
+};
+
+
+//---------------------------------------------------------------------
+// level n is max(w >> n, 1) x max(h >> n, 1) like Texture::GetLevelWidth,
+// each level is filtered from the float result of the one above it.
+// rows of every level are split across threads (<= 0: one per core)
+// and the filter loops are SSE2 / AVX2 with the same results as the
+// generic code. alpha is always linear, with MIPMAP_COVERAGE every
+// level gets its alpha scaled so the fraction of pixels above
+// alpha_ref matches level 0
+//---------------------------------------------------------------------
+
+// levels of a full chain down to 1 x 1
+int GetMipmapLevels(int w, int h);
+
+// builds levels 1 .. count of src as new images in its format, level
+// n goes to chain[n - 1]. returns the number built (count is clamped to
+// the full chain), the caller deletes them
+int BuildMipmaps(Image **chain, int count, const Image *src, MipmapFilter filter,
+		int flags = 0, float alpha_ref = 0.5f, int threads = 0);
+
+// fills levels 1 .. GetLevels() - 1 of tex from src, the content of
+// its level 0 (NULL: level 0 is read back from tex). false if tex is
+// not lockable or a level could not be built
+bool GenerateMipmaps(Texture *tex, const Image *src, MipmapFilter filter,
+		int flags = 0, float alpha_ref = 0.5f, int threads = 0);
+
+
+//---------------------------------------------------------------------
+// Namespace End
+//---------------------------------------------------------------------
+NAMESPACE_END(GFX);
+
+
+#endif
+
+
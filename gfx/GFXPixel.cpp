@@ -0,0 +1,1100 @@
+//=====================================================================
+//
+// GFXPixel.cpp - conversion between every PixelFormat pair
+//
+// Last Modified: 2026/10/18 19:02:41
+//
+//=====================================================================
+#include <stddef.h>
+#include <string.h>
+
+#include "GFXPixel.h"
+
+
+#if GFX_PIXEL_X86
+	#if defined(_MSC_VER)
+		#include <intrin.h>
+	#else
+		#include <cpuid.h>
+	#endif
+#endif
+
+
+//---------------------------------------------------------------------
+// Namespace Begin
+//---------------------------------------------------------------------
+NAMESPACE_BEGIN(GFX);
+
+
+//---------------------------------------------------------------------
+// row kernel: count pixels from src to dst, either side may be the
+// A8R8G8B8 row. unaligned, and the simd versions never touch memory
+// past the end of either row
+//---------------------------------------------------------------------
+typedef void (*PixelRowProc)(uint8_t *dst, const uint8_t *src, int count);
+
+struct PixelKernelSet
+{
+	PixelRowProc unpack[FMT_UNKNOWN];	// fmt -> A8R8G8B8
+	PixelRowProc pack[FMT_UNKNOWN];		// A8R8G8B8 -> fmt
+	PixelRowProc reverse;				// 32 bit, dst[i] = src[count - 1 - i]
+};
+
+// pixels per pass when neither side is A8R8G8B8, stays in L1
+#define PIXEL_CHUNK		256
+
+
+//---------------------------------------------------------------------
+// scalar helpers
+//---------------------------------------------------------------------
+static inline uint32_t Load16(const uint8_t *p) { uint16_t x; memcpy(&x, p, 2); return x; }
+static inline uint32_t Load32(const uint8_t *p) { uint32_t x; memcpy(&x, p, 4); return x; }
+static inline void Store16(uint8_t *p, uint32_t x) { uint16_t y = (uint16_t)x; memcpy(p, &y, 2); }
+static inline void Store32(uint8_t *p, uint32_t x) { memcpy(p, &x, 4); }
+
+static inline uint32_t Expand4(uint32_t v) { return v * 17; }
+static inline uint32_t Expand5(uint32_t v) { return (v << 3) | (v >> 2); }
+static inline uint32_t Expand6(uint32_t v) { return (v << 2) | (v >> 4); }
+
+// round(v * (2^n - 1) / 255) for every v in 0-255
+static inline uint32_t Narrow4(uint32_t v) { return (v * 15 + 135) >> 8; }
+static inline uint32_t Narrow5(uint32_t v) { return (v * 249 + 1014) >> 11; }
+static inline uint32_t Narrow6(uint32_t v) { return (v * 253 + 505) >> 10; }
+
+static inline uint32_t SwapRB(uint32_t c) {
+	return (c & 0xff00ff00) | ((c >> 16) & 0xff) | ((c & 0xff) << 16);
+}
+
+
+//---------------------------------------------------------------------
+// generic kernels
+//---------------------------------------------------------------------
+static void Copy32_C(uint8_t *dst, const uint8_t *src, int count)
+{
+	memcpy(dst, src, count * 4);
+}
+
+static void Reverse32_C(uint8_t *dst, const uint8_t *src, int count)
+{
+	for (int i = 0; i < count; i++) {
+		Store32(dst + i * 4, Load32(src + (count - 1 - i) * 4));
+	}
+}
+
+static void SwapRB_C(uint8_t *dst, const uint8_t *src, int count)
+{
+	for (int i = 0; i < count; i++) {
+		Store32(dst + i * 4, SwapRB(Load32(src + i * 4)));
+	}
+}
+
+static void SetAlpha_C(uint8_t *dst, const uint8_t *src, int count)
+{
+	for (int i = 0; i < count; i++) {
+		Store32(dst + i * 4, Load32(src + i * 4) | 0xff000000);
+	}
+}
+
+static void Unpack_R8G8B8_C(uint8_t *dst, const uint8_t *src, int count)
+{
+	for (int i = 0; i < count; i++, src += 3) {
+		uint32_t c = src[0] | (src[1] << 8) | (src[2] << 16);
+		Store32(dst + i * 4, c | 0xff000000);
+	}
+}
+
+static void Unpack_B8G8R8_C(uint8_t *dst, const uint8_t *src, int count)
+{
+	for (int i = 0; i < count; i++, src += 3) {
+		uint32_t c = src[2] | (src[1] << 8) | (src[0] << 16);
+		Store32(dst + i * 4, c | 0xff000000);
+	}
+}
+
+static void Unpack_A1R5G5B5_C(uint8_t *dst, const uint8_t *src, int count)
+{
+	for (int i = 0; i < count; i++) {
+		uint32_t p = Load16(src + i * 2);
+		uint32_t a = (p & 0x8000)? 0xff000000 : 0;
+		uint32_t r = Expand5((p >> 10) & 31);
+		uint32_t g = Expand5((p >> 5) & 31);
+		uint32_t b = Expand5(p & 31);
+		Store32(dst + i * 4, a | (r << 16) | (g << 8) | b);
+	}
+}
+
+static void Unpack_A4R4G4B4_C(uint8_t *dst, const uint8_t *src, int count)
+{
+	for (int i = 0; i < count; i++) {
+		uint32_t p = Load16(src + i * 2);
+		uint32_t a = Expand4(p >> 12);
+		uint32_t r = Expand4((p >> 8) & 15);
+		uint32_t g = Expand4((p >> 4) & 15);
+		uint32_t b = Expand4(p & 15);
+		Store32(dst + i * 4, (a << 24) | (r << 16) | (g << 8) | b);
+	}
+}
+
+static void Unpack_R5G6B5_C(uint8_t *dst, const uint8_t *src, int count)
+{
+	for (int i = 0; i < count; i++) {
+		uint32_t p = Load16(src + i * 2);
+		uint32_t r = Expand5(p >> 11);
+		uint32_t g = Expand6((p >> 5) & 63);
+		uint32_t b = Expand5(p & 31);
+		Store32(dst + i * 4, 0xff000000 | (r << 16) | (g << 8) | b);
+	}
+}
+
+static void Unpack_G8_C(uint8_t *dst, const uint8_t *src, int count)
+{
+	for (int i = 0; i < count; i++) {
+		Store32(dst + i * 4, 0xff000000 | (src[i] * 0x010101));
+	}
+}
+
+static void Pack_R8G8B8_C(uint8_t *dst, const uint8_t *src, int count)
+{
+	for (int i = 0; i < count; i++, dst += 3) {
+		uint32_t c = Load32(src + i * 4);
+		dst[0] = (uint8_t)c;
+		dst[1] = (uint8_t)(c >> 8);
+		dst[2] = (uint8_t)(c >> 16);
+	}
+}
+
+static void Pack_B8G8R8_C(uint8_t *dst, const uint8_t *src, int count)
+{
+	for (int i = 0; i < count; i++, dst += 3) {
+		uint32_t c = Load32(src + i * 4);
+		dst[0] = (uint8_t)(c >> 16);
+		dst[1] = (uint8_t)(c >> 8);
+		dst[2] = (uint8_t)c;
+	}
+}
+
+static void Pack_A1R5G5B5_C(uint8_t *dst, const uint8_t *src, int count)
+{
+	for (int i = 0; i < count; i++) {
+		uint32_t c = Load32(src + i * 4);
+		uint32_t r = Narrow5((c >> 16) & 0xff);
+		uint32_t g = Narrow5((c >> 8) & 0xff);
+		uint32_t b = Narrow5(c & 0xff);
+		Store16(dst + i * 2, ((c >> 31) << 15) | (r << 10) | (g << 5) | b);
+	}
+}
+
+static void Pack_A4R4G4B4_C(uint8_t *dst, const uint8_t *src, int count)
+{
+	for (int i = 0; i < count; i++) {
+		uint32_t c = Load32(src + i * 4);
+		uint32_t a = Narrow4(c >> 24);
+		uint32_t r = Narrow4((c >> 16) & 0xff);
+		uint32_t g = Narrow4((c >> 8) & 0xff);
+		uint32_t b = Narrow4(c & 0xff);
+		Store16(dst + i * 2, (a << 12) | (r << 8) | (g << 4) | b);
+	}
+}
+
+static void Pack_R5G6B5_C(uint8_t *dst, const uint8_t *src, int count)
+{
+	for (int i = 0; i < count; i++) {
+		uint32_t c = Load32(src + i * 4);
+		uint32_t r = Narrow5((c >> 16) & 0xff);
+		uint32_t g = Narrow6((c >> 8) & 0xff);
+		uint32_t b = Narrow5(c & 0xff);
+		Store16(dst + i * 2, (r << 11) | (g << 5) | b);
+	}
+}
+
+static void Pack_G8_C(uint8_t *dst, const uint8_t *src, int count)
+{
+	for (int i = 0; i < count; i++) {
+		uint32_t c = Load32(src + i * 4);
+		uint32_t r = (c >> 16) & 0xff;
+		uint32_t g = (c >> 8) & 0xff;
+		uint32_t b = c & 0xff;
+		dst[i] = (uint8_t)((r * 77 + g * 151 + b * 28 + 128) >> 8);
+	}
+}
+
+static const PixelKernelSet PixelKernel_Generic = {
+	{ Copy32_C, SwapRB_C, SetAlpha_C, Unpack_R8G8B8_C, Unpack_B8G8R8_C,
+	  Unpack_A1R5G5B5_C, Unpack_A4R4G4B4_C, Unpack_R5G6B5_C, Unpack_G8_C },
+	{ Copy32_C, SwapRB_C, SetAlpha_C, Pack_R8G8B8_C, Pack_B8G8R8_C,
+	  Pack_A1R5G5B5_C, Pack_A4R4G4B4_C, Pack_R5G6B5_C, Pack_G8_C },
+	Reverse32_C,
+};
+
+
+#if GFX_PIXEL_X86
+
+//---------------------------------------------------------------------
+// SSE2: 16 bit formats are widened / narrowed in 16 bit lanes with the
+// same integer formulas as above, 24 bit formats are gathered with
+// byte shifts since there is no byte shuffle before SSSE3
+//---------------------------------------------------------------------
+#define PIXEL_LOAD(p)		_mm_loadu_si128((const __m128i*)(p))
+#define PIXEL_STORE(p, x)	_mm_storeu_si128((__m128i*)(p), (x))
+
+static GFX_PIXEL_SSE2 void SwapRB_SSE2(uint8_t *dst, const uint8_t *src, int count)
+{
+	const __m128i ag = _mm_set1_epi32((int)0xff00ff00);
+	int i = 0;
+	for (; i + 4 <= count; i += 4) {
+		__m128i c = PIXEL_LOAD(src + i * 4);
+		__m128i rb = _mm_andnot_si128(ag, c);
+		rb = _mm_shufflelo_epi16(rb, _MM_SHUFFLE(2, 3, 0, 1));
+		rb = _mm_shufflehi_epi16(rb, _MM_SHUFFLE(2, 3, 0, 1));
+		PIXEL_STORE(dst + i * 4, _mm_or_si128(_mm_and_si128(c, ag), rb));
+	}
+	SwapRB_C(dst + i * 4, src + i * 4, count - i);
+}
+
+// the remaining pixels of a reversed row are the first ones of src
+static GFX_PIXEL_SSE2 void Reverse32_SSE2(uint8_t *dst, const uint8_t *src, int count)
+{
+	int i = 0;
+	for (; i + 4 <= count; i += 4) {
+		__m128i c = PIXEL_LOAD(src + (count - i - 4) * 4);
+		PIXEL_STORE(dst + i * 4, _mm_shuffle_epi32(c, _MM_SHUFFLE(0, 1, 2, 3)));
+	}
+	Reverse32_C(dst + i * 4, src, count - i);
+}
+
+static GFX_PIXEL_SSE2 void SetAlpha_SSE2(uint8_t *dst, const uint8_t *src, int count)
+{
+	const __m128i alpha = _mm_set1_epi32((int)0xff000000);
+	int i = 0;
+	for (; i + 8 <= count; i += 8) {
+		__m128i c0 = PIXEL_LOAD(src + i * 4);
+		__m128i c1 = PIXEL_LOAD(src + i * 4 + 16);
+		PIXEL_STORE(dst + i * 4, _mm_or_si128(c0, alpha));
+		PIXEL_STORE(dst + i * 4 + 16, _mm_or_si128(c1, alpha));
+	}
+	SetAlpha_C(dst + i * 4, src + i * 4, count - i);
+}
+
+// four 24 bit pixels (12 of the 16 bytes loaded) to the low 24 bits
+// of each lane
+static GFX_PIXEL_SSE2 inline __m128i Gather24_SSE2(__m128i c)
+{
+	__m128i x01 = _mm_unpacklo_epi32(c, _mm_srli_si128(c, 3));
+	__m128i x23 = _mm_unpacklo_epi32(_mm_srli_si128(c, 6), _mm_srli_si128(c, 9));
+	return _mm_unpacklo_epi64(x01, x23);
+}
+
+// inverse: low 24 bits of each lane to 12 consecutive bytes
+static GFX_PIXEL_SSE2 inline __m128i Scatter24_SSE2(__m128i c)
+{
+	const __m128i even = _mm_set_epi32(0, 0xffffff, 0, 0xffffff);
+	const __m128i odd = _mm_set_epi32(0xffffff, 0, 0xffffff, 0);
+	const __m128i low = _mm_set_epi32(0, 0, -1, -1);
+	__m128i t = _mm_or_si128(_mm_and_si128(c, even),
+			_mm_srli_epi64(_mm_and_si128(c, odd), 8));
+	return _mm_or_si128(_mm_and_si128(t, low),
+			_mm_srli_si128(_mm_andnot_si128(low, t), 2));
+}
+
+static GFX_PIXEL_SSE2 inline __m128i SwapRB_Lanes_SSE2(__m128i c)
+{
+	const __m128i ag = _mm_set1_epi32((int)0xff00ff00);
+	__m128i rb = _mm_andnot_si128(ag, c);
+	rb = _mm_shufflelo_epi16(rb, _MM_SHUFFLE(2, 3, 0, 1));
+	rb = _mm_shufflehi_epi16(rb, _MM_SHUFFLE(2, 3, 0, 1));
+	return _mm_or_si128(_mm_and_si128(c, ag), rb);
+}
+
+// a 16 byte load at pixel i of a 24 bit row stays inside the row while
+// 6 or more pixels are left, the same holds for a 16 byte store
+static GFX_PIXEL_SSE2 void Unpack_R8G8B8_SSE2(uint8_t *dst, const uint8_t *src, int count)
+{
+	const __m128i alpha = _mm_set1_epi32((int)0xff000000);
+	int i = 0;
+	for (; i + 6 <= count; i += 4) {
+		__m128i c = Gather24_SSE2(PIXEL_LOAD(src + i * 3));
+		PIXEL_STORE(dst + i * 4, _mm_or_si128(c, alpha));
+	}
+	Unpack_R8G8B8_C(dst + i * 4, src + i * 3, count - i);
+}
+
+static GFX_PIXEL_SSE2 void Unpack_B8G8R8_SSE2(uint8_t *dst, const uint8_t *src, int count)
+{
+	const __m128i alpha = _mm_set1_epi32((int)0xff000000);
+	int i = 0;
+	for (; i + 6 <= count; i += 4) {
+		__m128i c = SwapRB_Lanes_SSE2(Gather24_SSE2(PIXEL_LOAD(src + i * 3)));
+		PIXEL_STORE(dst + i * 4, _mm_or_si128(c, alpha));
+	}
+	Unpack_B8G8R8_C(dst + i * 4, src + i * 3, count - i);
+}
+
+static GFX_PIXEL_SSE2 void Pack_R8G8B8_SSE2(uint8_t *dst, const uint8_t *src, int count)
+{
+	int i = 0;
+	for (; i + 6 <= count; i += 4) {
+		PIXEL_STORE(dst + i * 3, Scatter24_SSE2(PIXEL_LOAD(src + i * 4)));
+	}
+	Pack_R8G8B8_C(dst + i * 3, src + i * 4, count - i);
+}
+
+static GFX_PIXEL_SSE2 void Pack_B8G8R8_SSE2(uint8_t *dst, const uint8_t *src, int count)
+{
+	int i = 0;
+	for (; i + 6 <= count; i += 4) {
+		__m128i c = SwapRB_Lanes_SSE2(PIXEL_LOAD(src + i * 4));
+		PIXEL_STORE(dst + i * 3, Scatter24_SSE2(c));
+	}
+	Pack_B8G8R8_C(dst + i * 3, src + i * 4, count - i);
+}
+
+// 16 bit lanes: (g << 8) | b words and (a << 8) | r words to pixels
+static GFX_PIXEL_SSE2 inline void StoreWords_SSE2(uint8_t *dst, __m128i gb, __m128i ar)
+{
+	PIXEL_STORE(dst, _mm_unpacklo_epi16(gb, ar));
+	PIXEL_STORE(dst + 16, _mm_unpackhi_epi16(gb, ar));
+}
+
+// eight pixels to (g << 8) | b and (a << 8) | r words
+static GFX_PIXEL_SSE2 inline void LoadWords_SSE2(const uint8_t *src, __m128i *gb, __m128i *ar)
+{
+	__m128i c0 = PIXEL_LOAD(src);
+	__m128i c1 = PIXEL_LOAD(src + 16);
+	*gb = _mm_packs_epi32(_mm_srai_epi32(_mm_slli_epi32(c0, 16), 16),
+			_mm_srai_epi32(_mm_slli_epi32(c1, 16), 16));
+	*ar = _mm_packs_epi32(_mm_srai_epi32(c0, 16), _mm_srai_epi32(c1, 16));
+}
+
+static GFX_PIXEL_SSE2 inline __m128i Expand5_SSE2(__m128i v) {
+	return _mm_or_si128(_mm_slli_epi16(v, 3), _mm_srli_epi16(v, 2));
+}
+
+static GFX_PIXEL_SSE2 inline __m128i Expand6_SSE2(__m128i v) {
+	return _mm_or_si128(_mm_slli_epi16(v, 2), _mm_srli_epi16(v, 4));
+}
+
+static GFX_PIXEL_SSE2 inline __m128i Expand4_SSE2(__m128i v) {
+	return _mm_or_si128(_mm_slli_epi16(v, 4), v);
+}
+
+// narrowing formulas: products stay below 2^16
+#define PIXEL_NARROW_SSE2(v, mul, add, shift) \
+	_mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(v, _mm_set1_epi16(mul)), \
+		_mm_set1_epi16(add)), shift)
+
+#define PIXEL_NARROW4_SSE2(v)	PIXEL_NARROW_SSE2(v, 15, 135, 8)
+#define PIXEL_NARROW5_SSE2(v)	PIXEL_NARROW_SSE2(v, 249, 1014, 11)
+#define PIXEL_NARROW6_SSE2(v)	PIXEL_NARROW_SSE2(v, 253, 505, 10)
+
+static GFX_PIXEL_SSE2 void Unpack_A1R5G5B5_SSE2(uint8_t *dst, const uint8_t *src, int count)
+{
+	const __m128i m5 = _mm_set1_epi16(31);
+	const __m128i high = _mm_set1_epi16((short)0xff00);
+	int i = 0;
+	for (; i + 8 <= count; i += 8) {
+		__m128i p = PIXEL_LOAD(src + i * 2);
+		__m128i a = _mm_and_si128(_mm_srai_epi16(p, 15), high);
+		__m128i r = Expand5_SSE2(_mm_and_si128(_mm_srli_epi16(p, 10), m5));
+		__m128i g = Expand5_SSE2(_mm_and_si128(_mm_srli_epi16(p, 5), m5));
+		__m128i b = Expand5_SSE2(_mm_and_si128(p, m5));
+		StoreWords_SSE2(dst + i * 4, _mm_or_si128(_mm_slli_epi16(g, 8), b),
+				_mm_or_si128(a, r));
+	}
+	Unpack_A1R5G5B5_C(dst + i * 4, src + i * 2, count - i);
+}
+
+static GFX_PIXEL_SSE2 void Unpack_A4R4G4B4_SSE2(uint8_t *dst, const uint8_t *src, int count)
+{
+	const __m128i m4 = _mm_set1_epi16(15);
+	int i = 0;
+	for (; i + 8 <= count; i += 8) {
+		__m128i p = PIXEL_LOAD(src + i * 2);
+		__m128i a = Expand4_SSE2(_mm_srli_epi16(p, 12));
+		__m128i r = Expand4_SSE2(_mm_and_si128(_mm_srli_epi16(p, 8), m4));
+		__m128i g = Expand4_SSE2(_mm_and_si128(_mm_srli_epi16(p, 4), m4));
+		__m128i b = Expand4_SSE2(_mm_and_si128(p, m4));
+		StoreWords_SSE2(dst + i * 4, _mm_or_si128(_mm_slli_epi16(g, 8), b),
+				_mm_or_si128(_mm_slli_epi16(a, 8), r));
+	}
+	Unpack_A4R4G4B4_C(dst + i * 4, src + i * 2, count - i);
+}
+
+static GFX_PIXEL_SSE2 void Unpack_R5G6B5_SSE2(uint8_t *dst, const uint8_t *src, int count)
+{
+	const __m128i m5 = _mm_set1_epi16(31);
+	const __m128i m6 = _mm_set1_epi16(63);
+	const __m128i high = _mm_set1_epi16((short)0xff00);
+	int i = 0;
+	for (; i + 8 <= count; i += 8) {
+		__m128i p = PIXEL_LOAD(src + i * 2);
+		__m128i r = Expand5_SSE2(_mm_srli_epi16(p, 11));
+		__m128i g = Expand6_SSE2(_mm_and_si128(_mm_srli_epi16(p, 5), m6));
+		__m128i b = Expand5_SSE2(_mm_and_si128(p, m5));
+		StoreWords_SSE2(dst + i * 4, _mm_or_si128(_mm_slli_epi16(g, 8), b),
+				_mm_or_si128(high, r));
+	}
+	Unpack_R5G6B5_C(dst + i * 4, src + i * 2, count - i);
+}
+
+static GFX_PIXEL_SSE2 void Unpack_G8_SSE2(uint8_t *dst, const uint8_t *src, int count)
+{
+	const __m128i ff = _mm_set1_epi8((char)0xff);
+	int i = 0;
+	for (; i + 16 <= count; i += 16) {
+		__m128i g = PIXEL_LOAD(src + i);
+		__m128i lo = _mm_unpacklo_epi8(g, g);
+		__m128i hi = _mm_unpackhi_epi8(g, g);
+		StoreWords_SSE2(dst + i * 4, lo, _mm_unpacklo_epi8(g, ff));
+		StoreWords_SSE2(dst + i * 4 + 32, hi, _mm_unpackhi_epi8(g, ff));
+	}
+	Unpack_G8_C(dst + i * 4, src + i, count - i);
+}
+
+static GFX_PIXEL_SSE2 void Pack_A1R5G5B5_SSE2(uint8_t *dst, const uint8_t *src, int count)
+{
+	const __m128i low = _mm_set1_epi16(0xff);
+	const __m128i bit15 = _mm_set1_epi16((short)0x8000);
+	int i = 0;
+	for (; i + 8 <= count; i += 8) {
+		__m128i gb, ar;
+		LoadWords_SSE2(src + i * 4, &gb, &ar);
+		__m128i r = PIXEL_NARROW5_SSE2(_mm_and_si128(ar, low));
+		__m128i g = PIXEL_NARROW5_SSE2(_mm_srli_epi16(gb, 8));
+		__m128i b = PIXEL_NARROW5_SSE2(_mm_and_si128(gb, low));
+		__m128i p = _mm_or_si128(_mm_and_si128(ar, bit15), _mm_slli_epi16(r, 10));
+		p = _mm_or_si128(p, _mm_or_si128(_mm_slli_epi16(g, 5), b));
+		PIXEL_STORE(dst + i * 2, p);
+	}
+	Pack_A1R5G5B5_C(dst + i * 2, src + i * 4, count - i);
+}
+
+static GFX_PIXEL_SSE2 void Pack_A4R4G4B4_SSE2(uint8_t *dst, const uint8_t *src, int count)
+{
+	const __m128i low = _mm_set1_epi16(0xff);
+	int i = 0;
+	for (; i + 8 <= count; i += 8) {
+		__m128i gb, ar;
+		LoadWords_SSE2(src + i * 4, &gb, &ar);
+		__m128i a = PIXEL_NARROW4_SSE2(_mm_srli_epi16(ar, 8));
+		__m128i r = PIXEL_NARROW4_SSE2(_mm_and_si128(ar, low));
+		__m128i g = PIXEL_NARROW4_SSE2(_mm_srli_epi16(gb, 8));
+		__m128i b = PIXEL_NARROW4_SSE2(_mm_and_si128(gb, low));
+		__m128i p = _mm_or_si128(_mm_slli_epi16(a, 12), _mm_slli_epi16(r, 8));
+		p = _mm_or_si128(p, _mm_or_si128(_mm_slli_epi16(g, 4), b));
+		PIXEL_STORE(dst + i * 2, p);
+	}
+	Pack_A4R4G4B4_C(dst + i * 2, src + i * 4, count - i);
+}
+
+static GFX_PIXEL_SSE2 void Pack_R5G6B5_SSE2(uint8_t *dst, const uint8_t *src, int count)
+{
+	const __m128i low = _mm_set1_epi16(0xff);
+	int i = 0;
+	for (; i + 8 <= count; i += 8) {
+		__m128i gb, ar;
+		LoadWords_SSE2(src + i * 4, &gb, &ar);
+		__m128i r = PIXEL_NARROW5_SSE2(_mm_and_si128(ar, low));
+		__m128i g = PIXEL_NARROW6_SSE2(_mm_srli_epi16(gb, 8));
+		__m128i b = PIXEL_NARROW5_SSE2(_mm_and_si128(gb, low));
+		__m128i p = _mm_or_si128(_mm_slli_epi16(r, 11), _mm_slli_epi16(g, 5));
+		PIXEL_STORE(dst + i * 2, _mm_or_si128(p, b));
+	}
+	Pack_R5G6B5_C(dst + i * 2, src + i * 4, count - i);
+}
+
+// eight pixels to 16 bit luminance
+static GFX_PIXEL_SSE2 inline __m128i Luminance_SSE2(const uint8_t *src)
+{
+	const __m128i low = _mm_set1_epi16(0xff);
+	__m128i gb, ar;
+	LoadWords_SSE2(src, &gb, &ar);
+	__m128i r = _mm_mullo_epi16(_mm_and_si128(ar, low), _mm_set1_epi16(77));
+	__m128i g = _mm_mullo_epi16(_mm_srli_epi16(gb, 8), _mm_set1_epi16(151));
+	__m128i b = _mm_mullo_epi16(_mm_and_si128(gb, low), _mm_set1_epi16(28));
+	__m128i sum = _mm_add_epi16(_mm_add_epi16(r, g), _mm_add_epi16(b, _mm_set1_epi16(128)));
+	return _mm_srli_epi16(sum, 8);
+}
+
+static GFX_PIXEL_SSE2 void Pack_G8_SSE2(uint8_t *dst, const uint8_t *src, int count)
+{
+	int i = 0;
+	for (; i + 16 <= count; i += 16) {
+		__m128i l0 = Luminance_SSE2(src + i * 4);
+		__m128i l1 = Luminance_SSE2(src + i * 4 + 32);
+		PIXEL_STORE(dst + i, _mm_packus_epi16(l0, l1));
+	}
+	Pack_G8_C(dst + i, src + i * 4, count - i);
+}
+
+static const PixelKernelSet PixelKernel_SSE2 = {
+	{ Copy32_C, SwapRB_SSE2, SetAlpha_SSE2, Unpack_R8G8B8_SSE2, Unpack_B8G8R8_SSE2,
+	  Unpack_A1R5G5B5_SSE2, Unpack_A4R4G4B4_SSE2, Unpack_R5G6B5_SSE2, Unpack_G8_SSE2 },
+	{ Copy32_C, SwapRB_SSE2, SetAlpha_SSE2, Pack_R8G8B8_SSE2, Pack_B8G8R8_SSE2,
+	  Pack_A1R5G5B5_SSE2, Pack_A4R4G4B4_SSE2, Pack_R5G6B5_SSE2, Pack_G8_SSE2 },
+	Reverse32_SSE2,
+};
+
+
+//---------------------------------------------------------------------
+// AVX2: byte shuffles for the 8/24 bit formats, 16 bit lanes again for
+// the packed ones. unpack / pack work in 128 bit lanes and are put
+// back in order with one cross lane permute. vzeroupper before every
+// return since msvc may call these from non-vex code
+//---------------------------------------------------------------------
+#define PIXEL_LOAD8(p)		_mm256_loadu_si256((const __m256i*)(p))
+#define PIXEL_STORE8(p, x)	_mm256_storeu_si256((__m256i*)(p), (x))
+
+static GFX_PIXEL_AVX2 void SwapRB_AVX2(uint8_t *dst, const uint8_t *src, int count)
+{
+	const __m256i mask = _mm256_setr_epi8(
+			2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15,
+			2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+	int i = 0;
+	for (; i + 16 <= count; i += 16) {
+		__m256i c0 = PIXEL_LOAD8(src + i * 4);
+		__m256i c1 = PIXEL_LOAD8(src + i * 4 + 32);
+		PIXEL_STORE8(dst + i * 4, _mm256_shuffle_epi8(c0, mask));
+		PIXEL_STORE8(dst + i * 4 + 32, _mm256_shuffle_epi8(c1, mask));
+	}
+	_mm256_zeroupper();
+	SwapRB_SSE2(dst + i * 4, src + i * 4, count - i);
+}
+
+static GFX_PIXEL_AVX2 void Reverse32_AVX2(uint8_t *dst, const uint8_t *src, int count)
+{
+	const __m256i order = _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0);
+	int i = 0;
+	for (; i + 8 <= count; i += 8) {
+		__m256i c = PIXEL_LOAD8(src + (count - i - 8) * 4);
+		PIXEL_STORE8(dst + i * 4, _mm256_permutevar8x32_epi32(c, order));
+	}
+	_mm256_zeroupper();
+	Reverse32_SSE2(dst + i * 4, src, count - i);
+}
+
+static GFX_PIXEL_AVX2 void SetAlpha_AVX2(uint8_t *dst, const uint8_t *src, int count)
+{
+	const __m256i alpha = _mm256_set1_epi32((int)0xff000000);
+	int i = 0;
+	for (; i + 16 <= count; i += 16) {
+		__m256i c0 = PIXEL_LOAD8(src + i * 4);
+		__m256i c1 = PIXEL_LOAD8(src + i * 4 + 32);
+		PIXEL_STORE8(dst + i * 4, _mm256_or_si256(c0, alpha));
+		PIXEL_STORE8(dst + i * 4 + 32, _mm256_or_si256(c1, alpha));
+	}
+	_mm256_zeroupper();
+	SetAlpha_SSE2(dst + i * 4, src + i * 4, count - i);
+}
+
+// eight 24 bit pixels: two 16 byte loads at 0 and 12 (28 bytes, so 10
+// pixels must be left), one shuffle per lane
+static GFX_PIXEL_AVX2 inline __m256i Load24_AVX2(const uint8_t *src, __m256i mask)
+{
+	__m128i lo = _mm_loadu_si128((const __m128i*)src);
+	__m128i hi = _mm_loadu_si128((const __m128i*)(src + 12));
+	__m256i c = _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+	return _mm256_shuffle_epi8(c, mask);
+}
+
+static GFX_PIXEL_AVX2 inline void Store24_AVX2(uint8_t *dst, __m256i c, __m256i mask)
+{
+	c = _mm256_shuffle_epi8(c, mask);
+	_mm_storeu_si128((__m128i*)dst, _mm256_castsi256_si128(c));
+	_mm_storeu_si128((__m128i*)(dst + 12), _mm256_extracti128_si256(c, 1));
+}
+
+static GFX_PIXEL_AVX2 void Unpack_R8G8B8_AVX2(uint8_t *dst, const uint8_t *src, int count)
+{
+	const __m256i mask = _mm256_setr_epi8(
+			0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1,
+			0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+	const __m256i alpha = _mm256_set1_epi32((int)0xff000000);
+	int i = 0;
+	for (; i + 10 <= count; i += 8) {
+		__m256i c = Load24_AVX2(src + i * 3, mask);
+		PIXEL_STORE8(dst + i * 4, _mm256_or_si256(c, alpha));
+	}
+	_mm256_zeroupper();
+	Unpack_R8G8B8_SSE2(dst + i * 4, src + i * 3, count - i);
+}
+
+static GFX_PIXEL_AVX2 void Unpack_B8G8R8_AVX2(uint8_t *dst, const uint8_t *src, int count)
+{
+	const __m256i mask = _mm256_setr_epi8(
+			2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9, -1,
+			2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9, -1);
+	const __m256i alpha = _mm256_set1_epi32((int)0xff000000);
+	int i = 0;
+	for (; i + 10 <= count; i += 8) {
+		__m256i c = Load24_AVX2(src + i * 3, mask);
+		PIXEL_STORE8(dst + i * 4, _mm256_or_si256(c, alpha));
+	}
+	_mm256_zeroupper();
+	Unpack_B8G8R8_SSE2(dst + i * 4, src + i * 3, count - i);
+}
+
+static GFX_PIXEL_AVX2 void Pack_R8G8B8_AVX2(uint8_t *dst, const uint8_t *src, int count)
+{
+	const __m256i mask = _mm256_setr_epi8(
+			0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1,
+			0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+	int i = 0;
+	for (; i + 10 <= count; i += 8) {
+		Store24_AVX2(dst + i * 3, PIXEL_LOAD8(src + i * 4), mask);
+	}
+	_mm256_zeroupper();
+	Pack_R8G8B8_SSE2(dst + i * 3, src + i * 4, count - i);
+}
+
+static GFX_PIXEL_AVX2 void Pack_B8G8R8_AVX2(uint8_t *dst, const uint8_t *src, int count)
+{
+	const __m256i mask = _mm256_setr_epi8(
+			2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+			2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+	int i = 0;
+	for (; i + 10 <= count; i += 8) {
+		Store24_AVX2(dst + i * 3, PIXEL_LOAD8(src + i * 4), mask);
+	}
+	_mm256_zeroupper();
+	Pack_B8G8R8_SSE2(dst + i * 3, src + i * 4, count - i);
+}
+
+// 16 bit lanes for pixels 0-7 | 8-15 to pixels in memory order
+static GFX_PIXEL_AVX2 inline void StoreWords_AVX2(uint8_t *dst, __m256i gb, __m256i ar)
+{
+	__m256i c0 = _mm256_unpacklo_epi16(gb, ar);		// 0-3 | 8-11
+	__m256i c1 = _mm256_unpackhi_epi16(gb, ar);		// 4-7 | 12-15
+	PIXEL_STORE8(dst, _mm256_permute2x128_si256(c0, c1, 0x20));
+	PIXEL_STORE8(dst + 32, _mm256_permute2x128_si256(c0, c1, 0x31));
+}
+
+// sixteen pixels to words, lanes hold 0-3 8-11 | 4-7 12-15 which is
+// undone by StorePacked_AVX2
+static GFX_PIXEL_AVX2 inline void LoadWords_AVX2(const uint8_t *src, __m256i *gb, __m256i *ar)
+{
+	__m256i c0 = PIXEL_LOAD8(src);
+	__m256i c1 = PIXEL_LOAD8(src + 32);
+	*gb = _mm256_packs_epi32(_mm256_srai_epi32(_mm256_slli_epi32(c0, 16), 16),
+			_mm256_srai_epi32(_mm256_slli_epi32(c1, 16), 16));
+	*ar = _mm256_packs_epi32(_mm256_srai_epi32(c0, 16), _mm256_srai_epi32(c1, 16));
+}
+
+static GFX_PIXEL_AVX2 inline void StorePacked_AVX2(uint8_t *dst, __m256i p)
+{
+	PIXEL_STORE8(dst, _mm256_permute4x64_epi64(p, _MM_SHUFFLE(3, 1, 2, 0)));
+}
+
+static GFX_PIXEL_AVX2 inline __m256i Expand5_AVX2(__m256i v) {
+	return _mm256_or_si256(_mm256_slli_epi16(v, 3), _mm256_srli_epi16(v, 2));
+}
+
+static GFX_PIXEL_AVX2 inline __m256i Expand6_AVX2(__m256i v) {
+	return _mm256_or_si256(_mm256_slli_epi16(v, 2), _mm256_srli_epi16(v, 4));
+}
+
+static GFX_PIXEL_AVX2 inline __m256i Expand4_AVX2(__m256i v) {
+	return _mm256_or_si256(_mm256_slli_epi16(v, 4), v);
+}
+
+#define PIXEL_NARROW_AVX2(v, mul, add, shift) \
+	_mm256_srli_epi16(_mm256_add_epi16(_mm256_mullo_epi16(v, _mm256_set1_epi16(mul)), \
+		_mm256_set1_epi16(add)), shift)
+
+#define PIXEL_NARROW4_AVX2(v)	PIXEL_NARROW_AVX2(v, 15, 135, 8)
+#define PIXEL_NARROW5_AVX2(v)	PIXEL_NARROW_AVX2(v, 249, 1014, 11)
+#define PIXEL_NARROW6_AVX2(v)	PIXEL_NARROW_AVX2(v, 253, 505, 10)
+
+static GFX_PIXEL_AVX2 void Unpack_A1R5G5B5_AVX2(uint8_t *dst, const uint8_t *src, int count)
+{
+	const __m256i m5 = _mm256_set1_epi16(31);
+	const __m256i high = _mm256_set1_epi16((short)0xff00);
+	int i = 0;
+	for (; i + 16 <= count; i += 16) {
+		__m256i p = PIXEL_LOAD8(src + i * 2);
+		__m256i a = _mm256_and_si256(_mm256_srai_epi16(p, 15), high);
+		__m256i r = Expand5_AVX2(_mm256_and_si256(_mm256_srli_epi16(p, 10), m5));
+		__m256i g = Expand5_AVX2(_mm256_and_si256(_mm256_srli_epi16(p, 5), m5));
+		__m256i b = Expand5_AVX2(_mm256_and_si256(p, m5));
+		StoreWords_AVX2(dst + i * 4, _mm256_or_si256(_mm256_slli_epi16(g, 8), b),
+				_mm256_or_si256(a, r));
+	}
+	_mm256_zeroupper();
+	Unpack_A1R5G5B5_SSE2(dst + i * 4, src + i * 2, count - i);
+}
+
+static GFX_PIXEL_AVX2 void Unpack_A4R4G4B4_AVX2(uint8_t *dst, const uint8_t *src, int count)
+{
+	const __m256i m4 = _mm256_set1_epi16(15);
+	int i = 0;
+	for (; i + 16 <= count; i += 16) {
+		__m256i p = PIXEL_LOAD8(src + i * 2);
+		__m256i a = Expand4_AVX2(_mm256_srli_epi16(p, 12));
+		__m256i r = Expand4_AVX2(_mm256_and_si256(_mm256_srli_epi16(p, 8), m4));
+		__m256i g = Expand4_AVX2(_mm256_and_si256(_mm256_srli_epi16(p, 4), m4));
+		__m256i b = Expand4_AVX2(_mm256_and_si256(p, m4));
+		StoreWords_AVX2(dst + i * 4, _mm256_or_si256(_mm256_slli_epi16(g, 8), b),
+				_mm256_or_si256(_mm256_slli_epi16(a, 8), r));
+	}
+	_mm256_zeroupper();
+	Unpack_A4R4G4B4_SSE2(dst + i * 4, src + i * 2, count - i);
+}
+
+static GFX_PIXEL_AVX2 void Unpack_R5G6B5_AVX2(uint8_t *dst, const uint8_t *src, int count)
+{
+	const __m256i m5 = _mm256_set1_epi16(31);
+	const __m256i m6 = _mm256_set1_epi16(63);
+	const __m256i high = _mm256_set1_epi16((short)0xff00);
+	int i = 0;
+	for (; i + 16 <= count; i += 16) {
+		__m256i p = PIXEL_LOAD8(src + i * 2);
+		__m256i r = Expand5_AVX2(_mm256_srli_epi16(p, 11));
+		__m256i g = Expand6_AVX2(_mm256_and_si256(_mm256_srli_epi16(p, 5), m6));
+		__m256i b = Expand5_AVX2(_mm256_and_si256(p, m5));
+		StoreWords_AVX2(dst + i * 4, _mm256_or_si256(_mm256_slli_epi16(g, 8), b),
+				_mm256_or_si256(high, r));
+	}
+	_mm256_zeroupper();
+	Unpack_R5G6B5_SSE2(dst + i * 4, src + i * 2, count - i);
+}
+
+static GFX_PIXEL_AVX2 void Unpack_G8_AVX2(uint8_t *dst, const uint8_t *src, int count)
+{
+	const __m256i mask = _mm256_setr_epi8(
+			0, 0, 0, -1, 4, 4, 4, -1, 8, 8, 8, -1, 12, 12, 12, -1,
+			0, 0, 0, -1, 4, 4, 4, -1, 8, 8, 8, -1, 12, 12, 12, -1);
+	const __m256i alpha = _mm256_set1_epi32((int)0xff000000);
+	int i = 0;
+	for (; i + 16 <= count; i += 16) {
+		__m128i g = _mm_loadu_si128((const __m128i*)(src + i));
+		__m256i g0 = _mm256_cvtepu8_epi32(g);
+		__m256i g1 = _mm256_cvtepu8_epi32(_mm_srli_si128(g, 8));
+		PIXEL_STORE8(dst + i * 4, _mm256_or_si256(_mm256_shuffle_epi8(g0, mask), alpha));
+		PIXEL_STORE8(dst + i * 4 + 32, _mm256_or_si256(_mm256_shuffle_epi8(g1, mask), alpha));
+	}
+	_mm256_zeroupper();
+	Unpack_G8_SSE2(dst + i * 4, src + i, count - i);
+}
+
+static GFX_PIXEL_AVX2 void Pack_A1R5G5B5_AVX2(uint8_t *dst, const uint8_t *src, int count)
+{
+	const __m256i low = _mm256_set1_epi16(0xff);
+	const __m256i bit15 = _mm256_set1_epi16((short)0x8000);
+	int i = 0;
+	for (; i + 16 <= count; i += 16) {
+		__m256i gb, ar;
+		LoadWords_AVX2(src + i * 4, &gb, &ar);
+		__m256i r = PIXEL_NARROW5_AVX2(_mm256_and_si256(ar, low));
+		__m256i g = PIXEL_NARROW5_AVX2(_mm256_srli_epi16(gb, 8));
+		__m256i b = PIXEL_NARROW5_AVX2(_mm256_and_si256(gb, low));
+		__m256i p = _mm256_or_si256(_mm256_and_si256(ar, bit15), _mm256_slli_epi16(r, 10));
+		p = _mm256_or_si256(p, _mm256_or_si256(_mm256_slli_epi16(g, 5), b));
+		StorePacked_AVX2(dst + i * 2, p);
+	}
+	_mm256_zeroupper();
+	Pack_A1R5G5B5_SSE2(dst + i * 2, src + i * 4, count - i);
+}
+
+static GFX_PIXEL_AVX2 void Pack_A4R4G4B4_AVX2(uint8_t *dst, const uint8_t *src, int count)
+{
+	const __m256i low = _mm256_set1_epi16(0xff);
+	int i = 0;
+	for (; i + 16 <= count; i += 16) {
+		__m256i gb, ar;
+		LoadWords_AVX2(src + i * 4, &gb, &ar);
+		__m256i a = PIXEL_NARROW4_AVX2(_mm256_srli_epi16(ar, 8));
+		__m256i r = PIXEL_NARROW4_AVX2(_mm256_and_si256(ar, low));
+		__m256i g = PIXEL_NARROW4_AVX2(_mm256_srli_epi16(gb, 8));
+		__m256i b = PIXEL_NARROW4_AVX2(_mm256_and_si256(gb, low));
+		__m256i p = _mm256_or_si256(_mm256_slli_epi16(a, 12), _mm256_slli_epi16(r, 8));
+		p = _mm256_or_si256(p, _mm256_or_si256(_mm256_slli_epi16(g, 4), b));
+		StorePacked_AVX2(dst + i * 2, p);
+	}
+	_mm256_zeroupper();
+	Pack_A4R4G4B4_SSE2(dst + i * 2, src + i * 4, count - i);
+}
+
+static GFX_PIXEL_AVX2 void Pack_R5G6B5_AVX2(uint8_t *dst, const uint8_t *src, int count)
+{
+	const __m256i low = _mm256_set1_epi16(0xff);
+	int i = 0;
+	for (; i + 16 <= count; i += 16) {
+		__m256i gb, ar;
+		LoadWords_AVX2(src + i * 4, &gb, &ar);
+		__m256i r = PIXEL_NARROW5_AVX2(_mm256_and_si256(ar, low));
+		__m256i g = PIXEL_NARROW6_AVX2(_mm256_srli_epi16(gb, 8));
+		__m256i b = PIXEL_NARROW5_AVX2(_mm256_and_si256(gb, low));
+		__m256i p = _mm256_or_si256(_mm256_slli_epi16(r, 11), _mm256_slli_epi16(g, 5));
+		StorePacked_AVX2(dst + i * 2, _mm256_or_si256(p, b));
+	}
+	_mm256_zeroupper();
+	Pack_R5G6B5_SSE2(dst + i * 2, src + i * 4, count - i);
+}
+
+static GFX_PIXEL_AVX2 inline __m256i Luminance_AVX2(const uint8_t *src)
+{
+	const __m256i low = _mm256_set1_epi16(0xff);
+	__m256i gb, ar;
+	LoadWords_AVX2(src, &gb, &ar);
+	__m256i r = _mm256_mullo_epi16(_mm256_and_si256(ar, low), _mm256_set1_epi16(77));
+	__m256i g = _mm256_mullo_epi16(_mm256_srli_epi16(gb, 8), _mm256_set1_epi16(151));
+	__m256i b = _mm256_mullo_epi16(_mm256_and_si256(gb, low), _mm256_set1_epi16(28));
+	__m256i sum = _mm256_add_epi16(_mm256_add_epi16(r, g),
+			_mm256_add_epi16(b, _mm256_set1_epi16(128)));
+	return _mm256_srli_epi16(sum, 8);
+}
+
+static GFX_PIXEL_AVX2 void Pack_G8_AVX2(uint8_t *dst, const uint8_t *src, int count)
+{
+	const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+	int i = 0;
+	for (; i + 32 <= count; i += 32) {
+		__m256i l0 = Luminance_AVX2(src + i * 4);
+		__m256i l1 = Luminance_AVX2(src + i * 4 + 64);
+		__m256i g = _mm256_packus_epi16(l0, l1);
+		PIXEL_STORE8(dst + i, _mm256_permutevar8x32_epi32(g, order));
+	}
+	_mm256_zeroupper();
+	Pack_G8_SSE2(dst + i, src + i * 4, count - i);
+}
+
+static const PixelKernelSet PixelKernel_AVX2 = {
+	{ Copy32_C, SwapRB_AVX2, SetAlpha_AVX2, Unpack_R8G8B8_AVX2, Unpack_B8G8R8_AVX2,
+	  Unpack_A1R5G5B5_AVX2, Unpack_A4R4G4B4_AVX2, Unpack_R5G6B5_AVX2, Unpack_G8_AVX2 },
+	{ Copy32_C, SwapRB_AVX2, SetAlpha_AVX2, Pack_R8G8B8_AVX2, Pack_B8G8R8_AVX2,
+	  Pack_A1R5G5B5_AVX2, Pack_A4R4G4B4_AVX2, Pack_R5G6B5_AVX2, Pack_G8_AVX2 },
+	Reverse32_AVX2,
+};
+
+
+//---------------------------------------------------------------------
+// cpuid: AVX2 also needs the os to save ymm registers (OSXSAVE and
+// xcr0 bits 1-2)
+//---------------------------------------------------------------------
+static void PixelCpuid(int leaf, uint32_t *regs)
+{
+#if defined(_MSC_VER)
+	int info[4];
+	__cpuidex(info, leaf, 0);
+	for (int i = 0; i < 4; i++) regs[i] = (uint32_t)info[i];
+#else
+	unsigned int a, b, c, d;
+	__cpuid_count(leaf, 0, a, b, c, d);
+	regs[0] = a, regs[1] = b, regs[2] = c, regs[3] = d;
+#endif
+}
+
+static uint32_t PixelXgetbv()
+{
+#if defined(_MSC_VER)
+	return (uint32_t)_xgetbv(0);
+#else
+	uint32_t a, d;
+	__asm__ __volatile__ ("xgetbv" : "=a"(a), "=d"(d) : "c"(0));
+	return a;
+#endif
+}
+
+#endif
+
+
+//---------------------------------------------------------------------
+// kernel selection
+//---------------------------------------------------------------------
+static const PixelKernelSet *volatile PixelKernel_Current = NULL;
+
+PixelKernel DetectPixelKernel()
+{
+	static volatile int detected = -1;
+	if (detected < 0) {
+		int kernel = PIXEL_KERNEL_GENERIC;
+	#if GFX_PIXEL_X86
+		uint32_t regs[4];
+		PixelCpuid(0, regs);
+		uint32_t leaves = regs[0];
+		PixelCpuid(1, regs);
+		if (regs[3] & (1u << 26)) {
+			kernel = PIXEL_KERNEL_SSE2;
+			bool avx = (regs[2] & (1u << 27)) && (regs[2] & (1u << 28));
+			if (avx && (PixelXgetbv() & 6) == 6 && leaves >= 7) {
+				PixelCpuid(7, regs);
+				if (regs[1] & (1u << 5)) {
+					kernel = PIXEL_KERNEL_AVX2;
+				}
+			}
+		}
+	#endif
+		detected = kernel;
+	}
+	return (PixelKernel)detected;
+}
+
+PixelKernel SetPixelKernel(PixelKernel kernel)
+{
+	PixelKernel best = DetectPixelKernel();
+	if (kernel > best) kernel = best;
+	if (kernel < PIXEL_KERNEL_GENERIC) kernel = PIXEL_KERNEL_GENERIC;
+	switch (kernel) {
+#if GFX_PIXEL_X86
+	case PIXEL_KERNEL_AVX2: PixelKernel_Current = &PixelKernel_AVX2; break;
+	case PIXEL_KERNEL_SSE2: PixelKernel_Current = &PixelKernel_SSE2; break;
+#endif
+	default: PixelKernel_Current = &PixelKernel_Generic; break;
+	}
+	return kernel;
+}
+
+PixelKernel GetPixelKernel()
+{
+	const PixelKernelSet *set = PixelKernel_Current;
+	if (set == NULL) {
+		return SetPixelKernel(DetectPixelKernel());
+	}
+#if GFX_PIXEL_X86
+	if (set == &PixelKernel_AVX2) return PIXEL_KERNEL_AVX2;
+	if (set == &PixelKernel_SSE2) return PIXEL_KERNEL_SSE2;
+#endif
+	return PIXEL_KERNEL_GENERIC;
+}
+
+// concurrent first calls all store the same pointer
+static inline const PixelKernelSet* PixelKernel_Get()
+{
+	const PixelKernelSet *set = PixelKernel_Current;
+	if (set == NULL) {
+		SetPixelKernel(DetectPixelKernel());
+		set = PixelKernel_Current;
+	}
+	return set;
+}
+
+
+//---------------------------------------------------------------------
+// conversion
+//---------------------------------------------------------------------
+static inline bool PixelFormatValid(PixelFormat fmt) {
+	return fmt >= FMT_A8R8G8B8 && fmt < FMT_UNKNOWN;
+}
+
+static void ConvertRow(const PixelKernelSet *set, uint8_t *dst, PixelFormat dst_fmt,
+		const uint8_t *src, PixelFormat src_fmt, int count)
+{
+	if (src_fmt == dst_fmt) {
+		memcpy(dst, src, count * (Image::FormatToBpp(src_fmt) / 8));
+	}
+	else if (dst_fmt == FMT_A8R8G8B8) {
+		set->unpack[src_fmt](dst, src, count);
+	}
+	else if (src_fmt == FMT_A8R8G8B8) {
+		set->pack[dst_fmt](dst, src, count);
+	}
+	else {
+		PixelRowProc unpack = set->unpack[src_fmt];
+		PixelRowProc pack = set->pack[dst_fmt];
+		int src_size = Image::FormatToBpp(src_fmt) / 8;
+		int dst_size = Image::FormatToBpp(dst_fmt) / 8;
+		uint32_t argb[PIXEL_CHUNK];
+		for (int i = 0; i < count; i += PIXEL_CHUNK) {
+			int n = (count - i < PIXEL_CHUNK)? (count - i) : PIXEL_CHUNK;
+			unpack((uint8_t*)argb, src + i * src_size, n);
+			pack(dst + i * dst_size, (const uint8_t*)argb, n);
+		}
+	}
+}
+
+// dst[i] = src[count - 1 - i]: chunks are taken from the end of src
+// and reversed as A8R8G8B8, so every pixel is still read and written
+// once and the 16 / 24 bit kernels stay vectorized. same format round
+// trips are exact
+static void ConvertRowReverse(const PixelKernelSet *set, uint8_t *dst, PixelFormat dst_fmt,
+		const uint8_t *src, PixelFormat src_fmt, int count)
+{
+	int src_size = Image::FormatToBpp(src_fmt) / 8;
+	int dst_size = Image::FormatToBpp(dst_fmt) / 8;
+	uint32_t argb[PIXEL_CHUNK];
+	uint32_t flip[PIXEL_CHUNK];
+	for (int i = 0; i < count; i += PIXEL_CHUNK) {
+		int n = (count - i < PIXEL_CHUNK)? (count - i) : PIXEL_CHUNK;
+		const uint8_t *ss = src + (count - i - n) * src_size;
+		uint8_t *dd = dst + i * dst_size;
+		if (src_fmt == dst_fmt && src_size == 4) {
+			set->reverse(dd, ss, n);
+		}
+		else if (src_fmt == FMT_A8R8G8B8) {
+			set->reverse((uint8_t*)flip, ss, n);
+			set->pack[dst_fmt](dd, (const uint8_t*)flip, n);
+		}
+		else if (dst_fmt == FMT_A8R8G8B8) {
+			set->unpack[src_fmt]((uint8_t*)argb, ss, n);
+			set->reverse(dd, (const uint8_t*)argb, n);
+		}
+		else {
+			set->unpack[src_fmt]((uint8_t*)argb, ss, n);
+			set->reverse((uint8_t*)flip, (const uint8_t*)argb, n);
+			set->pack[dst_fmt](dd, (const uint8_t*)flip, n);
+		}
+	}
+}
+
+bool ConvertPixels(void *dst, int32_t dst_pitch, PixelFormat dst_fmt,
+		const void *src, int32_t src_pitch, PixelFormat src_fmt, int w, int h,
+		int mode)
+{
+	if (!PixelFormatValid(dst_fmt) || !PixelFormatValid(src_fmt)) {
+		return false;
+	}
+	const PixelKernelSet *set = PixelKernel_Get();
+	uint8_t *dd = (uint8_t*)dst;
+	const uint8_t *ss = (const uint8_t*)src;
+	if (mode & BLIT_VFLIP) {
+		ss += (ptrdiff_t)src_pitch * (h - 1);
+		src_pitch = -src_pitch;
+	}
+	for (int j = 0; j < h; j++) {
+		if (mode & BLIT_HFLIP) {
+			ConvertRowReverse(set, dd, dst_fmt, ss, src_fmt, w);
+		}
+		else {
+			ConvertRow(set, dd, dst_fmt, ss, src_fmt, w);
+		}
+		dd += dst_pitch;
+		ss += src_pitch;
+	}
+	return true;
+}
+
+bool ConvertPixelRow(void *dst, PixelFormat dst_fmt, const void *src,
+		PixelFormat src_fmt, int count)
+{
+	if (!PixelFormatValid(dst_fmt) || !PixelFormatValid(src_fmt)) {
+		return false;
+	}
+	ConvertRow(PixelKernel_Get(), (uint8_t*)dst, dst_fmt,
+			(const uint8_t*)src, src_fmt, count);
+	return true;
+}
+
+bool UnpackPixelRow(uint32_t *argb, const void *src, PixelFormat fmt, int count)
+{
+	if (!PixelFormatValid(fmt)) {
+		return false;
+	}
+	PixelKernel_Get()->unpack[fmt]((uint8_t*)argb, (const uint8_t*)src, count);
+	return true;
+}
+
+bool PackPixelRow(void *dst, PixelFormat fmt, const uint32_t *argb, int count)
+{
+	if (!PixelFormatValid(fmt)) {
+		return false;
+	}
+	PixelKernel_Get()->pack[fmt]((uint8_t*)dst, (const uint8_t*)argb, count);
+	return true;
+}
+
+
+//---------------------------------------------------------------------
+// Namespace End
+//---------------------------------------------------------------------
+NAMESPACE_END(GFX);
+
+
@@ -0,0 +1,112 @@
+//=====================================================================
+//
+// GFXPixel.h - pixel format conversion and blending
+//
+// Last Modified: 2026/10/18 19:02:41
+//
+//=====================================================================
+#ifndef _GFX_PIXEL_H_
+#define _GFX_PIXEL_H_
+
+#include "GFXImage.h"
+
+
+//---------------------------------------------------------------------
+// x86 kernels are compiled whatever the target options are and only
+// called after cpuid said so: msvc accepts any intrinsic, gcc / clang
+// need the target attribute on every function using them
+//---------------------------------------------------------------------
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+	#define GFX_PIXEL_X86	1
+	#include <emmintrin.h>
+	#include <immintrin.h>
+	#if defined(_MSC_VER)
+		#define GFX_PIXEL_SSE2
+		#define GFX_PIXEL_AVX2
+	#else
+		#define GFX_PIXEL_SSE2	__attribute__((target("sse2")))
+		#define GFX_PIXEL_AVX2	__attribute__((target("avx2")))
+	#endif
+#else
+	#define GFX_PIXEL_X86	0
+#endif
+
+
+//---------------------------------------------------------------------
+// Namespace Begin
+//---------------------------------------------------------------------
+NAMESPACE_BEGIN(GFX);
+
+
+//---------------------------------------------------------------------
+// row kernel sets: chosen from cpuid (and the os saving ymm state) on
+// first use, independent of GFX_PLATFORM so one binary runs at the
+// best level of the machine it is on. every set gives bit identical
+// results
+//---------------------------------------------------------------------
+enum PixelKernel
+{
+	PIXEL_KERNEL_GENERIC = 0,
+	PIXEL_KERNEL_SSE2,
+	PIXEL_KERNEL_AVX2,
+};
+
+// best kernel set the cpu supports
+PixelKernel DetectPixelKernel();
+
+// kernel set in use
+PixelKernel GetPixelKernel();
+
+// select a kernel set (clamped to what the cpu supports), returns the
+// one in effect. for tests and benchmarks, not while other threads
+// are converting
+PixelKernel SetPixelKernel(PixelKernel kernel);
+
+
+//---------------------------------------------------------------------
+// conversion rules: every format goes to and from A8R8G8B8. narrower
+// channels widen by bit replication (5 bits 0x1f -> 0xff) and narrow
+// with round to nearest, so narrow(widen(x)) == x. formats without
+// alpha read as 0xff and X8 is written as 0xff, A1 is set from alpha
+// >= 128. G8 reads as gray and is written as the luminance
+// (77 r + 151 g + 28 b) / 256, the fixed point Color::GetLuminance
+//---------------------------------------------------------------------
+
+// convert a w x h block, pitches in bytes. same formats are copied,
+// returns false for FMT_UNKNOWN. src and dst must not overlap. mode
+// mirrors src as in Image::ClipRect: BLIT_HFLIP / BLIT_VFLIP
+bool ConvertPixels(void *dst, int32_t dst_pitch, PixelFormat dst_fmt,
+		const void *src, int32_t src_pitch, PixelFormat src_fmt, int w, int h,
+		int mode = 0);
+
+// convert count pixels of one row
+bool ConvertPixelRow(void *dst, PixelFormat dst_fmt, const void *src,
+		PixelFormat src_fmt, int count);
+
+// the two halves of every conversion: fmt to A8R8G8B8 and back, for
+// code that works on A8R8G8B8 rows (blend, filter) between them
+bool UnpackPixelRow(uint32_t *argb, const void *src, PixelFormat fmt, int count);
+bool PackPixelRow(void *dst, PixelFormat fmt, const uint32_t *argb, int count);
+
+
+//---------------------------------------------------------------------
+// blending (GFXBlend.cpp): w x h src pixels onto dst with op, dst in
+// A8R8G8B8, X8R8G8B8 or R5G6B5 and src in any format. products are
+// divided by 255 with exact rounding, the simd kernels do 4 (SSE2) or
+// 8 (AVX2) pixels per step and match the generic ones bit for bit.
+// returns false for other formats
+//---------------------------------------------------------------------
+bool BlendPixels(void *dst, int32_t dst_pitch, PixelFormat dst_fmt,
+		const void *src, int32_t src_pitch, PixelFormat src_fmt, int w, int h,
+		BlendOp op, uint32_t color = 0xffffffff);
+
+
+//---------------------------------------------------------------------
+// Namespace End
+//---------------------------------------------------------------------
+NAMESPACE_END(GFX);
+
+
+#endif
+
+
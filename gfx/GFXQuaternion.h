@@ -0,0 +1,308 @@
+//=====================================================================
+//
+// GFXQuaternion.h -
+//
+// Last Modified: 2026/10/18 13:05:22
+//
+//=====================================================================
+#ifndef _GFX_QUATERNION_H_
+#define _GFX_QUATERNION_H_
+
+#include "GFXMath.h"
+#include "GFXVector.h"
+#include "GFXMatrix.h"
+
+
+//---------------------------------------------------------------------
+// Namespace Begin
+//---------------------------------------------------------------------
+NAMESPACE_BEGIN(GFX);
+NAMESPACE_BEGIN(Core);
+
+
+//---------------------------------------------------------------------
+// Quaternion: (x, y, z) is the vector part, w the scalar part.
+// Matrices follow the row-vector convention used by Matrix4, so
+// ToMatrix4(a) * ToMatrix4(b) == ToMatrix4(b * a): apply a then b.
+//---------------------------------------------------------------------
+struct Quaternion
+{
+	union {
+		struct { float x, y, z, w; };
+		float m[4];
+	};
+
+	inline Quaternion() {}
+	inline GFX_CONSTEXPR Quaternion(float ix, float iy, float iz, float iw): x(ix), y(iy), z(iz), w(iw) {}
+	inline GFX_CONSTEXPR Quaternion(const Vector3& v, float iw): x(v.x), y(v.y), z(v.z), w(iw) {}
+
+	inline Quaternion operator + (const Quaternion& q) const {
+		return Quaternion(x + q.x, y + q.y, z + q.z, w + q.w);
+	}
+
+	inline Quaternion operator - (const Quaternion& q) const {
+		return Quaternion(x - q.x, y - q.y, z - q.z, w - q.w);
+	}
+
+	inline Quaternion operator - () const {
+		return Quaternion(-x, -y, -z, -w);
+	}
+
+	inline Quaternion operator * (float k) const {
+		return Quaternion(x * k, y * k, z * k, w * k);
+	}
+
+	// Hamilton product
+	inline Quaternion operator * (const Quaternion& q) const {
+		return Quaternion(
+			w * q.x + x * q.w + y * q.z - z * q.y,
+			w * q.y - x * q.z + y * q.w + z * q.x,
+			w * q.z + x * q.y - y * q.x + z * q.w,
+			w * q.w - x * q.x - y * q.y - z * q.z);
+	}
+
+	inline Quaternion& operator *= (const Quaternion& q) {
+		*this = (*this) * q;
+		return *this;
+	}
+
+	inline Quaternion& operator *= (float k) {
+		x *= k, y *= k, z *= k, w *= k;
+		return *this;
+	}
+
+	inline Quaternion& SetIdentity() {
+		x = y = z = 0.0f;
+		w = 1.0f;
+		return *this;
+	}
+
+	inline Vector3 GetVector() const {
+		return Vector3(x, y, z);
+	}
+
+	inline float Dot(const Quaternion& q) const {
+		return x * q.x + y * q.y + z * q.z + w * q.w;
+	}
+
+	inline float LengthSq() const {
+		return Dot(*this);
+	}
+
+	inline float Length() const {
+		return SquareRoot(LengthSq());
+	}
+
+	inline Quaternion& Normalize() {
+		(*this) *= InverseSquareRoot(LengthSq());
+		return *this;
+	}
+
+	inline Quaternion Conjugate() const {
+		return Quaternion(-x, -y, -z, w);
+	}
+
+	inline Quaternion Inverse() const {
+		return Conjugate() * (1.0f / LengthSq());
+	}
+
+	// rotate v by a unit quaternion: v + 2 r x (r x v + w v)
+	inline Vector3 Rotate(const Vector3& v) const {
+		Vector3 r(x, y, z);
+		Vector3 t = r.Cross(v) + v * w;
+		return v + r.Cross(t) * 2.0f;
+	}
+
+	// axis does not need to be normalized, theta in radians
+	inline Quaternion& SetAxisAngle(float ax, float ay, float az, float theta) {
+		float k = ax * ax + ay * ay + az * az;
+		float s, c;
+		SinCos(theta * 0.5f, &s, &c);
+		k = (k > 0.0f)? (s / SquareRoot(k)) : 0.0f;
+		x = ax * k, y = ay * k, z = az * k, w = c;
+		return *this;
+	}
+
+	inline Matrix3 ToMatrix3() const {
+		Matrix3 m;
+		float x2 = x + x, y2 = y + y, z2 = z + z;
+		float xx = x * x2, yy = y * y2, zz = z * z2;
+		float xy = x * y2, xz = x * z2, yz = y * z2;
+		float wx = w * x2, wy = w * y2, wz = w * z2;
+		m.m00 = 1.0f - yy - zz, m.m01 = xy + wz, m.m02 = xz - wy;
+		m.m10 = xy - wz, m.m11 = 1.0f - xx - zz, m.m12 = yz + wx;
+		m.m20 = xz + wy, m.m21 = yz - wx, m.m22 = 1.0f - xx - yy;
+		return m;
+	}
+
+	inline Matrix4 ToMatrix4() const {
+		Matrix3 r = ToMatrix3();
+		Matrix4 m;
+		m.m00 = r.m00, m.m01 = r.m01, m.m02 = r.m02, m.m03 = 0.0f;
+		m.m10 = r.m10, m.m11 = r.m11, m.m12 = r.m12, m.m13 = 0.0f;
+		m.m20 = r.m20, m.m21 = r.m21, m.m22 = r.m22, m.m23 = 0.0f;
+		m.m30 = 0.0f, m.m31 = 0.0f, m.m32 = 0.0f, m.m33 = 1.0f;
+		return m;
+	}
+
+	// from the rotation part of an orthonormal matrix
+	inline Quaternion& SetMatrix(float m00, float m01, float m02,
+			float m10, float m11, float m12,
+			float m20, float m21, float m22) {
+		float trace = m00 + m11 + m22;
+		if (trace > 0.0f) {
+			float s = SquareRoot(trace + 1.0f) * 2.0f;
+			float k = 1.0f / s;
+			w = 0.25f * s;
+			x = (m12 - m21) * k;
+			y = (m20 - m02) * k;
+			z = (m01 - m10) * k;
+		}
+		else if (m00 > m11 && m00 > m22) {
+			float s = SquareRoot(1.0f + m00 - m11 - m22) * 2.0f;
+			float k = 1.0f / s;
+			w = (m12 - m21) * k;
+			x = 0.25f * s;
+			y = (m10 + m01) * k;
+			z = (m20 + m02) * k;
+		}
+		else if (m11 > m22) {
+			float s = SquareRoot(1.0f + m11 - m00 - m22) * 2.0f;
+			float k = 1.0f / s;
+			w = (m20 - m02) * k;
+			x = (m10 + m01) * k;
+			y = 0.25f * s;
+			z = (m21 + m12) * k;
+		}
+		else {
+			float s = SquareRoot(1.0f + m22 - m00 - m11) * 2.0f;
+			float k = 1.0f / s;
+			w = (m01 - m10) * k;
+			x = (m20 + m02) * k;
+			y = (m21 + m12) * k;
+			z = 0.25f * s;
+		}
+		return *this;
+	}
+
+	inline Quaternion& SetMatrix(const Matrix3& m) {
+		return SetMatrix(m.m00, m.m01, m.m02, m.m10, m.m11, m.m12,
+				m.m20, m.m21, m.m22);
+	}
+
+	inline Quaternion& SetMatrix(const Matrix4& m) {
+		return SetMatrix(m.m00, m.m01, m.m02, m.m10, m.m11, m.m12,
+				m.m20, m.m21, m.m22);
+	}
+
+	// normalized lerp along the shortest arc
+	inline Quaternion Nlerp(const Quaternion& q, float t) const {
+		float k = (Dot(q) < 0.0f)? -t : t;
+		Quaternion r = (*this) * (1.0f - t) + q * k;
+		return r.Normalize();
+	}
+
+	// nlerp with t re-mapped by a polynomial fitted to slerp, costs no
+	// trig, the angular error stays below 2e-3 rad for unit inputs
+	inline Quaternion SlerpFast(const Quaternion& q, float t) const {
+		float d = Abs(Dot(q));
+		float a = 1.0904f + d * (-3.2452f + d * (3.55645f - d * 1.43519f));
+		float b = 0.848013f + d * (-1.06021f + d * 0.215638f);
+		float k = a * (t - 0.5f) * (t - 0.5f) + b;
+		float u = t + t * (t - 0.5f) * (t - 1.0f) * k;
+		return Nlerp(q, u);
+	}
+
+	// exact slerp along the shortest arc, falls back to nlerp when the
+	// two rotations are nearly identical
+	inline Quaternion Slerp(const Quaternion& q, float t) const {
+		float c = Dot(q);
+		float sign = 1.0f;
+		if (c < 0.0f) c = -c, sign = -1.0f;
+		if (c > 0.9995f) {
+			return Nlerp(q, t);
+		}
+		float theta = (float)acos(c);
+		float k = 1.0f / (float)sin(theta);
+		float a = (float)sin((1.0f - t) * theta) * k;
+		float b = (float)sin(t * theta) * k * sign;
+		return (*this) * a + q * b;
+	}
+};
+
+
+//---------------------------------------------------------------------
+// DualQuaternion: rigid transform, real is the rotation and dual is
+// 0.5 * (t, 0) * real for a translation t applied after the rotation
+//---------------------------------------------------------------------
+struct DualQuaternion
+{
+	Quaternion real;
+	Quaternion dual;
+
+	inline DualQuaternion() {}
+	inline GFX_CONSTEXPR DualQuaternion(const Quaternion& r, const Quaternion& d): real(r), dual(d) {}
+
+	inline DualQuaternion(const Quaternion& rotation, const Vector3& translation) {
+		Set(rotation, translation);
+	}
+
+	inline DualQuaternion& Set(const Quaternion& rotation, const Vector3& translation) {
+		real = rotation;
+		dual = Quaternion(translation, 0.0f) * rotation * 0.5f;
+		return *this;
+	}
+
+	// from a rigid Matrix4 (rotation plus translation in row 3)
+	inline DualQuaternion& SetMatrix(const Matrix4& m) {
+		Quaternion r;
+		r.SetMatrix(m);
+		r.Normalize();
+		return Set(r, Vector3(m.m30, m.m31, m.m32));
+	}
+
+	inline Vector3 GetTranslation() const {
+		Quaternion t = dual * real.Conjugate();
+		return Vector3(t.x, t.y, t.z) * 2.0f;
+	}
+
+	inline Matrix4 ToMatrix4() const {
+		Matrix4 m = real.ToMatrix4();
+		Vector3 t = GetTranslation();
+		m.m30 = t.x, m.m31 = t.y, m.m32 = t.z;
+		return m;
+	}
+
+	inline Vector3 TransformPoint(const Vector3& p) const {
+		return real.Rotate(p) + GetTranslation();
+	}
+
+	inline Vector3 TransformNormal(const Vector3& n) const {
+		return real.Rotate(n);
+	}
+
+	inline DualQuaternion& Normalize() {
+		float k = InverseSquareRoot(real.LengthSq());
+		real *= k;
+		dual *= k;
+		return *this;
+	}
+};
+
+
+//---------------------------------------------------------------------
+// operators
+//---------------------------------------------------------------------
+inline Quaternion operator * (float k, const Quaternion& q) { return q * k; }
+
+
+//---------------------------------------------------------------------
+// Namespace End
+//---------------------------------------------------------------------
+NAMESPACE_END(Core);
+NAMESPACE_END(GFX);
+
+
+#endif
+
+
@@ -0,0 +1,467 @@
+//=====================================================================
+//
+// GFXResample.cpp - separable image resampling
+//
+// Last Modified: 2026/10/18 20:21:36
+//
+//=====================================================================
+#include <stddef.h>
+#include <string.h>
+#include <math.h>
+
+#include <vector>
+
+#include "GFXResample.h"
+#include "GFXPixel.h"
+#include "GFXUtil.h"
+
+
+//---------------------------------------------------------------------
+// Namespace Begin
+//---------------------------------------------------------------------
+NAMESPACE_BEGIN(GFX);
+
+
+//---------------------------------------------------------------------
+// fixed point: weights sum to 1 << 14, accumulators start at half
+// of it so the final shift rounds to nearest
+//---------------------------------------------------------------------
+#define RESAMPLE_BITS		14
+#define RESAMPLE_ONE		(1 << RESAMPLE_BITS)
+#define RESAMPLE_HALF		(1 << (RESAMPLE_BITS - 1))
+
+// rows per band are chosen so a band is at least this many pixels
+#define RESAMPLE_GRAIN		65536
+
+
+//---------------------------------------------------------------------
+// filter kernels
+//---------------------------------------------------------------------
+static double ResampleRadius(ResampleFilter filter)
+{
+	switch (filter) {
+	case RESAMPLE_BOX: return 0.5;
+	case RESAMPLE_BILINEAR: return 1.0;
+	case RESAMPLE_BICUBIC: return 2.0;
+	case RESAMPLE_LANCZOS3: return 3.0;
+	}
+	return 1.0;
+}
+
+static double ResampleSinc(double x)
+{
+	if (x == 0.0) return 1.0;
+	x *= 3.14159265358979323846;
+	return sin(x) / x;
+}
+
+static double ResampleKernel(ResampleFilter filter, double x)
+{
+	if (x < 0.0) x = -x;
+	switch (filter) {
+	case RESAMPLE_BOX:
+		return (x < 0.5)? 1.0 : 0.0;
+	case RESAMPLE_BILINEAR:
+		return (x < 1.0)? (1.0 - x) : 0.0;
+	case RESAMPLE_BICUBIC:
+		if (x < 1.0) return (1.5 * x - 2.5) * x * x + 1.0;
+		if (x < 2.0) return ((-0.5 * x + 2.5) * x - 4.0) * x + 2.0;
+		return 0.0;
+	case RESAMPLE_LANCZOS3:
+		return (x < 3.0)? ResampleSinc(x) * ResampleSinc(x / 3.0) : 0.0;
+	}
+	return 0.0;
+}
+
+
+//---------------------------------------------------------------------
+// ResampleTable - for output i the taps are source [start[i],
+// start[i] + taps), weights[i * taps + k]. taps is the same for every
+// output and a multiple of align, unused taps have weight 0 (and may
+// point past the source, see ResampleHorizontal)
+//---------------------------------------------------------------------
+struct ResampleTable
+{
+	int taps;
+	std::vector<int> start;
+	std::vector<int16_t> weights;
+};
+
+static void ResampleTable_Init(ResampleTable& table, int src_size, int dst_size,
+		ResampleFilter filter, int align)
+{
+	double scale = (double)src_size / (double)dst_size;
+	double stretch = (scale > 1.0)? scale : 1.0;
+	double radius = ResampleRadius(filter) * stretch;
+	int taps = (int)ceil(radius * 2.0) + 2;
+	taps = (taps + align - 1) / align * align;
+	table.taps = taps;
+	table.start.resize(dst_size);
+	table.weights.assign((size_t)dst_size * taps, 0);
+	std::vector<double> w(taps);
+	for (int i = 0; i < dst_size; i++) {
+		double center = (i + 0.5) * scale;
+		int left = (int)floor(center - radius);
+		int right = (int)ceil(center + radius);
+		if (left < 0) left = 0;
+		if (right > src_size) right = src_size;
+		if (right - left > taps) right = left + taps;
+		double sum = 0.0;
+		for (int k = left; k < right; k++) {
+			w[k - left] = ResampleKernel(filter, (k + 0.5 - center) / stretch);
+			sum += w[k - left];
+		}
+		int16_t *out = &table.weights[(size_t)i * taps];
+		table.start[i] = left;
+		if (sum < 1e-8) {
+			// nothing inside the source (tiny box filters), take the nearest
+			int k = (int)center;
+			table.start[i] = (k < src_size)? k : (src_size - 1);
+			out[0] = RESAMPLE_ONE;
+			continue;
+		}
+		// quantize, the rounding error goes to the largest weight so
+		// a flat color stays exactly flat
+		int total = 0, largest = 0;
+		for (int k = 0; k < right - left; k++) {
+			int q = (int)floor(w[k] / sum * RESAMPLE_ONE + 0.5);
+			out[k] = (int16_t)q;
+			total += q;
+			if (out[k] > out[largest]) largest = k;
+		}
+		out[largest] = (int16_t)(out[largest] + (RESAMPLE_ONE - total));
+	}
+}
+
+
+//---------------------------------------------------------------------
+// kernels: a horizontal one filters a whole row (src padded by taps
+// pixels), a vertical one combines taps rows into one, both A8R8G8B8
+//---------------------------------------------------------------------
+typedef void (*ResampleRowProc)(uint8_t *dst, const uint8_t *src, int count,
+		const ResampleTable& table);
+typedef void (*ResampleColumnProc)(uint8_t *dst, const uint8_t *const *rows,
+		const int16_t *weights, int taps, int count);
+
+struct ResampleKernels
+{
+	ResampleRowProc horizontal;
+	ResampleColumnProc vertical;
+};
+
+static inline uint8_t ResampleClamp(int32_t x)
+{
+	x >>= RESAMPLE_BITS;
+	return (uint8_t)((x < 0)? 0 : ((x > 255)? 255 : x));
+}
+
+static void Horizontal_C(uint8_t *dst, const uint8_t *src, int count,
+		const ResampleTable& table)
+{
+	int taps = table.taps;
+	for (int i = 0; i < count; i++) {
+		const uint8_t *p = src + table.start[i] * 4;
+		const int16_t *w = &table.weights[(size_t)i * taps];
+		int32_t acc[4] = { RESAMPLE_HALF, RESAMPLE_HALF, RESAMPLE_HALF, RESAMPLE_HALF };
+		for (int k = 0; k < taps; k++, p += 4) {
+			for (int c = 0; c < 4; c++) acc[c] += w[k] * p[c];
+		}
+		for (int c = 0; c < 4; c++) dst[i * 4 + c] = ResampleClamp(acc[c]);
+	}
+}
+
+static void Vertical_C(uint8_t *dst, const uint8_t *const *rows,
+		const int16_t *weights, int taps, int count)
+{
+	for (int i = 0; i < count * 4; i++) {
+		int32_t acc = RESAMPLE_HALF;
+		for (int k = 0; k < taps; k++) {
+			acc += weights[k] * rows[k][i];
+		}
+		dst[i] = ResampleClamp(acc);
+	}
+}
+
+static const ResampleKernels ResampleKernel_Generic = { Horizontal_C, Vertical_C };
+
+
+#if GFX_PIXEL_X86
+
+//---------------------------------------------------------------------
+// SSE2: pmaddwd on two taps whose channels are interleaved as
+// (b0 b1 g0 g1 r0 r1 a0 a1) against (w0 w1) pairs
+//---------------------------------------------------------------------
+static GFX_PIXEL_SSE2 inline uint32_t Finish_SSE2(__m128i acc)
+{
+	acc = _mm_srai_epi32(acc, RESAMPLE_BITS);
+	acc = _mm_packs_epi32(acc, acc);
+	return (uint32_t)_mm_cvtsi128_si32(_mm_packus_epi16(acc, acc));
+}
+
+static GFX_PIXEL_SSE2 void Horizontal_SSE2(uint8_t *dst, const uint8_t *src, int count,
+		const ResampleTable& table)
+{
+	const __m128i zero = _mm_setzero_si128();
+	int taps = table.taps;
+	for (int i = 0; i < count; i++) {
+		const uint8_t *p = src + table.start[i] * 4;
+		const int16_t *w = &table.weights[(size_t)i * taps];
+		__m128i acc = _mm_set1_epi32(RESAMPLE_HALF);
+		for (int k = 0; k < taps; k += 2) {
+			__m128i x = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(p + k * 4)), zero);
+			x = _mm_unpacklo_epi16(x, _mm_srli_si128(x, 8));
+			int32_t pair;
+			memcpy(&pair, w + k, 4);
+			acc = _mm_add_epi32(acc, _mm_madd_epi16(x, _mm_set1_epi32(pair)));
+		}
+		uint32_t c = Finish_SSE2(acc);
+		memcpy(dst + i * 4, &c, 4);
+	}
+}
+
+// taps rows pairwise, four pixels per step. an odd last tap pairs
+// with itself at weight 0
+static GFX_PIXEL_SSE2 void Vertical_SSE2(uint8_t *dst, const uint8_t *const *rows,
+		const int16_t *weights, int taps, int count)
+{
+	const __m128i zero = _mm_setzero_si128();
+	int x = 0;
+	for (; x + 4 <= count; x += 4) {
+		__m128i acc0 = _mm_set1_epi32(RESAMPLE_HALF);
+		__m128i acc1 = acc0, acc2 = acc0, acc3 = acc0;
+		for (int k = 0; k < taps; k += 2) {
+			int k1 = (k + 1 < taps)? (k + 1) : k;
+			uint32_t w1 = (k + 1 < taps)? (uint16_t)weights[k + 1] : 0;
+			__m128i w = _mm_set1_epi32((int)((uint16_t)weights[k] | (w1 << 16)));
+			__m128i a = _mm_loadu_si128((const __m128i*)(rows[k] + x * 4));
+			__m128i b = _mm_loadu_si128((const __m128i*)(rows[k1] + x * 4));
+			__m128i alo = _mm_unpacklo_epi8(a, zero);
+			__m128i blo = _mm_unpacklo_epi8(b, zero);
+			__m128i ahi = _mm_unpackhi_epi8(a, zero);
+			__m128i bhi = _mm_unpackhi_epi8(b, zero);
+			acc0 = _mm_add_epi32(acc0, _mm_madd_epi16(_mm_unpacklo_epi16(alo, blo), w));
+			acc1 = _mm_add_epi32(acc1, _mm_madd_epi16(_mm_unpackhi_epi16(alo, blo), w));
+			acc2 = _mm_add_epi32(acc2, _mm_madd_epi16(_mm_unpacklo_epi16(ahi, bhi), w));
+			acc3 = _mm_add_epi32(acc3, _mm_madd_epi16(_mm_unpackhi_epi16(ahi, bhi), w));
+		}
+		__m128i lo = _mm_packs_epi32(_mm_srai_epi32(acc0, RESAMPLE_BITS),
+				_mm_srai_epi32(acc1, RESAMPLE_BITS));
+		__m128i hi = _mm_packs_epi32(_mm_srai_epi32(acc2, RESAMPLE_BITS),
+				_mm_srai_epi32(acc3, RESAMPLE_BITS));
+		_mm_storeu_si128((__m128i*)(dst + x * 4), _mm_packus_epi16(lo, hi));
+	}
+	for (int i = x * 4; i < count * 4; i++) {
+		int32_t acc = RESAMPLE_HALF;
+		for (int k = 0; k < taps; k++) acc += weights[k] * rows[k][i];
+		dst[i] = ResampleClamp(acc);
+	}
+}
+
+static const ResampleKernels ResampleKernel_SSE2 = { Horizontal_SSE2, Vertical_SSE2 };
+
+
+//---------------------------------------------------------------------
+// AVX2: four taps per pmaddwd in the horizontal pass (two per lane),
+// eight pixels per step in the vertical one
+//---------------------------------------------------------------------
+static GFX_PIXEL_AVX2 void Horizontal_AVX2(uint8_t *dst, const uint8_t *src, int count,
+		const ResampleTable& table)
+{
+	const __m256i pairs = _mm256_setr_epi8(
+			0, 1, 8, 9, 2, 3, 10, 11, 4, 5, 12, 13, 6, 7, 14, 15,
+			0, 1, 8, 9, 2, 3, 10, 11, 4, 5, 12, 13, 6, 7, 14, 15);
+	const __m256i spread = _mm256_setr_epi32(0, 0, 0, 0, 1, 1, 1, 1);
+	int taps = table.taps;
+	for (int i = 0; i < count; i++) {
+		const uint8_t *p = src + table.start[i] * 4;
+		const int16_t *w = &table.weights[(size_t)i * taps];
+		__m256i acc = _mm256_setzero_si256();
+		for (int k = 0; k < taps; k += 4) {
+			__m128i x4 = _mm_loadu_si128((const __m128i*)(p + k * 4));
+			__m256i x = _mm256_shuffle_epi8(_mm256_cvtepu8_epi16(x4), pairs);
+			__m128i w4 = _mm_loadl_epi64((const __m128i*)(w + k));
+			__m256i ww = _mm256_permutevar8x32_epi32(_mm256_castsi128_si256(w4), spread);
+			acc = _mm256_add_epi32(acc, _mm256_madd_epi16(x, ww));
+		}
+		__m128i sum = _mm_add_epi32(_mm256_castsi256_si128(acc),
+				_mm256_extracti128_si256(acc, 1));
+		uint32_t c = Finish_SSE2(_mm_add_epi32(sum, _mm_set1_epi32(RESAMPLE_HALF)));
+		memcpy(dst + i * 4, &c, 4);
+	}
+	_mm256_zeroupper();
+}
+
+static GFX_PIXEL_AVX2 void Vertical_AVX2(uint8_t *dst, const uint8_t *const *rows,
+		const int16_t *weights, int taps, int count)
+{
+	const __m256i zero = _mm256_setzero_si256();
+	int x = 0;
+	for (; x + 8 <= count; x += 8) {
+		__m256i acc0 = _mm256_set1_epi32(RESAMPLE_HALF);
+		__m256i acc1 = acc0, acc2 = acc0, acc3 = acc0;
+		for (int k = 0; k < taps; k += 2) {
+			int k1 = (k + 1 < taps)? (k + 1) : k;
+			uint32_t w1 = (k + 1 < taps)? (uint16_t)weights[k + 1] : 0;
+			__m256i w = _mm256_set1_epi32((int)((uint16_t)weights[k] | (w1 << 16)));
+			__m256i a = _mm256_loadu_si256((const __m256i*)(rows[k] + x * 4));
+			__m256i b = _mm256_loadu_si256((const __m256i*)(rows[k1] + x * 4));
+			__m256i alo = _mm256_unpacklo_epi8(a, zero);
+			__m256i blo = _mm256_unpacklo_epi8(b, zero);
+			__m256i ahi = _mm256_unpackhi_epi8(a, zero);
+			__m256i bhi = _mm256_unpackhi_epi8(b, zero);
+			acc0 = _mm256_add_epi32(acc0, _mm256_madd_epi16(_mm256_unpacklo_epi16(alo, blo), w));
+			acc1 = _mm256_add_epi32(acc1, _mm256_madd_epi16(_mm256_unpackhi_epi16(alo, blo), w));
+			acc2 = _mm256_add_epi32(acc2, _mm256_madd_epi16(_mm256_unpacklo_epi16(ahi, bhi), w));
+			acc3 = _mm256_add_epi32(acc3, _mm256_madd_epi16(_mm256_unpackhi_epi16(ahi, bhi), w));
+		}
+		__m256i lo = _mm256_packs_epi32(_mm256_srai_epi32(acc0, RESAMPLE_BITS),
+				_mm256_srai_epi32(acc1, RESAMPLE_BITS));
+		__m256i hi = _mm256_packs_epi32(_mm256_srai_epi32(acc2, RESAMPLE_BITS),
+				_mm256_srai_epi32(acc3, RESAMPLE_BITS));
+		_mm256_storeu_si256((__m256i*)(dst + x * 4), _mm256_packus_epi16(lo, hi));
+	}
+	_mm256_zeroupper();
+	for (int i = x * 4; i < count * 4; i++) {
+		int32_t acc = RESAMPLE_HALF;
+		for (int k = 0; k < taps; k++) acc += weights[k] * rows[k][i];
+		dst[i] = ResampleClamp(acc);
+	}
+}
+
+static const ResampleKernels ResampleKernel_AVX2 = { Horizontal_AVX2, Vertical_AVX2 };
+
+#endif
+
+
+//---------------------------------------------------------------------
+// passes
+//---------------------------------------------------------------------
+struct ResampleJob
+{
+	const ResampleKernels *kernels;
+	const uint8_t *src;
+	int32_t src_pitch;
+	PixelFormat src_fmt;
+	int sw, sh;
+	uint8_t *dst;
+	int32_t dst_pitch;
+	PixelFormat dst_fmt;
+	int dw, dh;
+	ResampleTable htable;
+	ResampleTable vtable;
+	std::vector<uint32_t> buffer;		// sh x dw after the horizontal pass
+};
+
+// source rows [begin, end) into the buffer, each unpacked into a row
+// with taps zero pixels after it so every tap can be read
+static void ResampleHorizontal(void *ctx, int begin, int end)
+{
+	ResampleJob *job = (ResampleJob*)ctx;
+	std::vector<uint32_t> row(job->sw + job->htable.taps, 0);
+	for (int y = begin; y < end; y++) {
+		uint32_t *out = &job->buffer[(size_t)y * job->dw];
+		const uint8_t *line = job->src + (ptrdiff_t)job->src_pitch * y;
+		if (job->sw == job->dw) {
+			UnpackPixelRow(out, line, job->src_fmt, job->sw);
+			continue;
+		}
+		UnpackPixelRow(&row[0], line, job->src_fmt, job->sw);
+		job->kernels->horizontal((uint8_t*)out, (const uint8_t*)&row[0],
+				job->dw, job->htable);
+	}
+}
+
+// output rows [begin, end), taps past the last row have weight 0 and
+// read the last row
+static void ResampleVertical(void *ctx, int begin, int end)
+{
+	ResampleJob *job = (ResampleJob*)ctx;
+	int taps = job->vtable.taps;
+	std::vector<const uint8_t*> rows(taps);
+	std::vector<uint32_t> line(job->dst_fmt == FMT_A8R8G8B8? 0 : job->dw);
+	for (int y = begin; y < end; y++) {
+		uint8_t *out = job->dst + (ptrdiff_t)job->dst_pitch * y;
+		uint8_t *argb = line.empty()? out : (uint8_t*)&line[0];
+		if (job->sh == job->dh) {
+			memcpy(argb, &job->buffer[(size_t)y * job->dw], job->dw * 4);
+		}
+		else {
+			int start = job->vtable.start[y];
+			for (int k = 0; k < taps; k++) {
+				int sy = (start + k < job->sh)? (start + k) : (job->sh - 1);
+				rows[k] = (const uint8_t*)&job->buffer[(size_t)sy * job->dw];
+			}
+			job->kernels->vertical(argb, &rows[0],
+					&job->vtable.weights[(size_t)y * taps], taps, job->dw);
+		}
+		if (!line.empty()) {
+			PackPixelRow(out, job->dst_fmt, &line[0], job->dw);
+		}
+	}
+}
+
+
+//---------------------------------------------------------------------
+// resample
+//---------------------------------------------------------------------
+bool ResamplePixels(void *dst, int32_t dst_pitch, PixelFormat dst_fmt, int dw, int dh,
+		const void *src, int32_t src_pitch, PixelFormat src_fmt, int sw, int sh,
+		ResampleFilter filter, int threads)
+{
+	if (dst_fmt < FMT_A8R8G8B8 || dst_fmt >= FMT_UNKNOWN) return false;
+	if (src_fmt < FMT_A8R8G8B8 || src_fmt >= FMT_UNKNOWN) return false;
+	if (dw <= 0 || dh <= 0 || sw <= 0 || sh <= 0) return false;
+	ResampleJob job;
+	job.kernels = &ResampleKernel_Generic;
+#if GFX_PIXEL_X86
+	switch (GetPixelKernel()) {
+	case PIXEL_KERNEL_AVX2: job.kernels = &ResampleKernel_AVX2; break;
+	case PIXEL_KERNEL_SSE2: job.kernels = &ResampleKernel_SSE2; break;
+	default: break;
+	}
+#endif
+	job.src = (const uint8_t*)src;
+	job.src_pitch = src_pitch;
+	job.src_fmt = src_fmt;
+	job.sw = sw;
+	job.sh = sh;
+	job.dst = (uint8_t*)dst;
+	job.dst_pitch = dst_pitch;
+	job.dst_fmt = dst_fmt;
+	job.dw = dw;
+	job.dh = dh;
+	ResampleTable_Init(job.htable, sw, dw, filter, 4);
+	ResampleTable_Init(job.vtable, sh, dh, filter, 1);
+	job.buffer.resize((size_t)sh * dw);
+	int hgrain = RESAMPLE_GRAIN / (sw + dw) + 1;
+	int vgrain = RESAMPLE_GRAIN / dw + 1;
+	ParallelFor(sh, hgrain, threads, ResampleHorizontal, &job);
+	ParallelFor(dh, vgrain, threads, ResampleVertical, &job);
+	return true;
+}
+
+bool ResampleImage(Image *dst, const Image *src, ResampleFilter filter, int threads)
+{
+	return ResamplePixels(dst->GetBits(), dst->GetPitch(), dst->GetFormat(),
+			dst->GetWidth(), dst->GetHeight(), src->GetBits(), src->GetPitch(),
+			src->GetFormat(), src->GetWidth(), src->GetHeight(), filter, threads);
+}
+
+Image* ResizeImage(const Image *src, int w, int h, ResampleFilter filter, int threads)
+{
+	if (w <= 0 || h <= 0) return NULL;
+	Image *image = new Image(w, h, src->GetFormat());
+	if (!ResampleImage(image, src, filter, threads)) {
+		delete image;
+		return NULL;
+	}
+	return image;
+}
+
+
+//---------------------------------------------------------------------
+// Namespace End
+//---------------------------------------------------------------------
+NAMESPACE_END(GFX);
+
+
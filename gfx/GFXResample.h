@@ -0,0 +1,62 @@
+//=====================================================================
+//
+// GFXResample.h - separable image resampling
+//
+// Last Modified: 2026/10/18 20:21:36
+//
+//=====================================================================
+#ifndef _GFX_RESAMPLE_H_
+#define _GFX_RESAMPLE_H_
+
+#include "GFXImage.h"
+
+
+//---------------------------------------------------------------------
+// Namespace Begin
+//---------------------------------------------------------------------
+NAMESPACE_BEGIN(GFX);
+
+
+//---------------------------------------------------------------------
+// Filters, widened by the scale factor when shrinking so every source
+// pixel contributes
+//---------------------------------------------------------------------
+enum ResampleFilter
+{
+	RESAMPLE_BOX = 0,		// nearest when enlarging, area average when shrinking
+	RESAMPLE_BILINEAR,		// triangle, radius 1
+	RESAMPLE_BICUBIC,		// Catmull-Rom, radius 2
+	RESAMPLE_LANCZOS3,		// windowed sinc, radius 3
+};
+
+
+//---------------------------------------------------------------------
+// horizontal pass into an A8R8G8B8 buffer, then vertical pass into dst.
+// weights are 1.14 fixed point tables built once per axis, the inner
+// loops are multiply-adds of two (SSE2) or four (AVX2) taps, and the
+// rows of each pass are split across threads (<= 0: one per core,
+// small images stay on the calling thread). channels are filtered
+// independently (straight alpha) and the result is clamped to 0-255.
+// formats are converted on the way in and out.
+// returns false for an unknown format or an empty size
+//---------------------------------------------------------------------
+bool ResamplePixels(void *dst, int32_t dst_pitch, PixelFormat dst_fmt, int dw, int dh,
+		const void *src, int32_t src_pitch, PixelFormat src_fmt, int sw, int sh,
+		ResampleFilter filter, int threads = 0);
+
+// all of src into all of dst
+bool ResampleImage(Image *dst, const Image *src, ResampleFilter filter, int threads = 0);
+
+// new image of w x h in the format of src, NULL on failure
+Image* ResizeImage(const Image *src, int w, int h, ResampleFilter filter, int threads = 0);
+
+
+//---------------------------------------------------------------------
+// Namespace End
+//---------------------------------------------------------------------
+NAMESPACE_END(GFX);
+
+
+#endif
+
+
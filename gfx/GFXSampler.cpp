@@ -0,0 +1,659 @@
+//=====================================================================
+//
+// GFXSampler.cpp - software texture sampling
+//
+// Last Modified: 2026/10/18 23:48:31
+//
+//=====================================================================
+#include <stddef.h>
+#include <string.h>
+#include <math.h>
+
+#include "GFXSampler.h"
+#include "GFXMipmap.h"
+#include "GFXPixel.h"
+
+
+//---------------------------------------------------------------------
+// Namespace Begin
+//---------------------------------------------------------------------
+NAMESPACE_BEGIN(GFX);
+
+
+// samples per pass through the kernels (stack buffers)
+#define SAMPLER_CHUNK		64
+
+// coordinates are clamped to +-2^23 before wrapping, beyond it every
+// float is an integer and the (int) conversions stay in range
+#define SAMPLER_RANGE		8388608.0f
+
+#define SAMPLER_MAX_ANISOTROPY	16
+
+
+//---------------------------------------------------------------------
+// addressing: u is brought into [0, 1] in float, the integer texel
+// coordinates are then fixed up at the edges. the SIMD versions below
+// repeat these operations one by one, SamplerFloor is the truncation
+// trick they use rather than floorf
+//---------------------------------------------------------------------
+static inline float SamplerFloor(float x)
+{
+	float t = (float)(int)x;
+	return (t > x)? (t - 1.0f) : t;
+}
+
+static inline float SamplerAddress_C(float u, int mode)
+{
+	if (mode == SAMPLER_CLAMP) {
+		return (u < 1.0f)? ((u > 0.0f)? u : 0.0f) : 1.0f;
+	}
+	u = (u < SAMPLER_RANGE)? ((u > -SAMPLER_RANGE)? u : -SAMPLER_RANGE) : SAMPLER_RANGE;
+	if (mode == SAMPLER_WRAP) {
+		return u - SamplerFloor(u);
+	}
+	float m = u - 2.0f * SamplerFloor(u * 0.5f);
+	return (m > 1.0f)? (2.0f - m) : m;
+}
+
+// bilinear neighbours x0, x0 + 1 of a texel coordinate in [-1, size - 1]
+static inline void SamplerEdge_C(int& x0, int& x1, int size, int mode)
+{
+	x1 = x0 + 1;
+	if (mode == SAMPLER_WRAP) {
+		x0 = (x0 < 0)? (size - 1) : x0;
+		x1 = (x1 > size - 1)? 0 : x1;
+	}
+	else {
+		x0 = (x0 < 0)? 0 : x0;
+		x1 = (x1 > size - 1)? (size - 1) : x1;
+	}
+}
+
+// 8 bit weights, columns first then rows, each rounded
+static inline uint32_t SamplerBlend_C(uint32_t c00, uint32_t c01, uint32_t c10,
+		uint32_t c11, int fx, int fy)
+{
+	uint32_t c = 0;
+	for (int k = 0; k < 32; k += 8) {
+		int a = (c00 >> k) & 0xff, b = (c01 >> k) & 0xff;
+		int d = (c10 >> k) & 0xff, e = (c11 >> k) & 0xff;
+		int top = (a * (256 - fx) + b * fx + 128) >> 8;
+		int bottom = (d * (256 - fx) + e * fx + 128) >> 8;
+		c |= (uint32_t)((top * (256 - fy) + bottom * fy + 128) >> 8) << k;
+	}
+	return c;
+}
+
+
+//---------------------------------------------------------------------
+// span kernels: count samples of one level
+//---------------------------------------------------------------------
+typedef void (*SamplerSpanProc)(uint32_t *dst, const float *u, const float *v,
+		int count, const Sampler::Level& level, int au, int av);
+
+struct SamplerKernels
+{
+	SamplerSpanProc point;
+	SamplerSpanProc bilinear;
+};
+
+static void SamplerPoint_C(uint32_t *dst, const float *u, const float *v,
+		int count, const Sampler::Level& level, int au, int av)
+{
+	float fw = (float)level.width, fh = (float)level.height;
+	for (int i = 0; i < count; i++) {
+		int x = (int)(SamplerAddress_C(u[i], au) * fw);
+		int y = (int)(SamplerAddress_C(v[i], av) * fh);
+		x = (x > level.width - 1)? (level.width - 1) : x;
+		y = (y > level.height - 1)? (level.height - 1) : y;
+		dst[i] = level.texels[y * level.pitch + x];
+	}
+}
+
+static void SamplerBilinear_C(uint32_t *dst, const float *u, const float *v,
+		int count, const Sampler::Level& level, int au, int av)
+{
+	float fw = (float)level.width, fh = (float)level.height;
+	for (int i = 0; i < count; i++) {
+		float x = SamplerAddress_C(u[i], au) * fw - 0.5f;
+		float y = SamplerAddress_C(v[i], av) * fh - 0.5f;
+		float xf = SamplerFloor(x), yf = SamplerFloor(y);
+		int x0 = (int)xf, y0 = (int)yf, x1, y1;
+		int fx = (int)((x - xf) * 256.0f);
+		int fy = (int)((y - yf) * 256.0f);
+		SamplerEdge_C(x0, x1, level.width, au);
+		SamplerEdge_C(y0, y1, level.height, av);
+		const uint32_t *r0 = level.texels + y0 * level.pitch;
+		const uint32_t *r1 = level.texels + y1 * level.pitch;
+		dst[i] = SamplerBlend_C(r0[x0], r0[x1], r1[x0], r1[x1], fx, fy);
+	}
+}
+
+static const SamplerKernels SamplerKernel_Generic = {
+	SamplerPoint_C, SamplerBilinear_C };
+
+
+#if GFX_PIXEL_X86
+
+//---------------------------------------------------------------------
+// SSE2: 4 samples per step, texels loaded one by one
+//---------------------------------------------------------------------
+static GFX_PIXEL_SSE2 inline __m128 SamplerFloor_SSE2(__m128 x)
+{
+	__m128 t = _mm_cvtepi32_ps(_mm_cvttps_epi32(x));
+	return _mm_sub_ps(t, _mm_and_ps(_mm_cmpgt_ps(t, x), _mm_set1_ps(1.0f)));
+}
+
+static GFX_PIXEL_SSE2 inline __m128 SamplerAddress_SSE2(__m128 u, int mode)
+{
+	if (mode == SAMPLER_CLAMP) {
+		return _mm_max_ps(_mm_min_ps(u, _mm_set1_ps(1.0f)), _mm_setzero_ps());
+	}
+	u = _mm_max_ps(_mm_min_ps(u, _mm_set1_ps(SAMPLER_RANGE)), _mm_set1_ps(-SAMPLER_RANGE));
+	if (mode == SAMPLER_WRAP) {
+		return _mm_sub_ps(u, SamplerFloor_SSE2(u));
+	}
+	__m128 f = SamplerFloor_SSE2(_mm_mul_ps(u, _mm_set1_ps(0.5f)));
+	__m128 m = _mm_sub_ps(u, _mm_mul_ps(_mm_set1_ps(2.0f), f));
+	__m128 over = _mm_cmpgt_ps(m, _mm_set1_ps(1.0f));
+	__m128 back = _mm_sub_ps(_mm_set1_ps(2.0f), m);
+	return _mm_or_ps(_mm_and_ps(over, back), _mm_andnot_ps(over, m));
+}
+
+static GFX_PIXEL_SSE2 inline void SamplerEdge_SSE2(__m128i& x0, __m128i& x1,
+		__m128i last, int mode)
+{
+	__m128i zero = _mm_setzero_si128();
+	x1 = _mm_add_epi32(x0, _mm_set1_epi32(1));
+	__m128i under = _mm_cmplt_epi32(x0, zero);
+	__m128i over = _mm_cmpgt_epi32(x1, last);
+	if (mode == SAMPLER_WRAP) {
+		x0 = _mm_or_si128(_mm_and_si128(under, last), _mm_andnot_si128(under, x0));
+		x1 = _mm_andnot_si128(over, x1);
+	}
+	else {
+		x0 = _mm_andnot_si128(under, x0);
+		x1 = _mm_or_si128(_mm_and_si128(over, last), _mm_andnot_si128(over, x1));
+	}
+}
+
+// weights of 4 samples (32 bit lanes) spread over the 4 channels of
+// samples 0, 1 (lo) and 2, 3 (hi) as 16 bit lanes
+static GFX_PIXEL_SSE2 inline void SamplerSpread_SSE2(__m128i w, __m128i& lo, __m128i& hi)
+{
+	w = _mm_packs_epi32(w, w);
+	w = _mm_unpacklo_epi16(w, w);
+	lo = _mm_unpacklo_epi32(w, w);
+	hi = _mm_unpackhi_epi32(w, w);
+}
+
+static GFX_PIXEL_SSE2 inline __m128i SamplerLerp_SSE2(__m128i a, __m128i b, __m128i w)
+{
+	__m128i iw = _mm_sub_epi16(_mm_set1_epi16(256), w);
+	__m128i x = _mm_add_epi16(_mm_mullo_epi16(a, iw), _mm_mullo_epi16(b, w));
+	return _mm_srli_epi16(_mm_add_epi16(x, _mm_set1_epi16(128)), 8);
+}
+
+static GFX_PIXEL_SSE2 inline __m128i SamplerBlend_SSE2(__m128i c00, __m128i c01,
+		__m128i c10, __m128i c11, __m128i fx, __m128i fy)
+{
+	__m128i zero = _mm_setzero_si128();
+	__m128i xl, xh, yl, yh;
+	SamplerSpread_SSE2(fx, xl, xh);
+	SamplerSpread_SSE2(fy, yl, yh);
+	__m128i tl = SamplerLerp_SSE2(_mm_unpacklo_epi8(c00, zero), _mm_unpacklo_epi8(c01, zero), xl);
+	__m128i th = SamplerLerp_SSE2(_mm_unpackhi_epi8(c00, zero), _mm_unpackhi_epi8(c01, zero), xh);
+	__m128i bl = SamplerLerp_SSE2(_mm_unpacklo_epi8(c10, zero), _mm_unpacklo_epi8(c11, zero), xl);
+	__m128i bh = SamplerLerp_SSE2(_mm_unpackhi_epi8(c10, zero), _mm_unpackhi_epi8(c11, zero), xh);
+	return _mm_packus_epi16(SamplerLerp_SSE2(tl, bl, yl), SamplerLerp_SSE2(th, bh, yh));
+}
+
+static GFX_PIXEL_SSE2 void SamplerPoint_SSE2(uint32_t *dst, const float *u, const float *v,
+		int count, const Sampler::Level& level, int au, int av)
+{
+	__m128 fw = _mm_set1_ps((float)level.width);
+	__m128 fh = _mm_set1_ps((float)level.height);
+	__m128i w1 = _mm_set1_epi32(level.width - 1);
+	__m128i h1 = _mm_set1_epi32(level.height - 1);
+	int32_t xs[4], ys[4];
+	int i = 0;
+	for (; i + 4 <= count; i += 4) {
+		__m128i x = _mm_cvttps_epi32(_mm_mul_ps(SamplerAddress_SSE2(_mm_loadu_ps(u + i), au), fw));
+		__m128i y = _mm_cvttps_epi32(_mm_mul_ps(SamplerAddress_SSE2(_mm_loadu_ps(v + i), av), fh));
+		__m128i mx = _mm_cmpgt_epi32(x, w1);
+		__m128i my = _mm_cmpgt_epi32(y, h1);
+		x = _mm_or_si128(_mm_and_si128(mx, w1), _mm_andnot_si128(mx, x));
+		y = _mm_or_si128(_mm_and_si128(my, h1), _mm_andnot_si128(my, y));
+		_mm_storeu_si128((__m128i*)xs, x);
+		_mm_storeu_si128((__m128i*)ys, y);
+		for (int k = 0; k < 4; k++) {
+			dst[i + k] = level.texels[ys[k] * level.pitch + xs[k]];
+		}
+	}
+	SamplerPoint_C(dst + i, u + i, v + i, count - i, level, au, av);
+}
+
+static GFX_PIXEL_SSE2 void SamplerBilinear_SSE2(uint32_t *dst, const float *u, const float *v,
+		int count, const Sampler::Level& level, int au, int av)
+{
+	__m128 fw = _mm_set1_ps((float)level.width);
+	__m128 fh = _mm_set1_ps((float)level.height);
+	__m128 half = _mm_set1_ps(0.5f);
+	__m128 scale = _mm_set1_ps(256.0f);
+	__m128i w1 = _mm_set1_epi32(level.width - 1);
+	__m128i h1 = _mm_set1_epi32(level.height - 1);
+	int32_t xs0[4], xs1[4], ys0[4], ys1[4];
+	int i = 0;
+	for (; i + 4 <= count; i += 4) {
+		__m128 x = _mm_sub_ps(_mm_mul_ps(SamplerAddress_SSE2(_mm_loadu_ps(u + i), au), fw), half);
+		__m128 y = _mm_sub_ps(_mm_mul_ps(SamplerAddress_SSE2(_mm_loadu_ps(v + i), av), fh), half);
+		__m128 xf = SamplerFloor_SSE2(x), yf = SamplerFloor_SSE2(y);
+		__m128i fx = _mm_cvttps_epi32(_mm_mul_ps(_mm_sub_ps(x, xf), scale));
+		__m128i fy = _mm_cvttps_epi32(_mm_mul_ps(_mm_sub_ps(y, yf), scale));
+		__m128i x0 = _mm_cvttps_epi32(xf), y0 = _mm_cvttps_epi32(yf), x1, y1;
+		SamplerEdge_SSE2(x0, x1, w1, au);
+		SamplerEdge_SSE2(y0, y1, h1, av);
+		_mm_storeu_si128((__m128i*)xs0, x0);
+		_mm_storeu_si128((__m128i*)xs1, x1);
+		_mm_storeu_si128((__m128i*)ys0, y0);
+		_mm_storeu_si128((__m128i*)ys1, y1);
+		uint32_t c00[4], c01[4], c10[4], c11[4];
+		for (int k = 0; k < 4; k++) {
+			const uint32_t *r0 = level.texels + ys0[k] * level.pitch;
+			const uint32_t *r1 = level.texels + ys1[k] * level.pitch;
+			c00[k] = r0[xs0[k]];
+			c01[k] = r0[xs1[k]];
+			c10[k] = r1[xs0[k]];
+			c11[k] = r1[xs1[k]];
+		}
+		__m128i c = SamplerBlend_SSE2(_mm_loadu_si128((const __m128i*)c00),
+				_mm_loadu_si128((const __m128i*)c01), _mm_loadu_si128((const __m128i*)c10),
+				_mm_loadu_si128((const __m128i*)c11), fx, fy);
+		_mm_storeu_si128((__m128i*)(dst + i), c);
+	}
+	SamplerBilinear_C(dst + i, u + i, v + i, count - i, level, au, av);
+}
+
+static const SamplerKernels SamplerKernel_SSE2 = {
+	SamplerPoint_SSE2, SamplerBilinear_SSE2 };
+
+
+//---------------------------------------------------------------------
+// AVX2: 8 samples per step. bilinear gathers its texels, point loads
+// them one by one (a lone gather is slower). the 16 bit blends work
+// within each 128 bit half, so samples 0 - 3 and 4 - 7 are laid out
+// exactly as in the SSE2 code
+//---------------------------------------------------------------------
+static GFX_PIXEL_AVX2 inline __m256 SamplerAddress_AVX2(__m256 u, int mode)
+{
+	if (mode == SAMPLER_CLAMP) {
+		return _mm256_max_ps(_mm256_min_ps(u, _mm256_set1_ps(1.0f)), _mm256_setzero_ps());
+	}
+	u = _mm256_max_ps(_mm256_min_ps(u, _mm256_set1_ps(SAMPLER_RANGE)),
+			_mm256_set1_ps(-SAMPLER_RANGE));
+	if (mode == SAMPLER_WRAP) {
+		return _mm256_sub_ps(u, _mm256_floor_ps(u));
+	}
+	__m256 f = _mm256_floor_ps(_mm256_mul_ps(u, _mm256_set1_ps(0.5f)));
+	__m256 m = _mm256_sub_ps(u, _mm256_mul_ps(_mm256_set1_ps(2.0f), f));
+	__m256 over = _mm256_cmp_ps(m, _mm256_set1_ps(1.0f), _CMP_GT_OQ);
+	return _mm256_blendv_ps(m, _mm256_sub_ps(_mm256_set1_ps(2.0f), m), over);
+}
+
+static GFX_PIXEL_AVX2 inline void SamplerEdge_AVX2(__m256i& x0, __m256i& x1,
+		__m256i last, int mode)
+{
+	__m256i zero = _mm256_setzero_si256();
+	x1 = _mm256_add_epi32(x0, _mm256_set1_epi32(1));
+	if (mode == SAMPLER_WRAP) {
+		x0 = _mm256_blendv_epi8(x0, last, _mm256_cmpgt_epi32(zero, x0));
+		x1 = _mm256_andnot_si256(_mm256_cmpgt_epi32(x1, last), x1);
+	}
+	else {
+		x0 = _mm256_max_epi32(x0, zero);
+		x1 = _mm256_min_epi32(x1, last);
+	}
+}
+
+static GFX_PIXEL_AVX2 inline void SamplerSpread_AVX2(__m256i w, __m256i& lo, __m256i& hi)
+{
+	w = _mm256_packs_epi32(w, w);
+	w = _mm256_unpacklo_epi16(w, w);
+	lo = _mm256_unpacklo_epi32(w, w);
+	hi = _mm256_unpackhi_epi32(w, w);
+}
+
+static GFX_PIXEL_AVX2 inline __m256i SamplerLerp_AVX2(__m256i a, __m256i b, __m256i w)
+{
+	__m256i iw = _mm256_sub_epi16(_mm256_set1_epi16(256), w);
+	__m256i x = _mm256_add_epi16(_mm256_mullo_epi16(a, iw), _mm256_mullo_epi16(b, w));
+	return _mm256_srli_epi16(_mm256_add_epi16(x, _mm256_set1_epi16(128)), 8);
+}
+
+static GFX_PIXEL_AVX2 void SamplerPoint_AVX2(uint32_t *dst, const float *u, const float *v,
+		int count, const Sampler::Level& level, int au, int av)
+{
+	__m256 fw = _mm256_set1_ps((float)level.width);
+	__m256 fh = _mm256_set1_ps((float)level.height);
+	__m256i w1 = _mm256_set1_epi32(level.width - 1);
+	__m256i h1 = _mm256_set1_epi32(level.height - 1);
+	__m256i pitch = _mm256_set1_epi32(level.pitch);
+	int32_t index[8];
+	int i = 0;
+	for (; i + 8 <= count; i += 8) {
+		__m256i x = _mm256_cvttps_epi32(_mm256_mul_ps(
+					SamplerAddress_AVX2(_mm256_loadu_ps(u + i), au), fw));
+		__m256i y = _mm256_cvttps_epi32(_mm256_mul_ps(
+					SamplerAddress_AVX2(_mm256_loadu_ps(v + i), av), fh));
+		x = _mm256_min_epi32(x, w1);
+		y = _mm256_min_epi32(y, h1);
+		_mm256_storeu_si256((__m256i*)index, _mm256_add_epi32(_mm256_mullo_epi32(y, pitch), x));
+		for (int k = 0; k < 8; k++) {
+			dst[i + k] = level.texels[index[k]];
+		}
+	}
+	_mm256_zeroupper();
+	SamplerPoint_C(dst + i, u + i, v + i, count - i, level, au, av);
+}
+
+static GFX_PIXEL_AVX2 void SamplerBilinear_AVX2(uint32_t *dst, const float *u, const float *v,
+		int count, const Sampler::Level& level, int au, int av)
+{
+	const int *texels = (const int*)level.texels;
+	__m256 fw = _mm256_set1_ps((float)level.width);
+	__m256 fh = _mm256_set1_ps((float)level.height);
+	__m256 half = _mm256_set1_ps(0.5f);
+	__m256 scale = _mm256_set1_ps(256.0f);
+	__m256i w1 = _mm256_set1_epi32(level.width - 1);
+	__m256i h1 = _mm256_set1_epi32(level.height - 1);
+	__m256i pitch = _mm256_set1_epi32(level.pitch);
+	__m256i zero = _mm256_setzero_si256();
+	int i = 0;
+	for (; i + 8 <= count; i += 8) {
+		__m256 x = _mm256_sub_ps(_mm256_mul_ps(
+					SamplerAddress_AVX2(_mm256_loadu_ps(u + i), au), fw), half);
+		__m256 y = _mm256_sub_ps(_mm256_mul_ps(
+					SamplerAddress_AVX2(_mm256_loadu_ps(v + i), av), fh), half);
+		__m256 xf = _mm256_floor_ps(x), yf = _mm256_floor_ps(y);
+		__m256i fx = _mm256_cvttps_epi32(_mm256_mul_ps(_mm256_sub_ps(x, xf), scale));
+		__m256i fy = _mm256_cvttps_epi32(_mm256_mul_ps(_mm256_sub_ps(y, yf), scale));
+		__m256i x0 = _mm256_cvttps_epi32(xf), y0 = _mm256_cvttps_epi32(yf), x1, y1;
+		SamplerEdge_AVX2(x0, x1, w1, au);
+		SamplerEdge_AVX2(y0, y1, h1, av);
+		__m256i r0 = _mm256_mullo_epi32(y0, pitch);
+		__m256i r1 = _mm256_mullo_epi32(y1, pitch);
+		__m256i c00 = _mm256_i32gather_epi32(texels, _mm256_add_epi32(r0, x0), 4);
+		__m256i c01 = _mm256_i32gather_epi32(texels, _mm256_add_epi32(r0, x1), 4);
+		__m256i c10 = _mm256_i32gather_epi32(texels, _mm256_add_epi32(r1, x0), 4);
+		__m256i c11 = _mm256_i32gather_epi32(texels, _mm256_add_epi32(r1, x1), 4);
+		__m256i xl, xh, yl, yh;
+		SamplerSpread_AVX2(fx, xl, xh);
+		SamplerSpread_AVX2(fy, yl, yh);
+		__m256i tl = SamplerLerp_AVX2(_mm256_unpacklo_epi8(c00, zero),
+				_mm256_unpacklo_epi8(c01, zero), xl);
+		__m256i th = SamplerLerp_AVX2(_mm256_unpackhi_epi8(c00, zero),
+				_mm256_unpackhi_epi8(c01, zero), xh);
+		__m256i bl = SamplerLerp_AVX2(_mm256_unpacklo_epi8(c10, zero),
+				_mm256_unpacklo_epi8(c11, zero), xl);
+		__m256i bh = SamplerLerp_AVX2(_mm256_unpackhi_epi8(c10, zero),
+				_mm256_unpackhi_epi8(c11, zero), xh);
+		__m256i c = _mm256_packus_epi16(SamplerLerp_AVX2(tl, bl, yl),
+				SamplerLerp_AVX2(th, bh, yh));
+		_mm256_storeu_si256((__m256i*)(dst + i), c);
+	}
+	_mm256_zeroupper();
+	SamplerBilinear_C(dst + i, u + i, v + i, count - i, level, au, av);
+}
+
+static const SamplerKernels SamplerKernel_AVX2 = {
+	SamplerPoint_AVX2, SamplerBilinear_AVX2 };
+
+#endif
+
+
+static const SamplerKernels& SamplerKernel_Get()
+{
+#if GFX_PIXEL_X86
+	switch (GetPixelKernel()) {
+	case PIXEL_KERNEL_AVX2: return SamplerKernel_AVX2;
+	case PIXEL_KERNEL_SSE2: return SamplerKernel_SSE2;
+	default: break;
+	}
+#endif
+	return SamplerKernel_Generic;
+}
+
+
+//---------------------------------------------------------------------
+// ctor
+//---------------------------------------------------------------------
+Sampler::Sampler()
+{
+	m_filter = SAMPLER_BILINEAR;
+	m_address_u = SAMPLER_WRAP;
+	m_address_v = SAMPLER_WRAP;
+	m_max_anisotropy = 8;
+	m_lod_bias = 0.0f;
+}
+
+
+//---------------------------------------------------------------------
+// dtor
+//---------------------------------------------------------------------
+Sampler::~Sampler()
+{
+	Unbind();
+}
+
+
+//---------------------------------------------------------------------
+// binding
+//---------------------------------------------------------------------
+void Sampler::Unbind()
+{
+	for (size_t i = 0; i < m_images.size(); i++) {
+		delete m_images[i];
+	}
+	m_images.clear();
+	m_levels.clear();
+}
+
+void Sampler::Add(const Image *image)
+{
+	Level level;
+	level.texels = (const uint32_t*)image->GetBits();
+	level.pitch = image->GetPitch() / 4;
+	level.width = image->GetWidth();
+	level.height = image->GetHeight();
+	m_levels.push_back(level);
+}
+
+bool Sampler::Bind(const Image *image, bool mipmaps)
+{
+	Unbind();
+	if (image == NULL || image->GetWidth() <= 0 || image->GetHeight() <= 0) {
+		return false;
+	}
+	if (image->GetFormat() == FMT_A8R8G8B8 && !mipmaps) {
+		Add(image);
+		return true;
+	}
+	if (Image::FormatToBpp(image->GetFormat()) == 0) {
+		return false;
+	}
+	int w = image->GetWidth();
+	int h = image->GetHeight();
+	Image *base = new Image(w, h, FMT_A8R8G8B8);
+	base->Blit(0, 0, image, 0, 0, w, h, 0);
+	m_images.push_back(base);
+	Add(base);
+	int count = (mipmaps)? (GetMipmapLevels(w, h) - 1) : 0;
+	if (count > 0) {
+		std::vector<Image*> chain(count);
+		count = BuildMipmaps(&chain[0], count, base, MIPMAP_BOX);
+		for (int i = 0; i < count; i++) {
+			m_images.push_back(chain[i]);
+			Add(chain[i]);
+		}
+	}
+	return true;
+}
+
+bool Sampler::Bind(Texture *texture)
+{
+	Unbind();
+	if (texture == NULL) {
+		return false;
+	}
+	for (int i = 0; i < texture->GetLevels(); i++) {
+		int w = texture->GetLevelWidth(i);
+		int h = texture->GetLevelHeight(i);
+		if (w <= 0 || h <= 0) break;
+		Image *image = new Image(w, h, FMT_A8R8G8B8);
+		memset(image->GetBits(), 0, (size_t)image->GetPitch() * h);
+		texture->CopyTo(i, 0, 0, image, 0, 0, w, h);
+		m_images.push_back(image);
+		Add(image);
+	}
+	return !m_levels.empty();
+}
+
+void Sampler::SetMaxAnisotropy(int n)
+{
+	m_max_anisotropy = (n < 1)? 1 : ((n > SAMPLER_MAX_ANISOTROPY)? SAMPLER_MAX_ANISOTROPY : n);
+}
+
+
+//---------------------------------------------------------------------
+// at most SAMPLER_CHUNK samples at one lod (bias included)
+//---------------------------------------------------------------------
+void Sampler::SampleLevels(uint32_t *dst, const float *u, const float *v, int count,
+		float lod) const
+{
+	const SamplerKernels& kernels = SamplerKernel_Get();
+	int au = (int)m_address_u, av = (int)m_address_v;
+	int last = (int)m_levels.size() - 1;
+	lod = (lod > 0.0f)? ((lod < (float)last)? lod : (float)last) : 0.0f;
+	if (m_filter == SAMPLER_POINT || m_filter == SAMPLER_BILINEAR) {
+		const Level& level = m_levels[(int)(lod + 0.5f)];
+		if (m_filter == SAMPLER_POINT) {
+			kernels.point(dst, u, v, count, level, au, av);
+		}
+		else {
+			kernels.bilinear(dst, u, v, count, level, au, av);
+		}
+		return;
+	}
+	int l0 = (int)lod;
+	int f = (int)((lod - (float)l0) * 256.0f);
+	kernels.bilinear(dst, u, v, count, m_levels[l0], au, av);
+	if (f == 0 || l0 >= last) {
+		return;
+	}
+	uint32_t next[SAMPLER_CHUNK];
+	kernels.bilinear(next, u, v, count, m_levels[l0 + 1], au, av);
+	uint8_t *a = (uint8_t*)dst;
+	const uint8_t *b = (const uint8_t*)next;
+	for (int i = 0; i < count * 4; i++) {
+		a[i] = (uint8_t)((a[i] * (256 - f) + b[i] * f + 128) >> 8);
+	}
+}
+
+
+//---------------------------------------------------------------------
+// sampling
+//---------------------------------------------------------------------
+uint32_t Sampler::Sample(float u, float v, float lod) const
+{
+	uint32_t c = 0;
+	SampleSpan(&c, &u, &v, 1, lod);
+	return c;
+}
+
+uint32_t Sampler::Sample(float u, float v, float dudx, float dvdx, float dudy, float dvdy) const
+{
+	uint32_t c = 0;
+	SampleSpan(&c, &u, &v, 1, dudx, dvdx, dudy, dvdy);
+	return c;
+}
+
+void Sampler::SampleSpan(uint32_t *dst, const float *u, const float *v, int count,
+		float lod) const
+{
+	if (m_levels.empty()) {
+		if (count > 0) memset(dst, 0, sizeof(uint32_t) * count);
+		return;
+	}
+	for (int i = 0; i < count; i += SAMPLER_CHUNK) {
+		int n = (count - i < SAMPLER_CHUNK)? (count - i) : SAMPLER_CHUNK;
+		SampleLevels(dst + i, u + i, v + i, n, lod + m_lod_bias);
+	}
+}
+
+
+//---------------------------------------------------------------------
+// the footprint of a pixel in level 0 texels has the axes (dudx, dvdx)
+// and (dudy, dvdy). isotropic filters take the lod of the longer one,
+// ANISOTROPIC probes ceil(long / short) times (at most the max
+// anisotropy) along it at the lod of long / probes, and averages
+//---------------------------------------------------------------------
+void Sampler::SampleSpan(uint32_t *dst, const float *u, const float *v, int count,
+		float dudx, float dvdx, float dudy, float dvdy) const
+{
+	if (m_levels.empty()) {
+		if (count > 0) memset(dst, 0, sizeof(uint32_t) * count);
+		return;
+	}
+	float w = (float)m_levels[0].width, h = (float)m_levels[0].height;
+	float lx = sqrtf(dudx * dudx * w * w + dvdx * dvdx * h * h);
+	float ly = sqrtf(dudy * dudy * w * w + dvdy * dvdy * h * h);
+	float major = (lx > ly)? lx : ly;
+	float minor = (lx > ly)? ly : lx;
+	int probes = 1;
+	if (m_filter == SAMPLER_ANISOTROPIC && m_max_anisotropy > 1 && major > 1.0f) {
+		float ratio = (minor > 0.0f)? ceilf(major / minor) : (float)m_max_anisotropy;
+		probes = (ratio < (float)m_max_anisotropy)? (int)ratio : m_max_anisotropy;
+	}
+	float lod = (major > 0.0f)? log2f(major / (float)probes) : 0.0f;
+	if (probes <= 1) {
+		SampleSpan(dst, u, v, count, lod);
+		return;
+	}
+	float du = (lx > ly)? dudx : dudy;
+	float dv = (lx > ly)? dvdx : dvdy;
+	for (int i = 0; i < count; i += SAMPLER_CHUNK) {
+		int n = (count - i < SAMPLER_CHUNK)? (count - i) : SAMPLER_CHUNK;
+		uint16_t sum[SAMPLER_CHUNK * 4];
+		uint32_t texels[SAMPLER_CHUNK];
+		float pu[SAMPLER_CHUNK], pv[SAMPLER_CHUNK];
+		const uint8_t *bytes = (const uint8_t*)texels;
+		memset(sum, 0, sizeof(sum));
+		for (int p = 0; p < probes; p++) {
+			float t = ((float)p + 0.5f) / (float)probes - 0.5f;
+			for (int j = 0; j < n; j++) {
+				pu[j] = u[i + j] + du * t;
+				pv[j] = v[i + j] + dv * t;
+			}
+			SampleLevels(texels, pu, pv, n, lod + m_lod_bias);
+			for (int j = 0; j < n * 4; j++) {
+				sum[j] += bytes[j];
+			}
+		}
+		// (sum + probes / 2) / probes as a multiply, exact for sums
+		// up to 16 * 255
+		uint32_t scale = (65536 + probes - 1) / probes;
+		uint32_t round = (uint32_t)probes / 2;
+		uint8_t *out = (uint8_t*)(dst + i);
+		for (int j = 0; j < n * 4; j++) {
+			out[j] = (uint8_t)(((sum[j] + round) * scale) >> 16);
+		}
+	}
+}
+
+
+//---------------------------------------------------------------------
+// Namespace End
+//---------------------------------------------------------------------
+NAMESPACE_END(GFX);
+
+
@@ -0,0 +1,145 @@
+//=====================================================================
+//
+// GFXSampler.h - software texture sampling
+//
+// Last Modified: 2026/10/18 23:48:31
+//
+//=====================================================================
+#ifndef _GFX_SAMPLER_H_
+#define _GFX_SAMPLER_H_
+
+#include <vector>
+
+#include "GFXTypes.h"
+#include "GFXImage.h"
+#include "GFXTexture.h"
+
+
+//---------------------------------------------------------------------
+// Namespace Begin
+//---------------------------------------------------------------------
+NAMESPACE_BEGIN(GFX);
+
+
+//---------------------------------------------------------------------
+// addressing of coordinates outside [0, 1]
+//---------------------------------------------------------------------
+enum SamplerAddress
+{
+	SAMPLER_WRAP = 0,
+	SAMPLER_CLAMP,
+	SAMPLER_MIRROR,
+};
+
+
+//---------------------------------------------------------------------
+// filtering: POINT and BILINEAR read the nearest level, TRILINEAR
+// blends the two levels around the lod, ANISOTROPIC takes up to the
+// max anisotropy trilinear probes along the longer screen axis
+//---------------------------------------------------------------------
+enum SamplerFilter
+{
+	SAMPLER_POINT = 0,
+	SAMPLER_BILINEAR,
+	SAMPLER_TRILINEAR,
+	SAMPLER_ANISOTROPIC,
+};
+
+
+//---------------------------------------------------------------------
+// Sampler - reads A8R8G8B8 texels of an image or of the levels of a
+// texture with D3D style filtering. coordinates are normalized (1.0 is
+// the width / height), texel centers are at (i + 0.5) / size.
+//
+// weights are 8 bit fixed point from the texel coordinates: bilinear
+// blends the two columns then the two rows, rounding each time, and
+// trilinear blends the two levels the same way. spans go through SSE2
+// (4 samples per step) or AVX2 (8 samples, gathered) kernels chosen
+// by GetPixelKernel, with the same results as the generic code.
+//
+// Bind takes a copy of the texture levels (and of images not in
+// A8R8G8B8), bind again after they change. A8R8G8B8 images without
+// mipmaps are read in place and must outlive the binding. coordinates
+// beyond +-2^23 wrap / mirror as integers
+//---------------------------------------------------------------------
+class Sampler
+{
+public:
+	virtual ~Sampler();
+	Sampler();
+
+public:
+	// sample image, with mipmaps its chain is built (box filter)
+	bool Bind(const Image *image, bool mipmaps = false);
+
+	// sample every level of texture, pending uploads are flushed first
+	bool Bind(Texture *texture);
+
+	void Unbind();
+
+	inline void SetFilter(SamplerFilter filter) { m_filter = filter; }
+	inline SamplerFilter GetFilter() const { return m_filter; }
+
+	inline void SetAddress(SamplerAddress u, SamplerAddress v) { m_address_u = u; m_address_v = v; }
+	inline SamplerAddress GetAddressU() const { return m_address_u; }
+	inline SamplerAddress GetAddressV() const { return m_address_v; }
+
+	// probes of SAMPLER_ANISOTROPIC, 1 .. 16
+	void SetMaxAnisotropy(int n);
+	inline int GetMaxAnisotropy() const { return m_max_anisotropy; }
+
+	// added to every lod
+	inline void SetLodBias(float bias) { m_lod_bias = bias; }
+	inline float GetLodBias() const { return m_lod_bias; }
+
+	inline int GetLevels() const { return (int)m_levels.size(); }
+
+	// one texel at (u, v), lod 0 is level 0 and each 1.0 one level down.
+	// ANISOTROPIC samples as TRILINEAR without derivatives. 0 if unbound
+	uint32_t Sample(float u, float v, float lod = 0.0f) const;
+
+	// lod (and anisotropy) from the derivatives of u, v along screen x, y
+	uint32_t Sample(float u, float v, float dudx, float dvdx, float dudy, float dvdy) const;
+
+	// count texels of (u[i], v[i]) into dst, all at the same lod
+	void SampleSpan(uint32_t *dst, const float *u, const float *v, int count,
+			float lod = 0.0f) const;
+
+	// count texels sharing one set of derivatives, as in a scanline of
+	// an affine mapping
+	void SampleSpan(uint32_t *dst, const float *u, const float *v, int count,
+			float dudx, float dvdx, float dudy, float dvdy) const;
+
+public:
+	// one level as the kernels read it
+	struct Level {
+		const uint32_t *texels;
+		int pitch;			// in texels
+		int width;
+		int height;
+	};
+
+protected:
+	void SampleLevels(uint32_t *dst, const float *u, const float *v, int count, float lod) const;
+	void Add(const Image *image);
+
+protected:
+	SamplerFilter m_filter;
+	SamplerAddress m_address_u;
+	SamplerAddress m_address_v;
+	int m_max_anisotropy;
+	float m_lod_bias;
+	std::vector<Level> m_levels;
+	std::vector<Image*> m_images;		// owned copies behind m_levels
+};
+
+
+//---------------------------------------------------------------------
+// Namespace End
+//---------------------------------------------------------------------
+NAMESPACE_END(GFX);
+
+
+#endif
+
+
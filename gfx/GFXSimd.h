@@ -0,0 +1,1036 @@
+//=====================================================================
+//
+// GFXSimd.h - 4/8 lane float wrappers over SSE/AVX/NEON
+//
+// Last Modified: 2026/10/18 11:02:17
+//
+//=====================================================================
+#ifndef _GFX_SIMD_H_
+#define _GFX_SIMD_H_
+
+#include <string.h>
+
+#include "GFXMath.h"
+
+
+//---------------------------------------------------------------------
+// Namespace Begin
+//---------------------------------------------------------------------
+NAMESPACE_BEGIN(GFX);
+NAMESPACE_BEGIN(Core);
+
+
+//---------------------------------------------------------------------
+// Float4 - 4 lanes, comparisons return all-ones/all-zeros lane masks
+//---------------------------------------------------------------------
+struct Float4
+{
+	enum { LANES = 4 };
+
+#if GFX_SIMD_SSE
+	__m128 v;
+	inline Float4(__m128 x): v(x) {}
+#elif GFX_SIMD_NEON
+	float32x4_t v;
+	inline Float4(float32x4_t x): v(x) {}
+#else
+	float v[4];
+#endif
+
+	inline Float4() {}
+
+	inline explicit Float4(float x) {
+#if GFX_SIMD_SSE
+		v = _mm_set1_ps(x);
+#elif GFX_SIMD_NEON
+		v = vdupq_n_f32(x);
+#else
+		v[0] = v[1] = v[2] = v[3] = x;
+#endif
+	}
+
+	inline Float4(float a, float b, float c, float d) {
+#if GFX_SIMD_SSE
+		v = _mm_setr_ps(a, b, c, d);
+#else
+		float t[4] = { a, b, c, d };
+		*this = Load(t);
+#endif
+	}
+
+	static inline Float4 Zero() {
+		return Float4(0.0f);
+	}
+
+	// unaligned load/store
+	static inline Float4 Load(const float *p) {
+#if GFX_SIMD_SSE
+		return Float4(_mm_loadu_ps(p));
+#elif GFX_SIMD_NEON
+		return Float4(vld1q_f32(p));
+#else
+		Float4 t;
+		t.v[0] = p[0], t.v[1] = p[1], t.v[2] = p[2], t.v[3] = p[3];
+		return t;
+#endif
+	}
+
+	inline void Store(float *p) const {
+#if GFX_SIMD_SSE
+		_mm_storeu_ps(p, v);
+#elif GFX_SIMD_NEON
+		vst1q_f32(p, v);
+#else
+		p[0] = v[0], p[1] = v[1], p[2] = v[2], p[3] = v[3];
+#endif
+	}
+
+	inline float Get(int i) const {
+		float t[4];
+		Store(t);
+		return t[i];
+	}
+
+	// bit i set when lane i has its sign bit set (true mask lanes)
+	inline int MoveMask() const {
+#if GFX_SIMD_SSE
+		return _mm_movemask_ps(v);
+#else
+		uint32_t t[4];
+		float f[4];
+		Store(f);
+		memcpy(t, f, sizeof(t));
+		return (int)((t[0] >> 31) | ((t[1] >> 31) << 1) |
+			((t[2] >> 31) << 2) | ((t[3] >> 31) << 3));
+#endif
+	}
+};
+
+
+#if !GFX_SIMD_SSE && !GFX_SIMD_NEON
+//---------------------------------------------------------------------
+// scalar fallback helpers
+//---------------------------------------------------------------------
+template <class OP>
+inline Float4 Float4_Map(const Float4& a, const Float4& b, OP op) {
+	Float4 t;
+	for (int i = 0; i < 4; i++) t.v[i] = op(a.v[i], b.v[i]);
+	return t;
+}
+
+inline uint32_t Float4_Bits(float x) {
+	uint32_t u;
+	memcpy(&u, &x, sizeof(u));
+	return u;
+}
+
+inline float Float4_Float(uint32_t u) {
+	float x;
+	memcpy(&x, &u, sizeof(x));
+	return x;
+}
+
+struct Float4_Add { float operator()(float a, float b) const { return a + b; } };
+struct Float4_Sub { float operator()(float a, float b) const { return a - b; } };
+struct Float4_Mul { float operator()(float a, float b) const { return a * b; } };
+struct Float4_Div { float operator()(float a, float b) const { return a / b; } };
+struct Float4_Min { float operator()(float a, float b) const { return (a < b)? a : b; } };
+struct Float4_Max { float operator()(float a, float b) const { return (a > b)? a : b; } };
+struct Float4_And { float operator()(float a, float b) const {
+	return Float4_Float(Float4_Bits(a) & Float4_Bits(b)); } };
+struct Float4_Or { float operator()(float a, float b) const {
+	return Float4_Float(Float4_Bits(a) | Float4_Bits(b)); } };
+struct Float4_AndNot { float operator()(float a, float b) const {
+	return Float4_Float(~Float4_Bits(a) & Float4_Bits(b)); } };
+struct Float4_Lt { float operator()(float a, float b) const {
+	return Float4_Float((a < b)? 0xffffffffu : 0); } };
+struct Float4_Le { float operator()(float a, float b) const {
+	return Float4_Float((a <= b)? 0xffffffffu : 0); } };
+struct Float4_Eq { float operator()(float a, float b) const {
+	return Float4_Float((a == b)? 0xffffffffu : 0); } };
+#endif
+
+
+//---------------------------------------------------------------------
+// Float4 operators
+//---------------------------------------------------------------------
+inline Float4 operator + (const Float4& a, const Float4& b) {
+#if GFX_SIMD_SSE
+	return _mm_add_ps(a.v, b.v);
+#elif GFX_SIMD_NEON
+	return vaddq_f32(a.v, b.v);
+#else
+	return Float4_Map(a, b, Float4_Add());
+#endif
+}
+
+inline Float4 operator - (const Float4& a, const Float4& b) {
+#if GFX_SIMD_SSE
+	return _mm_sub_ps(a.v, b.v);
+#elif GFX_SIMD_NEON
+	return vsubq_f32(a.v, b.v);
+#else
+	return Float4_Map(a, b, Float4_Sub());
+#endif
+}
+
+inline Float4 operator * (const Float4& a, const Float4& b) {
+#if GFX_SIMD_SSE
+	return _mm_mul_ps(a.v, b.v);
+#elif GFX_SIMD_NEON
+	return vmulq_f32(a.v, b.v);
+#else
+	return Float4_Map(a, b, Float4_Mul());
+#endif
+}
+
+inline Float4 operator / (const Float4& a, const Float4& b) {
+#if GFX_SIMD_SSE
+	return _mm_div_ps(a.v, b.v);
+#elif GFX_SIMD_NEON && defined(__aarch64__)
+	return vdivq_f32(a.v, b.v);
+#elif GFX_SIMD_NEON
+	float32x4_t r = vrecpeq_f32(b.v);
+	r = vmulq_f32(r, vrecpsq_f32(b.v, r));
+	r = vmulq_f32(r, vrecpsq_f32(b.v, r));
+	return vmulq_f32(a.v, r);
+#else
+	return Float4_Map(a, b, Float4_Div());
+#endif
+}
+
+inline Float4 operator - (const Float4& a) {
+	return Float4::Zero() - a;
+}
+
+inline Float4 operator * (const Float4& a, float k) { return a * Float4(k); }
+inline Float4 operator * (float k, const Float4& a) { return a * Float4(k); }
+
+inline Float4& operator += (Float4& a, const Float4& b) { a = a + b; return a; }
+inline Float4& operator -= (Float4& a, const Float4& b) { a = a - b; return a; }
+inline Float4& operator *= (Float4& a, const Float4& b) { a = a * b; return a; }
+
+// a * b + c
+inline Float4 MulAdd(const Float4& a, const Float4& b, const Float4& c) {
+#if GFX_SIMD_FMA
+	return _mm_fmadd_ps(a.v, b.v, c.v);
+#elif GFX_SIMD_NEON
+	return vmlaq_f32(c.v, a.v, b.v);
+#else
+	return a * b + c;
+#endif
+}
+
+inline Float4 Min(const Float4& a, const Float4& b) {
+#if GFX_SIMD_SSE
+	return _mm_min_ps(a.v, b.v);
+#elif GFX_SIMD_NEON
+	return vminq_f32(a.v, b.v);
+#else
+	return Float4_Map(a, b, Float4_Min());
+#endif
+}
+
+inline Float4 Max(const Float4& a, const Float4& b) {
+#if GFX_SIMD_SSE
+	return _mm_max_ps(a.v, b.v);
+#elif GFX_SIMD_NEON
+	return vmaxq_f32(a.v, b.v);
+#else
+	return Float4_Map(a, b, Float4_Max());
+#endif
+}
+
+inline Float4 And(const Float4& a, const Float4& b) {
+#if GFX_SIMD_SSE
+	return _mm_and_ps(a.v, b.v);
+#elif GFX_SIMD_NEON
+	return vreinterpretq_f32_u32(vandq_u32(
+		vreinterpretq_u32_f32(a.v), vreinterpretq_u32_f32(b.v)));
+#else
+	return Float4_Map(a, b, Float4_And());
+#endif
+}
+
+inline Float4 Or(const Float4& a, const Float4& b) {
+#if GFX_SIMD_SSE
+	return _mm_or_ps(a.v, b.v);
+#elif GFX_SIMD_NEON
+	return vreinterpretq_f32_u32(vorrq_u32(
+		vreinterpretq_u32_f32(a.v), vreinterpretq_u32_f32(b.v)));
+#else
+	return Float4_Map(a, b, Float4_Or());
+#endif
+}
+
+// ~a & b
+inline Float4 AndNot(const Float4& a, const Float4& b) {
+#if GFX_SIMD_SSE
+	return _mm_andnot_ps(a.v, b.v);
+#elif GFX_SIMD_NEON
+	return vreinterpretq_f32_u32(vbicq_u32(
+		vreinterpretq_u32_f32(b.v), vreinterpretq_u32_f32(a.v)));
+#else
+	return Float4_Map(a, b, Float4_AndNot());
+#endif
+}
+
+// mask ? a : b, per lane
+inline Float4 Select(const Float4& mask, const Float4& a, const Float4& b) {
+#if GFX_SIMD_NEON
+	return vbslq_f32(vreinterpretq_u32_f32(mask.v), a.v, b.v);
+#else
+	return Or(And(mask, a), AndNot(mask, b));
+#endif
+}
+
+inline Float4 CmpLt(const Float4& a, const Float4& b) {
+#if GFX_SIMD_SSE
+	return _mm_cmplt_ps(a.v, b.v);
+#elif GFX_SIMD_NEON
+	return vreinterpretq_f32_u32(vcltq_f32(a.v, b.v));
+#else
+	return Float4_Map(a, b, Float4_Lt());
+#endif
+}
+
+inline Float4 CmpLe(const Float4& a, const Float4& b) {
+#if GFX_SIMD_SSE
+	return _mm_cmple_ps(a.v, b.v);
+#elif GFX_SIMD_NEON
+	return vreinterpretq_f32_u32(vcleq_f32(a.v, b.v));
+#else
+	return Float4_Map(a, b, Float4_Le());
+#endif
+}
+
+inline Float4 CmpEq(const Float4& a, const Float4& b) {
+#if GFX_SIMD_SSE
+	return _mm_cmpeq_ps(a.v, b.v);
+#elif GFX_SIMD_NEON
+	return vreinterpretq_f32_u32(vceqq_f32(a.v, b.v));
+#else
+	return Float4_Map(a, b, Float4_Eq());
+#endif
+}
+
+inline Float4 CmpGt(const Float4& a, const Float4& b) { return CmpLt(b, a); }
+inline Float4 CmpGe(const Float4& a, const Float4& b) { return CmpLe(b, a); }
+
+inline Float4 Abs(const Float4& a) {
+	return AndNot(Float4(-0.0f), a);
+}
+
+inline Float4 Sqrt(const Float4& a) {
+#if GFX_SIMD_SSE
+	return _mm_sqrt_ps(a.v);
+#elif GFX_SIMD_NEON && defined(__aarch64__)
+	return vsqrtq_f32(a.v);
+#elif GFX_SIMD_NEON
+	float32x4_t r = vrsqrteq_f32(a.v);
+	r = vmulq_f32(r, vrsqrtsq_f32(vmulq_f32(a.v, r), r));
+	r = vmulq_f32(r, vrsqrtsq_f32(vmulq_f32(a.v, r), r));
+	float32x4_t s = vmulq_f32(a.v, r);
+	return vbslq_f32(vceqq_f32(a.v, vdupq_n_f32(0.0f)), a.v, s);
+#else
+	Float4 t;
+	for (int i = 0; i < 4; i++) t.v[i] = sqrtf(a.v[i]);
+	return t;
+#endif
+}
+
+// hardware estimate, about 12 bits on SSE and 8 bits on NEON
+inline Float4 RsqrtEst(const Float4& a) {
+#if GFX_SIMD_SSE
+	return _mm_rsqrt_ps(a.v);
+#elif GFX_SIMD_NEON
+	return vrsqrteq_f32(a.v);
+#else
+	Float4 t;
+	for (int i = 0; i < 4; i++) t.v[i] = InverseSquareRoot(a.v[i]);
+	return t;
+#endif
+}
+
+// estimate refined with one Newton-Raphson step: y * (1.5 - 0.5 x y y)
+inline Float4 Rsqrt(const Float4& a) {
+#if GFX_SIMD_NEON
+	float32x4_t r = vrsqrteq_f32(a.v);
+	r = vmulq_f32(r, vrsqrtsq_f32(vmulq_f32(a.v, r), r));
+	return vmulq_f32(r, vrsqrtsq_f32(vmulq_f32(a.v, r), r));
+#elif GFX_SIMD_SSE
+	Float4 y = RsqrtEst(a);
+	Float4 h = a * Float4(0.5f);
+	return y * (Float4(1.5f) - h * y * y);
+#else
+	Float4 t;
+	for (int i = 0; i < 4; i++) t.v[i] = 1.0f / sqrtf(a.v[i]);
+	return t;
+#endif
+}
+
+// largest integer not greater than a, |a| < 2^31
+inline Float4 Floor(const Float4& a) {
+#if GFX_SIMD_AVX
+	return _mm_floor_ps(a.v);
+#elif GFX_SIMD_SSE
+	__m128 t = _mm_cvtepi32_ps(_mm_cvttps_epi32(a.v));
+	return _mm_sub_ps(t, _mm_and_ps(_mm_cmpgt_ps(t, a.v), _mm_set1_ps(1.0f)));
+#elif GFX_SIMD_NEON
+	float32x4_t t = vcvtq_f32_s32(vcvtq_s32_f32(a.v));
+	uint32x4_t m = vandq_u32(vcgtq_f32(t, a.v), vreinterpretq_u32_f32(vdupq_n_f32(1.0f)));
+	return vsubq_f32(t, vreinterpretq_f32_u32(m));
+#else
+	Float4 t;
+	for (int i = 0; i < 4; i++) t.v[i] = floorf(a.v[i]);
+	return t;
+#endif
+}
+
+// 2^n for integral n in [-126, 127], built in the exponent field
+inline Float4 Pow2(const Float4& n) {
+#if GFX_SIMD_SSE
+	__m128i e = _mm_add_epi32(_mm_cvttps_epi32(n.v), _mm_set1_epi32(127));
+	return _mm_castsi128_ps(_mm_slli_epi32(e, 23));
+#elif GFX_SIMD_NEON
+	int32x4_t e = vaddq_s32(vcvtq_s32_f32(n.v), vdupq_n_s32(127));
+	return vreinterpretq_f32_s32(vshlq_n_s32(e, 23));
+#else
+	Float4 t;
+	for (int i = 0; i < 4; i++) {
+		t.v[i] = Float4_Float((uint32_t)((int32_t)n.v[i] + 127) << 23);
+	}
+	return t;
+#endif
+}
+
+// a = m * 2^e with m in [0.5, 1), for positive normal a
+inline Float4 Frexp(const Float4& a, Float4& e) {
+#if GFX_SIMD_SSE
+	__m128i b = _mm_castps_si128(a.v);
+	__m128i x = _mm_srli_epi32(_mm_and_si128(b, _mm_set1_epi32(0x7f800000)), 23);
+	e = _mm_cvtepi32_ps(_mm_sub_epi32(x, _mm_set1_epi32(126)));
+	b = _mm_or_si128(_mm_and_si128(b, _mm_set1_epi32(0x807fffff)),
+		_mm_set1_epi32(0x3f000000));
+	return _mm_castsi128_ps(b);
+#elif GFX_SIMD_NEON
+	uint32x4_t b = vreinterpretq_u32_f32(a.v);
+	uint32x4_t x = vshrq_n_u32(vandq_u32(b, vdupq_n_u32(0x7f800000)), 23);
+	e = vcvtq_f32_s32(vsubq_s32(vreinterpretq_s32_u32(x), vdupq_n_s32(126)));
+	b = vorrq_u32(vandq_u32(b, vdupq_n_u32(0x807fffff)), vdupq_n_u32(0x3f000000));
+	return vreinterpretq_f32_u32(b);
+#else
+	Float4 t;
+	for (int i = 0; i < 4; i++) {
+		uint32_t b = Float4_Bits(a.v[i]);
+		e.v[i] = (float)((int)((b >> 23) & 0xff) - 126);
+		t.v[i] = Float4_Float((b & 0x807fffff) | 0x3f000000);
+	}
+	return t;
+#endif
+}
+
+
+//---------------------------------------------------------------------
+// gather 4 vectors of N (3 or 4) floats at a byte stride into x/y/z/w
+// lanes, w is 1 when N is 3. packed Vector3 is deinterleaved from
+// three loads on SSE and with vld3 on NEON
+//---------------------------------------------------------------------
+template <int N>
+inline void Float4_Gather(const uint8_t *src, size_t stride,
+		Float4& x, Float4& y, Float4& z, Float4& w)
+{
+	const float *p0 = (const float*)(src);
+	const float *p1 = (const float*)(src + stride);
+	const float *p2 = (const float*)(src + stride * 2);
+	const float *p3 = (const float*)(src + stride * 3);
+#if GFX_SIMD_SSE
+	if (N == 4) {
+		__m128 a = _mm_loadu_ps(p0);
+		__m128 b = _mm_loadu_ps(p1);
+		__m128 c = _mm_loadu_ps(p2);
+		__m128 d = _mm_loadu_ps(p3);
+		_MM_TRANSPOSE4_PS(a, b, c, d);
+		x = a, y = b, z = c, w = d;
+	}
+	else if (stride == sizeof(float) * 3) {
+		// packed Vector3: x0y0z0x1 y1z1x2y2 z2x3y3z3
+		__m128 a = _mm_loadu_ps(p0);
+		__m128 b = _mm_loadu_ps(p0 + 4);
+		__m128 c = _mm_loadu_ps(p0 + 8);
+		__m128 t = _mm_shuffle_ps(b, c, _MM_SHUFFLE(1, 1, 2, 2));
+		x = _mm_shuffle_ps(a, t, _MM_SHUFFLE(2, 0, 3, 0));
+		__m128 t1 = _mm_shuffle_ps(a, b, _MM_SHUFFLE(0, 0, 1, 1));
+		__m128 t2 = _mm_shuffle_ps(b, c, _MM_SHUFFLE(2, 2, 3, 3));
+		y = _mm_shuffle_ps(t1, t2, _MM_SHUFFLE(2, 0, 2, 0));
+		t1 = _mm_shuffle_ps(a, b, _MM_SHUFFLE(1, 1, 2, 2));
+		t2 = _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 3, 0, 0));
+		z = _mm_shuffle_ps(t1, t2, _MM_SHUFFLE(2, 0, 2, 0));
+		w = _mm_set1_ps(1.0f);
+	}
+	else {
+		x = _mm_setr_ps(p0[0], p1[0], p2[0], p3[0]);
+		y = _mm_setr_ps(p0[1], p1[1], p2[1], p3[1]);
+		z = _mm_setr_ps(p0[2], p1[2], p2[2], p3[2]);
+		w = _mm_set1_ps(1.0f);
+	}
+#else
+	#if GFX_SIMD_NEON
+	if (stride == sizeof(float) * N) {
+		if (N == 4) {
+			float32x4x4_t v = vld4q_f32(p0);
+			x = v.val[0], y = v.val[1], z = v.val[2], w = v.val[3];
+		}
+		else {
+			float32x4x3_t v = vld3q_f32(p0);
+			x = v.val[0], y = v.val[1], z = v.val[2];
+			w = vdupq_n_f32(1.0f);
+		}
+		return;
+	}
+	#endif
+	x = Float4(p0[0], p1[0], p2[0], p3[0]);
+	y = Float4(p0[1], p1[1], p2[1], p3[1]);
+	z = Float4(p0[2], p1[2], p2[2], p3[2]);
+	w = (N == 4)? Float4(p0[3], p1[3], p2[3], p3[3]) : Float4(1.0f);
+#endif
+}
+
+
+//---------------------------------------------------------------------
+// scatter x/y/z/w lanes back to 4 vectors of N floats, w is dropped
+// when N is 3
+//---------------------------------------------------------------------
+template <int N>
+inline void Float4_Scatter(uint8_t *dst, size_t stride,
+		const Float4& x, const Float4& y, const Float4& z, const Float4& w)
+{
+	float *p0 = (float*)(dst);
+	float *p1 = (float*)(dst + stride);
+	float *p2 = (float*)(dst + stride * 2);
+	float *p3 = (float*)(dst + stride * 3);
+#if GFX_SIMD_SSE
+	__m128 a = x.v, b = y.v, c = z.v, d = w.v;
+	_MM_TRANSPOSE4_PS(a, b, c, d);
+	if (N == 4) {
+		_mm_storeu_ps(p0, a);
+		_mm_storeu_ps(p1, b);
+		_mm_storeu_ps(p2, c);
+		_mm_storeu_ps(p3, d);
+	}
+	else if (stride == sizeof(float) * 3) {
+		// packed Vector3: each store overwrites the garbage lane
+		// left by the previous one, the last store is 12 bytes
+		_mm_storeu_ps(p0, a);
+		_mm_storeu_ps(p1, b);
+		_mm_storeu_ps(p2, c);
+		_mm_storel_pi((__m64*)p3, d);
+		_mm_store_ss(p3 + 2, _mm_movehl_ps(d, d));
+	}
+	else {
+		_mm_storel_pi((__m64*)p0, a);
+		_mm_store_ss(p0 + 2, _mm_movehl_ps(a, a));
+		_mm_storel_pi((__m64*)p1, b);
+		_mm_store_ss(p1 + 2, _mm_movehl_ps(b, b));
+		_mm_storel_pi((__m64*)p2, c);
+		_mm_store_ss(p2 + 2, _mm_movehl_ps(c, c));
+		_mm_storel_pi((__m64*)p3, d);
+		_mm_store_ss(p3 + 2, _mm_movehl_ps(d, d));
+	}
+#else
+	#if GFX_SIMD_NEON
+	if (stride == sizeof(float) * N) {
+		if (N == 4) {
+			float32x4x4_t v;
+			v.val[0] = x.v, v.val[1] = y.v, v.val[2] = z.v, v.val[3] = w.v;
+			vst4q_f32(p0, v);
+		}
+		else {
+			float32x4x3_t v;
+			v.val[0] = x.v, v.val[1] = y.v, v.val[2] = z.v;
+			vst3q_f32(p0, v);
+		}
+		return;
+	}
+	#endif
+	float lanes[4][4];
+	x.Store(lanes[0]);
+	y.Store(lanes[1]);
+	z.Store(lanes[2]);
+	w.Store(lanes[3]);
+	float *p[4] = { p0, p1, p2, p3 };
+	for (int i = 0; i < 4; i++) {
+		p[i][0] = lanes[0][i];
+		p[i][1] = lanes[1][i];
+		p[i][2] = lanes[2][i];
+		if (N == 4) p[i][3] = lanes[3][i];
+	}
+#endif
+}
+
+
+//---------------------------------------------------------------------
+// Float8 - 8 lanes, native on AVX, a pair of Float4 elsewhere
+//---------------------------------------------------------------------
+struct Float8
+{
+	enum { LANES = 8 };
+
+#if GFX_SIMD_AVX
+	__m256 v;
+	inline Float8(__m256 x): v(x) {}
+#else
+	Float4 lo, hi;
+	inline Float8(const Float4& l, const Float4& h): lo(l), hi(h) {}
+#endif
+
+	inline Float8() {}
+
+	inline explicit Float8(float x) {
+#if GFX_SIMD_AVX
+		v = _mm256_set1_ps(x);
+#else
+		lo = hi = Float4(x);
+#endif
+	}
+
+	static inline Float8 Zero() {
+		return Float8(0.0f);
+	}
+
+	static inline Float8 Load(const float *p) {
+#if GFX_SIMD_AVX
+		return Float8(_mm256_loadu_ps(p));
+#else
+		return Float8(Float4::Load(p), Float4::Load(p + 4));
+#endif
+	}
+
+	inline void Store(float *p) const {
+#if GFX_SIMD_AVX
+		_mm256_storeu_ps(p, v);
+#else
+		lo.Store(p);
+		hi.Store(p + 4);
+#endif
+	}
+
+	inline float Get(int i) const {
+		float t[8];
+		Store(t);
+		return t[i];
+	}
+
+	inline int MoveMask() const {
+#if GFX_SIMD_AVX
+		return _mm256_movemask_ps(v);
+#else
+		return lo.MoveMask() | (hi.MoveMask() << 4);
+#endif
+	}
+};
+
+
+//---------------------------------------------------------------------
+// Float8 operators
+//---------------------------------------------------------------------
+#if GFX_SIMD_AVX
+#define GFX_FLOAT8_BINARY(name, avx, split) \
+	inline Float8 name(const Float8& a, const Float8& b) { \
+		return avx(a.v, b.v); \
+	}
+#else
+#define GFX_FLOAT8_BINARY(name, avx, split) \
+	inline Float8 name(const Float8& a, const Float8& b) { \
+		return Float8(split(a.lo, b.lo), split(a.hi, b.hi)); \
+	}
+#endif
+
+GFX_FLOAT8_BINARY(operator +, _mm256_add_ps, operator +)
+GFX_FLOAT8_BINARY(operator -, _mm256_sub_ps, operator -)
+GFX_FLOAT8_BINARY(operator *, _mm256_mul_ps, operator *)
+GFX_FLOAT8_BINARY(operator /, _mm256_div_ps, operator /)
+GFX_FLOAT8_BINARY(Min, _mm256_min_ps, Min)
+GFX_FLOAT8_BINARY(Max, _mm256_max_ps, Max)
+GFX_FLOAT8_BINARY(And, _mm256_and_ps, And)
+GFX_FLOAT8_BINARY(Or, _mm256_or_ps, Or)
+GFX_FLOAT8_BINARY(AndNot, _mm256_andnot_ps, AndNot)
+
+#undef GFX_FLOAT8_BINARY
+
+inline Float8 operator - (const Float8& a) {
+	return Float8::Zero() - a;
+}
+
+inline Float8 operator * (const Float8& a, float k) { return a * Float8(k); }
+inline Float8 operator * (float k, const Float8& a) { return a * Float8(k); }
+
+inline Float8& operator += (Float8& a, const Float8& b) { a = a + b; return a; }
+inline Float8& operator -= (Float8& a, const Float8& b) { a = a - b; return a; }
+inline Float8& operator *= (Float8& a, const Float8& b) { a = a * b; return a; }
+
+inline Float8 MulAdd(const Float8& a, const Float8& b, const Float8& c) {
+#if GFX_SIMD_FMA
+	return _mm256_fmadd_ps(a.v, b.v, c.v);
+#elif GFX_SIMD_AVX
+	return _mm256_add_ps(_mm256_mul_ps(a.v, b.v), c.v);
+#else
+	return Float8(MulAdd(a.lo, b.lo, c.lo), MulAdd(a.hi, b.hi, c.hi));
+#endif
+}
+
+inline Float8 Select(const Float8& mask, const Float8& a, const Float8& b) {
+#if GFX_SIMD_AVX
+	return _mm256_blendv_ps(b.v, a.v, mask.v);
+#else
+	return Float8(Select(mask.lo, a.lo, b.lo), Select(mask.hi, a.hi, b.hi));
+#endif
+}
+
+#if GFX_SIMD_AVX
+inline Float8 CmpLt(const Float8& a, const Float8& b) { return _mm256_cmp_ps(a.v, b.v, _CMP_LT_OQ); }
+inline Float8 CmpLe(const Float8& a, const Float8& b) { return _mm256_cmp_ps(a.v, b.v, _CMP_LE_OQ); }
+inline Float8 CmpEq(const Float8& a, const Float8& b) { return _mm256_cmp_ps(a.v, b.v, _CMP_EQ_OQ); }
+inline Float8 Sqrt(const Float8& a) { return _mm256_sqrt_ps(a.v); }
+inline Float8 RsqrtEst(const Float8& a) { return _mm256_rsqrt_ps(a.v); }
+#else
+inline Float8 CmpLt(const Float8& a, const Float8& b) { return Float8(CmpLt(a.lo, b.lo), CmpLt(a.hi, b.hi)); }
+inline Float8 CmpLe(const Float8& a, const Float8& b) { return Float8(CmpLe(a.lo, b.lo), CmpLe(a.hi, b.hi)); }
+inline Float8 CmpEq(const Float8& a, const Float8& b) { return Float8(CmpEq(a.lo, b.lo), CmpEq(a.hi, b.hi)); }
+inline Float8 Sqrt(const Float8& a) { return Float8(Sqrt(a.lo), Sqrt(a.hi)); }
+inline Float8 RsqrtEst(const Float8& a) { return Float8(RsqrtEst(a.lo), RsqrtEst(a.hi)); }
+#endif
+
+inline Float8 CmpGt(const Float8& a, const Float8& b) { return CmpLt(b, a); }
+inline Float8 CmpGe(const Float8& a, const Float8& b) { return CmpLe(b, a); }
+
+inline Float8 Abs(const Float8& a) {
+	return AndNot(Float8(-0.0f), a);
+}
+
+inline Float8 Rsqrt(const Float8& a) {
+#if GFX_SIMD_AVX
+	Float8 y = RsqrtEst(a);
+	Float8 h = a * Float8(0.5f);
+	return y * (Float8(1.5f) - h * y * y);
+#else
+	return Float8(Rsqrt(a.lo), Rsqrt(a.hi));
+#endif
+}
+
+inline Float8 Floor(const Float8& a) {
+#if GFX_SIMD_AVX
+	return _mm256_floor_ps(a.v);
+#else
+	return Float8(Floor(a.lo), Floor(a.hi));
+#endif
+}
+
+// split into and join from 4-lane halves, plain AVX has no 256-bit
+// integer ops so those run on the two halves
+inline Float4 Float8_Lo(const Float8& a) {
+#if GFX_SIMD_AVX
+	return _mm256_castps256_ps128(a.v);
+#else
+	return a.lo;
+#endif
+}
+
+inline Float4 Float8_Hi(const Float8& a) {
+#if GFX_SIMD_AVX
+	return _mm256_extractf128_ps(a.v, 1);
+#else
+	return a.hi;
+#endif
+}
+
+inline Float8 Float8_Join(const Float4& lo, const Float4& hi) {
+#if GFX_SIMD_AVX
+	return _mm256_insertf128_ps(_mm256_castps128_ps256(lo.v), hi.v, 1);
+#else
+	return Float8(lo, hi);
+#endif
+}
+
+
+//---------------------------------------------------------------------
+// Float4_Gather / Float4_Scatter for 8 vectors. on AVX vectors i and
+// i + 4 share a register (128-bit loads paired by insertf128) and the
+// SSE shuffles run on both halves at once. packed Vector3 on AVX2 is
+// three full loads: blends put each component's lanes in one register
+// and a permute orders them. strided Vector3 and other platforms go
+// as two groups of 4
+//---------------------------------------------------------------------
+#if GFX_SIMD_AVX
+inline __m256 Float8_Load2(const float *lo, const float *hi) {
+	return _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(lo)),
+			_mm_loadu_ps(hi), 1);
+}
+
+// 4x4 transpose within each 128-bit half
+inline void Float8_Transpose4(__m256& a, __m256& b, __m256& c, __m256& d) {
+	__m256 t0 = _mm256_unpacklo_ps(a, b);
+	__m256 t1 = _mm256_unpacklo_ps(c, d);
+	__m256 t2 = _mm256_unpackhi_ps(a, b);
+	__m256 t3 = _mm256_unpackhi_ps(c, d);
+	a = _mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(1, 0, 1, 0));
+	b = _mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(3, 2, 3, 2));
+	c = _mm256_shuffle_ps(t2, t3, _MM_SHUFFLE(1, 0, 1, 0));
+	d = _mm256_shuffle_ps(t2, t3, _MM_SHUFFLE(3, 2, 3, 2));
+}
+#endif
+
+template <int N>
+inline void Float8_Gather(const uint8_t *src, size_t stride,
+		Float8& x, Float8& y, Float8& z, Float8& w)
+{
+#if GFX_SIMD_AVX
+	if (N == 4) {
+		const float *p0 = (const float*)(src);
+		const float *p4 = (const float*)(src + stride * 4);
+		__m256 a = Float8_Load2(p0, p4);
+		__m256 b = Float8_Load2((const float*)((const uint8_t*)p0 + stride),
+				(const float*)((const uint8_t*)p4 + stride));
+		__m256 c = Float8_Load2((const float*)((const uint8_t*)p0 + stride * 2),
+				(const float*)((const uint8_t*)p4 + stride * 2));
+		__m256 d = Float8_Load2((const float*)((const uint8_t*)p0 + stride * 3),
+				(const float*)((const uint8_t*)p4 + stride * 3));
+		Float8_Transpose4(a, b, c, d);
+		x = a, y = b, z = c, w = d;
+		return;
+	}
+	if (stride == sizeof(float) * 3) {
+		const float *p = (const float*)src;
+	#if GFX_SIMD_AVX2
+		// a: x0y0z0x1y1z1x2y2 b: z2x3y3z3x4y4z4x5 c: y5z5x6y6z6x7y7z7
+		__m256 a = _mm256_loadu_ps(p);
+		__m256 b = _mm256_loadu_ps(p + 8);
+		__m256 c = _mm256_loadu_ps(p + 16);
+		__m256 tx = _mm256_blend_ps(_mm256_blend_ps(a, b, 0x92), c, 0x24);
+		__m256 ty = _mm256_blend_ps(_mm256_blend_ps(c, a, 0x92), b, 0x24);
+		__m256 tz = _mm256_blend_ps(_mm256_blend_ps(b, c, 0x92), a, 0x24);
+		x = _mm256_permutevar8x32_ps(tx, _mm256_setr_epi32(0, 3, 6, 1, 4, 7, 2, 5));
+		y = _mm256_permutevar8x32_ps(ty, _mm256_setr_epi32(1, 4, 7, 2, 5, 0, 3, 6));
+		z = _mm256_permutevar8x32_ps(tz, _mm256_setr_epi32(2, 5, 0, 3, 6, 1, 4, 7));
+	#else
+		// same shuffles as Float4_Gather
+		__m256 a = Float8_Load2(p, p + 12);
+		__m256 b = Float8_Load2(p + 4, p + 16);
+		__m256 c = Float8_Load2(p + 8, p + 20);
+		__m256 t = _mm256_shuffle_ps(b, c, _MM_SHUFFLE(1, 1, 2, 2));
+		x = _mm256_shuffle_ps(a, t, _MM_SHUFFLE(2, 0, 3, 0));
+		__m256 t1 = _mm256_shuffle_ps(a, b, _MM_SHUFFLE(0, 0, 1, 1));
+		__m256 t2 = _mm256_shuffle_ps(b, c, _MM_SHUFFLE(2, 2, 3, 3));
+		y = _mm256_shuffle_ps(t1, t2, _MM_SHUFFLE(2, 0, 2, 0));
+		t1 = _mm256_shuffle_ps(a, b, _MM_SHUFFLE(1, 1, 2, 2));
+		t2 = _mm256_shuffle_ps(c, c, _MM_SHUFFLE(3, 3, 0, 0));
+		z = _mm256_shuffle_ps(t1, t2, _MM_SHUFFLE(2, 0, 2, 0));
+	#endif
+		w = _mm256_set1_ps(1.0f);
+		return;
+	}
+#endif
+	Float4 x0, y0, z0, w0, x1, y1, z1, w1;
+	Float4_Gather<N>(src, stride, x0, y0, z0, w0);
+	Float4_Gather<N>(src + stride * 4, stride, x1, y1, z1, w1);
+	x = Float8_Join(x0, x1);
+	y = Float8_Join(y0, y1);
+	z = Float8_Join(z0, z1);
+	w = Float8_Join(w0, w1);
+}
+
+template <int N>
+inline void Float8_Scatter(uint8_t *dst, size_t stride,
+		const Float8& x, const Float8& y, const Float8& z, const Float8& w)
+{
+#if GFX_SIMD_AVX2
+	if (N == 3 && stride == sizeof(float) * 3) {
+		// the gather in reverse
+		float *p = (float*)dst;
+		__m256 tx = _mm256_permutevar8x32_ps(x.v, _mm256_setr_epi32(0, 3, 6, 1, 4, 7, 2, 5));
+		__m256 ty = _mm256_permutevar8x32_ps(y.v, _mm256_setr_epi32(5, 0, 3, 6, 1, 4, 7, 2));
+		__m256 tz = _mm256_permutevar8x32_ps(z.v, _mm256_setr_epi32(2, 5, 0, 3, 6, 1, 4, 7));
+		_mm256_storeu_ps(p, _mm256_blend_ps(_mm256_blend_ps(tx, ty, 0x92), tz, 0x24));
+		_mm256_storeu_ps(p + 8, _mm256_blend_ps(_mm256_blend_ps(tz, tx, 0x92), ty, 0x24));
+		_mm256_storeu_ps(p + 16, _mm256_blend_ps(_mm256_blend_ps(ty, tz, 0x92), tx, 0x24));
+		return;
+	}
+#endif
+#if GFX_SIMD_AVX
+	if (N == 4 || stride == sizeof(float) * 3) {
+		__m256 a = x.v, b = y.v, c = z.v, d = w.v;
+		Float8_Transpose4(a, b, c, d);
+		__m128 r[8] = {
+			_mm256_castps256_ps128(a), _mm256_castps256_ps128(b),
+			_mm256_castps256_ps128(c), _mm256_castps256_ps128(d),
+			_mm256_extractf128_ps(a, 1), _mm256_extractf128_ps(b, 1),
+			_mm256_extractf128_ps(c, 1), _mm256_extractf128_ps(d, 1) };
+		if (N == 4) {
+			for (int i = 0; i < 8; i++) {
+				_mm_storeu_ps((float*)(dst + stride * i), r[i]);
+			}
+		}
+		else {
+			// packed Vector3: in order, each store overwrites the
+			// garbage lane of the previous one, the last is 12 bytes
+			float *p = (float*)dst;
+			for (int i = 0; i < 7; i++) {
+				_mm_storeu_ps(p + i * 3, r[i]);
+			}
+			_mm_storel_pi((__m64*)(p + 21), r[7]);
+			_mm_store_ss(p + 23, _mm_movehl_ps(r[7], r[7]));
+		}
+		return;
+	}
+#endif
+	Float4_Scatter<N>(dst, stride, Float8_Lo(x), Float8_Lo(y), Float8_Lo(z), Float8_Lo(w));
+	Float4_Scatter<N>(dst + stride * 4, stride, Float8_Hi(x), Float8_Hi(y),
+			Float8_Hi(z), Float8_Hi(w));
+}
+
+inline Float8 Pow2(const Float8& n) {
+#if GFX_SIMD_AVX2
+	__m256i e = _mm256_add_epi32(_mm256_cvttps_epi32(n.v), _mm256_set1_epi32(127));
+	return _mm256_castsi256_ps(_mm256_slli_epi32(e, 23));
+#elif GFX_SIMD_AVX
+	return Float8_Join(Pow2(Float8_Lo(n)), Pow2(Float8_Hi(n)));
+#else
+	return Float8(Pow2(n.lo), Pow2(n.hi));
+#endif
+}
+
+inline Float8 Frexp(const Float8& a, Float8& e) {
+#if GFX_SIMD_AVX2
+	__m256i b = _mm256_castps_si256(a.v);
+	__m256i x = _mm256_srli_epi32(_mm256_and_si256(b, _mm256_set1_epi32(0x7f800000)), 23);
+	e = _mm256_cvtepi32_ps(_mm256_sub_epi32(x, _mm256_set1_epi32(126)));
+	b = _mm256_or_si256(_mm256_and_si256(b, _mm256_set1_epi32(0x807fffff)),
+		_mm256_set1_epi32(0x3f000000));
+	return _mm256_castsi256_ps(b);
+#elif GFX_SIMD_AVX
+	Float4 elo, ehi;
+	Float4 lo = Frexp(Float8_Lo(a), elo);
+	Float4 hi = Frexp(Float8_Hi(a), ehi);
+	e = Float8_Join(elo, ehi);
+	return Float8_Join(lo, hi);
+#else
+	return Float8(Frexp(a.lo, e.lo), Frexp(a.hi, e.hi));
+#endif
+}
+
+
+//---------------------------------------------------------------------
+// Fast math, 4/8 lanes: same polynomials and error bounds as the
+// scalar FastXxx in GFXMath.h, quadrants are picked with masks
+//---------------------------------------------------------------------
+template <class F>
+inline void FastSinCosN(const F& x, F& s, F& c) {
+	F n = Floor(MulAdd(x, F(0.636619772f), F(0.5f)));
+	F r = MulAdd(n, F(-1.5703125f), x);
+	r = MulAdd(n, F(-4.837512969970703125e-4f), r);
+	r = MulAdd(n, F(-7.549533620476723e-8f), r);
+	r = MulAdd(n, F(-2.5632829192545614e-12f), r);
+	r = MulAdd(n, F(-6.123234262925839e-17f), r);
+	F z = r * r;
+	F ps = MulAdd(z, F(-1.9515295891e-4f), F(8.3321608736e-3f));
+	ps = MulAdd(ps, z, F(-1.6666654611e-1f));
+	ps = MulAdd(ps * z, r, r);
+	F pc = MulAdd(z, F(2.443315711809948e-5f), F(-1.388731625493765e-3f));
+	pc = MulAdd(pc, z, F(4.166664568298827e-2f));
+	pc = MulAdd(pc * z, z, MulAdd(z, F(-0.5f), F(1.0f)));
+	// k = n mod 4
+	F k = MulAdd(Floor(n * F(0.25f)), F(-4.0f), n);
+	F swap = Or(CmpEq(k, F(1.0f)), CmpEq(k, F(3.0f)));
+	F sin_neg = CmpGe(k, F(2.0f));
+	F cos_neg = And(CmpGe(k, F(1.0f)), CmpLe(k, F(2.0f)));
+	F ss = Select(swap, pc, ps);
+	F cc = Select(swap, ps, pc);
+	s = Select(sin_neg, -ss, ss);
+	c = Select(cos_neg, -cc, cc);
+}
+
+template <class F>
+inline F FastAtan2N(const F& y, const F& x) {
+	F ax = Abs(x), ay = Abs(y);
+	F hi = Max(ax, ay), lo = Min(ax, ay);
+	F zero = F::Zero();
+	F t = lo / Select(CmpEq(hi, zero), F(1.0f), hi);
+	F big = CmpGt(t, F(0.4142135623730950f));
+	t = Select(big, (t - F(1.0f)) / (t + F(1.0f)), t);
+	F z = t * t;
+	F p = MulAdd(z, F(8.05374449538e-2f), F(-1.38776856032e-1f));
+	p = MulAdd(p, z, F(1.99777106478e-1f));
+	p = MulAdd(p, z, F(-3.33329491539e-1f));
+	F r = MulAdd(p * z, t, t) + And(big, F(PI_DIV_4));
+	r = Select(CmpGt(ay, ax), F(PI_DIV_2) - r, r);
+	r = Select(CmpLt(x, zero), F(PI) - r, r);
+	return Select(CmpLt(y, zero), -r, r);
+}
+
+template <class F>
+inline F FastExpN(const F& x) {
+	F v = Min(Max(x, F(-87.3365447f)), F(88.7228391f));
+	F n = Floor(MulAdd(v, F(1.44269504088896341f), F(0.5f)));
+	F r = MulAdd(n, F(-0.693359375f), v);
+	r = MulAdd(n, F(2.12194440e-4f), r);
+	F p = MulAdd(r, F(1.9875691500e-4f), F(1.3981999507e-3f));
+	p = MulAdd(p, r, F(8.3334519073e-3f));
+	p = MulAdd(p, r, F(4.1665795894e-2f));
+	p = MulAdd(p, r, F(1.6666665459e-1f));
+	p = MulAdd(p, r, F(5.0000001201e-1f));
+	p = MulAdd(p, r * r, r + F(1.0f));
+	F n1 = Floor(n * F(0.5f));
+	return p * Pow2(n1) * Pow2(n - n1);
+}
+
+template <class F>
+inline F FastLogN(const F& x) {
+	F e;
+	F m = Frexp(x, e);
+	F small = CmpLt(m, F(0.707106781186547524f));
+	e = e - And(small, F(1.0f));
+	m = m + And(small, m) - F(1.0f);
+	F z = m * m;
+	F p = MulAdd(m, F(7.0376836292e-2f), F(-1.1514610310e-1f));
+	p = MulAdd(p, m, F(1.1676998740e-1f));
+	p = MulAdd(p, m, F(-1.2420140846e-1f));
+	p = MulAdd(p, m, F(1.4249322787e-1f));
+	p = MulAdd(p, m, F(-1.6668057665e-1f));
+	p = MulAdd(p, m, F(2.0000714765e-1f));
+	p = MulAdd(p, m, F(-2.4999993993e-1f));
+	p = MulAdd(p, m, F(3.3333331174e-1f));
+	F y = MulAdd(e, F(-2.12194440e-4f), p * m * z);
+	y = MulAdd(z, F(-0.5f), y);
+	F r = MulAdd(e, F(0.693359375f), m + y);
+	// log(0) = -inf, log(x < 0) = nan
+	F zero = F::Zero();
+	r = Select(CmpEq(x, zero), F(-HUGE_VALF), r);
+	return Select(CmpLt(x, zero), F(NAN), r);
+}
+
+inline void FastSinCos(const Float4& x, Float4& s, Float4& c) { FastSinCosN(x, s, c); }
+inline void FastSinCos(const Float8& x, Float8& s, Float8& c) { FastSinCosN(x, s, c); }
+
+inline Float4 FastTan(const Float4& x) { Float4 s, c; FastSinCosN(x, s, c); return s / c; }
+inline Float8 FastTan(const Float8& x) { Float8 s, c; FastSinCosN(x, s, c); return s / c; }
+
+inline Float4 FastAtan2(const Float4& y, const Float4& x) { return FastAtan2N(y, x); }
+inline Float8 FastAtan2(const Float8& y, const Float8& x) { return FastAtan2N(y, x); }
+
+inline Float4 FastExp(const Float4& x) { return FastExpN(x); }
+inline Float8 FastExp(const Float8& x) { return FastExpN(x); }
+
+inline Float4 FastLog(const Float4& x) { return FastLogN(x); }
+inline Float8 FastLog(const Float8& x) { return FastLogN(x); }
+
+
+//---------------------------------------------------------------------
+// Namespace End
+//---------------------------------------------------------------------
+NAMESPACE_END(Core);
+NAMESPACE_END(GFX);
+
+
+#endif
+
+
@@ -0,0 +1,175 @@
+//=====================================================================
+//
+// GFXSkinning.cpp - CPU skinning kernels
+//
+// Last Modified: 2026/10/18 14:20:37
+//
+//=====================================================================
+#include "GFXSkinning.h"
+#include "GFXSimd.h"
+#include "GFXVectorSoA.h"
+
+
+//---------------------------------------------------------------------
+// Namespace Begin
+//---------------------------------------------------------------------
+NAMESPACE_BEGIN(GFX);
+NAMESPACE_BEGIN(Core);
+
+
+//---------------------------------------------------------------------
+// linear blend skinning: the weighted bone rows are summed in SIMD
+// registers, then position and normal go through the blended rows
+//---------------------------------------------------------------------
+void Skin_LinearBlend(VertexSt *dst, const VertexSt *src, 
+		const SkinWeight *weights, size_t count, const Matrix4 *bones)
+{
+	for (size_t i = 0; i < count; i++) {
+		const SkinWeight *sw = &weights[i];
+		Float4 r0 = Float4::Zero();
+		Float4 r1 = Float4::Zero();
+		Float4 r2 = Float4::Zero();
+		Float4 r3 = Float4::Zero();
+		for (int k = 0; k < 4; k++) {
+			float w = sw->weight[k];
+			if (w == 0.0f) continue;
+			const Matrix4 *b = &bones[sw->index[k]];
+			Float4 fw(w);
+			r0 = MulAdd(Float4::Load(b->m[0]), fw, r0);
+			r1 = MulAdd(Float4::Load(b->m[1]), fw, r1);
+			r2 = MulAdd(Float4::Load(b->m[2]), fw, r2);
+			r3 = MulAdd(Float4::Load(b->m[3]), fw, r3);
+		}
+		const Vector3& pos = src[i].pos;
+		const Vector3& nrm = src[i].normal;
+		Float4 p = MulAdd(Float4(pos.x), r0, MulAdd(Float4(pos.y), r1,
+					MulAdd(Float4(pos.z), r2, r3)));
+		Float4 n = MulAdd(Float4(nrm.x), r0, MulAdd(Float4(nrm.y), r1,
+					Float4(nrm.z) * r2));
+		float pp[4], nn[4];
+		p.Store(pp);
+		n.Store(nn);
+		float len = nn[0] * nn[0] + nn[1] * nn[1] + nn[2] * nn[2];
+		float k = (len > 0.0f)? InverseSquareRoot(len) : 0.0f;
+		VertexSt *d = &dst[i];
+		if (d != &src[i]) {
+			d->color = src[i].color;
+			d->tuv = src[i].tuv;
+		}
+		d->pos.Set(pp[0], pp[1], pp[2]);
+		d->normal.Set(nn[0] * k, nn[1] * k, nn[2] * k);
+	}
+}
+
+
+//---------------------------------------------------------------------
+// blend up to 4 dual quaternions for one vertex, flipping the sign of
+// influences on the other hemisphere, result is normalized
+//---------------------------------------------------------------------
+static inline void DualQuaternionBlend(const SkinWeight *sw, 
+		const DualQuaternion *bones, float *real, float *dual)
+{
+	Float4 r = Float4::Zero();
+	Float4 d = Float4::Zero();
+	const Quaternion *pivot = NULL;
+	for (int k = 0; k < 4; k++) {
+		float w = sw->weight[k];
+		if (w == 0.0f) continue;
+		const DualQuaternion *b = &bones[sw->index[k]];
+		if (pivot == NULL) {
+			pivot = &b->real;
+		}
+		else if (pivot->Dot(b->real) < 0.0f) {
+			w = -w;
+		}
+		Float4 fw(w);
+		r = MulAdd(Float4::Load(b->real.m), fw, r);
+		d = MulAdd(Float4::Load(b->dual.m), fw, d);
+	}
+	if (pivot == NULL) {
+		real[0] = real[1] = real[2] = 0.0f;
+		real[3] = 1.0f;
+		dual[0] = dual[1] = dual[2] = dual[3] = 0.0f;
+		return;
+	}
+	r.Store(real);
+	d.Store(dual);
+	float len = real[0] * real[0] + real[1] * real[1] + 
+		real[2] * real[2] + real[3] * real[3];
+	float k = InverseSquareRoot(len);
+	for (int i = 0; i < 4; i++) {
+		real[i] *= k;
+		dual[i] *= k;
+	}
+}
+
+
+//---------------------------------------------------------------------
+// dual quaternion skinning, 4 vertices per step: blending is done per
+// vertex, the rotation and translation run on Vector3x4 packets
+//---------------------------------------------------------------------
+void Skin_DualQuaternion(VertexSt *dst, const VertexSt *src,
+		const SkinWeight *weights, size_t count, const DualQuaternion *bones)
+{
+	for (size_t base = 0; base < count; base += 4) {
+		int n = (count - base < 4)? (int)(count - base) : 4;
+		float qr[4][4], qd[4][4];
+		for (int i = 0; i < 4; i++) {
+			float real[4], dual[4];
+			if (i < n) {
+				DualQuaternionBlend(&weights[base + i], bones, real, dual);
+			}
+			else {
+				real[0] = real[1] = real[2] = 0.0f, real[3] = 1.0f;
+				dual[0] = dual[1] = dual[2] = dual[3] = 0.0f;
+			}
+			for (int c = 0; c < 4; c++) {
+				qr[c][i] = real[c];
+				qd[c][i] = dual[c];
+			}
+		}
+		Vector3x4 rv(Float4::Load(qr[0]), Float4::Load(qr[1]), Float4::Load(qr[2]));
+		Vector3x4 dv(Float4::Load(qd[0]), Float4::Load(qd[1]), Float4::Load(qd[2]));
+		Float4 rw = Float4::Load(qr[3]);
+		Float4 dw = Float4::Load(qd[3]);
+		Vector3x4 p, nrm;
+		p.LoadPosition(src + base, n);
+		nrm.LoadNormal(src + base, n);
+		// rotate: v + 2 r x (r x v + w v)
+		Vector3x4 tp = rv.Cross(p) + p * rw;
+		Vector3x4 tn = rv.Cross(nrm) + nrm * rw;
+		p += rv.Cross(tp) * 2.0f;
+		nrm += rv.Cross(tn) * 2.0f;
+		// translation: 2 * vector(dual * conjugate(real))
+		Vector3x4 t = dv * rw - rv * dw + rv.Cross(dv);
+		p += t * 2.0f;
+		if (dst != src) {
+			for (int i = 0; i < n; i++) {
+				dst[base + i].color = src[base + i].color;
+				dst[base + i].tuv = src[base + i].tuv;
+			}
+		}
+		p.StorePosition(dst + base, n);
+		nrm.StoreNormal(dst + base, n);
+	}
+}
+
+
+//---------------------------------------------------------------------
+// rigid matrices to dual quaternions
+//---------------------------------------------------------------------
+void Skin_MatrixToDualQuaternion(DualQuaternion *dst, const Matrix4 *src, size_t count)
+{
+	for (size_t i = 0; i < count; i++) {
+		dst[i].SetMatrix(src[i]);
+	}
+}
+
+
+//---------------------------------------------------------------------
+// Namespace End
+//---------------------------------------------------------------------
+NAMESPACE_END(Core);
+NAMESPACE_END(GFX);
+
+
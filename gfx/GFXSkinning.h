@@ -0,0 +1,60 @@
+//=====================================================================
+//
+// GFXSkinning.h - CPU skinning kernels
+//
+// Last Modified: 2026/10/18 13:41:08
+//
+//=====================================================================
+#ifndef _GFX_SKINNING_H_
+#define _GFX_SKINNING_H_
+
+#include "GFXMatrix.h"
+#include "GFXVertex.h"
+#include "GFXQuaternion.h"
+
+
+//---------------------------------------------------------------------
+// Namespace Begin
+//---------------------------------------------------------------------
+NAMESPACE_BEGIN(GFX);
+NAMESPACE_BEGIN(Core);
+
+
+//---------------------------------------------------------------------
+// SkinWeight - up to 4 bone influences per vertex, unused slots
+// must have a zero weight, weights are expected to sum to one
+//---------------------------------------------------------------------
+struct SkinWeight
+{
+	uint16_t index[4];
+	float weight[4];
+};
+
+
+//---------------------------------------------------------------------
+// Skinning
+//---------------------------------------------------------------------
+
+// linear blend: pos' = pos * sum(w * bone), normals are renormalized,
+// dst may equal src, other members of VertexSt are copied from src
+void Skin_LinearBlend(VertexSt *dst, const VertexSt *src, 
+		const SkinWeight *weights, size_t count, const Matrix4 *bones);
+
+// dual quaternion blend, bones must be rigid (no scale)
+void Skin_DualQuaternion(VertexSt *dst, const VertexSt *src,
+		const SkinWeight *weights, size_t count, const DualQuaternion *bones);
+
+// convert rigid bone matrices to dual quaternions for Skin_DualQuaternion
+void Skin_MatrixToDualQuaternion(DualQuaternion *dst, const Matrix4 *src, size_t count);
+
+
+//---------------------------------------------------------------------
+// Namespace End
+//---------------------------------------------------------------------
+NAMESPACE_END(Core);
+NAMESPACE_END(GFX);
+
+
+#endif
+
+
@@ -0,0 +1,139 @@
+//=====================================================================
+//
+// GFXSnapshot.cpp - lock free transform snapshots across threads
+//
+// Last Modified: 2026/10/18 18:05:17
+//
+//=====================================================================
+#include <stdlib.h>
+#include <string.h>
+#include <new>
+
+#include "GFXSnapshot.h"
+
+
+//---------------------------------------------------------------------
+// Namespace Begin
+//---------------------------------------------------------------------
+NAMESPACE_BEGIN(GFX);
+NAMESPACE_BEGIN(Core);
+
+
+//---------------------------------------------------------------------
+// ctor
+//---------------------------------------------------------------------
+TransformSnapshotBuffer::TransformSnapshotBuffer()
+{
+	for (int i = 0; i < 2; i++) {
+		TransformSnapshot& data = m_slot[i].data;
+		data.world = Matrix4Unit;
+		data.view = Matrix4Unit;
+		data.projection = Matrix4Unit;
+		data.mvp = Matrix4Unit;
+		data.mv = Matrix4Unit;
+		data.vp = Matrix4Unit;
+		data.version = 0;
+		data.opengl = false;
+		m_slot[i].sequence.store(0, std::memory_order_relaxed);
+	}
+	m_version = 0;
+	m_latest.store(0, std::memory_order_release);
+}
+
+
+//---------------------------------------------------------------------
+// dtor
+//---------------------------------------------------------------------
+TransformSnapshotBuffer::~TransformSnapshotBuffer()
+{
+}
+
+
+//---------------------------------------------------------------------
+// 64 byte aligned allocation, the malloc pointer is kept just below
+// the returned address
+//---------------------------------------------------------------------
+void* TransformSnapshotBuffer::operator new (size_t size)
+{
+	void *raw = malloc(size + 64 + sizeof(void*));
+	if (raw == NULL) {
+		throw std::bad_alloc();
+	}
+	size_t aligned = ((size_t)raw + sizeof(void*) + 63) & ~((size_t)63);
+	((void**)aligned)[-1] = raw;
+	return (void*)aligned;
+}
+
+void TransformSnapshotBuffer::operator delete (void *ptr)
+{
+	if (ptr) {
+		free(((void**)ptr)[-1]);
+	}
+}
+
+
+//---------------------------------------------------------------------
+// writer side of the sequence lock: odd while the slot is written.
+// the slot written is never the one m_latest points to
+//---------------------------------------------------------------------
+uint32_t TransformSnapshotBuffer::Publish(const TransformSnapshot& snapshot)
+{
+	uint32_t version = m_version + 1;
+	if (version == 0) {
+		version = 2;	// 0 means never published, keep slots alternating
+	}
+	Slot& slot = m_slot[version & 1];
+	uint32_t sequence = slot.sequence.load(std::memory_order_relaxed);
+	slot.sequence.store(sequence + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	memcpy(&slot.data, &snapshot, sizeof(TransformSnapshot));
+	slot.data.version = version;
+	slot.sequence.store(sequence + 2, std::memory_order_release);
+	m_latest.store(version, std::memory_order_release);
+	m_version = version;
+	return version;
+}
+
+uint32_t TransformSnapshotBuffer::Publish(Transform& transform)
+{
+	TransformSnapshot snapshot;
+	transform.GetSnapshot(snapshot);
+	return Publish(snapshot);
+}
+
+
+//---------------------------------------------------------------------
+// reader side: copy, then retry if the sequence moved meanwhile
+//---------------------------------------------------------------------
+uint32_t TransformSnapshotBuffer::Read(TransformSnapshot& snapshot) const
+{
+	for (;;) {
+		uint32_t latest = m_latest.load(std::memory_order_acquire);
+		const Slot& slot = m_slot[latest & 1];
+		uint32_t s0 = slot.sequence.load(std::memory_order_acquire);
+		if (s0 & 1) continue;
+		memcpy(&snapshot, &slot.data, sizeof(TransformSnapshot));
+		std::atomic_thread_fence(std::memory_order_acquire);
+		uint32_t s1 = slot.sequence.load(std::memory_order_relaxed);
+		if (s0 == s1) {
+			return snapshot.version;
+		}
+	}
+}
+
+bool TransformSnapshotBuffer::ReadNewer(TransformSnapshot& snapshot, uint32_t version) const
+{
+	if (GetVersion() == version) {
+		return false;
+	}
+	return Read(snapshot) != version;
+}
+
+
+//---------------------------------------------------------------------
+// Namespace End
+//---------------------------------------------------------------------
+NAMESPACE_END(Core);
+NAMESPACE_END(GFX);
+
+
@@ -0,0 +1,82 @@
+//=====================================================================
+//
+// GFXSnapshot.h - lock free transform snapshots across threads
+//
+// Last Modified: 2026/10/18 18:05:17
+//
+//=====================================================================
+#ifndef _GFX_SNAPSHOT_H_
+#define _GFX_SNAPSHOT_H_
+
+#include <atomic>
+
+#include "GFXTransform.h"
+
+
+//---------------------------------------------------------------------
+// Namespace Begin
+//---------------------------------------------------------------------
+NAMESPACE_BEGIN(GFX);
+NAMESPACE_BEGIN(Core);
+
+
+//---------------------------------------------------------------------
+// TransformSnapshotBuffer - one producer (game thread) publishes,
+// any number of consumers (render thread) read the latest snapshot.
+// two slots, each guarded by its own sequence lock: the producer
+// always writes the slot readers are not directed to, so a reader
+// only retries when it was stalled for a whole publish. neither side
+// takes a lock and the producer never waits.
+//---------------------------------------------------------------------
+class TransformSnapshotBuffer
+{
+public:
+	virtual ~TransformSnapshotBuffer();
+	TransformSnapshotBuffer();
+
+	// the slots are cache line aligned, plain new only guarantees 16
+	static void* operator new (size_t size);
+	static void operator delete (void *ptr);
+
+public:
+	// producer: version increases by one per publish, returns it
+	uint32_t Publish(const TransformSnapshot& snapshot);
+
+	// producer: snapshot of transform (mvp is brought up to date)
+	uint32_t Publish(Transform& transform);
+
+	// consumer: copy of the latest snapshot, returns its version, 0
+	// (and an identity snapshot) before the first publish
+	uint32_t Read(TransformSnapshot& snapshot) const;
+
+	// consumer: Read() only when the latest version differs from
+	// version, returns true when a different snapshot was copied
+	bool ReadNewer(TransformSnapshot& snapshot, uint32_t version) const;
+
+	// version of the latest snapshot
+	inline uint32_t GetVersion() const {
+		return m_latest.load(std::memory_order_acquire);
+	}
+
+protected:
+	GFX_ALIGNED_STRUCT(64) Slot {
+		std::atomic<uint32_t> sequence;
+		TransformSnapshot data;
+	};
+
+	Slot m_slot[2];
+	GFX_ALIGNED_DATA(64) std::atomic<uint32_t> m_latest;
+	uint32_t m_version;
+};
+
+
+//---------------------------------------------------------------------
+// Namespace End
+//---------------------------------------------------------------------
+NAMESPACE_END(Core);
+NAMESPACE_END(GFX);
+
+
+#endif
+
+
@@ -6,6 +6,8 @@
 //
 //=====================================================================
 #include "GFXTexture.h"
+#include "GFXPixel.h"
+#include "GFXDriver.h"
 
 //---------------------------------------------------------------------
 // Namespace Begin
@@ -18,7 +20,9 @@ NAMESPACE_BEGIN(GFX);
 //---------------------------------------------------------------------
 Texture::Texture()
 {
+	m_driver = NULL;
 	InitSize(0, 0, FMT_A8R8G8B8, true);
+	ResetUploadStats();
 }
 
 
@@ -28,6 +32,10 @@ Texture::Texture()
 //---------------------------------------------------------------------
 Texture::~Texture()
 {
+	if (m_driver) {
+		m_driver->DetachTexture(this);
+		m_driver = NULL;
+	}
 }
 
 
@@ -48,6 +56,8 @@ void Texture::InitSize(int w, int h, PixelFormat fmt, bool lockable)
 	m_inv_width = (w == 0)? 0.0f : 1.0f / ((float)w);
 	m_inv_height = (h == 0)? 0.0f : 1.0f / ((float)h);
 	m_lockable = lockable;
+	m_staging.clear();
+	m_pending = 0;
 }
 
 
@@ -78,6 +88,9 @@ int Texture::GetLevelHeight(int level) const
 //---------------------------------------------------------------------
 bool Texture::UpdateTexture(int mip, const Rect *rect, const void *bits, int pitch)
 {
+	if (m_driver) {
+		return StageUpdate(mip, rect, bits, pitch, m_format);
+	}
 	if (m_lockable && m_locked_bits == NULL) {
 		const uint8_t *src = reinterpret_cast<const uint8_t*>(bits);
 		Rect rc;
@@ -114,6 +127,9 @@ bool Texture::UpdateTexture(int mip, const Rect *rect, const void *bits, int pit
 //---------------------------------------------------------------------
 bool Texture::ReadTexture(int mip, const Rect *rect, void *bits, int pitch)
 {
+	if (m_pending > 0) {
+		Flush();
+	}
 	if (m_lockable && m_locked_bits == NULL) {
 		uint8_t *dst = reinterpret_cast<uint8_t*>(bits);
 		Rect rc;
@@ -137,6 +153,8 @@ bool Texture::ReadTexture(int mip, const Rect *rect, void *bits, int pitch)
 			dst += pitch;
 			src += m_locked_pitch;
 		}
+		Unlock(mip);
+		return true;
 	}
 	return false;
 }
@@ -182,10 +200,9 @@ int Texture::PostReset()
 //---------------------------------------------------------------------
 void Texture::CopyTo(int mip, int x, int y, Image *src, int sx, int sy, int sw, int sh)
 {
-	if (GetBpp() != src->GetBpp()) {
-		return;
+	if (m_pending > 0) {
+		Flush();
 	}
-	int pixelbytes = m_bpp / 8;
 	if (mip == 0) {
 		int clipdst[4] = { 0, 0, GetWidth(), GetHeight() };
 		int clipsrc[4] = { 0, 0, src->GetWidth(), src->GetHeight() };
@@ -204,8 +221,13 @@ void Texture::CopyTo(int mip, int x, int y, Image *src, int sx, int sy, int sw,
 	rc.top = y;
 	rc.right = x + sw;
 	rc.bottom = y + sh;
-	unsigned char *bits = src->GetLine(sy) + pixelbytes * sx;
-	ReadTexture(mip, &rc, bits, src->GetPitch());
+	unsigned char *bits = src->GetLine(sy) + (src->GetBpp() / 8) * sx;
+	if (src->GetFormat() == m_format) {
+		ReadTexture(mip, &rc, bits, src->GetPitch());
+	}
+	else {
+		ReadConverted(mip, &rc, bits, src->GetPitch(), src->GetFormat());
+	}
 }
 
 
@@ -214,10 +236,6 @@ void Texture::CopyTo(int mip, int x, int y, Image *src, int sx, int sy, int sw,
 //---------------------------------------------------------------------
 void Texture::CopyFrom(int mip, int x, int y, const Image *src, int sx, int sy, int sw, int sh)
 {
-	if (GetBpp() != src->GetBpp()) {
-		return;
-	}
-	int pixelbytes = m_bpp / 8;
 	if (mip == 0) {
 		int clipdst[4] = { 0, 0, GetWidth(), GetHeight() };
 		int clipsrc[4] = { 0, 0, src->GetWidth(), src->GetHeight() };
@@ -236,8 +254,57 @@ void Texture::CopyFrom(int mip, int x, int y, const Image *src, int sx, int sy,
 	rc.top = y;
 	rc.right = x + sw;
 	rc.bottom = y + sh;
-	const unsigned char *bits = src->GetLine(sy) + pixelbytes * sx;
-	UpdateTexture(mip, &rc, bits, src->GetPitch());
+	const unsigned char *bits = src->GetLine(sy) + (src->GetBpp() / 8) * sx;
+	if (m_driver) {
+		StageUpdate(mip, &rc, bits, src->GetPitch(), src->GetFormat());
+	}
+	else if (src->GetFormat() == m_format) {
+		UpdateTexture(mip, &rc, bits, src->GetPitch());
+	}
+	else {
+		UpdateConverted(mip, &rc, bits, src->GetPitch(), src->GetFormat());
+	}
+}
+
+
+//---------------------------------------------------------------------
+// read rect converted to fmt: one lock at a time, the texture must
+// not be locked already
+//---------------------------------------------------------------------
+bool Texture::ReadConverted(int mip, const Rect *rect, void *bits, int pitch,
+		PixelFormat fmt)
+{
+	if (m_lockable == false || m_locked_bits != NULL) {
+		return false;
+	}
+	const void *locked = Lock(mip, rect, true);
+	if (locked == NULL) {
+		return false;
+	}
+	ConvertPixels(bits, pitch, fmt, locked, m_locked_pitch, m_format,
+			rect->right - rect->left, rect->bottom - rect->top);
+	Unlock(mip);
+	return true;
+}
+
+
+//---------------------------------------------------------------------
+// write rect converted from fmt
+//---------------------------------------------------------------------
+bool Texture::UpdateConverted(int mip, const Rect *rect, const void *bits, int pitch,
+		PixelFormat fmt)
+{
+	if (m_lockable == false || m_locked_bits != NULL) {
+		return false;
+	}
+	void *locked = Lock(mip, rect, false);
+	if (locked == NULL) {
+		return false;
+	}
+	ConvertPixels(locked, m_locked_pitch, m_format, bits, pitch, fmt,
+			rect->right - rect->left, rect->bottom - rect->top);
+	Unlock(mip);
+	return true;
 }
 
 
@@ -246,16 +313,19 @@ void Texture::CopyFrom(int mip, int x, int y, const Image *src, int sx, int sy,
 //---------------------------------------------------------------------
 void Texture::CopyFrom(int x, int y, Texture *src, int sx, int sy, int sw, int sh)
 {
-	if (GetBpp() != src->GetBpp()) {
-		return;
-	}
 	if (m_lockable == false || src->m_lockable == false) {
 		return;
 	}
-	unsigned char *sbits = (unsigned char*)Lock(0, NULL, false);
-	if (sbits == NULL) return;
-	unsigned char *dbits = (unsigned char*)src->Lock(0, NULL, true);
-	if (dbits) {
+	if (m_pending > 0) {
+		Flush();
+	}
+	if (src->m_pending > 0) {
+		src->Flush();
+	}
+	unsigned char *dbits = (unsigned char*)Lock(0, NULL, false);
+	if (dbits == NULL) return;
+	const unsigned char *sbits = (const unsigned char*)src->Lock(0, NULL, true);
+	if (sbits) {
 		int clipdst[4] = { 0, 0, GetWidth(), GetHeight() };
 		int clipsrc[4] = { 0, 0, src->GetWidth(), src->GetHeight() };
 		int rectsrc[4] = { sx, sy, sx + sw, sy + sh };
@@ -265,13 +335,11 @@ void Texture::CopyFrom(int x, int y, Texture *src, int sx, int sy, int sw, int s
 			sy = rectsrc[1];
 			sw = rectsrc[2] - rectsrc[0];
 			sh = rectsrc[3] - rectsrc[1];
-			int need = sw * (GetBpp() / 8);
-			int pixelbytes = m_bpp / 8;
-			for (int j = 0; j < sh; j++) {
-				const unsigned char *ss = dbits + (sy + j) * src->m_locked_pitch;
-				unsigned char *dd = sbits + (y + j) * m_locked_pitch; 
-				memcpy(dd + pixelbytes * x, ss + pixelbytes * sx, need);
-			}
+			const unsigned char *ss = sbits + sy * src->m_locked_pitch + 
+				(src->m_bpp / 8) * sx;
+			unsigned char *dd = dbits + y * m_locked_pitch + (m_bpp / 8) * x;
+			ConvertPixels(dd, m_locked_pitch, m_format, ss, src->m_locked_pitch,
+					src->m_format, sw, sh);
 		}
 		src->Unlock(0);
 	}
@@ -279,6 +347,200 @@ void Texture::CopyFrom(int x, int y, Texture *src, int sx, int sy, int sw, int s
 }
 
 
+//---------------------------------------------------------------------
+// deferred mode
+//---------------------------------------------------------------------
+void Texture::SetDeferred(VideoDriver *driver)
+{
+	if (driver == m_driver) {
+		return;
+	}
+	if (m_driver) {
+		Flush();
+		m_driver->DetachTexture(this);
+		m_staging.clear();
+	}
+	m_driver = driver;
+	if (m_driver) {
+		m_driver->AttachTexture(this);
+	}
+}
+
+
+//---------------------------------------------------------------------
+// reset stats
+//---------------------------------------------------------------------
+void Texture::ResetUploadStats()
+{
+	memset(&m_upload_stats, 0, sizeof(m_upload_stats));
+	m_upload_reported = m_upload_stats;
+}
+
+
+//---------------------------------------------------------------------
+// stage an update: the rect is merged with every pending rect whose
+// bounding box is exactly their union (one contains the other, or they
+// overlap / touch along a whole side), so a merged rect never covers
+// texels that were not staged. past TEXTURE_MAX_RECTS the level is
+// flushed instead
+//---------------------------------------------------------------------
+#define TEXTURE_MAX_RECTS	64
+
+static inline int64_t TextureRectArea(const Rect& r)
+{
+	return (int64_t)(r.right - r.left) * (r.bottom - r.top);
+}
+
+static inline int64_t TextureRectOverlap(const Rect& a, const Rect& b)
+{
+	int w = ((a.right < b.right)? a.right : b.right) - ((a.left > b.left)? a.left : b.left);
+	int h = ((a.bottom < b.bottom)? a.bottom : b.bottom) - ((a.top > b.top)? a.top : b.top);
+	return (w > 0 && h > 0)? (int64_t)w * h : 0;
+}
+
+static inline Rect TextureRectUnion(const Rect& a, const Rect& b)
+{
+	Rect r;
+	r.left = (a.left < b.left)? a.left : b.left;
+	r.top = (a.top < b.top)? a.top : b.top;
+	r.right = (a.right > b.right)? a.right : b.right;
+	r.bottom = (a.bottom > b.bottom)? a.bottom : b.bottom;
+	return r;
+}
+
+bool Texture::StageUpdate(int mip, const Rect *rect, const void *bits, int pitch,
+		PixelFormat fmt)
+{
+	if (mip < 0 || mip >= m_levels) {
+		return false;
+	}
+	int lw = GetLevelWidth(mip);
+	int lh = GetLevelHeight(mip);
+	Rect rc;
+	if (rect == NULL) {
+		rc.left = 0;
+		rc.top = 0;
+		rc.right = lw;
+		rc.bottom = lh;
+	}
+	else {
+		rc = *rect;
+		if (rc.left < 0 || rc.top < 0 || rc.right > lw || rc.bottom > lh) {
+			return false;
+		}
+		if (rc.left >= rc.right || rc.top >= rc.bottom) {
+			return false;
+		}
+	}
+	if ((int)m_staging.size() < m_levels) {
+		m_staging.resize(m_levels);
+	}
+	Staging& staging = m_staging[mip];
+	if (staging.bits.empty()) {
+		staging.pitch = lw * (m_bpp / 8);
+		staging.bits.resize((size_t)staging.pitch * lh);
+	}
+	int w = rc.right - rc.left;
+	int h = rc.bottom - rc.top;
+	uint8_t *dst = &staging.bits[0] + (size_t)staging.pitch * rc.top +
+		rc.left * (m_bpp / 8);
+	if (!ConvertPixels(dst, staging.pitch, m_format, bits, pitch, fmt, w, h)) {
+		return false;
+	}
+	m_upload_stats.updates++;
+	m_upload_stats.bytes_staged += (uint64_t)w * h * (m_bpp / 8);
+
+	std::vector<Rect>& rects = staging.rects;
+	for (size_t i = 0; i < rects.size(); ) {
+		Rect u = TextureRectUnion(rects[i], rc);
+		if (TextureRectArea(u) != TextureRectArea(rects[i]) + TextureRectArea(rc) -
+				TextureRectOverlap(rects[i], rc)) {
+			i++;
+			continue;
+		}
+		// the union may now touch rects already passed, start over
+		rc = u;
+		rects[i] = rects.back();
+		rects.pop_back();
+		m_pending--;
+		m_upload_stats.rects_merged++;
+		i = 0;
+	}
+	if (rects.size() >= TEXTURE_MAX_RECTS) {
+		// widening a rect would upload stale staging texels. when the
+		// level can't be locked it just keeps more rects
+		FlushLevel(mip);
+	}
+	rects.push_back(rc);
+	m_pending++;
+	return true;
+}
+
+
+//---------------------------------------------------------------------
+// flush: one lock of the bounding box per level, then every rect is
+// copied from the staging level. a level that can't be locked stays
+// pending
+//---------------------------------------------------------------------
+int Texture::FlushLevel(int mip)
+{
+	Staging& staging = m_staging[mip];
+	std::vector<Rect>& rects = staging.rects;
+	if (rects.empty()) {
+		return 0;
+	}
+	Rect bound = rects[0];
+	for (size_t i = 1; i < rects.size(); i++) {
+		bound = TextureRectUnion(bound, rects[i]);
+	}
+	uint8_t *bits = (uint8_t*)Lock(mip, &bound, false);
+	if (bits == NULL) {
+		return 0;
+	}
+	int bpp = m_bpp / 8;
+	for (size_t i = 0; i < rects.size(); i++) {
+		const Rect& rc = rects[i];
+		int size = (rc.right - rc.left) * bpp;
+		const uint8_t *src = &staging.bits[0] + (size_t)staging.pitch * rc.top +
+			rc.left * bpp;
+		uint8_t *dst = bits + (ptrdiff_t)m_locked_pitch * (rc.top - bound.top) +
+			(rc.left - bound.left) * bpp;
+		for (int y = rc.top; y < rc.bottom; y++) {
+			memcpy(dst, src, size);
+			src += staging.pitch;
+			dst += m_locked_pitch;
+		}
+		m_upload_stats.bytes_uploaded += (uint64_t)size * (rc.bottom - rc.top);
+	}
+	Unlock(mip);
+	int count = (int)rects.size();
+	m_upload_stats.locks++;
+	m_upload_stats.rects_uploaded += count;
+	m_pending -= count;
+	rects.clear();
+	return count;
+}
+
+int Texture::Flush(TextureUploadStats *stats)
+{
+	int count = 0;
+	for (int mip = 0; mip < (int)m_staging.size() && m_pending > 0; mip++) {
+		count += FlushLevel(mip);
+	}
+	if (stats) {
+		// everything since the last report, staging included
+		stats->updates += m_upload_stats.updates - m_upload_reported.updates;
+		stats->rects_merged += m_upload_stats.rects_merged - m_upload_reported.rects_merged;
+		stats->rects_uploaded += m_upload_stats.rects_uploaded - m_upload_reported.rects_uploaded;
+		stats->locks += m_upload_stats.locks - m_upload_reported.locks;
+		stats->bytes_staged += m_upload_stats.bytes_staged - m_upload_reported.bytes_staged;
+		stats->bytes_uploaded += m_upload_stats.bytes_uploaded - m_upload_reported.bytes_uploaded;
+		m_upload_reported = m_upload_stats;
+	}
+	return count;
+}
+
+
 //---------------------------------------------------------------------
 // save to image
 //---------------------------------------------------------------------
@@ -22,6 +22,20 @@ NAMESPACE_BEGIN(GFX);
 class VideoDriver;
 
 
+//---------------------------------------------------------------------
+// counters of deferred uploads (Texture::SetDeferred)
+//---------------------------------------------------------------------
+struct TextureUploadStats
+{
+	uint64_t updates;          // UpdateTexture / CopyFrom calls staged
+	uint64_t rects_merged;     // staged rects folded into another one
+	uint64_t rects_uploaded;   // rects copied by flushes
+	uint64_t locks;            // Lock calls made by flushes
+	uint64_t bytes_staged;     // bytes written to the staging levels
+	uint64_t bytes_uploaded;   // bytes copied into the texture
+};
+
+
 //---------------------------------------------------------------------
 // Texture
 //---------------------------------------------------------------------
@@ -52,12 +66,32 @@ public:
 	virtual int GetLevelWidth(int level) const;
 	virtual int GetLevelHeight(int level) const;
 
+	// deferred uploads: with a driver set, UpdateTexture and CopyFrom
+	// write into a system memory copy of the level and record the rect,
+	// rects whose union is a rectangle are merged, and Flush uploads them
+	// with one Lock per level. the driver flushes its deferred textures
+	// at BeginScene, until then Lock sees the old content. ReadTexture,
+	// CopyTo and CopyFrom of a texture flush what they read first.
+	// NULL flushes and goes back to immediate uploads
+	void SetDeferred(VideoDriver *driver);
+	inline bool IsDeferred() const { return m_driver != NULL; }
+	inline int GetPendingRects() const { return m_pending; }
+
+	// upload the pending rects, returns how many. the texture's own
+	// stats count everything, stats (may be NULL) gets what happened
+	// since the last call that passed one
+	int Flush(TextureUploadStats *stats = NULL);
+
+	inline const TextureUploadStats& GetUploadStats() const { return m_upload_stats; }
+	void ResetUploadStats();
+
 	inline virtual bool Available() const { return false; }
 
 	inline int GetWidth() const { return m_width; }
 	inline int GetHeight() const { return m_height; }
 	inline PixelFormat GetFormat() const { return m_format; }
 	inline int GetBpp() const { return m_bpp; }
+	inline int GetLevels() const { return m_levels; }
 
 	inline float GetInvWidth() const { return m_inv_width; }
 	inline float GetInvHeight() const { return m_inv_height; }
@@ -72,6 +106,25 @@ public:
 protected:
 	void InitSize(int w, int h, PixelFormat fmt, bool lockable);
 
+	// copy (converting from fmt) into the staging level and record rect
+	bool StageUpdate(int mip, const Rect *rect, const void *bits, int pitch,
+			PixelFormat fmt);
+
+	// upload the pending rects of one level, returns how many
+	int FlushLevel(int mip);
+
+	// the format converting paths of CopyTo / CopyFrom, rect is set
+	virtual bool ReadConverted(int mip, const Rect *rect, void *bits, int pitch,
+			PixelFormat fmt);
+	virtual bool UpdateConverted(int mip, const Rect *rect, const void *bits, int pitch,
+			PixelFormat fmt);
+
+	struct Staging {
+		std::vector<uint8_t> bits;
+		int32_t pitch;
+		std::vector<Rect> rects;
+	};
+
 protected:
 	PixelFormat m_format;
 	int m_bpp;
@@ -85,6 +138,11 @@ protected:
 	int m_locked_h;
 	uint8_t *m_locked_bits;
 	int32_t m_locked_pitch;
+	VideoDriver *m_driver;
+	std::vector<Staging> m_staging;
+	int m_pending;
+	TextureUploadStats m_upload_stats;
+	TextureUploadStats m_upload_reported;
 };
 
 
@@ -0,0 +1,208 @@
+//=====================================================================
+//
+// GFXTexturePool.cpp - recycling of textures by description
+//
+// Last Modified: 2026/10/18 23:12:44
+//
+//=====================================================================
+#include "GFXTexturePool.h"
+#include "GFXMipmap.h"
+
+
+//---------------------------------------------------------------------
+// Namespace Begin
+//---------------------------------------------------------------------
+NAMESPACE_BEGIN(GFX);
+
+
+//---------------------------------------------------------------------
+// ctor
+//---------------------------------------------------------------------
+TexturePool::TexturePool()
+{
+	m_budget = 64 * 1024 * 1024;
+	ResetStats();
+}
+
+
+//---------------------------------------------------------------------
+// dtor
+//---------------------------------------------------------------------
+TexturePool::~TexturePool()
+{
+	Purge();
+}
+
+
+//---------------------------------------------------------------------
+// key
+//---------------------------------------------------------------------
+bool TexturePool::Key::operator < (const Key& k) const
+{
+	if (width != k.width) return width < k.width;
+	if (height != k.height) return height < k.height;
+	if (format != k.format) return format < k.format;
+	if (levels != k.levels) return levels < k.levels;
+	return flag < k.flag;
+}
+
+TexturePool::Key TexturePool::MakeKey(const TextureDesc& desc)
+{
+	Key key;
+	key.width = desc.width;
+	key.height = desc.height;
+	key.format = (int)desc.format;
+	key.levels = desc.levels;
+	key.flag = desc.flag;
+	return key;
+}
+
+
+//---------------------------------------------------------------------
+// memory estimate
+//---------------------------------------------------------------------
+size_t TexturePool::GetMemorySize(const TextureDesc& desc)
+{
+	int levels = GetMipmapLevels(desc.width, desc.height);
+	if (desc.levels > 0 && desc.levels < levels) {
+		levels = desc.levels;
+	}
+	size_t bytes = 0;
+	size_t bpp = (size_t)Image::FormatToBpp(desc.format) / 8;
+	for (int i = 0; i < levels; i++) {
+		int w = desc.width >> i;
+		int h = desc.height >> i;
+		bytes += (size_t)((w < 1)? 1 : w) * ((h < 1)? 1 : h) * bpp;
+	}
+	return bytes;
+}
+
+
+//---------------------------------------------------------------------
+// settings
+//---------------------------------------------------------------------
+void TexturePool::SetFactory(TextureFactory factory)
+{
+	m_factory = factory;
+}
+
+void TexturePool::SetBudget(size_t bytes)
+{
+	m_budget = bytes;
+	Trim(m_budget);
+}
+
+void TexturePool::ResetStats()
+{
+	m_stats.hits = 0;
+	m_stats.misses = 0;
+	m_stats.evictions = 0;
+	m_stats.failures = 0;
+	m_stats.idle_bytes = 0;
+	m_stats.idle_count = 0;
+	m_stats.live_count = 0;
+	for (IdleList::iterator it = m_lru.begin(); it != m_lru.end(); ++it) {
+		m_stats.idle_bytes += it->bytes;
+		m_stats.idle_count++;
+	}
+	m_stats.live_count = (int)m_live.size();
+}
+
+
+//---------------------------------------------------------------------
+// acquire: the most recently released texture of the key, or a new one
+//---------------------------------------------------------------------
+Texture* TexturePool::Acquire(const TextureDesc& desc)
+{
+	Texture *texture = NULL;
+	std::map<Key, std::list<IdleList::iterator> >::iterator it = m_free.find(MakeKey(desc));
+	if (it != m_free.end()) {
+		IdleList::iterator idle = it->second.back();
+		texture = idle->texture;
+		m_stats.idle_bytes -= idle->bytes;
+		m_stats.idle_count--;
+		m_lru.erase(idle);
+		it->second.pop_back();
+		if (it->second.empty()) {
+			m_free.erase(it);
+		}
+		m_stats.hits++;
+	}
+	else {
+		if (m_factory) {
+			texture = m_factory(desc);
+		}
+		if (texture == NULL) {
+			m_stats.failures++;
+			return NULL;
+		}
+		m_stats.misses++;
+	}
+	m_live[texture] = desc;
+	m_stats.live_count++;
+	return texture;
+}
+
+Texture* TexturePool::Acquire(int w, int h, PixelFormat fmt, int levels, int flag)
+{
+	TextureDesc desc;
+	desc.width = w;
+	desc.height = h;
+	desc.format = fmt;
+	desc.levels = levels;
+	desc.flag = flag;
+	return Acquire(desc);
+}
+
+
+//---------------------------------------------------------------------
+// release: newest at the back of the lru and of its key's free list
+//---------------------------------------------------------------------
+bool TexturePool::Release(Texture *texture)
+{
+	std::map<Texture*, TextureDesc>::iterator it = m_live.find(texture);
+	if (it == m_live.end()) {
+		return false;
+	}
+	Idle idle;
+	idle.key = MakeKey(it->second);
+	idle.texture = texture;
+	idle.bytes = GetMemorySize(it->second);
+	m_live.erase(it);
+	m_stats.live_count--;
+	m_lru.push_back(idle);
+	m_free[idle.key].push_back(--m_lru.end());
+	m_stats.idle_bytes += idle.bytes;
+	m_stats.idle_count++;
+	Trim(m_budget);
+	return true;
+}
+
+
+//---------------------------------------------------------------------
+// trim: the front of the lru is also the front of its key's list
+//---------------------------------------------------------------------
+void TexturePool::Trim(size_t bytes)
+{
+	while (!m_lru.empty() && (m_stats.idle_bytes > bytes || bytes == 0)) {
+		Idle& idle = m_lru.front();
+		std::map<Key, std::list<IdleList::iterator> >::iterator it = m_free.find(idle.key);
+		it->second.pop_front();
+		if (it->second.empty()) {
+			m_free.erase(it);
+		}
+		m_stats.idle_bytes -= idle.bytes;
+		m_stats.idle_count--;
+		m_stats.evictions++;
+		delete idle.texture;
+		m_lru.pop_front();
+	}
+}
+
+
+//---------------------------------------------------------------------
+// Namespace End
+//---------------------------------------------------------------------
+NAMESPACE_END(GFX);
+
+
@@ -0,0 +1,133 @@
+//=====================================================================
+//
+// GFXTexturePool.h - recycling of textures by description
+//
+// Last Modified: 2026/10/18 23:12:44
+//
+//=====================================================================
+#ifndef _GFX_TEXTURE_POOL_H_
+#define _GFX_TEXTURE_POOL_H_
+
+#include <functional>
+#include <list>
+#include <map>
+
+#include "GFXTexture.h"
+
+
+//---------------------------------------------------------------------
+// Namespace Begin
+//---------------------------------------------------------------------
+NAMESPACE_BEGIN(GFX);
+
+
+//---------------------------------------------------------------------
+// description of a texture, every field is part of the pool key.
+// levels is as in CD3D9Texture::Create (0: full chain), flag is the
+// backend's creation flag (0xffff: render target for D3D9)
+//---------------------------------------------------------------------
+struct TextureDesc
+{
+	int width;
+	int height;
+	PixelFormat format;
+	int levels;
+	int flag;
+};
+
+// creates a texture for desc with some backend, NULL on failure
+typedef std::function<Texture*(const TextureDesc& desc)> TextureFactory;
+
+
+//---------------------------------------------------------------------
+// pool counters
+//---------------------------------------------------------------------
+struct TexturePoolStats
+{
+	uint64_t hits;          // Acquire served from a free list
+	uint64_t misses;        // Acquire that created a texture
+	uint64_t evictions;     // idle textures deleted for the budget
+	uint64_t failures;      // factory returned NULL
+	size_t idle_bytes;      // estimated memory of idle textures
+	int idle_count;         // textures on the free lists
+	int live_count;         // textures handed out
+};
+
+
+//---------------------------------------------------------------------
+// TexturePool - Acquire hands out a texture matching a description,
+// reusing a released one when there is one, Release puts it back on
+// the free list of its description. idle textures past the memory
+// budget are deleted least recently released first. the content of a
+// recycled texture is whatever the last user left. not thread safe,
+// textures still handed out when the pool dies belong to the caller
+//---------------------------------------------------------------------
+class TexturePool
+{
+public:
+	virtual ~TexturePool();
+	TexturePool();
+
+public:
+	void SetFactory(TextureFactory factory);
+
+	// bytes idle textures may use (estimated from the descriptions),
+	// evicts down to it right away
+	void SetBudget(size_t bytes);
+	inline size_t GetBudget() const { return m_budget; }
+
+	// a texture for desc, NULL when the factory failed
+	Texture* Acquire(const TextureDesc& desc);
+	Texture* Acquire(int w, int h, PixelFormat fmt, int levels = 1, int flag = 0);
+
+	// give back a texture from Acquire, false for any other
+	bool Release(Texture *texture);
+
+	// delete idle textures, least recent first, until they use no more
+	// than bytes
+	void Trim(size_t bytes);
+
+	// delete every idle texture
+	inline void Purge() { Trim(0); }
+
+	inline const TexturePoolStats& GetStats() const { return m_stats; }
+	void ResetStats();
+
+	// memory estimate of a description: every level at its format size
+	static size_t GetMemorySize(const TextureDesc& desc);
+
+protected:
+	struct Key {
+		int width, height, format, levels, flag;
+		bool operator < (const Key& k) const;
+	};
+
+	struct Idle {
+		Key key;
+		Texture *texture;
+		size_t bytes;
+	};
+
+	typedef std::list<Idle> IdleList;
+
+	static Key MakeKey(const TextureDesc& desc);
+
+protected:
+	TextureFactory m_factory;
+	size_t m_budget;
+	TexturePoolStats m_stats;
+	IdleList m_lru;                                     // oldest first
+	std::map<Key, std::list<IdleList::iterator> > m_free; // per key, oldest first
+	std::map<Texture*, TextureDesc> m_live;
+};
+
+
+//---------------------------------------------------------------------
+// Namespace End
+//---------------------------------------------------------------------
+NAMESPACE_END(GFX);
+
+
+#endif
+
+
@@ -6,6 +6,13 @@
 //
 //=====================================================================
 #include "GFXTransform.h"
+#include "GFXQuaternion.h"
+#include "GFXVertex.h"
+#include "GFXSimd.h"
+
+#if GFX_CPLUSPLUS >= 201103L
+#include <type_traits>
+#endif
 
 
 //---------------------------------------------------------------------
@@ -16,29 +23,14 @@ NAMESPACE_BEGIN(Core);
 
 
 //---------------------------------------------------------------------
-// matrixs
+// math types must stay memcpy-able for bulk vertex/matrix copies
 //---------------------------------------------------------------------
-static float s_zeros[] = {0.0f, 0.0f, 0.0f, 0.0f,  0.0f, 0.0f, 0.0f, 0.0f,
-	0.0f, 0.0f, 0.0f, 0.0f,  0.0f, 0.0f, 0.0f, 0.0f};
-
-static float s_unit2[] = {1.0f, 0.0f,  0.0f, 1.0f};
-
-static float s_unit3[] = {1.0f, 0.0f, 0.0f,  0.0f, 1.0f, 0.0f,  
-	0.0f, 0.0f, 1.0f};
-
-static float s_unit4[] = {1.0f, 0.0f, 0.0f, 0.0f,  0.0f, 1.0f, 0.0f, 0.0f,
-	0.0f, 0.0f, 1.0f, 0.0f,  0.0f, 0.0f, 0.0f, 1.0f};
-
-static float s_gl2dx[] = {1.0f, 0.0f, 0.0f, 0.0f,  0.0f, 1.0f, 0.0f, 0.0f,
-	0.0f, 0.0f, 2.0f, 0.0f,  0.0f, 0.0f, -1.0f, 1.0f};
-
-const Matrix2 Matrix2Unit(s_unit2);
-const Matrix2 Matrix2Zero(s_zeros);
-const Matrix3 Matrix3Unit(s_unit3);
-const Matrix3 Matrix3Zero(s_zeros);
-const Matrix4 Matrix4Unit(s_unit4);
-const Matrix4 Matrix4Zero(s_zeros);
-const Matrix4 Matrix4GL2DX(s_gl2dx);
+#if GFX_CPLUSPLUS >= 201103L && (!defined(__GNUC__) || __GNUC__ >= 5 || defined(__clang__))
+static_assert(std::is_trivially_copyable<Vector4>::value, "Vector4 must be trivially copyable");
+static_assert(std::is_trivially_copyable<Matrix4>::value, "Matrix4 must be trivially copyable");
+static_assert(std::is_trivially_copyable<VertexSt>::value, "VertexSt must be trivially copyable");
+static_assert(std::is_trivially_copyable<Quaternion>::value, "Quaternion must be trivially copyable");
+#endif
 
 
 //---------------------------------------------------------------------
@@ -49,6 +41,8 @@ Transform::Transform()
 	m_opengl = false;
 	m_dirty = true;
 	m_update = true;
+	m_dirty_view_inv = true;
+	m_dirty_normal = true;
 	Reset();
 }
 
@@ -72,7 +66,11 @@ void Transform::Reset()
 	m_mvp = Matrix4Unit;
 	m_mv = Matrix4Unit;
 	m_vp = Matrix4Unit;
+	m_view_inv = Matrix4Unit;
+	m_normal = Matrix4Unit;
 	m_dirty = false;
+	m_dirty_view_inv = false;
+	m_dirty_normal = false;
 }
 
 
@@ -86,12 +84,15 @@ void Transform::SetTransform(TransformState state, const Matrix4* matrix)
 	switch (state) {
 	case TS_WORLD:
 		m_world = *matrix;
+		m_dirty_normal = true;
 		break;
 	case TS_VIEW:
 		m_view = *matrix;
+		m_dirty_view_inv = true;
+		m_dirty_normal = true;
 		break;
 	case TS_PROJECTION:
-		m_view = *matrix;
+		m_projection = *matrix;
 		break;
 	}
 }
@@ -124,16 +125,12 @@ void Transform::GetTransform(TransformState state, Matrix4* matrix)
 //---------------------------------------------------------------------
 void Transform::UpdateMvp()
 {
-	Matrix4 mvp;
-	mvp = m_world;
-	mvp *= m_view;
-	mvp *= m_projection;
+	Matrix4::Multiply(m_mv, m_world, m_view);
+	Matrix4::Multiply(m_vp, m_view, m_projection);
+	Matrix4::Multiply(m_mvp, m_mv, m_projection);
 	if (m_opengl) {
-		mvp *= Matrix4GL2DX;
+		m_mvp *= Matrix4GL2DX;
 	}
-	m_mvp = mvp;
-	m_mv = m_world * m_view;
-	m_vp = m_view * m_projection;
 	m_dirty = false;
 }
 
@@ -146,7 +143,6 @@ Matrix4* Transform::GetMvp()
 	if (m_dirty) {
 		if (m_update) {
 			UpdateMvp();
-			m_dirty = true;
 		}
 	}
 	return &m_mvp;
@@ -161,7 +157,6 @@ Matrix4* Transform::GetMv()
 	if (m_dirty) {
 		if (m_update) {
 			UpdateMvp();
-			m_dirty = true;
 		}
 	}
 	return &m_mv;
@@ -176,13 +171,56 @@ Matrix4* Transform::GetVp()
 	if (m_dirty) {
 		if (m_update) {
 			UpdateMvp();
-			m_dirty = true;
 		}
 	}
 	return &m_vp;
 }
 
 
+//---------------------------------------------------------------------
+// Get inverse of View
+//---------------------------------------------------------------------
+Matrix4* Transform::GetViewInverse()
+{
+	if (m_dirty_view_inv) {
+		if (m_view.m03 == 0.0f && m_view.m13 == 0.0f &&
+			m_view.m23 == 0.0f && m_view.m33 == 1.0f) {
+			if (!Matrix4::InverseAffine(m_view_inv, m_view)) {
+				m_view_inv = Matrix4Unit;
+			}
+		}
+		else {
+			if (!Matrix4::Inverse(m_view_inv, m_view)) {
+				m_view_inv = Matrix4Unit;
+			}
+		}
+		m_dirty_view_inv = false;
+	}
+	return &m_view_inv;
+}
+
+
+//---------------------------------------------------------------------
+// Get transpose(inverse(World * View)) with translation cleared
+//---------------------------------------------------------------------
+Matrix4* Transform::GetNormal()
+{
+	if (m_dirty_normal) {
+		Matrix4 mv, inv;
+		Matrix4::Multiply(mv, m_world, m_view);
+		mv.m03 = mv.m13 = mv.m23 = 0.0f;
+		mv.m30 = mv.m31 = mv.m32 = 0.0f;
+		mv.m33 = 1.0f;
+		if (!Matrix4::InverseAffine(inv, mv)) {
+			inv = Matrix4Unit;
+		}
+		Matrix4::Transpose(m_normal, inv);
+		m_dirty_normal = false;
+	}
+	return &m_normal;
+}
+
+
 //---------------------------------------------------------------------
 // Set Matrix
 //---------------------------------------------------------------------
@@ -193,57 +231,146 @@ void Transform::SetMvp(const Matrix4 *matrix)
 }
 
 
+//---------------------------------------------------------------------
+// copy everything at once
+//---------------------------------------------------------------------
+void Transform::GetSnapshot(TransformSnapshot& snapshot)
+{
+	if (m_dirty && m_update) {
+		UpdateMvp();
+	}
+	snapshot.world = m_world;
+	snapshot.view = m_view;
+	snapshot.projection = m_projection;
+	snapshot.mvp = m_mvp;
+	snapshot.mv = m_mv;
+	snapshot.vp = m_vp;
+	snapshot.version = 0;
+	snapshot.opengl = m_opengl;
+}
 
-//=====================================================================
-// matrix utils
-//=====================================================================
 
-void Matrix4_SetIdentity(Matrix4& m) {
-	m = Matrix4Unit;
+//---------------------------------------------------------------------
+// instance kernels: the rows of b stay in registers and every element
+// of a is broadcast, dst = a * b (dst must not alias a)
+//---------------------------------------------------------------------
+static inline void InstanceMultiply(float *dst, const float *a, const Float4 *b)
+{
+	for (int i = 0; i < 4; i++) {
+		const float *r = a + i * 4;
+		Float4 t = MulAdd(Float4(r[0]), b[0], MulAdd(Float4(r[1]), b[1],
+				MulAdd(Float4(r[2]), b[2], Float4(r[3]) * b[3])));
+		t.Store(dst + i * 4);
+	}
 }
 
-void Matrix4_SetZero(Matrix4& m) {
-	m.m[0][0] = m.m[0][1] = m.m[0][2] = m.m[0][3] = 0.0f;
-	m.m[1][0] = m.m[1][1] = m.m[1][2] = m.m[1][3] = 0.0f;
-	m.m[2][0] = m.m[2][1] = m.m[2][2] = m.m[2][3] = 0.0f;
-	m.m[3][0] = m.m[3][1] = m.m[3][2] = m.m[3][3] = 0.0f;
+// normal matrices of 4 mv at once (matrices are stride bytes apart):
+// the rows of transpose(inverse(m)) are the cross products of the
+// other two rows over the determinant, as in InverseAffine, singular
+// matrices give the identity
+static void InstanceNormal4(uint8_t *normal, size_t normal_stride,
+		const uint8_t *mv, size_t mv_stride)
+{
+	const Float4 zero(0.0f), one(1.0f);
+	Float4 ax, ay, az, bx, by, bz, cx, cy, cz, w;
+	Float4_Gather<3>(mv, mv_stride, ax, ay, az, w);
+	Float4_Gather<3>(mv + 16, mv_stride, bx, by, bz, w);
+	Float4_Gather<3>(mv + 32, mv_stride, cx, cy, cz, w);
+	Float4 x0 = by * cz - bz * cy, y0 = bz * cx - bx * cz, z0 = bx * cy - by * cx;
+	Float4 x1 = cy * az - cz * ay, y1 = cz * ax - cx * az, z1 = cx * ay - cy * ax;
+	Float4 x2 = ay * bz - az * by, y2 = az * bx - ax * bz, z2 = ax * by - ay * bx;
+	Float4 det = ax * x0 + ay * y0 + az * z0;
+	Float4 singular = CmpEq(det, zero);
+	Float4 k = one / Select(singular, one, det);
+	x0 = Select(singular, one, x0 * k);
+	y0 = Select(singular, zero, y0 * k);
+	z0 = Select(singular, zero, z0 * k);
+	x1 = Select(singular, zero, x1 * k);
+	y1 = Select(singular, one, y1 * k);
+	z1 = Select(singular, zero, z1 * k);
+	x2 = Select(singular, zero, x2 * k);
+	y2 = Select(singular, zero, y2 * k);
+	z2 = Select(singular, one, z2 * k);
+	Float4_Scatter<4>(normal, normal_stride, x0, y0, z0, zero);
+	Float4_Scatter<4>(normal + 16, normal_stride, x1, y1, z1, zero);
+	Float4_Scatter<4>(normal + 32, normal_stride, x2, y2, z2, zero);
+	const Float4 r3(0.0f, 0.0f, 0.0f, 1.0f);
+	for (int i = 0; i < 4; i++) {
+		r3.Store((float*)(normal + i * normal_stride + 48));
+	}
 }
 
-void Matrix4_SetTranslate(Matrix4& m, float x, float y, float z) {
-	Matrix4_SetIdentity(m);
-	m.m[3][0] = x;
-	m.m[3][1] = y;
-	m.m[3][2] = z;
-}
 
-void Matrix4_SetScale(Matrix4& m, float x, float y, float z) {
-	Matrix4_SetIdentity(m);
-	m.m[0][0] = x;
-	m.m[1][1] = y;
-	m.m[2][2] = z;
+//---------------------------------------------------------------------
+// one pass over the instances: one multiply for mvp with the cached
+// vp instead of the three of SetTransform(TS_WORLD) + GetMvp(), a
+// second one for mv only when mv or normal is wanted. the normals of
+// a group of 4 are built from the mv just written, a partial group
+// at the end goes through a local copy
+//---------------------------------------------------------------------
+void Transform::ComputeInstances(const Matrix4 *world, size_t count,
+		Matrix4 *mvp, Matrix4 *mv, Matrix4 *normal, size_t stride,
+		size_t world_stride)
+{
+	Matrix4 vp = *GetVp();
+	if (m_opengl) {
+		vp *= Matrix4GL2DX;
+	}
+	Float4 b[4], v[4];
+	for (int i = 0; i < 4; i++) {
+		b[i] = Float4::Load(vp.m[i]);
+		v[i] = Float4::Load(m_view.m[i]);
+	}
+	const uint8_t *src = (const uint8_t*)world;
+	Matrix4 tmv[4], tnormal[4];
+	for (size_t i = 0; i < count; i += 4) {
+		size_t n = (count - i < 4)? (count - i) : 4;
+		bool full = (n == 4 && mv != NULL);
+		uint8_t *group_mv = full? ((uint8_t*)mv + i * stride) : (uint8_t*)tmv;
+		size_t group_stride = full? stride : sizeof(Matrix4);
+		for (size_t k = 0; k < n; k++) {
+			const Matrix4 *w = (const Matrix4*)(src + (i + k) * world_stride);
+			if (mvp) {
+				Matrix4 *t = (Matrix4*)((uint8_t*)mvp + (i + k) * stride);
+				InstanceMultiply(t->m[0], w->m[0], b);
+			}
+			if (mv || normal) {
+				Matrix4 *t = (Matrix4*)(group_mv + k * group_stride);
+				InstanceMultiply(t->m[0], w->m[0], v);
+			}
+		}
+		if (mv && !full) {
+			for (size_t k = 0; k < n; k++) {
+				*(Matrix4*)((uint8_t*)mv + (i + k) * stride) = tmv[k];
+			}
+		}
+		if (normal == NULL) {
+			continue;
+		}
+		if (n == 4) {
+			InstanceNormal4((uint8_t*)normal + i * stride, stride, group_mv, group_stride);
+		}
+		else {
+			for (size_t k = n; k < 4; k++) {
+				tmv[k] = Matrix4Unit;
+			}
+			InstanceNormal4((uint8_t*)tnormal, sizeof(Matrix4), (uint8_t*)tmv, sizeof(Matrix4));
+			for (size_t k = 0; k < n; k++) {
+				*(Matrix4*)((uint8_t*)normal + (i + k) * stride) = tnormal[k];
+			}
+		}
+	}
 }
 
+
+//=====================================================================
+// matrix utils
+//=====================================================================
+
 void Matrix4_SetRotate(Matrix4& m, float x, float y, float z, float theta) {
-	float qsin = (float)sin(theta * 0.5f);
-	float qcos = (float)cos(theta * 0.5f);
-	Vector4 vec(x, y, z, 1.0f);
-	float w = qcos;
-	vec.Normalize();
-	x = vec.x * qsin;
-	y = vec.y * qsin;
-	z = vec.z * qsin;
-	m.m[0][0] = 1 - 2 * y * y - 2 * z * z;
-	m.m[1][0] = 2 * x * y - 2 * w * z;
-	m.m[2][0] = 2 * x * z + 2 * w * y;
-	m.m[0][1] = 2 * x * y + 2 * w * z;
-	m.m[1][1] = 1 - 2 * x * x - 2 * z * z;
-	m.m[2][1] = 2 * y * z - 2 * w * x;
-	m.m[0][2] = 2 * x * z - 2 * w * y;
-	m.m[1][2] = 2 * y * z + 2 * w * x;
-	m.m[2][2] = 1 - 2 * x * x - 2 * y * y;
-	m.m[0][3] = m.m[1][3] = m.m[2][3] = 0.0f;
-	m.m[3][0] = m.m[3][1] = m.m[3][2] = 0.0f;	
-	m.m[3][3] = 1.0f;
+	Quaternion q;
+	q.SetAxisAngle(x, y, z, theta);
+	m = q.ToMatrix4();
 }
 
 void Matrix4_LookAt(Matrix4& m, const Vector4& eye, const Vector4& at, const Vector4& up) {
@@ -277,7 +404,7 @@ void Matrix4_LookAt(Matrix4& m, const Vector4& eye, const Vector4& at, const Vec
 
 // D3DXMatrixPerspectiveFovLH
 void Matrix4_SetPerspective(Matrix4& m, float fovy, float aspect, float zn, float zf) {
-	float fax = 1.0f / (float)tan(fovy * 0.5f);
+	float fax = 1.0f / Tan(fovy * 0.5f);
 	Matrix4_SetZero(m);
 	m.m[0][0] = (float)(fax / aspect);
 	m.m[1][1] = (float)(fax);
@@ -286,19 +413,6 @@ void Matrix4_SetPerspective(Matrix4& m, float fovy, float aspect, float zn, floa
 	m.m[2][3] = 1.0f;
 }
 
-// D3DXMatrixOrthoOffCenterLH
-void Matrix4_SetOrtho2D(Matrix4& m, float l, float r, float b, float t, float zn, float zf)
-{
-	Matrix4_SetZero(m);
-	m.m[0][0] = 2.0f / (r - l);
-	m.m[1][1] = 2.0f / (t - b);
-	m.m[2][2] = 1.0f / (zf - zn);
-	m.m[3][3] = 1.0f;
-	m.m[3][0] = (l + r) / (l - r);
-	m.m[3][1] = (t + b) / (b - t);
-	m.m[3][2] = zn / (zn - zf);
-}
-
 
 //---------------------------------------------------------------------
 // Namespace End
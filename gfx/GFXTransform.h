@@ -23,13 +23,38 @@ NAMESPACE_BEGIN(Core);
 //---------------------------------------------------------------------
 // Global
 //---------------------------------------------------------------------
-const extern Matrix2 Matrix2Unit;
-const extern Matrix2 Matrix2Zero;
-const extern Matrix3 Matrix3Unit;
-const extern Matrix3 Matrix3Zero;
-const extern Matrix4 Matrix4Unit;
-const extern Matrix4 Matrix4Zero;
-const extern Matrix4 Matrix4GL2DX;
+GFX_CONSTEXPR const Matrix2 Matrix2Unit(1.0f, 0.0f,  0.0f, 1.0f);
+
+GFX_CONSTEXPR const Matrix2 Matrix2Zero(0.0f, 0.0f,  0.0f, 0.0f);
+
+GFX_CONSTEXPR const Matrix3 Matrix3Unit(
+	1.0f, 0.0f, 0.0f,
+	0.0f, 1.0f, 0.0f,
+	0.0f, 0.0f, 1.0f);
+
+GFX_CONSTEXPR const Matrix3 Matrix3Zero(
+	0.0f, 0.0f, 0.0f,
+	0.0f, 0.0f, 0.0f,
+	0.0f, 0.0f, 0.0f);
+
+GFX_CONSTEXPR const Matrix4 Matrix4Unit(
+	1.0f, 0.0f, 0.0f, 0.0f,
+	0.0f, 1.0f, 0.0f, 0.0f,
+	0.0f, 0.0f, 1.0f, 0.0f,
+	0.0f, 0.0f, 0.0f, 1.0f);
+
+GFX_CONSTEXPR const Matrix4 Matrix4Zero(
+	0.0f, 0.0f, 0.0f, 0.0f,
+	0.0f, 0.0f, 0.0f, 0.0f,
+	0.0f, 0.0f, 0.0f, 0.0f,
+	0.0f, 0.0f, 0.0f, 0.0f);
+
+// maps OpenGL clip z [-1, 1] to Direct3D [0, 1]
+GFX_CONSTEXPR const Matrix4 Matrix4GL2DX(
+	1.0f, 0.0f, 0.0f, 0.0f,
+	0.0f, 1.0f, 0.0f, 0.0f,
+	0.0f, 0.0f, 2.0f, 0.0f,
+	0.0f, 0.0f, -1.0f, 1.0f);
 
 
 //---------------------------------------------------------------------
@@ -42,6 +67,23 @@ enum TransformState {
 };
 
 
+//---------------------------------------------------------------------
+// TransformSnapshot - a copy of every matrix of a Transform taken at
+// one point in time, each matrix starts a cache line
+//---------------------------------------------------------------------
+GFX_ALIGNED_STRUCT(64) TransformSnapshot
+{
+	Matrix4 world;
+	Matrix4 view;
+	Matrix4 projection;
+	Matrix4 mvp;
+	Matrix4 mv;
+	Matrix4 vp;
+	uint32_t version;
+	bool opengl;
+};
+
+
 //---------------------------------------------------------------------
 // Transform
 //---------------------------------------------------------------------
@@ -63,12 +105,37 @@ public:
 	Matrix4* GetMv();
 	Matrix4* GetVp();
 
+	// inverse of view (camera to world), computed on demand
+	Matrix4* GetViewInverse();
+
+	// inverse transpose of world * view for normals, computed on demand
+	Matrix4* GetNormal();
+
 	void SetMvp(const Matrix4 *matrix);
 
+	// update mvp if needed and copy all matrices, version is left 0
+	void GetSnapshot(TransformSnapshot& snapshot);
+
+	// per instance matrices for count objects under the current view
+	// and projection: mvp[i] = world[i] * GetVp() (with Matrix4GL2DX
+	// on opengl), mv[i] = world[i] * view and normal[i] as GetNormal()
+	// computes it. mv and normal may be NULL. outputs are stride bytes
+	// apart so they can interleave in one instance vertex buffer, they
+	// must not overlap world
+	void ComputeInstances(const Matrix4 *world, size_t count,
+			Matrix4 *mvp, Matrix4 *mv = NULL, Matrix4 *normal = NULL,
+			size_t stride = sizeof(Matrix4),
+			size_t world_stride = sizeof(Matrix4));
+
+	// projection maps z to [-w, w] and GetMvp() appends Matrix4GL2DX
+	inline bool IsOpenGL() const { return m_opengl; }
+
 protected:
 	bool m_opengl;
 	bool m_dirty;
 	bool m_update;
+	bool m_dirty_view_inv;
+	bool m_dirty_normal;
 
 protected:
 	Matrix4 m_world;
@@ -77,6 +144,8 @@ protected:
 	Matrix4 m_mvp;
 	Matrix4 m_mv;
 	Matrix4 m_vp;
+	Matrix4 m_view_inv;
+	Matrix4 m_normal;
 };
 
 
@@ -84,13 +153,49 @@ protected:
 // Matrix Utils
 //---------------------------------------------------------------------
 
-void Matrix4_SetIdentity(Matrix4& m);
+inline GFX_CONSTEXPR Matrix4 Matrix4_Identity() {
+	return Matrix4(1.0f, 0.0f, 0.0f, 0.0f,  0.0f, 1.0f, 0.0f, 0.0f,
+		0.0f, 0.0f, 1.0f, 0.0f,  0.0f, 0.0f, 0.0f, 1.0f);
+}
+
+inline GFX_CONSTEXPR Matrix4 Matrix4_Zero() {
+	return Matrix4(0.0f, 0.0f, 0.0f, 0.0f,  0.0f, 0.0f, 0.0f, 0.0f,
+		0.0f, 0.0f, 0.0f, 0.0f,  0.0f, 0.0f, 0.0f, 0.0f);
+}
+
+inline GFX_CONSTEXPR Matrix4 Matrix4_Translate(float x, float y, float z) {
+	return Matrix4(1.0f, 0.0f, 0.0f, 0.0f,  0.0f, 1.0f, 0.0f, 0.0f,
+		0.0f, 0.0f, 1.0f, 0.0f,  x, y, z, 1.0f);
+}
+
+inline GFX_CONSTEXPR Matrix4 Matrix4_Scale(float x, float y, float z) {
+	return Matrix4(x, 0.0f, 0.0f, 0.0f,  0.0f, y, 0.0f, 0.0f,
+		0.0f, 0.0f, z, 0.0f,  0.0f, 0.0f, 0.0f, 1.0f);
+}
+
+// D3DXMatrixOrthoOffCenterLH
+inline GFX_CONSTEXPR Matrix4 Matrix4_Ortho2D(float l, float r, float b, float t, float zn, float zf) {
+	return Matrix4(2.0f / (r - l), 0.0f, 0.0f, 0.0f,
+		0.0f, 2.0f / (t - b), 0.0f, 0.0f,
+		0.0f, 0.0f, 1.0f / (zf - zn), 0.0f,
+		(l + r) / (l - r), (t + b) / (b - t), zn / (zn - zf), 1.0f);
+}
+
+inline GFX_CONSTEXPR14 void Matrix4_SetIdentity(Matrix4& m) {
+	m = Matrix4_Identity();
+}
 
-void Matrix4_SetZero(Matrix4& m);
+inline GFX_CONSTEXPR14 void Matrix4_SetZero(Matrix4& m) {
+	m = Matrix4_Zero();
+}
 
-void Matrix4_SetTranslate(Matrix4& m, float x, float y, float z);
+inline GFX_CONSTEXPR14 void Matrix4_SetTranslate(Matrix4& m, float x, float y, float z) {
+	m = Matrix4_Translate(x, y, z);
+}
 
-void Matrix4_SetScale(Matrix4& m, float x, float y, float z);
+inline GFX_CONSTEXPR14 void Matrix4_SetScale(Matrix4& m, float x, float y, float z) {
+	m = Matrix4_Scale(x, y, z);
+}
 
 void Matrix4_SetRotate(Matrix4& m, float x, float y, float z, float theta);
 
@@ -100,7 +205,9 @@ void Matrix4_LookAt(Matrix4& m, const Vector4& eye, const Vector4& at, const Vec
 void Matrix4_SetPerspective(Matrix4& m, float fovy, float aspect, float zn, float zf);
 
 // D3DXMatrixOrthoOffCenterLH
-void Matrix4_SetOrtho2D(Matrix4& m, float l, float r, float b, float t, float zn, float zf);
+inline GFX_CONSTEXPR14 void Matrix4_SetOrtho2D(Matrix4& m, float l, float r, float b, float t, float zn, float zf) {
+	m = Matrix4_Ortho2D(l, r, b, t, zn, zf);
+}
 
 
 //---------------------------------------------------------------------
@@ -6,6 +6,8 @@
 //
 //=====================================================================
 
+#include <thread>
+
 #include "GFXUtil.h"
 
 
@@ -15,6 +17,55 @@
 NAMESPACE_BEGIN(GFX);
 
 
+//---------------------------------------------------------------------
+// hardware threads
+//---------------------------------------------------------------------
+int GetHardwareThreads()
+{
+	unsigned int n = std::thread::hardware_concurrency();
+	return (n == 0)? 1 : (int)n;
+}
+
+
+//---------------------------------------------------------------------
+// parallel for
+//---------------------------------------------------------------------
+void ParallelFor(int count, int grain, int threads, ParallelProc proc, void *ctx)
+{
+	if (count <= 0) return;
+	if (threads <= 0) threads = GetHardwareThreads();
+	if (grain < 1) grain = 1;
+	int bands = (count + grain - 1) / grain;
+	if (bands > threads) bands = threads;
+	if (bands <= 1) {
+		proc(ctx, 0, count);
+		return;
+	}
+	std::vector<std::thread> workers;
+	workers.reserve(bands - 1);
+	int i = 1;
+	for (; i < bands; i++) {
+		int begin = (int)((int64_t)count * i / bands);
+		int end = (int)((int64_t)count * (i + 1) / bands);
+		try {
+			workers.push_back(std::thread(proc, ctx, begin, end));
+		}
+		catch (...) {
+			break;
+		}
+	}
+	proc(ctx, 0, (int)((int64_t)count / bands));
+	for (; i < bands; i++) {
+		int begin = (int)((int64_t)count * i / bands);
+		int end = (int)((int64_t)count * (i + 1) / bands);
+		proc(ctx, begin, end);
+	}
+	for (size_t j = 0; j < workers.size(); j++) {
+		workers[j].join();
+	}
+}
+
+
 
 //---------------------------------------------------------------------
 // Namespace End
@@ -16,6 +16,21 @@
 NAMESPACE_BEGIN(GFX);
 
 
+//---------------------------------------------------------------------
+// ParallelFor - split [0, count) into contiguous bands and call
+// proc(ctx, begin, end) once per band, bands run on worker threads and
+// the calling thread takes the first one. at most threads bands (<= 0
+// for one per core), none smaller than grain. returns after all bands
+// finished, a band that cannot get a thread runs on the caller
+//---------------------------------------------------------------------
+typedef void (*ParallelProc)(void *ctx, int begin, int end);
+
+void ParallelFor(int count, int grain, int threads, ParallelProc proc, void *ctx);
+
+// number of hardware threads, at least 1
+int GetHardwareThreads();
+
+
 
 //---------------------------------------------------------------------
 // Namespace End
@@ -0,0 +1,264 @@
+//=====================================================================
+//
+// GFXVector.cpp - batch vector kernels
+//
+// Last Modified: 2026/10/18 16:12:37
+//
+//=====================================================================
+#include "GFXVector.h"
+#include "GFXSimd.h"
+
+
+//---------------------------------------------------------------------
+// Namespace Begin
+//---------------------------------------------------------------------
+NAMESPACE_BEGIN(GFX);
+NAMESPACE_BEGIN(Core);
+
+
+//---------------------------------------------------------------------
+// 8 vectors per iteration with AVX, 4 otherwise
+//---------------------------------------------------------------------
+#if GFX_SIMD_AVX
+typedef Float8 FloatBatch;
+#else
+typedef Float4 FloatBatch;
+#endif
+
+
+//---------------------------------------------------------------------
+// strided gather/scatter of N (3 or 4) float vectors into lanes
+//---------------------------------------------------------------------
+template <int N>
+static inline void VectorGather(const uint8_t *src, size_t stride,
+		Float4& x, Float4& y, Float4& z, Float4& w)
+{
+	Float4_Gather<N>(src, stride, x, y, z, w);
+}
+
+template <int N>
+static inline void VectorGather(const uint8_t *src, size_t stride,
+		Float8& x, Float8& y, Float8& z, Float8& w)
+{
+	Float8_Gather<N>(src, stride, x, y, z, w);
+}
+
+template <int N>
+static inline void VectorScatter(uint8_t *dst, size_t stride,
+		const Float4& x, const Float4& y, const Float4& z, const Float4& w)
+{
+	Float4_Scatter<N>(dst, stride, x, y, z, w);
+}
+
+template <int N>
+static inline void VectorScatter(uint8_t *dst, size_t stride,
+		const Float8& x, const Float8& y, const Float8& z, const Float8& w)
+{
+	Float8_Scatter<N>(dst, stride, x, y, z, w);
+}
+
+template <int N, class F>
+static inline F VectorLengthSq(const F& x, const F& y, const F& z, const F& w)
+{
+	F t = MulAdd(x, x, MulAdd(y, y, z * z));
+	return (N == 4)? MulAdd(w, w, t) : t;
+}
+
+// 1 / sqrt(lsq): divide or rsqrt estimate with one Newton step,
+// zero length gives zero instead of inf
+template <class F>
+static inline F VectorInvLength(const F& lsq, bool precise)
+{
+	F zero = F::Zero();
+	F inv = precise? F(1.0f) / Sqrt(lsq) : Rsqrt(lsq);
+	return Select(CmpGt(lsq, zero), inv, zero);
+}
+
+
+//---------------------------------------------------------------------
+// lane kernels, F::LANES vectors each
+//---------------------------------------------------------------------
+template <int N, class F>
+static inline void NormalizeLanes(uint8_t *dst, size_t dst_stride,
+		const uint8_t *src, size_t src_stride, bool precise)
+{
+	F x, y, z, w;
+	VectorGather<N>(src, src_stride, x, y, z, w);
+	F inv = VectorInvLength(VectorLengthSq<N>(x, y, z, w), precise);
+	VectorScatter<N>(dst, dst_stride, x * inv, y * inv, z * inv, w * inv);
+}
+
+template <int N, class F>
+static inline void LengthLanes(float *dst, const uint8_t *src,
+		size_t src_stride, bool precise)
+{
+	F x, y, z, w;
+	VectorGather<N>(src, src_stride, x, y, z, w);
+	F lsq = VectorLengthSq<N>(x, y, z, w);
+	F len = precise? Sqrt(lsq) : lsq * VectorInvLength(lsq, false);
+	len.Store(dst);
+}
+
+template <int N, class F>
+static inline void DistanceSqLanes(float *dst, const uint8_t *a,
+		size_t a_stride, const uint8_t *b, size_t b_stride)
+{
+	F ax, ay, az, aw, bx, by, bz, bw;
+	VectorGather<N>(a, a_stride, ax, ay, az, aw);
+	VectorGather<N>(b, b_stride, bx, by, bz, bw);
+	VectorLengthSq<N>(ax - bx, ay - by, az - bz, aw - bw).Store(dst);
+}
+
+
+//---------------------------------------------------------------------
+// drivers: full batches, then groups of 4, and the last 1-3 vectors
+// are copied into a zero padded packed block so every element goes
+// through the same lane code
+//---------------------------------------------------------------------
+template <int N>
+static void VectorCopyIn(float *t, const uint8_t *src, size_t stride, size_t n)
+{
+	for (size_t i = 0; i < 4 * N; i++) t[i] = 0.0f;
+	for (size_t i = 0; i < n; i++, src += stride) {
+		for (int k = 0; k < N; k++) t[i * N + k] = ((const float*)src)[k];
+	}
+}
+
+template <int N>
+static void NormalizeKernel(uint8_t *dst, size_t dst_stride,
+		const uint8_t *src, size_t src_stride, size_t count, bool precise)
+{
+	const size_t L = FloatBatch::LANES;
+	size_t i = 0;
+	for (; i + L <= count; i += L) {
+		NormalizeLanes<N, FloatBatch>(dst, dst_stride, src, src_stride, precise);
+		src += src_stride * L;
+		dst += dst_stride * L;
+	}
+	for (; i + 4 <= count; i += 4) {
+		NormalizeLanes<N, Float4>(dst, dst_stride, src, src_stride, precise);
+		src += src_stride * 4;
+		dst += dst_stride * 4;
+	}
+	if (i < count) {
+		float t[4 * N];
+		size_t n = count - i;
+		VectorCopyIn<N>(t, src, src_stride, n);
+		NormalizeLanes<N, Float4>((uint8_t*)t, sizeof(float) * N,
+				(const uint8_t*)t, sizeof(float) * N, precise);
+		for (size_t j = 0; j < n; j++, dst += dst_stride) {
+			for (int k = 0; k < N; k++) ((float*)dst)[k] = t[j * N + k];
+		}
+	}
+}
+
+template <int N>
+static void LengthKernel(float *dst, const uint8_t *src, size_t src_stride,
+		size_t count, bool precise)
+{
+	const size_t L = FloatBatch::LANES;
+	size_t i = 0;
+	for (; i + L <= count; i += L) {
+		LengthLanes<N, FloatBatch>(dst + i, src, src_stride, precise);
+		src += src_stride * L;
+	}
+	for (; i + 4 <= count; i += 4) {
+		LengthLanes<N, Float4>(dst + i, src, src_stride, precise);
+		src += src_stride * 4;
+	}
+	if (i < count) {
+		float t[4 * N], r[4];
+		size_t n = count - i;
+		VectorCopyIn<N>(t, src, src_stride, n);
+		LengthLanes<N, Float4>(r, (const uint8_t*)t, sizeof(float) * N, precise);
+		for (size_t j = 0; j < n; j++) dst[i + j] = r[j];
+	}
+}
+
+template <int N>
+static void DistanceSqKernel(float *dst, const uint8_t *a, size_t a_stride,
+		const uint8_t *b, size_t b_stride, size_t count)
+{
+	const size_t L = FloatBatch::LANES;
+	size_t i = 0;
+	for (; i + L <= count; i += L) {
+		DistanceSqLanes<N, FloatBatch>(dst + i, a, a_stride, b, b_stride);
+		a += a_stride * L;
+		b += b_stride * L;
+	}
+	for (; i + 4 <= count; i += 4) {
+		DistanceSqLanes<N, Float4>(dst + i, a, a_stride, b, b_stride);
+		a += a_stride * 4;
+		b += b_stride * 4;
+	}
+	if (i < count) {
+		float ta[4 * N], tb[4 * N], r[4];
+		size_t n = count - i;
+		VectorCopyIn<N>(ta, a, a_stride, n);
+		VectorCopyIn<N>(tb, b, b_stride, n);
+		DistanceSqLanes<N, Float4>(r, (const uint8_t*)ta, sizeof(float) * N,
+				(const uint8_t*)tb, sizeof(float) * N);
+		for (size_t j = 0; j < n; j++) dst[i + j] = r[j];
+	}
+}
+
+
+//---------------------------------------------------------------------
+// NormalizeArray
+//---------------------------------------------------------------------
+void NormalizeArray(Vector3 *dst, const Vector3 *src, size_t count,
+		bool precise, size_t dst_stride, size_t src_stride)
+{
+	NormalizeKernel<3>((uint8_t*)dst, dst_stride, (const uint8_t*)src,
+			src_stride, count, precise);
+}
+
+void NormalizeArray(Vector4 *dst, const Vector4 *src, size_t count,
+		bool precise, size_t dst_stride, size_t src_stride)
+{
+	NormalizeKernel<4>((uint8_t*)dst, dst_stride, (const uint8_t*)src,
+			src_stride, count, precise);
+}
+
+
+//---------------------------------------------------------------------
+// LengthArray
+//---------------------------------------------------------------------
+void LengthArray(float *dst, const Vector3 *src, size_t count,
+		bool precise, size_t src_stride)
+{
+	LengthKernel<3>(dst, (const uint8_t*)src, src_stride, count, precise);
+}
+
+void LengthArray(float *dst, const Vector4 *src, size_t count,
+		bool precise, size_t src_stride)
+{
+	LengthKernel<4>(dst, (const uint8_t*)src, src_stride, count, precise);
+}
+
+
+//---------------------------------------------------------------------
+// DistanceSqArray
+//---------------------------------------------------------------------
+void DistanceSqArray(float *dst, const Vector3 *a, const Vector3 *b,
+		size_t count, size_t a_stride, size_t b_stride)
+{
+	DistanceSqKernel<3>(dst, (const uint8_t*)a, a_stride,
+			(const uint8_t*)b, b_stride, count);
+}
+
+void DistanceSqArray(float *dst, const Vector4 *a, const Vector4 *b,
+		size_t count, size_t a_stride, size_t b_stride)
+{
+	DistanceSqKernel<4>(dst, (const uint8_t*)a, a_stride,
+			(const uint8_t*)b, b_stride, count);
+}
+
+
+//---------------------------------------------------------------------
+// Namespace End
+//---------------------------------------------------------------------
+NAMESPACE_END(Core);
+NAMESPACE_END(GFX);
+
+
@@ -2,7 +2,7 @@
 //
 // GFXVector.h - 
 //
-// Last Modified: 2020/04/25 22:25:10
+// Last Modified: 2026/10/18 16:48:20
 //
 //=====================================================================
 #ifndef _GFX_VECTOR_H_
@@ -23,341 +23,276 @@ NAMESPACE_BEGIN(Core);
 
 
 //---------------------------------------------------------------------
-// Vector2
+// Vector<T, N> - N is 2, 3 or 4, T is float, double, int32_t or Half.
+// the element access (x, y, z, w and m[]) and constructors live in
+// the specializations below, everything else is written once in
+// VectorOps and the element loops go through VectorKernel, which has
+// a SIMD specialization for float 4-wide vectors.
 //---------------------------------------------------------------------
-struct Vector2
-{
-	union {
-		struct { float x, y; };
-		float m[2];
-	};
-
-	inline Vector2() {}
-	inline Vector2(const Vector2& v): x(v.x), y(v.y) {}
-	inline Vector2(float ix, float iy): x(ix), y(iy) {}
-	inline Vector2(const float *v): x(v[0]), y(v[1]) {}
-
-	inline Vector2& operator = (const Vector2& v) {
-		x = v.x, y = v.y;
-		return *this;
-	}
-
-	inline bool operator == (const Vector2& v) const {
-		return x == v.x && y == v.y;
-	}
-
-	inline bool operator != (const Vector2& v) const {
-		return x != v.x || y != v.y;
-	}
+template <class T, int N> struct Vector;
 
-	inline Vector2 operator + () const {
-		return *this;
-	}
-
-	inline Vector2 operator - () const {
-		return Vector2(-x, -y);
-	}
-
-	inline Vector2 operator + (const Vector2& v) const {
-		return Vector2(x + v.x, y + v.y);
-	}
 
-	inline Vector2 operator - (const Vector2& v) const {
-		return Vector2(x - v.x, y - v.y);
-	}
-
-	inline Vector2 operator * (const Vector2& v) const {
-		return Vector2(x * v.x, y * v.y);
-	}
-
-	inline Vector2 operator * (float scale) const {
-		return Vector2(x * scale, y * scale);
-	}
-
-	inline Vector2 operator / (float scale) const {
-		float inv = 1.0f / scale;
-		return Vector2(x * inv, y * inv);
-	}
-
-	inline Vector2 operator += (const Vector2& v) {
-		x += v.x, y += v.y;
-		return *this;
-	}
-
-	inline Vector2 operator -= (const Vector2& v) {
-		x -= v.x, y -= v.y;
-		return *this;
-	}
-
-	inline Vector2 operator *= (const Vector2& v) {
-		x *= v.x, y *= v.y;
-		return *this;
-	}
+//---------------------------------------------------------------------
+// VectorKernel - element loops on T[N]
+//---------------------------------------------------------------------
+template <class T, int N>
+struct VectorKernel
+{
+	typedef typename ScalarTraits<T>::Scalar Scalar;
 
-	inline Vector2& operator *= (float scale) {
-		x *= scale, y *= scale;
-		return *this;
+	static inline void Add(T *t, const T *a, const T *b) {
+		for (int i = 0; i < N; i++) t[i] = a[i] + b[i];
 	}
 
-	inline Vector2& operator /= (float scale) {
-		float inv = 1.0f / scale;
-		x *= inv, y *= inv;
-		return *this;
+	static inline void Sub(T *t, const T *a, const T *b) {
+		for (int i = 0; i < N; i++) t[i] = a[i] - b[i];
 	}
 
-	inline Vector2& Zero() {
-		x = y = 0.0f;
-		return *this;
+	static inline void Mul(T *t, const T *a, const T *b) {
+		for (int i = 0; i < N; i++) t[i] = a[i] * b[i];
 	}
 
-	inline Vector2& One() {
-		x = y = 1.0f;
-		return *this;
+	static inline void Scale(T *t, const T *a, Scalar k) {
+		for (int i = 0; i < N; i++) t[i] = a[i] * k;
 	}
 
-	inline Vector2& Set(float x, float y) {
-		m[0] = x, m[1] = y;
-		return *this;
+	// floating point types multiply by the reciprocal
+	static inline void Divide(T *t, const T *a, Scalar k) {
+		if (ScalarTraits<T>::IS_FLOAT) {
+			Scale(t, a, Scalar(1) / k);
+		}
+		else {
+			for (int i = 0; i < N; i++) t[i] = a[i] / k;
+		}
 	}
 
-	inline float LengthSq() const {
-		return x * x + y * y;
+	static inline Scalar Dot(const T *a, const T *b) {
+		Scalar s = Scalar(a[0]) * Scalar(b[0]);
+		for (int i = 1; i < N; i++) s += Scalar(a[i]) * Scalar(b[i]);
+		return s;
 	}
+};
 
-	inline float Length() const {
-		return sqrtf(LengthSq());
-	}
+#if GFX_SIMD_SSE || GFX_SIMD_NEON
+template <>
+struct VectorKernel<float, 4>
+{
+	typedef float Scalar;
 
-	inline Vector2& Normalize() {
-		(*this) /= Length();
-		return *this;
+#if GFX_SIMD_SSE
+	static inline void Add(float *t, const float *a, const float *b) {
+		_mm_storeu_ps(t, _mm_add_ps(_mm_loadu_ps(a), _mm_loadu_ps(b)));
 	}
 
-	inline float Dot(const Vector2& v) const {
-		return x * v.x + y * v.y;
+	static inline void Sub(float *t, const float *a, const float *b) {
+		_mm_storeu_ps(t, _mm_sub_ps(_mm_loadu_ps(a), _mm_loadu_ps(b)));
 	}
 
-	inline Vector2 Cross(const Vector2& v) const {
-		Vector2 a;
-		a.x = x * v.y - y * v.x;
-		a.y = a.x;
-		return a;
+	static inline void Mul(float *t, const float *a, const float *b) {
+		_mm_storeu_ps(t, _mm_mul_ps(_mm_loadu_ps(a), _mm_loadu_ps(b)));
 	}
 
-	inline float Distance(const Vector2& v) const {
-		Vector2 a = (*this) - v;
-		return a.Length();
+	static inline void Scale(float *t, const float *a, float k) {
+		_mm_storeu_ps(t, _mm_mul_ps(_mm_loadu_ps(a), _mm_set1_ps(k)));
 	}
 
-	inline float DistanceSq(const Vector2& v) const {
-		Vector2 a = (*this) - v;
-		return a.LengthSq();
+	static inline float Dot(const float *a, const float *b) {
+		__m128 p = _mm_mul_ps(_mm_loadu_ps(a), _mm_loadu_ps(b));
+		__m128 q = _mm_add_ps(p, _mm_movehl_ps(p, p));
+		q = _mm_add_ss(q, _mm_shuffle_ps(q, q, 0x55));
+		return _mm_cvtss_f32(q);
 	}
-
-	inline bool NearEqual(const Vector2& v) const {
-		return ::GFX::Core::NearZero(DistanceSq(v));
+#else
+	static inline void Add(float *t, const float *a, const float *b) {
+		vst1q_f32(t, vaddq_f32(vld1q_f32(a), vld1q_f32(b)));
 	}
 
-	inline bool NearZero() const {
-		return ::GFX::Core::NearZero(LengthSq());
+	static inline void Sub(float *t, const float *a, const float *b) {
+		vst1q_f32(t, vsubq_f32(vld1q_f32(a), vld1q_f32(b)));
 	}
 
-	inline Vector2 Interp(const Vector2& v, float t) const {
-		return (*this) + (v - (*this)) * t;
+	static inline void Mul(float *t, const float *a, const float *b) {
+		vst1q_f32(t, vmulq_f32(vld1q_f32(a), vld1q_f32(b)));
 	}
 
-	inline Vector2 LengthClamp(float LengthMin, float LengthMax) const {
-		float length = Length();
-		if (length >= LengthMin && length <= LengthMax) {
-			return (*this);
-		}
-		else if (length > LengthMax) {
-			Vector2 n = (*this) / length;
-			return (*this) - (n * (length - LengthMax));
-		}	
-		else {
-			Vector2 n = (*this) / length;
-			return (*this) + (n * (LengthMin - length));
-		}
+	static inline void Scale(float *t, const float *a, float k) {
+		vst1q_f32(t, vmulq_n_f32(vld1q_f32(a), k));
 	}
 
-	inline std::ostream& Trace(std::ostream& os) const {
-		os << "Vector2(" << x << "," << y << ")";
-		return os;
+	static inline float Dot(const float *a, const float *b) {
+		float32x4_t p = vmulq_f32(vld1q_f32(a), vld1q_f32(b));
+		float32x2_t q = vadd_f32(vget_low_f32(p), vget_high_f32(p));
+		return vget_lane_f32(vpadd_f32(q, q), 0);
 	}
+#endif
 
-	inline std::string ToString() const {
-		std::stringstream ss;
-		Trace(ss);
-		return ss.str();
+	static inline void Divide(float *t, const float *a, float k) {
+		Scale(t, a, 1.0f / k);
 	}
 };
+#endif
 
 
 //---------------------------------------------------------------------
-// Vector3
+// VectorOps - shared members, D is the derived Vector<T, N>
 //---------------------------------------------------------------------
-struct Vector3
+template <class D, class T, int N>
+struct VectorOps
 {
-	union {
-		struct { float x, y, z; };
-		struct { float r, g, b; };
-		float m[3];
-	};
+	typedef T Type;
+	typedef typename ScalarTraits<T>::Scalar Scalar;
+	typedef typename ScalarTraits<T>::Real Real;
+	typedef VectorKernel<T, N> Kernel;
 
-	inline Vector3() {}
-	inline Vector3(const Vector3& v): x(v.x), y(v.y), z(v.z) {}
-	inline Vector3(float ix, float iy, float iz): x(ix), y(iy), z(iz) {}
-	inline Vector3(const float *v): x(v[0]), y(v[1]), z(v[2]) {}
-	inline Vector3(const Vector2& v, float iz): x(v.x), y(v.y), z(iz) {}
+	enum { SIZE = N };
 
-	inline Vector3& operator = (const Vector3& v) {
-		x = v.x, y = v.y, z = v.z;
-		return *this;
-	}
+	inline D& Self() { return *static_cast<D*>(this); }
+	inline const D& Self() const { return *static_cast<const D*>(this); }
 
-	inline bool operator == (const Vector3& v) {
-		return x == v.x && y == v.y && z == v.z;
+	inline bool operator == (const D& v) const {
+		for (int i = 0; i < N; i++) {
+			if (Self().m[i] != v.m[i]) return false;
+		}
+		return true;
 	}
 
-	inline bool operator != (const Vector3& v) {
-		return x != v.x || y != v.y || z != v.z;
+	inline bool operator != (const D& v) const {
+		return !(*this == v);
 	}
 
-	inline Vector3 operator + () {
-		return *this;
+	inline D operator + () const {
+		return Self();
 	}
 
-	inline Vector3 operator - () {
-		return Vector3(-x, -y, -z);
+	inline D operator - () const {
+		D t;
+		for (int i = 0; i < N; i++) t.m[i] = -Self().m[i];
+		return t;
 	}
 
-	inline Vector3 operator + (const Vector3& v) const {
-		return Vector3(x + v.x, y + v.y, z + v.z);
+	inline D operator + (const D& v) const {
+		D t;
+		Kernel::Add(t.m, Self().m, v.m);
+		return t;
 	}
 
-	inline Vector3 operator - (const Vector3& v) const {
-		return Vector3(x - v.x, y - v.y, z - v.z);
+	inline D operator - (const D& v) const {
+		D t;
+		Kernel::Sub(t.m, Self().m, v.m);
+		return t;
 	}
 
-	inline Vector3 operator * (const Vector3& v) const {
-		return Vector3(x * v.x, y * v.y, z * v.z);
+	inline D operator * (const D& v) const {
+		D t;
+		Kernel::Mul(t.m, Self().m, v.m);
+		return t;
 	}
 
-	inline Vector3 operator * (float scale) const {
-		return Vector3(x * scale, y * scale, z * scale);
+	inline D operator * (Scalar scale) const {
+		D t;
+		Kernel::Scale(t.m, Self().m, scale);
+		return t;
 	}
 
-	inline Vector3 operator / (float scale) const {
-		float inv = 1.0f / scale;
-		return Vector3(x * inv, y * inv, z * inv);
+	inline D operator / (Scalar scale) const {
+		D t;
+		Kernel::Divide(t.m, Self().m, scale);
+		return t;
 	}
 
-	inline Vector3 operator += (const Vector3& v) {
-		x += v.x, y += v.y, z += v.z;
-		return *this;
+	inline D& operator += (const D& v) {
+		Kernel::Add(Self().m, Self().m, v.m);
+		return Self();
 	}
 
-	inline Vector3 operator -= (const Vector3& v) {
-		x -= v.x, y -= v.y, z -= v.z;
-		return *this;
+	inline D& operator -= (const D& v) {
+		Kernel::Sub(Self().m, Self().m, v.m);
+		return Self();
 	}
 
-	inline Vector3 operator *= (const Vector3& v) {
-		x *= v.x, y *= v.y, z *= v.z;
-		return *this;
+	inline D& operator *= (const D& v) {
+		Kernel::Mul(Self().m, Self().m, v.m);
+		return Self();
 	}
 
-	inline Vector3& operator *= (float scale) {
-		x *= scale, y *= scale, z *= scale;
-		return *this;
-	}
-
-	inline Vector3& operator /= (float scale) {
-		float inv = 1.0f / scale;
-		x *= inv, y *= inv, z *= inv;
-		return *this;
+	inline D& operator *= (Scalar scale) {
+		Kernel::Scale(Self().m, Self().m, scale);
+		return Self();
 	}
 
-	inline Vector3& Zero() {
-		x = y = z = 0.0f;
-		return *this;
+	inline D& operator /= (Scalar scale) {
+		Kernel::Divide(Self().m, Self().m, scale);
+		return Self();
 	}
 
-	inline Vector3& One() {
-		x = y = z = 1.0f;
-		return *this;
+	inline D& Zero() {
+		for (int i = 0; i < N; i++) Self().m[i] = Scalar(0);
+		return Self();
 	}
 
-	inline Vector3& Set(float x, float y, float z) {
-		m[0] = x, m[1] = y, m[2] = z;
-		return *this;
+	inline D& One() {
+		for (int i = 0; i < N; i++) Self().m[i] = Scalar(1);
+		return Self();
 	}
 
-	inline float LengthSq() const {
-		return x * x + y * y + z * z;
+	inline Scalar LengthSq() const {
+		return Kernel::Dot(Self().m, Self().m);
 	}
 
-	inline float Length() const {
-		return sqrtf(LengthSq());
+	inline Real Length() const {
+		return SquareRoot(Real(LengthSq()));
 	}
 
-	inline Vector3& Normalize() {
-		(*this) /= Length();
-		return *this;
+	inline D& Normalize() {
+		Self() /= Scalar(Length());
+		return Self();
 	}
 
-	inline float Dot(const Vector3& v) const {
-		return x * v.x + y * v.y + z * v.z;
+	inline Scalar Dot(const D& v) const {
+		return Kernel::Dot(Self().m, v.m);
 	}
 
-	inline Vector3 Cross(const Vector3& v) const {
-		Vector3 a;
-		a.x = m[1] * v.m[2] - m[2] * v.m[1];
-		a.y = m[2] * v.m[0] - m[0] * v.m[2];
-		a.z = m[0] * v.m[1] - m[1] * v.m[0];
-		return a;
-	}
-
-	inline float Distance(const Vector3& v) const {
-		Vector3 a = (*this) - v;
+	inline Real Distance(const D& v) const {
+		D a = Self() - v;
 		return a.Length();
 	}
 
-	inline float DistanceSq(const Vector3& v) const {
-		Vector3 a = (*this) - v;
+	inline Scalar DistanceSq(const D& v) const {
+		D a = Self() - v;
 		return a.LengthSq();
 	}
 
-	inline bool NearEqual(const Vector3& v) const {
-		return ::GFX::Core::NearZero(DistanceSq(v));
+	inline bool NearEqual(const D& v) const {
+		return ::GFX::Core::NearZero(Real(DistanceSq(v)));
 	}
 
 	inline bool NearZero() const {
-		return ::GFX::Core::NearZero(LengthSq());
+		return ::GFX::Core::NearZero(Real(LengthSq()));
 	}
 
-	inline Vector3 Interp(const Vector3& v, float t) const {
-		return (*this) + (v - (*this)) * t;
+	inline D Interp(const D& v, Scalar t) const {
+		return Self() + (v - Self()) * t;
 	}
 
-	inline Vector3 LengthClamp(float LengthMin, float LengthMax) const {
-		float length = Length();
+	inline D LengthClamp(Real LengthMin, Real LengthMax) const {
+		Real length = Length();
 		if (length >= LengthMin && length <= LengthMax) {
-			return (*this);
+			return Self();
 		}
 		else if (length > LengthMax) {
-			Vector3 n = (*this) / length;
-			return (*this) - (n * (length - LengthMax));
-		}	
+			D n = Self() / Scalar(length);
+			return Self() - (n * Scalar(length - LengthMax));
+		}
 		else {
-			Vector3 n = (*this) / length;
-			return (*this) + (n * (LengthMin - length));
+			D n = Self() / Scalar(length);
+			return Self() + (n * Scalar(LengthMin - length));
 		}
 	}
 
 	inline std::ostream& Trace(std::ostream& os) const {
-		os << "Vector3(" << x << "," << y << "," << z << ")";
+		os << "Vector" << N << "(" << Self().m[0];
+		for (int i = 1; i < N; i++) os << "," << Self().m[i];
+		os << ")";
 		return os;
 	}
 
@@ -370,191 +305,174 @@ struct Vector3
 
 
 //---------------------------------------------------------------------
-// Vector4
+// Vector<T, 2>
 //---------------------------------------------------------------------
-struct Vector4
+template <class T>
+struct Vector<T, 2>: public VectorOps<Vector<T, 2>, T, 2>
 {
+	typedef typename ScalarTraits<T>::Scalar Scalar;
+
 	union {
-		struct { float x, y, z, w; };
-		struct { float r, g, b, a; };
-		float m[4];
+		struct { T x, y; };
+		T m[2];
 	};
 
-	inline Vector4() {}
-	inline Vector4(const Vector4& v): x(v.x), y(v.y), z(v.z), w(v.w) {}
-	inline Vector4(float ix, float iy, float iz, float iw): x(ix), y(iy), z(iz), w(iw) {}
-	inline Vector4(const float *v): x(v[0]), y(v[1]), z(v[2]), w(v[3]) {}
-	inline Vector4(const Vector3& v, float iw): x(v.x), y(v.y), z(v.z), w(iw) {}
-
-	inline Vector4& operator = (const Vector4& v) {
-		x = v.x, y = v.y, z = v.z, w = v.w;
-		return *this;
-	}
-
-	inline bool operator == (const Vector4& v) {
-		return x == v.x && y == v.y && z == v.z && w == v.w;
-	}
-
-	inline bool operator != (const Vector4& v) {
-		return x != v.x || y != v.y || z != v.z || w != v.w;
-	}
+	inline Vector() {}
+	inline GFX_CONSTEXPR Vector(T ix, T iy): x(ix), y(iy) {}
+	inline Vector(const T *v): x(v[0]), y(v[1]) {}
 
-	inline Vector4 operator + () {
+	inline Vector& Set(Scalar ix, Scalar iy) {
+		m[0] = ix, m[1] = iy;
 		return *this;
 	}
 
-	inline Vector4 operator - () {
-		return Vector4(-x, -y, -z, -w);
-	}
-
-	inline Vector4 operator + (const Vector4& v) const {
-		return Vector4(x + v.x, y + v.y, z + v.z, w + v.w);
-	}
-
-	inline Vector4 operator - (const Vector4& v) const {
-		return Vector4(x - v.x, y - v.y, z - v.z, w - v.w);
-	}
-
-	inline Vector4 operator * (const Vector4& v) const {
-		return Vector4(x * v.x, y * v.y, z * v.z, w * v.w);
-	}
-
-	inline Vector4 operator * (float scale) const {
-		return Vector4(x * scale, y * scale, z * scale, w * scale);
-	}
-
-	inline Vector4 operator / (float scale) const {
-		float inv = 1.0f / scale;
-		return Vector4(x * inv, y * inv, z * inv, w * inv);
+	// the z of the 3d cross product in both lanes
+	inline Vector Cross(const Vector& v) const {
+		Vector a;
+		a.x = Scalar(x) * Scalar(v.y) - Scalar(y) * Scalar(v.x);
+		a.y = a.x;
+		return a;
 	}
+};
 
-	inline Vector4 operator += (const Vector4& v) {
-		x += v.x, y += v.y, z += v.z, w += v.w;
-		return *this;
-	}
 
-	inline Vector4 operator -= (const Vector4& v) {
-		x -= v.x, y -= v.y, z -= v.z, w -= v.w;
-		return *this;
-	}
+//---------------------------------------------------------------------
+// Vector<T, 3>
+//---------------------------------------------------------------------
+template <class T>
+struct Vector<T, 3>: public VectorOps<Vector<T, 3>, T, 3>
+{
+	typedef typename ScalarTraits<T>::Scalar Scalar;
 
-	inline Vector4 operator *= (const Vector4& v) {
-		x *= v.x, y *= v.y, z *= v.z, w *= v.w;
-		return *this;
-	}
+	union {
+		struct { T x, y, z; };
+		struct { T r, g, b; };
+		T m[3];
+	};
 
-	inline Vector4& operator *= (float scale) {
-		x *= scale, y *= scale, z *= scale, w *= scale;
-		return *this;
-	}
+	inline Vector() {}
+	inline GFX_CONSTEXPR Vector(T ix, T iy, T iz): x(ix), y(iy), z(iz) {}
+	inline Vector(const T *v): x(v[0]), y(v[1]), z(v[2]) {}
+	inline GFX_CONSTEXPR Vector(const Vector<T, 2>& v, T iz): x(v.x), y(v.y), z(iz) {}
 
-	inline Vector4& operator /= (float scale) {
-		float inv = 1.0f / scale;
-		x *= inv, y *= inv, z *= inv, w *= inv;
+	inline Vector& Set(Scalar ix, Scalar iy, Scalar iz) {
+		m[0] = ix, m[1] = iy, m[2] = iz;
 		return *this;
 	}
 
-	inline Vector4& Zero() {
-		x = y = z = w = 0.0f;
-		return *this;
+	inline Vector Cross(const Vector& v) const {
+		Vector a;
+		a.x = Scalar(m[1]) * Scalar(v.m[2]) - Scalar(m[2]) * Scalar(v.m[1]);
+		a.y = Scalar(m[2]) * Scalar(v.m[0]) - Scalar(m[0]) * Scalar(v.m[2]);
+		a.z = Scalar(m[0]) * Scalar(v.m[1]) - Scalar(m[1]) * Scalar(v.m[0]);
+		return a;
 	}
+};
 
-	inline Vector4& One() {
-		x = y = z = w = 1.0f;
-		return *this;
-	}
 
-	inline Vector4& Set(float x, float y, float z, float w) {
-		m[0] = x, m[1] = y, m[2] = z, m[3] = w;
-		return *this;
-	}
+//---------------------------------------------------------------------
+// Vector<T, 4>
+//---------------------------------------------------------------------
+template <class T>
+struct Vector<T, 4>: public VectorOps<Vector<T, 4>, T, 4>
+{
+	typedef typename ScalarTraits<T>::Scalar Scalar;
 
-	inline float LengthSq() const {
-		return x * x + y * y + z * z + w * w;
-	}
+	union {
+		struct { T x, y, z, w; };
+		struct { T r, g, b, a; };
+		T m[4];
+	};
 
-	inline float Length() const {
-		return sqrtf(LengthSq());
-	}
+	inline Vector() {}
+	inline GFX_CONSTEXPR Vector(T ix, T iy, T iz, T iw): x(ix), y(iy), z(iz), w(iw) {}
+	inline Vector(const T *v): x(v[0]), y(v[1]), z(v[2]), w(v[3]) {}
+	inline GFX_CONSTEXPR Vector(const Vector<T, 3>& v, T iw): x(v.x), y(v.y), z(v.z), w(iw) {}
 
-	inline Vector4& Normalize() {
-		(*this) /= Length();
+	inline Vector& Set(Scalar ix, Scalar iy, Scalar iz, Scalar iw) {
+		m[0] = ix, m[1] = iy, m[2] = iz, m[3] = iw;
 		return *this;
 	}
 
-	inline float Dot(const Vector4& v) const {
-		return x * v.x + y * v.y + z * v.z + w * v.w;
-	}
-
-	inline Vector4 Cross(const Vector4& v) const {
-		Vector4 a;
-		a.x = m[1] * v.m[2] - m[3] * v.m[2];
-		a.y = m[2] * v.m[3] - m[0] * v.m[3];
-		a.z = m[3] * v.m[0] - m[1] * v.m[0];
-		a.w = m[0] * v.m[1] - m[2] * v.m[1];
+	// cross product of the xyz parts, w is zero
+	inline Vector Cross(const Vector& v) const {
+		Vector a;
+		a.x = Scalar(m[1]) * Scalar(v.m[2]) - Scalar(m[2]) * Scalar(v.m[1]);
+		a.y = Scalar(m[2]) * Scalar(v.m[0]) - Scalar(m[0]) * Scalar(v.m[2]);
+		a.z = Scalar(m[0]) * Scalar(v.m[1]) - Scalar(m[1]) * Scalar(v.m[0]);
+		a.w = Scalar(0);
 		return a;
 	}
+};
 
-	inline float Distance(const Vector4& v) const {
-		Vector4 a = (*this) - v;
-		return a.Length();
-	}
 
-	inline float DistanceSq(const Vector4& v) const {
-		Vector4 a = (*this) - v;
-		return a.LengthSq();
-	}
+//---------------------------------------------------------------------
+// names
+//---------------------------------------------------------------------
+typedef Vector<float, 2> Vector2;
+typedef Vector<float, 3> Vector3;
+typedef Vector<float, 4> Vector4;
 
-	inline bool NearEqual(const Vector4& v) const {
-		return ::GFX::Core::NearZero(DistanceSq(v));
-	}
+typedef Vector<double, 2> Vector2d;
+typedef Vector<double, 3> Vector3d;
+typedef Vector<double, 4> Vector4d;
 
-	inline bool NearZero() const {
-		return ::GFX::Core::NearZero(LengthSq());
-	}
+typedef Vector<int32_t, 2> Vector2i;
+typedef Vector<int32_t, 3> Vector3i;
+typedef Vector<int32_t, 4> Vector4i;
 
-	inline Vector4 Interp(const Vector4& v, float t) const {
-		return (*this) + (v - (*this)) * t;
-	}
+typedef Vector<Half, 2> Vector2h;
+typedef Vector<Half, 3> Vector3h;
+typedef Vector<Half, 4> Vector4h;
 
-	inline Vector4 LengthClamp(float LengthMin, float LengthMax) const {
-		float length = Length();
-		if (length >= LengthMin && length <= LengthMax) {
-			return (*this);
-		}
-		else if (length > LengthMax) {
-			Vector4 n = (*this) / length;
-			return (*this) - (n * (length - LengthMax));
-		}	
-		else {
-			Vector4 n = (*this) / length;
-			return (*this) + (n * (LengthMin - length));
-		}
-	}
 
-	inline std::ostream& Trace(std::ostream& os) const {
-		os << "Vector4(" << x << "," << y << "," << z << "," << z << ")";
-		return os;
-	}
+//---------------------------------------------------------------------
+// operators
+//---------------------------------------------------------------------
+template <class T, int N>
+inline Vector<T, N> operator * (typename ScalarTraits<T>::Scalar k, const Vector<T, N>& v) {
+	return v * k;
+}
 
-	inline std::string ToString() const {
-		std::stringstream ss;
-		Trace(ss);
-		return ss.str();
-	}
-};
+template <class T, int N>
+inline std::ostream& operator << (std::ostream& os, const Vector<T, N>& v) {
+	return v.Trace(os);
+}
 
 
 //---------------------------------------------------------------------
-// operators
+// batch kernels over strided arrays, strides are in bytes so they can
+// walk vertex structs, dst may be the same array as src. precise uses
+// sqrt and divide, otherwise the rsqrt estimate with one Newton step
+// (under 1e-6 relative error). zero length vectors normalize to zero.
 //---------------------------------------------------------------------
-inline Vector2 operator * (float k, const Vector2& v) { return v.operator*(k); }
-inline Vector3 operator * (float k, const Vector3& v) { return v.operator*(k); }
-inline Vector4 operator * (float k, const Vector4& v) { return v.operator*(k); }
-
-inline std::ostream& operator << (std::ostream& os, const Vector2& v) { return v.Trace(os); }
-inline std::ostream& operator << (std::ostream& os, const Vector3& v) { return v.Trace(os); }
-inline std::ostream& operator << (std::ostream& os, const Vector4& v) { return v.Trace(os); }
+void NormalizeArray(Vector3 *dst, const Vector3 *src, size_t count,
+		bool precise = false,
+		size_t dst_stride = sizeof(Vector3),
+		size_t src_stride = sizeof(Vector3));
+
+void NormalizeArray(Vector4 *dst, const Vector4 *src, size_t count,
+		bool precise = false,
+		size_t dst_stride = sizeof(Vector4),
+		size_t src_stride = sizeof(Vector4));
+
+// dst[i] = src[i].Length()
+void LengthArray(float *dst, const Vector3 *src, size_t count,
+		bool precise = false, size_t src_stride = sizeof(Vector3));
+
+void LengthArray(float *dst, const Vector4 *src, size_t count,
+		bool precise = false, size_t src_stride = sizeof(Vector4));
+
+// dst[i] = a[i].DistanceSq(b[i])
+void DistanceSqArray(float *dst, const Vector3 *a, const Vector3 *b,
+		size_t count,
+		size_t a_stride = sizeof(Vector3),
+		size_t b_stride = sizeof(Vector3));
+
+void DistanceSqArray(float *dst, const Vector4 *a, const Vector4 *b,
+		size_t count,
+		size_t a_stride = sizeof(Vector4),
+		size_t b_stride = sizeof(Vector4));
 
 
 //---------------------------------------------------------------------
@@ -0,0 +1,376 @@
+//=====================================================================
+//
+// GFXVectorSoA.h - structure-of-arrays vector packets
+//
+// Last Modified: 2026/10/18 11:40:51
+//
+//=====================================================================
+#ifndef _GFX_VECTOR_SOA_H_
+#define _GFX_VECTOR_SOA_H_
+
+#include "GFXSimd.h"
+#include "GFXVector.h"
+#include "GFXVertex.h"
+
+
+//---------------------------------------------------------------------
+// Namespace Begin
+//---------------------------------------------------------------------
+NAMESPACE_BEGIN(GFX);
+NAMESPACE_BEGIN(Core);
+
+
+//---------------------------------------------------------------------
+// AoS <-> SoA transpose of a full packet of either width
+//---------------------------------------------------------------------
+template <int N>
+inline void PacketGather(const uint8_t *src, size_t stride,
+		Float4& x, Float4& y, Float4& z, Float4& w) {
+	Float4_Gather<N>(src, stride, x, y, z, w);
+}
+
+template <int N>
+inline void PacketGather(const uint8_t *src, size_t stride,
+		Float8& x, Float8& y, Float8& z, Float8& w) {
+	Float8_Gather<N>(src, stride, x, y, z, w);
+}
+
+template <int N>
+inline void PacketScatter(uint8_t *dst, size_t stride,
+		const Float4& x, const Float4& y, const Float4& z, const Float4& w) {
+	Float4_Scatter<N>(dst, stride, x, y, z, w);
+}
+
+template <int N>
+inline void PacketScatter(uint8_t *dst, size_t stride,
+		const Float8& x, const Float8& y, const Float8& z, const Float8& w) {
+	Float8_Scatter<N>(dst, stride, x, y, z, w);
+}
+
+
+//---------------------------------------------------------------------
+// Vector3xN - N lanes of Vector3 (F is Float4 or Float8)
+//---------------------------------------------------------------------
+template <class F>
+struct Vector3xN
+{
+	enum { LANES = F::LANES };
+
+	F x, y, z;
+
+	inline Vector3xN() {}
+	inline Vector3xN(const F& ix, const F& iy, const F& iz): x(ix), y(iy), z(iz) {}
+	inline explicit Vector3xN(const Vector3& v): x(v.x), y(v.y), z(v.z) {}
+
+	inline Vector3xN operator + (const Vector3xN& v) const {
+		return Vector3xN(x + v.x, y + v.y, z + v.z);
+	}
+
+	inline Vector3xN operator - (const Vector3xN& v) const {
+		return Vector3xN(x - v.x, y - v.y, z - v.z);
+	}
+
+	inline Vector3xN operator - () const {
+		return Vector3xN(-x, -y, -z);
+	}
+
+	inline Vector3xN operator * (const Vector3xN& v) const {
+		return Vector3xN(x * v.x, y * v.y, z * v.z);
+	}
+
+	inline Vector3xN operator * (const F& scale) const {
+		return Vector3xN(x * scale, y * scale, z * scale);
+	}
+
+	inline Vector3xN operator * (float scale) const {
+		return (*this) * F(scale);
+	}
+
+	inline Vector3xN operator / (const F& scale) const {
+		F inv = F(1.0f) / scale;
+		return Vector3xN(x * inv, y * inv, z * inv);
+	}
+
+	inline Vector3xN& operator += (const Vector3xN& v) {
+		x += v.x, y += v.y, z += v.z;
+		return *this;
+	}
+
+	inline Vector3xN& operator -= (const Vector3xN& v) {
+		x -= v.x, y -= v.y, z -= v.z;
+		return *this;
+	}
+
+	inline Vector3xN& operator *= (const F& scale) {
+		x *= scale, y *= scale, z *= scale;
+		return *this;
+	}
+
+	inline F LengthSq() const {
+		return MulAdd(x, x, MulAdd(y, y, z * z));
+	}
+
+	inline F Length() const {
+		return Sqrt(LengthSq());
+	}
+
+	inline Vector3xN& Normalize() {
+		(*this) *= F(1.0f) / Length();
+		return *this;
+	}
+
+	inline F Dot(const Vector3xN& v) const {
+		return MulAdd(x, v.x, MulAdd(y, v.y, z * v.z));
+	}
+
+	inline Vector3xN Cross(const Vector3xN& v) const {
+		return Vector3xN(y * v.z - z * v.y, z * v.x - x * v.z, x * v.y - y * v.x);
+	}
+
+	inline F Distance(const Vector3xN& v) const {
+		return ((*this) - v).Length();
+	}
+
+	inline F DistanceSq(const Vector3xN& v) const {
+		return ((*this) - v).LengthSq();
+	}
+
+	inline Vector3xN Interp(const Vector3xN& v, const F& t) const {
+		return Vector3xN(MulAdd(v.x - x, t, x), MulAdd(v.y - y, t, y),
+				MulAdd(v.z - z, t, z));
+	}
+
+	inline Vector3xN Interp(const Vector3xN& v, float t) const {
+		return Interp(v, F(t));
+	}
+
+	// same result as Vector3::LengthClamp per lane
+	inline Vector3xN LengthClamp(float LengthMin, float LengthMax) const {
+		F length = Length();
+		F lo = F(LengthMin), hi = F(LengthMax);
+		F k = Select(CmpGt(length, hi), hi, lo) / length;
+		F inside = And(CmpGe(length, lo), CmpLe(length, hi));
+		k = Select(inside, F(1.0f), k);
+		return (*this) * k;
+	}
+
+	// gather from AoS, stride in bytes, lanes past count are zero.
+	// full packets are transposed in registers
+	inline Vector3xN& Load(const Vector3 *src, size_t stride = sizeof(Vector3),
+			int count = LANES) {
+		if (count >= LANES) {
+			F w;
+			PacketGather<3>((const uint8_t*)src, stride, x, y, z, w);
+			return *this;
+		}
+		float t[3][LANES];
+		const uint8_t *p = (const uint8_t*)src;
+		for (int i = 0; i < LANES; i++, p += stride) {
+			if (i < count) {
+				const Vector3 *v = (const Vector3*)p;
+				t[0][i] = v->x, t[1][i] = v->y, t[2][i] = v->z;
+			}
+			else {
+				t[0][i] = t[1][i] = t[2][i] = 0.0f;
+			}
+		}
+		x = F::Load(t[0]), y = F::Load(t[1]), z = F::Load(t[2]);
+		return *this;
+	}
+
+	// scatter to AoS, only the first count lanes are written
+	inline void Store(Vector3 *dst, size_t stride = sizeof(Vector3),
+			int count = LANES) const {
+		if (count >= LANES) {
+			// w is dropped for 3 floats
+			PacketScatter<3>((uint8_t*)dst, stride, x, y, z, z);
+			return;
+		}
+		float t[3][LANES];
+		x.Store(t[0]), y.Store(t[1]), z.Store(t[2]);
+		uint8_t *p = (uint8_t*)dst;
+		for (int i = 0; i < count; i++, p += stride) {
+			Vector3 *v = (Vector3*)p;
+			v->x = t[0][i], v->y = t[1][i], v->z = t[2][i];
+		}
+	}
+
+	inline Vector3xN& LoadPosition(const VertexSt *src, int count = LANES) {
+		return Load(&src->pos, sizeof(VertexSt), count);
+	}
+
+	inline Vector3xN& LoadNormal(const VertexSt *src, int count = LANES) {
+		return Load(&src->normal, sizeof(VertexSt), count);
+	}
+
+	inline void StorePosition(VertexSt *dst, int count = LANES) const {
+		Store(&dst->pos, sizeof(VertexSt), count);
+	}
+
+	inline void StoreNormal(VertexSt *dst, int count = LANES) const {
+		Store(&dst->normal, sizeof(VertexSt), count);
+	}
+
+	inline Vector3 Get(int i) const {
+		return Vector3(x.Get(i), y.Get(i), z.Get(i));
+	}
+};
+
+
+//---------------------------------------------------------------------
+// Vector4xN - N lanes of Vector4
+//---------------------------------------------------------------------
+template <class F>
+struct Vector4xN
+{
+	enum { LANES = F::LANES };
+
+	F x, y, z, w;
+
+	inline Vector4xN() {}
+	inline Vector4xN(const F& ix, const F& iy, const F& iz, const F& iw):
+		x(ix), y(iy), z(iz), w(iw) {}
+	inline explicit Vector4xN(const Vector4& v): x(v.x), y(v.y), z(v.z), w(v.w) {}
+	inline Vector4xN(const Vector3xN<F>& v, const F& iw): x(v.x), y(v.y), z(v.z), w(iw) {}
+
+	inline Vector4xN operator + (const Vector4xN& v) const {
+		return Vector4xN(x + v.x, y + v.y, z + v.z, w + v.w);
+	}
+
+	inline Vector4xN operator - (const Vector4xN& v) const {
+		return Vector4xN(x - v.x, y - v.y, z - v.z, w - v.w);
+	}
+
+	inline Vector4xN operator - () const {
+		return Vector4xN(-x, -y, -z, -w);
+	}
+
+	inline Vector4xN operator * (const Vector4xN& v) const {
+		return Vector4xN(x * v.x, y * v.y, z * v.z, w * v.w);
+	}
+
+	inline Vector4xN operator * (const F& scale) const {
+		return Vector4xN(x * scale, y * scale, z * scale, w * scale);
+	}
+
+	inline Vector4xN operator * (float scale) const {
+		return (*this) * F(scale);
+	}
+
+	inline Vector4xN& operator += (const Vector4xN& v) {
+		x += v.x, y += v.y, z += v.z, w += v.w;
+		return *this;
+	}
+
+	inline Vector4xN& operator -= (const Vector4xN& v) {
+		x -= v.x, y -= v.y, z -= v.z, w -= v.w;
+		return *this;
+	}
+
+	inline Vector4xN& operator *= (const F& scale) {
+		x *= scale, y *= scale, z *= scale, w *= scale;
+		return *this;
+	}
+
+	inline F LengthSq() const {
+		return MulAdd(x, x, MulAdd(y, y, MulAdd(z, z, w * w)));
+	}
+
+	inline F Length() const {
+		return Sqrt(LengthSq());
+	}
+
+	inline Vector4xN& Normalize() {
+		(*this) *= F(1.0f) / Length();
+		return *this;
+	}
+
+	inline F Dot(const Vector4xN& v) const {
+		return MulAdd(x, v.x, MulAdd(y, v.y, MulAdd(z, v.z, w * v.w)));
+	}
+
+	inline F DistanceSq(const Vector4xN& v) const {
+		return ((*this) - v).LengthSq();
+	}
+
+	inline Vector4xN Interp(const Vector4xN& v, const F& t) const {
+		return Vector4xN(MulAdd(v.x - x, t, x), MulAdd(v.y - y, t, y),
+				MulAdd(v.z - z, t, z), MulAdd(v.w - w, t, w));
+	}
+
+	inline Vector4xN Interp(const Vector4xN& v, float t) const {
+		return Interp(v, F(t));
+	}
+
+	inline Vector4xN LengthClamp(float LengthMin, float LengthMax) const {
+		F length = Length();
+		F lo = F(LengthMin), hi = F(LengthMax);
+		F k = Select(CmpGt(length, hi), hi, lo) / length;
+		F inside = And(CmpGe(length, lo), CmpLe(length, hi));
+		k = Select(inside, F(1.0f), k);
+		return (*this) * k;
+	}
+
+	inline Vector4xN& Load(const Vector4 *src, size_t stride = sizeof(Vector4),
+			int count = LANES) {
+		if (count >= LANES) {
+			PacketGather<4>((const uint8_t*)src, stride, x, y, z, w);
+			return *this;
+		}
+		float t[4][LANES];
+		const uint8_t *p = (const uint8_t*)src;
+		for (int i = 0; i < LANES; i++, p += stride) {
+			for (int k = 0; k < 4; k++) {
+				t[k][i] = (i < count)? ((const Vector4*)p)->m[k] : 0.0f;
+			}
+		}
+		x = F::Load(t[0]), y = F::Load(t[1]), z = F::Load(t[2]), w = F::Load(t[3]);
+		return *this;
+	}
+
+	inline void Store(Vector4 *dst, size_t stride = sizeof(Vector4),
+			int count = LANES) const {
+		if (count >= LANES) {
+			PacketScatter<4>((uint8_t*)dst, stride, x, y, z, w);
+			return;
+		}
+		float t[4][LANES];
+		x.Store(t[0]), y.Store(t[1]), z.Store(t[2]), w.Store(t[3]);
+		uint8_t *p = (uint8_t*)dst;
+		for (int i = 0; i < count; i++, p += stride) {
+			Vector4 *v = (Vector4*)p;
+			v->x = t[0][i], v->y = t[1][i], v->z = t[2][i], v->w = t[3][i];
+		}
+	}
+
+	inline Vector4 Get(int i) const {
+		return Vector4(x.Get(i), y.Get(i), z.Get(i), w.Get(i));
+	}
+};
+
+
+//---------------------------------------------------------------------
+// packets
+//---------------------------------------------------------------------
+typedef Vector3xN<Float4> Vector3x4;
+typedef Vector3xN<Float8> Vector3x8;
+typedef Vector4xN<Float4> Vector4x4;
+typedef Vector4xN<Float8> Vector4x8;
+
+template <class F>
+inline Vector3xN<F> operator * (const F& k, const Vector3xN<F>& v) { return v * k; }
+
+template <class F>
+inline Vector4xN<F> operator * (const F& k, const Vector4xN<F>& v) { return v * k; }
+
+
+//---------------------------------------------------------------------
+// Namespace End
+//---------------------------------------------------------------------
+NAMESPACE_END(Core);
+NAMESPACE_END(GFX);
+
+
+#endif
+
+
@@ -38,11 +38,11 @@ struct VertexSt
 	Vector2 tuv;
 
 	inline VertexSt() {}
-	inline VertexSt(float x, float y, float z, 
+	inline GFX_CONSTEXPR VertexSt(float x, float y, float z, 
 			float nx, float ny, float nz,
 			uint32_t col, float u, float v): 
 		pos(x, y, z), normal(nx, ny, nz), color(col), tuv(u, v) {}
-	inline VertexSt(const Vector3& Pos, const Vector3& Normal,
+	inline GFX_CONSTEXPR VertexSt(const Vector3& Pos, const Vector3& Normal,
 			const Color cc, const Vector2& Tuv):
 		pos(Pos), normal(Normal), color(cc), tuv(Tuv) {}
 };
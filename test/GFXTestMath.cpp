@@ -0,0 +1,407 @@
+//=====================================================================
+//
+// GFXTestMath.cpp - fast math accuracy against double precision libm
+//
+// Last Modified: 2026/10/19 11:36:52
+//
+// checks the error table above FastSinCos in GFXMath.h for the scalar
+// FastXxx and the 4/8 lane versions of GFXSimd.h, build one executable
+// per GFX_PLATFORM and run each:
+//
+//   cl /O2 /EHsc /DGFX_PLATFORM=1 /I..\gfx GFXTestMath.cpp
+//
+//   g++ -O2 -msse2 -DGFX_PLATFORM=1 -I../gfx GFXTestMath.cpp
+//
+// (platform 0 none, 1 sse2, 2 /arch:AVX, 3 /arch:AVX2, 4 neon)
+//
+// usage: GFXTestMath [-f filter], exits with 1 if a bound is exceeded
+//
+//=====================================================================
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <vector>
+
+#include "GFXMath.h"
+#include "GFXSimd.h"
+
+using namespace GFX::Core;
+
+
+//---------------------------------------------------------------------
+// checks
+//---------------------------------------------------------------------
+static int g_failed = 0;
+
+#define TEST_CHECK(x) do { \
+		if (!(x)) { \
+			printf("  %s:%d: %s\n", __FILE__, __LINE__, #x); \
+			g_failed++; \
+		} \
+	} while (0)
+
+static uint32_t g_seed = 0x12345678;
+
+// uniform in [-1, 1)
+static float Random()
+{
+	g_seed = g_seed * 1664525u + 1013904223u;
+	return (float)(int)(g_seed >> 8) / 8388608.0f - 1.0f;
+}
+
+
+//---------------------------------------------------------------------
+// inputs
+//---------------------------------------------------------------------
+typedef std::vector<float> Floats;
+
+static float FloatFromBits(uint32_t u)
+{
+	float x;
+	memcpy(&x, &u, 4);
+	return x;
+}
+
+static uint32_t FloatToBits(float x)
+{
+	uint32_t u;
+	memcpy(&u, &x, 4);
+	return u;
+}
+
+// every step-th float of [lo, hi], 0 < lo < hi, and their negatives
+// when signed, an odd step walks through the mantissas too
+static void Sweep(Floats& x, float lo, float hi, uint32_t step, bool signed_)
+{
+	for (uint32_t u = FloatToBits(lo); u <= FloatToBits(hi); u += step) {
+		x.push_back(FloatFromBits(u));
+		if (signed_) x.push_back(-FloatFromBits(u));
+	}
+	x.push_back(hi);
+	if (signed_) x.push_back(-hi);
+}
+
+// the floats around k * pi/2 up to limit: the zeros of sin and cos,
+// where the range reduction has to keep the most bits
+static void Quadrants(Floats& x, float limit)
+{
+	for (int k = 1; k * 1.5707963267948966 <= limit; k++) {
+		float f = (float)(k * 1.5707963267948966);
+		float l = f, h = f;
+		for (int i = 0; i < 3; i++) {
+			l = nextafterf(l, 0.0f);
+			h = nextafterf(h, limit);
+		}
+		for (float t = l; t <= h && t <= limit; t = nextafterf(t, limit)) {
+			x.push_back(t);
+			x.push_back(-t);
+		}
+	}
+}
+
+
+//---------------------------------------------------------------------
+// Error - largest error and where it happened
+//---------------------------------------------------------------------
+struct Error
+{
+	double max;
+	float x;
+
+	Error(): max(0.0), x(0.0f) {}
+
+	void Update(double e, float at) {
+		if (!(e <= max)) {
+			max = e;
+			x = at;
+		}
+	}
+};
+
+static double AbsError(float t, double r)
+{
+	return fabs((double)t - r);
+}
+
+static double RelError(float t, double r)
+{
+	return (r == 0.0)? fabs((double)t) : fabs(((double)t - r) / r);
+}
+
+
+//---------------------------------------------------------------------
+// the three versions of one function: scalar, 4 lanes, 8 lanes. count
+// is padded with the last input to a multiple of 8
+//---------------------------------------------------------------------
+enum { VERSION_SCALAR = 0, VERSION_FLOAT4, VERSION_FLOAT8, VERSION_COUNT };
+
+static const char *g_version_names[VERSION_COUNT] = { "scalar", "4 lanes", "8 lanes" };
+
+template <class OP>
+static void Evaluate(const OP& op, Floats& y, Floats& x, Floats out[VERSION_COUNT])
+{
+	if (y.size() < x.size()) y.resize(x.size(), 0.0f);
+	while (x.size() % 8) {
+		x.push_back(x.back());
+		y.push_back(y.back());
+	}
+	size_t count = x.size();
+	for (int v = 0; v < VERSION_COUNT; v++) out[v].resize(count);
+	for (size_t i = 0; i < count; i++) {
+		out[VERSION_SCALAR][i] = op(y[i], x[i]);
+	}
+	for (size_t i = 0; i < count; i += 4) {
+		op(Float4::Load(&y[i]), Float4::Load(&x[i])).Store(&out[VERSION_FLOAT4][i]);
+	}
+	for (size_t i = 0; i < count; i += 8) {
+		op(Float8::Load(&y[i]), Float8::Load(&x[i])).Store(&out[VERSION_FLOAT8][i]);
+	}
+}
+
+static void Report(const char *name, const char *kind, const Error& e, double bound)
+{
+	printf("  %-20s %s error %.2e at %.9g (bound %.1e)\n", name, kind, e.max,
+			e.x, bound);
+}
+
+
+//---------------------------------------------------------------------
+// ops, y is only used by atan2
+//---------------------------------------------------------------------
+struct OpSin
+{
+	float operator()(float, float x) const { return FastSin(x); }
+	template <class F> F operator()(const F&, const F& x) const { F s, c; FastSinCos(x, s, c); return s; }
+};
+
+struct OpCos
+{
+	float operator()(float, float x) const { return FastCos(x); }
+	template <class F> F operator()(const F&, const F& x) const { F s, c; FastSinCos(x, s, c); return c; }
+};
+
+struct OpTan
+{
+	float operator()(float, float x) const { return FastTan(x); }
+	template <class F> F operator()(const F&, const F& x) const { return FastTan(x); }
+};
+
+struct OpAtan2
+{
+	float operator()(float y, float x) const { return FastAtan2(y, x); }
+	template <class F> F operator()(const F& y, const F& x) const { return FastAtan2(y, x); }
+};
+
+struct OpExp
+{
+	float operator()(float, float x) const { return FastExp(x); }
+	template <class F> F operator()(const F&, const F& x) const { return FastExp(x); }
+};
+
+struct OpLog
+{
+	float operator()(float, float x) const { return FastLog(x); }
+	template <class F> F operator()(const F&, const F& x) const { return FastLog(x); }
+};
+
+
+//---------------------------------------------------------------------
+// FastSinCos, |x| <= 8192, absolute error
+//---------------------------------------------------------------------
+static void Test_SinCos()
+{
+	Floats x, y, sin_out[VERSION_COUNT], cos_out[VERSION_COUNT];
+	Sweep(x, 1e-30f, 8192.0f, 4099, true);
+	Quadrants(x, 8192.0f);
+	x.push_back(0.0f);
+	Evaluate(OpSin(), y, x, sin_out);
+	Evaluate(OpCos(), y, x, cos_out);
+	for (int v = 0; v < VERSION_COUNT; v++) {
+		Error es, ec;
+		for (size_t i = 0; i < x.size(); i++) {
+			es.Update(AbsError(sin_out[v][i], sin((double)x[i])), x[i]);
+			ec.Update(AbsError(cos_out[v][i], cos((double)x[i])), x[i]);
+		}
+		Report(g_version_names[v], "sin abs", es, 1.0e-7);
+		Report(g_version_names[v], "cos abs", ec, 1.0e-7);
+		TEST_CHECK(es.max <= 1.0e-7);
+		TEST_CHECK(ec.max <= 1.0e-7);
+	}
+}
+
+
+//---------------------------------------------------------------------
+// FastTan, |x| <= 8192 and |cos x| > 0.01, relative error. the hard
+// inputs are next to the zeros of tan
+//---------------------------------------------------------------------
+static void Test_Tan()
+{
+	Floats x, y, out[VERSION_COUNT];
+	Sweep(x, 1e-30f, 8192.0f, 4099, true);
+	Quadrants(x, 8192.0f);
+	Evaluate(OpTan(), y, x, out);
+	for (int v = 0; v < VERSION_COUNT; v++) {
+		Error e;
+		for (size_t i = 0; i < x.size(); i++) {
+			if (fabs(cos((double)x[i])) <= 0.01) continue;
+			e.Update(RelError(out[v][i], tan((double)x[i])), x[i]);
+		}
+		Report(g_version_names[v], "tan rel", e, 2.5e-7);
+		TEST_CHECK(e.max <= 2.5e-7);
+	}
+}
+
+
+//---------------------------------------------------------------------
+// FastAtan2, absolute error in radians, (0, 0) gives 0 and -0 counts
+// as +0 (atan2(-0, -1) is pi)
+//---------------------------------------------------------------------
+static void Test_Atan2()
+{
+	Floats x, y, out[VERSION_COUNT];
+	for (int i = 0; i < 200000; i++) {
+		x.push_back(Random());
+		y.push_back(Random());
+	}
+	for (int i = 0; i < 200000; i++) {
+		x.push_back(ldexpf(Random(), (int)(Random() * 60.0f)));
+		y.push_back(ldexpf(Random(), (int)(Random() * 60.0f)));
+	}
+	const float axes[] = { 0.0f, -0.0f, 1.0f, -1.0f, 1e-30f, -1e30f };
+	for (int i = 0; i < 6; i++) {
+		for (int j = 0; j < 6; j++) {
+			y.push_back(axes[i]);
+			x.push_back(axes[j]);
+		}
+	}
+	Evaluate(OpAtan2(), y, x, out);
+	for (int v = 0; v < VERSION_COUNT; v++) {
+		Error e;
+		for (size_t i = 0; i < x.size(); i++) {
+			double r = (x[i] == 0.0f && y[i] == 0.0f)? 0.0 :
+					atan2((double)y[i] + 0.0, (double)x[i] + 0.0);
+			e.Update(AbsError(out[v][i], r), x[i]);
+		}
+		Report(g_version_names[v], "atan2 abs", e, 3.0e-7);
+		TEST_CHECK(e.max <= 3.0e-7);
+	}
+}
+
+
+//---------------------------------------------------------------------
+// FastExp on [-87.3, 88.7], relative error, clamped outside. the top
+// floats of the range overflow in float, they must give inf
+//---------------------------------------------------------------------
+static void Test_Exp()
+{
+	Floats x, y, out[VERSION_COUNT];
+	Sweep(x, 1e-30f, 87.3365447f, 1021, true);
+	Sweep(x, 87.3365447f, 88.7228391f, 1, false);
+	x.push_back(0.0f);
+	Evaluate(OpExp(), y, x, out);
+	for (int v = 0; v < VERSION_COUNT; v++) {
+		Error e;
+		for (size_t i = 0; i < x.size(); i++) {
+			double r = exp((double)x[i]);
+			if (r > 3.40282347e+38) TEST_CHECK(out[v][i] == HUGE_VALF);
+			else e.Update(RelError(out[v][i], r), x[i]);
+		}
+		Report(g_version_names[v], "exp rel", e, 1.2e-7);
+		TEST_CHECK(e.max <= 1.2e-7);
+	}
+
+	Floats cx, cy, clamped[VERSION_COUNT];
+	cx.push_back(-1000.0f);
+	cx.push_back(1000.0f);
+	Evaluate(OpExp(), cy, cx, clamped);
+	for (int v = 0; v < VERSION_COUNT; v++) {
+		TEST_CHECK(clamped[v][0] == FastExp(-87.3365447f));
+		TEST_CHECK(clamped[v][1] == HUGE_VALF);
+	}
+}
+
+
+//---------------------------------------------------------------------
+// FastLog on positive normal floats, relative error, and absolute
+// error on [0.5, 2] where log crosses 0
+//---------------------------------------------------------------------
+static void Test_Log()
+{
+	Floats x, y, out[VERSION_COUNT];
+	Sweep(x, 1.17549435e-38f, 3.40282347e+38f, 1021, false);
+	Sweep(x, 0.5f, 2.0f, 3, false);
+	Evaluate(OpLog(), y, x, out);
+	for (int v = 0; v < VERSION_COUNT; v++) {
+		Error e, ea;
+		for (size_t i = 0; i < x.size(); i++) {
+			double r = log((double)x[i]);
+			if (x[i] >= 0.5f && x[i] <= 2.0f) ea.Update(AbsError(out[v][i], r), x[i]);
+			else e.Update(RelError(out[v][i], r), x[i]);
+		}
+		Report(g_version_names[v], "log rel", e, 8.0e-8);
+		Report(g_version_names[v], "log abs [0.5, 2]", ea, 4.0e-8);
+		TEST_CHECK(e.max <= 8.0e-8);
+		TEST_CHECK(ea.max <= 4.0e-8);
+	}
+
+	Floats sx, sy, special[VERSION_COUNT];
+	sx.push_back(0.0f);
+	sx.push_back(-1.0f);
+	Evaluate(OpLog(), sy, sx, special);
+	for (int v = 0; v < VERSION_COUNT; v++) {
+		TEST_CHECK(special[v][0] == -HUGE_VALF);
+		TEST_CHECK(special[v][1] != special[v][1]);
+	}
+}
+
+
+//---------------------------------------------------------------------
+// cases
+//---------------------------------------------------------------------
+struct TestCase
+{
+	const char *name;
+	void (*proc)();
+};
+
+static const TestCase g_cases[] = {
+	{ "SinCos", Test_SinCos },
+	{ "Tan", Test_Tan },
+	{ "Atan2", Test_Atan2 },
+	{ "Exp", Test_Exp },
+	{ "Log", Test_Log },
+};
+
+
+//---------------------------------------------------------------------
+// main
+//---------------------------------------------------------------------
+int main(int argc, char *argv[])
+{
+	const char *filter = NULL;
+
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "-f") == 0 && i + 1 < argc) {
+			filter = argv[++i];
+		}
+		else {
+			printf("usage: %s [-f filter]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	printf("platform %d\n", GFX_PLATFORM);
+
+	for (size_t c = 0; c < sizeof(g_cases) / sizeof(g_cases[0]); c++) {
+		if (filter && strstr(g_cases[c].name, filter) == NULL) continue;
+		int failed = g_failed;
+		g_cases[c].proc();
+		printf("%-32s %s\n", g_cases[c].name, (g_failed == failed)? "ok" : "FAILED");
+	}
+
+	printf("%s\n", (g_failed == 0)? "all passed" : "failures");
+	return (g_failed == 0)? 0 : 1;
+}
+
+
@@ -0,0 +1,453 @@
+//=====================================================================
+//
+// GFXTestMatrix.cpp - Matrix4Kernel<float> against the scalar references
+//
+// Last Modified: 2026/10/19 11:02:37
+//
+// build one executable per GFX_PLATFORM and run each:
+//
+//   cl /O2 /EHsc /DGFX_PLATFORM=1 /I..\gfx GFXTestMatrix.cpp
+//      ..\gfx\GFXMatrix.cpp ..\gfx\GFXVector.cpp
+//
+//   g++ -O2 -msse2 -DGFX_PLATFORM=1 -I../gfx GFXTestMatrix.cpp
+//      ../gfx/GFXMatrix.cpp ../gfx/GFXVector.cpp
+//
+// (platform 0 none, 1 sse2, 2 /arch:AVX, 3 /arch:AVX2, 4 neon)
+//
+// usage: GFXTestMatrix [-f filter], exits with 1 if a check failed
+//
+//=====================================================================
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <vector>
+
+#include "GFXMatrix.h"
+#include "GFXVector.h"
+
+using namespace GFX::Core;
+
+
+//---------------------------------------------------------------------
+// checks
+//---------------------------------------------------------------------
+static int g_failed = 0;
+
+#define TEST_CHECK(x) do { \
+		if (!(x)) { \
+			printf("  %s:%d: %s\n", __FILE__, __LINE__, #x); \
+			g_failed++; \
+		} \
+	} while (0)
+
+static uint32_t g_seed = 0x12345678;
+
+// uniform in [-1, 1)
+static float Random()
+{
+	g_seed = g_seed * 1664525u + 1013904223u;
+	return (float)(int)(g_seed >> 8) / 8388608.0f - 1.0f;
+}
+
+
+//---------------------------------------------------------------------
+// helpers: results may differ from the references by rounding (FMA,
+// other summation order), eps is relative to the largest element
+//---------------------------------------------------------------------
+static float MaxAbs(const Matrix4& a)
+{
+	float k = 0.0f;
+	for (int j = 0; j < 4; j++) {
+		for (int i = 0; i < 4; i++) k = fmaxf(k, fabsf(a.m[j][i]));
+	}
+	return k;
+}
+
+static bool Near(const Matrix4& x, const Matrix4& y, float eps)
+{
+	float limit = eps * (1.0f + MaxAbs(y));
+	for (int j = 0; j < 4; j++) {
+		for (int i = 0; i < 4; i++) {
+			if (!(fabsf(x.m[j][i] - y.m[j][i]) <= limit)) return false;
+		}
+	}
+	return true;
+}
+
+static bool Near(const float *x, const float *y, int n, float eps)
+{
+	float k = 0.0f;
+	for (int i = 0; i < n; i++) k = fmaxf(k, fabsf(y[i]));
+	for (int i = 0; i < n; i++) {
+		if (!(fabsf(x[i] - y[i]) <= eps * (1.0f + k))) return false;
+	}
+	return true;
+}
+
+static bool Same(const Matrix4& x, const Matrix4& y)
+{
+	return memcmp(x.m, y.m, sizeof(x.m)) == 0;
+}
+
+// random elements in [-1, 1) plus 4 on the diagonal, well conditioned
+static Matrix4 RandomMatrix()
+{
+	Matrix4 a;
+	for (int j = 0; j < 4; j++) {
+		for (int i = 0; i < 4; i++) a.m[j][i] = Random();
+		a.m[j][j] += 4.0f;
+	}
+	return a;
+}
+
+// rotation / scale / shear in the 3x3 part, translation in row 3
+static Matrix4 RandomAffine()
+{
+	Matrix4 a = RandomMatrix();
+	a.m03 = a.m13 = a.m23 = 0.0f;
+	a.m30 *= 10.0f, a.m31 *= 10.0f, a.m32 *= 10.0f;
+	a.m33 = 1.0f;
+	return a;
+}
+
+static Matrix4 Sentinel()
+{
+	Matrix4 a;
+	for (int j = 0; j < 4; j++) {
+		for (int i = 0; i < 4; i++) a.m[j][i] = 1234.5f + (float)(j * 4 + i);
+	}
+	return a;
+}
+
+
+//---------------------------------------------------------------------
+// Multiply, t aliasing a, b or both
+//---------------------------------------------------------------------
+static void Test_Multiply()
+{
+	for (int n = 0; n < 200; n++) {
+		Matrix4 a = RandomMatrix(), b = RandomMatrix(), r, t;
+		Matrix4::MultiplyScalar(r, a, b);
+		Matrix4::Multiply(t, a, b);
+		TEST_CHECK(Near(t, r, 1e-6f));
+
+		t = a;
+		Matrix4::Multiply(t, t, b);
+		TEST_CHECK(Near(t, r, 1e-6f));
+
+		t = b;
+		Matrix4::Multiply(t, a, t);
+		TEST_CHECK(Near(t, r, 1e-6f));
+
+		Matrix4::MultiplyScalar(r, a, a);
+		t = a;
+		Matrix4::Multiply(t, t, t);
+		TEST_CHECK(Near(t, r, 1e-6f));
+	}
+}
+
+
+//---------------------------------------------------------------------
+// Transform of Vector4 and Vector3, t aliasing v
+//---------------------------------------------------------------------
+static void Test_Transform()
+{
+	for (int n = 0; n < 200; n++) {
+		Matrix4 m = RandomMatrix();
+		Vector4 v4(Random() * 10.0f, Random() * 10.0f, Random() * 10.0f, Random());
+		Vector4 r4, t4;
+		Matrix4::TransformScalar(r4, m, v4);
+		Matrix4::Transform(t4, m, v4);
+		TEST_CHECK(Near(t4.m, r4.m, 4, 1e-6f));
+		t4 = v4;
+		Matrix4::Transform(t4, m, t4);
+		TEST_CHECK(Near(t4.m, r4.m, 4, 1e-6f));
+
+		Vector3 v3(Random() * 10.0f, Random() * 10.0f, Random() * 10.0f);
+		Vector3 r3, t3;
+		Matrix4::TransformScalar(r3, m, v3);
+		Matrix4::Transform(t3, m, v3);
+		TEST_CHECK(Near(t3.m, r3.m, 3, 1e-6f));
+		t3 = v3;
+		Matrix4::Transform(t3, m, t3);
+		TEST_CHECK(Near(t3.m, r3.m, 3, 1e-6f));
+	}
+}
+
+
+//---------------------------------------------------------------------
+// TransformArray: every tail length, packed, strided and in place.
+// the float after each written vertex must stay untouched
+//---------------------------------------------------------------------
+template <int NOUT, int NIN>
+static void TestTransformArray(int stride)
+{
+	typedef Vector<float, NIN> VIN;
+	typedef Vector<float, NOUT> VOUT;
+	const float guard = -777.0f;
+	int din = (stride > 0)? stride : NIN + 1;
+	int dout = (stride > 0)? stride : NOUT + 1;
+	for (int count = 0; count <= 19; count++) {
+		Matrix4 m = RandomMatrix();
+		std::vector<float> src((size_t)din * (count + 1), guard);
+		std::vector<float> dst((size_t)dout * (count + 1), guard);
+		for (int i = 0; i < count; i++) {
+			for (int k = 0; k < NIN; k++) src[(size_t)i * din + k] = Random() * 10.0f;
+		}
+		// packed when stride is 0: NIN / NOUT floats apart
+		size_t sin = (stride > 0)? din * sizeof(float) : sizeof(VIN);
+		size_t sout = (stride > 0)? dout * sizeof(float) : sizeof(VOUT);
+		std::vector<float> packed_in((size_t)NIN * count + 1, guard);
+		std::vector<float> packed_out((size_t)NOUT * count + 1, guard);
+		const float *pin = (stride > 0)? &src[0] : &packed_in[0];
+		float *pout = (stride > 0)? &dst[0] : &packed_out[0];
+		if (stride == 0) {
+			for (int i = 0; i < count; i++) {
+				for (int k = 0; k < NIN; k++) packed_in[(size_t)i * NIN + k] = src[(size_t)i * din + k];
+			}
+		}
+		m.TransformArray((VOUT*)pout, (const VIN*)pin, count, sout, sin);
+		for (int i = 0; i < count; i++) {
+			const VIN& v = *(const VIN*)((const char*)pin + sin * i);
+			const float *t = (const float*)((const char*)pout + sout * i);
+			Vector4 r;
+			Vector4 h(v.m[0], v.m[1], v.m[2], (NIN == 4)? v.m[3] : 1.0f);
+			Matrix4::TransformScalar(r, m, h);
+			TEST_CHECK(Near(t, r.m, NOUT, 1e-6f));
+			if (stride > 0) TEST_CHECK(t[NOUT] == guard);
+		}
+		if (stride == 0) TEST_CHECK(packed_out[(size_t)NOUT * count] == guard);
+		else TEST_CHECK(dst[(size_t)dout * count] == guard);
+	}
+}
+
+// dst is src
+template <int N>
+static void TestTransformArrayInPlace()
+{
+	typedef Vector<float, N> V;
+	for (int count = 0; count <= 19; count++) {
+		Matrix4 m = RandomMatrix();
+		std::vector<V> v((size_t)count + 1), r((size_t)count + 1);
+		for (int i = 0; i < count; i++) {
+			for (int k = 0; k < N; k++) v[i].m[k] = Random() * 10.0f;
+			Vector4 h(v[i].m[0], v[i].m[1], v[i].m[2], (N == 4)? v[i].m[3] : 1.0f), t;
+			Matrix4::TransformScalar(t, m, h);
+			for (int k = 0; k < N; k++) r[i].m[k] = t.m[k];
+		}
+		m.TransformArray(&v[0], &v[0], count);
+		for (int i = 0; i < count; i++) {
+			TEST_CHECK(Near(v[i].m, r[i].m, N, 1e-6f));
+		}
+	}
+}
+
+static void Test_TransformArray()
+{
+	TestTransformArray<3, 3>(0);
+	TestTransformArray<4, 3>(0);
+	TestTransformArray<4, 4>(0);
+	TestTransformArray<3, 3>(8);
+	TestTransformArray<4, 3>(8);
+	TestTransformArray<4, 4>(8);
+	TestTransformArrayInPlace<3>();
+	TestTransformArrayInPlace<4>();
+}
+
+
+//---------------------------------------------------------------------
+// Add / Sub / Scale / Transpose are exact, t aliasing a or b
+//---------------------------------------------------------------------
+static void Test_Elementwise()
+{
+	for (int n = 0; n < 100; n++) {
+		Matrix4 a = RandomMatrix(), b = RandomMatrix(), r, t;
+		float k = Random() * 3.0f;
+
+		Matrix4::AddScalar(r, a, b);
+		Matrix4::Add(t, a, b);
+		TEST_CHECK(Same(t, r));
+		t = a;
+		Matrix4::Add(t, t, b);
+		TEST_CHECK(Same(t, r));
+		t = b;
+		Matrix4::Add(t, a, t);
+		TEST_CHECK(Same(t, r));
+
+		Matrix4::SubScalar(r, a, b);
+		Matrix4::Sub(t, a, b);
+		TEST_CHECK(Same(t, r));
+		t = a;
+		Matrix4::Sub(t, t, b);
+		TEST_CHECK(Same(t, r));
+		t = b;
+		Matrix4::Sub(t, a, t);
+		TEST_CHECK(Same(t, r));
+
+		Matrix4::ScaleScalar(r, a, k);
+		Matrix4::Scale(t, a, k);
+		TEST_CHECK(Same(t, r));
+		t = a;
+		Matrix4::Scale(t, t, k);
+		TEST_CHECK(Same(t, r));
+
+		Matrix4::TransposeScalar(r, a);
+		Matrix4::Transpose(t, a);
+		TEST_CHECK(Same(t, r));
+		t = a;
+		Matrix4::Transpose(t, t);
+		TEST_CHECK(Same(t, r));
+	}
+}
+
+
+//---------------------------------------------------------------------
+// Determinant
+//---------------------------------------------------------------------
+static void Test_Determinant()
+{
+	for (int n = 0; n < 200; n++) {
+		Matrix4 a = RandomMatrix();
+		float r = Matrix4::DeterminantScalar(a);
+		float t = Matrix4::Determinant(a);
+		TEST_CHECK(fabsf(t - r) <= 1e-5f * fabsf(r));
+	}
+
+	// small integers are exact in every summation order
+	Matrix4 a(2, 0, 1, 3,  1, 1, 0, 2,  0, 4, 1, 1,  3, 0, 2, 1);
+	TEST_CHECK(Matrix4::Determinant(a) == Matrix4::DeterminantScalar(a));
+	a.m30 = a.m00, a.m31 = a.m01, a.m32 = a.m02, a.m33 = a.m03;
+	TEST_CHECK(Matrix4::Determinant(a) == 0.0f);
+}
+
+
+//---------------------------------------------------------------------
+// Inverse, t aliasing a, singular input leaves t untouched
+//---------------------------------------------------------------------
+static void Test_Inverse()
+{
+	Matrix4 identity;
+	identity.SetIdentity();
+
+	for (int n = 0; n < 200; n++) {
+		Matrix4 a = RandomMatrix(), r, t, p;
+		TEST_CHECK(Matrix4::InverseScalar(r, a));
+		TEST_CHECK(Matrix4::Inverse(t, a));
+		TEST_CHECK(Near(t, r, 1e-5f));
+		Matrix4::MultiplyScalar(p, a, t);
+		TEST_CHECK(Near(p, identity, 1e-5f));
+
+		t = a;
+		TEST_CHECK(Matrix4::Inverse(t, t));
+		TEST_CHECK(Near(t, r, 1e-5f));
+	}
+
+	// zero matrix, a repeated row, a zero column
+	Matrix4 singular[3];
+	singular[0].SetZero();
+	singular[1] = Matrix4(2, 0, 1, 3,  1, 1, 0, 2,  2, 0, 1, 3,  3, 0, 2, 1);
+	singular[2] = Matrix4(2, 0, 1, 3,  1, 0, 0, 2,  0, 0, 1, 1,  3, 0, 2, 1);
+	for (int i = 0; i < 3; i++) {
+		Matrix4 t = Sentinel();
+		TEST_CHECK(!Matrix4::Inverse(t, singular[i]));
+		TEST_CHECK(Same(t, Sentinel()));
+		t = singular[i];
+		TEST_CHECK(!Matrix4::Inverse(t, t));
+		TEST_CHECK(Same(t, singular[i]));
+		TEST_CHECK(Same(singular[i].Inverse(), identity));
+	}
+}
+
+
+//---------------------------------------------------------------------
+// InverseAffine against InverseAffineScalar and the general inverse
+//---------------------------------------------------------------------
+static void Test_InverseAffine()
+{
+	Matrix4 identity;
+	identity.SetIdentity();
+
+	for (int n = 0; n < 200; n++) {
+		Matrix4 a = RandomAffine(), r, t, g, p;
+		TEST_CHECK(Matrix4::InverseAffineScalar(r, a));
+		TEST_CHECK(Matrix4::InverseAffine(t, a));
+		TEST_CHECK(Near(t, r, 1e-5f));
+		TEST_CHECK(Matrix4::InverseScalar(g, a));
+		TEST_CHECK(Near(t, g, 1e-5f));
+		TEST_CHECK(t.m03 == 0.0f && t.m13 == 0.0f && t.m23 == 0.0f && t.m33 == 1.0f);
+		Matrix4::MultiplyScalar(p, a, t);
+		TEST_CHECK(Near(p, identity, 1e-5f));
+
+		t = a;
+		TEST_CHECK(Matrix4::InverseAffine(t, t));
+		TEST_CHECK(Near(t, r, 1e-5f));
+	}
+
+	// zero scale on one axis, and a row that is the sum of the others
+	Matrix4 singular[2];
+	singular[0] = Matrix4(2, 0, 0, 0,  0, 0, 0, 0,  0, 0, 3, 0,  5, 6, 7, 1);
+	singular[1] = Matrix4(1, 2, 0, 0,  0, 1, 3, 0,  1, 3, 3, 0,  5, 6, 7, 1);
+	for (int i = 0; i < 2; i++) {
+		Matrix4 t = Sentinel();
+		TEST_CHECK(!Matrix4::InverseAffine(t, singular[i]));
+		TEST_CHECK(Same(t, Sentinel()));
+		t = singular[i];
+		TEST_CHECK(!Matrix4::InverseAffine(t, t));
+		TEST_CHECK(Same(t, singular[i]));
+		TEST_CHECK(Same(singular[i].InverseAffine(), identity));
+	}
+}
+
+
+//---------------------------------------------------------------------
+// cases
+//---------------------------------------------------------------------
+struct TestCase
+{
+	const char *name;
+	void (*proc)();
+};
+
+static const TestCase g_cases[] = {
+	{ "Multiply", Test_Multiply },
+	{ "Transform", Test_Transform },
+	{ "TransformArray", Test_TransformArray },
+	{ "Elementwise", Test_Elementwise },
+	{ "Determinant", Test_Determinant },
+	{ "Inverse", Test_Inverse },
+	{ "InverseAffine", Test_InverseAffine },
+};
+
+
+//---------------------------------------------------------------------
+// main
+//---------------------------------------------------------------------
+int main(int argc, char *argv[])
+{
+	const char *filter = NULL;
+
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "-f") == 0 && i + 1 < argc) {
+			filter = argv[++i];
+		}
+		else {
+			printf("usage: %s [-f filter]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	printf("platform %d\n", GFX_PLATFORM);
+
+	for (size_t c = 0; c < sizeof(g_cases) / sizeof(g_cases[0]); c++) {
+		if (filter && strstr(g_cases[c].name, filter) == NULL) continue;
+		int failed = g_failed;
+		g_cases[c].proc();
+		printf("%-32s %s\n", g_cases[c].name, (g_failed == failed)? "ok" : "FAILED");
+	}
+
+	printf("%s\n", (g_failed == 0)? "all passed" : "failures");
+	return (g_failed == 0)? 0 : 1;
+}
+
+
@@ -0,0 +1,313 @@
+//=====================================================================
+//
+// GFXTestTexture.cpp - deferred texture upload tests
+//
+// Last Modified: 2026/10/19 10:41:08
+//
+// textures are CMemoryTexture so it runs anywhere:
+//
+//   g++ -O1 -I../gfx GFXTestTexture.cpp ../gfx/GFXTexture.cpp
+//      ../gfx/CMemoryTexture.cpp ../gfx/GFXDriver.cpp ../gfx/GFXImage.cpp
+//      ../gfx/GFXPixel.cpp ../gfx/GFXBlend.cpp ../gfx/GFXMipmap.cpp
+//      ../gfx/GFXUtil.cpp ../gfx/GFXTexturePool.cpp -lpthread
+//
+// usage: GFXTestTexture [-f filter], exits with 1 if a check failed
+//
+//=====================================================================
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#include "CMemoryTexture.h"
+#include "GFXDriver.h"
+
+using namespace GFX;
+
+
+//---------------------------------------------------------------------
+// checks
+//---------------------------------------------------------------------
+static int g_failed = 0;
+
+#define TEST_CHECK(x) do { \
+		if (!(x)) { \
+			printf("  %s:%d: %s\n", __FILE__, __LINE__, #x); \
+			g_failed++; \
+		} \
+	} while (0)
+
+static uint32_t g_seed = 0x12345678;
+
+static int Random(int range)
+{
+	g_seed = g_seed * 1664525u + 1013904223u;
+	return (int)((g_seed >> 8) % (uint32_t)range);
+}
+
+
+//---------------------------------------------------------------------
+// helpers: a w x h A8R8G8B8 texture filled with color, and its level 0
+// read back
+//---------------------------------------------------------------------
+static void TestFill(CMemoryTexture& texture, int w, int h, uint32_t color)
+{
+	texture.Create(w, h, FMT_A8R8G8B8);
+	std::vector<uint32_t> pixels((size_t)w * h, color);
+	texture.UpdateTexture(0, NULL, &pixels[0], w * 4);
+}
+
+static std::vector<uint32_t> TestRead(CMemoryTexture& texture)
+{
+	int w = texture.GetWidth();
+	std::vector<uint32_t> pixels((size_t)w * texture.GetHeight(), 0);
+	texture.ReadTexture(0, NULL, &pixels[0], w * 4);
+	return pixels;
+}
+
+static void TestStage(Texture& texture, int left, int top, int right, int bottom,
+		uint32_t color, std::vector<uint32_t> *model)
+{
+	Rect rc;
+	rc.left = left;
+	rc.top = top;
+	rc.right = right;
+	rc.bottom = bottom;
+	int w = right - left;
+	std::vector<uint32_t> pixels((size_t)w * (bottom - top), color);
+	texture.UpdateTexture(0, &rc, &pixels[0], w * 4);
+	if (model) {
+		for (int y = top; y < bottom; y++) {
+			for (int x = left; x < right; x++) {
+				(*model)[(size_t)y * texture.GetWidth() + x] = color;
+			}
+		}
+	}
+}
+
+
+//---------------------------------------------------------------------
+// partly overlapping rects must not merge into their bounding box
+//---------------------------------------------------------------------
+static void Test_MergeOverlap()
+{
+	VideoDriver driver;
+	CMemoryTexture texture;
+	TestFill(texture, 32, 32, 0x11223344);
+	std::vector<uint32_t> model((size_t)32 * 32, 0x11223344);
+	texture.SetDeferred(&driver);
+	TestStage(texture, 0, 0, 10, 10, 0xff0000ff, &model);
+	TestStage(texture, 0, 0, 11, 9, 0xff00ff00, &model);
+	TEST_CHECK(texture.GetPendingRects() == 2);
+	driver.FlushTextures();
+	std::vector<uint32_t> pixels = TestRead(texture);
+	TEST_CHECK(pixels[9 * 32 + 10] == 0x11223344);
+	TEST_CHECK(pixels == model);
+	texture.SetDeferred(NULL);
+}
+
+
+//---------------------------------------------------------------------
+// contained, touching and overlapping strips do merge
+//---------------------------------------------------------------------
+static void Test_MergeExact()
+{
+	VideoDriver driver;
+	CMemoryTexture texture;
+	TestFill(texture, 32, 32, 0x11223344);
+	std::vector<uint32_t> model((size_t)32 * 32, 0x11223344);
+	texture.SetDeferred(&driver);
+	TestStage(texture, 4, 4, 20, 8, 1, &model);
+	TestStage(texture, 4, 8, 20, 12, 2, &model);
+	TestStage(texture, 4, 10, 20, 16, 3, &model);
+	TestStage(texture, 6, 6, 10, 10, 4, &model);
+	TEST_CHECK(texture.GetPendingRects() == 1);
+	driver.FlushTextures();
+	TEST_CHECK(TestRead(texture) == model);
+	texture.SetDeferred(NULL);
+}
+
+
+//---------------------------------------------------------------------
+// more disjoint rects than a level keeps: nothing unstaged is written
+//---------------------------------------------------------------------
+static void Test_MergeOverflow()
+{
+	VideoDriver driver;
+	CMemoryTexture texture;
+	TestFill(texture, 64, 64, 0x11223344);
+	std::vector<uint32_t> model((size_t)64 * 64, 0x11223344);
+	texture.SetDeferred(&driver);
+	for (int i = 0; i < 65; i++) {
+		int x = (i % 32) * 2, y = (i / 32) * 2;
+		TestStage(texture, x, y, x + 1, y + 1, 0xff000000 | i, &model);
+	}
+	TEST_CHECK(texture.GetPendingRects() <= 65);
+	driver.FlushTextures();
+	TEST_CHECK(TestRead(texture) == model);
+	texture.SetDeferred(NULL);
+}
+
+
+//---------------------------------------------------------------------
+// random rects against a model of the texture
+//---------------------------------------------------------------------
+static void Test_MergeRandom()
+{
+	VideoDriver driver;
+	CMemoryTexture texture;
+	TestFill(texture, 128, 64, 0x11223344);
+	std::vector<uint32_t> model((size_t)128 * 64, 0x11223344);
+	texture.SetDeferred(&driver);
+	for (int frame = 0; frame < 20; frame++) {
+		int count = Random(200);
+		for (int i = 0; i < count; i++) {
+			int x = Random(120), y = Random(56);
+			TestStage(texture, x, y, x + 1 + Random(8), y + 1 + Random(8),
+					0xff000000 | (frame << 16) | i, &model);
+		}
+		driver.FlushTextures();
+		TEST_CHECK(texture.GetPendingRects() == 0);
+		TEST_CHECK(TestRead(texture) == model);
+	}
+	texture.SetDeferred(NULL);
+}
+
+
+//---------------------------------------------------------------------
+// reads of a deferred texture see its staged updates
+//---------------------------------------------------------------------
+static void Test_ReadPending()
+{
+	VideoDriver driver;
+	CMemoryTexture texture;
+	TestFill(texture, 16, 16, 0x11223344);
+	texture.SetDeferred(&driver);
+	TestStage(texture, 2, 2, 6, 6, 0xff0000ff, NULL);
+	uint32_t pixel = 0;
+	Rect rc;
+	rc.left = 3;
+	rc.top = 3;
+	rc.right = 4;
+	rc.bottom = 4;
+	TEST_CHECK(texture.ReadTexture(0, &rc, &pixel, 4));
+	TEST_CHECK(pixel == 0xff0000ff);
+	TEST_CHECK(texture.GetPendingRects() == 0);
+
+	TestStage(texture, 8, 8, 10, 10, 0xff00ff00, NULL);
+	Image image(16, 16, FMT_A8R8G8B8);
+	texture.SaveToImage(0, &image);
+	TEST_CHECK(((const uint32_t*)image.GetLine(9))[9] == 0xff00ff00);
+
+	// converting read
+	TestStage(texture, 0, 0, 1, 1, 0xffffffff, NULL);
+	Image gray(16, 16, FMT_G8);
+	texture.CopyTo(0, 0, 0, &gray, 0, 0, 16, 16);
+	TEST_CHECK(gray.GetLine(0)[0] == 0xff);
+	texture.SetDeferred(NULL);
+}
+
+
+//---------------------------------------------------------------------
+// copying from a deferred texture reads its staged updates
+//---------------------------------------------------------------------
+static void Test_CopyPendingSource()
+{
+	VideoDriver driver;
+	CMemoryTexture source, target;
+	TestFill(source, 16, 16, 0x11223344);
+	TestFill(target, 16, 16, 0);
+	source.SetDeferred(&driver);
+	TestStage(source, 0, 0, 16, 8, 0xff0000ff, NULL);
+	target.CopyFrom(0, 0, &source, 0, 0, 16, 16);
+	std::vector<uint32_t> pixels = TestRead(target);
+	TEST_CHECK(pixels[0] == 0xff0000ff);
+	TEST_CHECK(pixels[8 * 16] == 0x11223344);
+	TEST_CHECK(source.GetPendingRects() == 0);
+	source.SetDeferred(NULL);
+}
+
+
+//---------------------------------------------------------------------
+// converting reads are readers too: they work while another read
+// lock is held, and a converting write waits for it to go away
+//---------------------------------------------------------------------
+static void Test_ConvertUnderReadLock()
+{
+	CMemoryTexture texture;
+	TestFill(texture, 16, 16, 0xffff0000);
+	TEST_CHECK(texture.Lock(0, NULL, true) != NULL);
+
+	Image same(16, 16, FMT_A8R8G8B8);
+	texture.SaveToImage(0, &same);
+	TEST_CHECK(((const uint32_t*)same.GetLine(5))[7] == 0xffff0000);
+
+	Image rgb565(16, 16, FMT_R5G6B5);
+	memset(rgb565.GetLine(0), 0, (size_t)rgb565.GetPitch() * 16);
+	texture.SaveToImage(0, &rgb565);
+	TEST_CHECK(((const uint16_t*)rgb565.GetLine(5))[7] == 0xf800);
+	TEST_CHECK(((const uint16_t*)rgb565.GetLine(15))[15] == 0xf800);
+
+	// a write must not slip in under the reader
+	Image blue(4, 4, FMT_R5G6B5);
+	for (int y = 0; y < 4; y++) {
+		for (int x = 0; x < 4; x++) ((uint16_t*)blue.GetLine(y))[x] = 0x001f;
+	}
+	texture.CopyFrom(0, 0, 0, &blue, 0, 0, 4, 4);
+	texture.Unlock(0);
+	TEST_CHECK(TestRead(texture)[0] == 0xffff0000);
+
+	texture.CopyFrom(0, 0, 0, &blue, 0, 0, 4, 4);
+	TEST_CHECK(TestRead(texture)[0] == 0xff0000ff);
+}
+
+
+//---------------------------------------------------------------------
+// cases
+//---------------------------------------------------------------------
+struct TestCase
+{
+	const char *name;
+	void (*proc)();
+};
+
+static const TestCase g_cases[] = {
+	{ "MergeOverlap", Test_MergeOverlap },
+	{ "MergeExact", Test_MergeExact },
+	{ "MergeOverflow", Test_MergeOverflow },
+	{ "MergeRandom", Test_MergeRandom },
+	{ "ReadPending", Test_ReadPending },
+	{ "CopyPendingSource", Test_CopyPendingSource },
+	{ "ConvertUnderReadLock", Test_ConvertUnderReadLock },
+};
+
+
+//---------------------------------------------------------------------
+// main
+//---------------------------------------------------------------------
+int main(int argc, char *argv[])
+{
+	const char *filter = NULL;
+
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "-f") == 0 && i + 1 < argc) {
+			filter = argv[++i];
+		}
+		else {
+			printf("usage: %s [-f filter]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	for (size_t c = 0; c < sizeof(g_cases) / sizeof(g_cases[0]); c++) {
+		if (filter && strstr(g_cases[c].name, filter) == NULL) continue;
+		int failed = g_failed;
+		g_cases[c].proc();
+		printf("%-32s %s\n", g_cases[c].name, (g_failed == failed)? "ok" : "FAILED");
+	}
+
+	printf("%s\n", (g_failed == 0)? "all passed" : "failures");
+	return (g_failed == 0)? 0 : 1;
+}
+
+